@@ -27,6 +27,7 @@
 #include "log.h"
 
 #include <sstream>
+#include <map>
 
 /**
  * \file
@@ -261,6 +262,110 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * An attribute which a Config path can go through: a pointer to an
+ * object or a container of objects.
+ */
+struct PathAttribute
+{
+  /** The attribute name. */
+  std::string name;
+  /** True for a container of objects, false for a pointer. */
+  bool isContainer;
+  /**
+   * The accessor which ObjectBase::GetAttribute uses for this name,
+   * or 0 if the attribute is not gettable.
+   */
+  Ptr<const AttributeAccessor> accessor;
+  /** The accessor of a container, or 0. */
+  Ptr<const ObjectPtrContainerAccessor> container;
+};
+
+/**
+ * \ingroup config-impl
+ * Index of the attributes which the Config paths go through, compiled
+ * once for each TypeId and path element.  It depends only on the
+ * TypeIds, not on the objects, thus it is never invalidated as nodes,
+ * devices and any other objects are created.
+ */
+class PathIndex : public Singleton<PathIndex>
+{
+public:
+  /**
+   * Get the attributes of the objects of a TypeId which match a Config
+   * path element, in the order of a walk of the TypeId and its parents.
+   *
+   * \param [in] tid The instance TypeId of the object.
+   * \param [in] item The path element, an attribute name or "*".
+   * \returns The matching pointer and container attributes.
+   */
+  const std::vector<PathAttribute> & GetAttributes (TypeId tid, std::string item);
+
+private:
+  /** Container type of the index: attributes by TypeId uid and path element. */
+  typedef std::map<std::pair<uint16_t, std::string>, std::vector<PathAttribute> > Index;
+  /** The index. */
+  Index m_index;
+
+};  // class PathIndex
+
+const std::vector<PathAttribute> &
+PathIndex::GetAttributes (TypeId instanceTid, std::string item)
+{
+  NS_LOG_FUNCTION (this << instanceTid << item);
+  std::pair<uint16_t, std::string> key (instanceTid.GetUid (), item);
+  Index::iterator it = m_index.find (key);
+  if (it != m_index.end ())
+    {
+      return it->second;
+    }
+
+  std::vector<PathAttribute> &attributes = m_index[key];
+  TypeId tid;
+  TypeId nextTid = instanceTid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          PathAttribute attribute;
+          attribute.name = info.name;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = false;
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isContainer = true;
+            }
+          else
+            {
+              // this could be anything else and we don't know what to do with it.
+              continue;
+            }
+          struct TypeId::AttributeInformation getInfo;
+          if (instanceTid.LookupAttributeByName (info.name, &getInfo)
+              && (getInfo.flags & TypeId::ATTR_GET) && getInfo.accessor->HasGetter ())
+            {
+              attribute.accessor = getInfo.accessor;
+            }
+          if (attribute.isContainer)
+            {
+              attribute.container = dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (attribute.accessor));
+            }
+          attributes.push_back (attribute);
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return attributes;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -304,6 +409,24 @@ private:
    * \param [in,out] vector The resulting list of matching objects.
    */
   void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  /**
+   * Parse the next element of the Config path as a plain index of a
+   * container, i.e., a string of decimal digits.
+   *
+   * \param [in] path The remaining Config path.
+   * \param [out] index The index.
+   * \param [out] pathLeft The Config path after the index.
+   * \returns \c true if the next element is a plain index.
+   */
+  bool ParseIndex (std::string path, uint32_t *index, std::string *pathLeft) const;
+  /**
+   * Get the value of an attribute of an object found on the path.
+   *
+   * \param [in] object The object.
+   * \param [in] attribute The attribute.
+   * \param [out] value The value.
+   */
+  void GetPathAttribute (Ptr<Object> object, const PathAttribute &attribute, AttributeValue &value) const;
   /**
    * Handle one object found on the path.
    *
@@ -483,63 +606,57 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const std::vector<PathAttribute> &attributes =
+        PathIndex::Get ()->GetAttributes (root->GetInstanceTypeId (), item);
+      for (std::vector<PathAttribute>::const_iterator i = attributes.begin (); i != attributes.end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!i->isContainer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              GetPathAttribute (root, *i, ptr);
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
+              m_workStack.push_back (i->name);
+              DoResolve (pathLeft, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath () << pathLeft);
+              m_workStack.push_back (i->name);
+              uint32_t index;
+              std::string indexPathLeft;
+              if (i->container != 0 && ParseIndex (pathLeft, &index, &indexPathLeft))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
+                  // look up the single instance, without copying the whole container
+                  Ptr<Object> object = i->container->Find (PeekPointer (root), index);
+                  if (object != 0)
                     {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
+                      std::ostringstream oss;
+                      oss << index;
+                      m_workStack.push_back (oss.str ());
+                      DoResolve (indexPathLeft, object);
+                      m_workStack.pop_back ();
                     }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
                 }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              else
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
                   ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
+                  GetPathAttribute (root, *i, vector);
                   DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.pop_back ();
             }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -547,6 +664,44 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     }
 }
 
+bool
+Resolver::ParseIndex (std::string path, uint32_t *index, std::string *pathLeft) const
+{
+  NS_LOG_FUNCTION (this << path << index << pathLeft);
+  std::string::size_type next = path.find ("/", 1);
+  if (next == std::string::npos || next == 1)
+    {
+      return false;
+    }
+  uint64_t value = 0;
+  for (std::string::size_type i = 1; i < next; i++)
+    {
+      if (path[i] < '0' || path[i] > '9')
+        {
+          return false;
+        }
+      value = value * 10 + (path[i] - '0');
+      if (value > 0xffffffff)
+        {
+          return false;
+        }
+    }
+  *index = value;
+  *pathLeft = path.substr (next, path.size () - next);
+  return true;
+}
+
+void
+Resolver::GetPathAttribute (Ptr<Object> object, const PathAttribute &attribute, AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << object << attribute.name << &value);
+  if (attribute.accessor == 0 || !attribute.accessor->Get (PeekPointer (object), value))
+    {
+      // the generic path, which reports the errors
+      object->GetAttribute (attribute.name, value);
+    }
+}
+
 void 
 Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
 {
@@ -25,10 +25,13 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "string.h"
 #include "assert.h"
+#include "abort.h"
 #include "log.h"
 
 #include <cmath>
+#include <cstring>
 
 
 /**
@@ -46,6 +49,15 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+/** The magic string at the start of an event trace. */
+static const char g_eventTraceMagic[8] = {'N', 'S', '3', 'E', 'V', 'T', 'R', 'C'};
+/** The version of the format of the event traces. */
+static const uint32_t g_eventTraceVersion = 1;
+/** The number of records buffered before writing them to the event trace. */
+static const uint32_t g_eventTraceBufferRecords = 4096;
+
+const uint32_t DefaultSimulatorImpl::EventTraceRecordSize;
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,6 +65,12 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventTraceFilename",
+                   "The name of the binary trace of the events inserted "
+                   "in the event queue, or empty to disable it",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::SetEventTraceFilename),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -73,11 +91,13 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_unscheduledEvents = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_eventTrace = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  SetEventTraceFilename ("");
 }
 
 void
@@ -92,6 +112,7 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  SetEventTraceFilename ("");
   SimulatorImpl::DoDispose ();
 }
 void
@@ -127,6 +148,87 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
   m_events = scheduler;
 }
 
+void
+DefaultSimulatorImpl::SetEventTraceFilename (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (m_eventTrace != 0)
+    {
+      FlushEventTrace ();
+      m_eventTrace->close ();
+      delete m_eventTrace;
+      m_eventTrace = 0;
+    }
+  if (filename.empty ())
+    {
+      return;
+    }
+
+  m_eventTrace = new std::ofstream (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (!m_eventTrace->good (), "Cannot open the event trace " << filename);
+  m_eventTrace->write (g_eventTraceMagic, sizeof (g_eventTraceMagic));
+  m_eventTrace->write ((const char *) &g_eventTraceVersion, sizeof (g_eventTraceVersion));
+  m_eventTrace->write ((const char *) &EventTraceRecordSize, sizeof (EventTraceRecordSize));
+  m_eventTraceBuffer.reserve (g_eventTraceBufferRecords * EventTraceRecordSize);
+}
+
+void
+DefaultSimulatorImpl::TraceInsert (const Scheduler::Event &ev)
+{
+  if (m_eventTrace == 0)
+    {
+      return;
+    }
+  char record[EventTraceRecordSize];
+  std::memcpy (record, &m_currentTs, 8);
+  std::memcpy (record + 8, &ev.key.m_ts, 8);
+  std::memcpy (record + 16, &ev.key.m_context, 4);
+  m_eventTraceBuffer.insert (m_eventTraceBuffer.end (), record, record + EventTraceRecordSize);
+  if (m_eventTraceBuffer.size () >= g_eventTraceBufferRecords * EventTraceRecordSize)
+    {
+      FlushEventTrace ();
+    }
+}
+
+void
+DefaultSimulatorImpl::FlushEventTrace (void)
+{
+  if (!m_eventTraceBuffer.empty ())
+    {
+      m_eventTrace->write (&m_eventTraceBuffer[0], m_eventTraceBuffer.size ());
+      m_eventTraceBuffer.clear ();
+    }
+}
+
+bool
+DefaultSimulatorImpl::ReadEventTrace (std::string filename, std::vector<EventTraceRecord> &records)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (g_eventTraceMagic)];
+  uint32_t version = 0;
+  uint32_t recordSize = 0;
+  file.read (magic, sizeof (magic));
+  file.read ((char *) &version, sizeof (version));
+  file.read ((char *) &recordSize, sizeof (recordSize));
+  if (!file.good () || std::memcmp (magic, g_eventTraceMagic, sizeof (magic)) != 0
+      || version != g_eventTraceVersion || recordSize != EventTraceRecordSize)
+    {
+      return false;
+    }
+
+  char record[EventTraceRecordSize];
+  while (file.read (record, EventTraceRecordSize))
+    {
+      EventTraceRecord ev;
+      std::memcpy (&ev.insertTs, record, 8);
+      std::memcpy (&ev.eventTs, record + 8, 8);
+      std::memcpy (&ev.context, record + 16, 4);
+      records.push_back (ev);
+    }
+  return true;
+}
+
 // System ID for non-distributed simulation is always zero
 uint32_t 
 DefaultSimulatorImpl::GetSystemId (void) const
@@ -185,6 +287,7 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
+       TraceInsert (ev);
     }
 }
 
@@ -242,6 +345,7 @@ DefaultSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  TraceInsert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
@@ -261,6 +365,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       m_uid++;
       m_unscheduledEvents++;
       m_events->Insert (ev);
+      TraceInsert (ev);
     }
   else
     {
@@ -290,6 +395,7 @@ DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
   m_uid++;
   m_unscheduledEvents++;
   m_events->Insert (ev);
+  TraceInsert (ev);
   return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
 }
 
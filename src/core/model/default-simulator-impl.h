@@ -30,6 +30,9 @@
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
+#include <fstream>
 
 /**
  * \file
@@ -43,6 +46,15 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * If the EventTraceFilename attribute is set, every event inserted in
+ * the event queue is recorded in a binary event trace, which
+ * utils/bench-simulator.cc can replay against the Scheduler
+ * implementations.  The trace has a header with a magic string, the
+ * format version and the record size, followed by a record of
+ * EventTraceRecordSize bytes for each event, with the insertion time
+ * and the event time in time steps, and the event context, in the
+ * byte order of the host.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -78,6 +90,26 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /** An event of an event trace. */
+  struct EventTraceRecord
+  {
+    uint64_t insertTs;     /**< The time of the insertion, in time steps. */
+    uint64_t eventTs;      /**< The time of the event, in time steps. */
+    uint32_t context;      /**< The context of the event. */
+  };
+  /** The size of a record of an event trace, in bytes. */
+  static const uint32_t EventTraceRecordSize = 20;
+
+  /**
+   * Read an event trace written with the EventTraceFilename attribute.
+   *
+   * \param [in] filename The name of the trace.
+   * \param [out] records The events of the trace, in the order of
+   *        insertion.
+   * \returns \c false if the file is not an event trace of this version.
+   */
+  static bool ReadEventTrace (std::string filename, std::vector<EventTraceRecord> &records);
+
 private:
   virtual void DoDispose (void);
 
@@ -85,6 +117,20 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /**
+   * Open the event trace, or close it if the name is empty.
+   *
+   * \param [in] filename The name of the trace.
+   */
+  void SetEventTraceFilename (std::string filename);
+  /**
+   * Record the insertion of an event, if the event trace is open.
+   *
+   * \param [in] ev The event.
+   */
+  void TraceInsert (const Scheduler::Event &ev);
+  /** Write the buffered records to the event trace. */
+  void FlushEventTrace (void);
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -132,6 +178,11 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The event trace, or 0 if disabled. */
+  std::ofstream *m_eventTrace;
+  /** The records not yet written to the event trace. */
+  std::vector<char> m_eventTraceBuffer;
 };
 
 } // namespace ns3
@@ -0,0 +1,389 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "abort.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+/** Number of buckets tracked by a word of the bitmap. */
+static const uint32_t g_bucketsPerWord = 64;
+/** Number of nodes allocated at once by the pool. */
+static const uint32_t g_nodesPerBlock = 1024;
+/**
+ * Number of events of a bucket which a new event can precede, beyond
+ * which it goes to the overflow map.
+ */
+static const uint32_t g_maxScan = 16;
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("BucketWidth",
+                   "The duration of the interval of each bucket",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&LadderScheduler::m_bucketWidth),
+                   MakeTimeChecker ())
+    .AddAttribute ("NumBuckets",
+                   "The number of buckets, which cover the near future; "
+                   "the events after them are kept in an overflow map",
+                   UintegerValue (32768),
+                   MakeUintegerAccessor (&LadderScheduler::m_nBuckets),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_nBuckets (0),
+    m_width (0),
+    m_firstSlot (0),
+    m_nearSize (0),
+    m_freeNodes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<EventNode *>::iterator i = m_blocks.begin (); i != m_blocks.end (); ++i)
+    {
+      delete [] *i;
+    }
+  m_blocks.clear ();
+  m_freeNodes = 0;
+}
+
+void
+LadderScheduler::Init (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (!m_bucketWidth.IsStrictlyPositive (), "The BucketWidth must be positive");
+  m_width = m_bucketWidth.GetTimeStep ();
+  m_buckets.assign (m_nBuckets, Bucket ());
+  m_occupied.assign ((m_nBuckets + g_bucketsPerWord - 1) / g_bucketsPerWord, 0);
+  m_firstSlot = 0;
+  NS_LOG_LOGIC ("width=" << m_width << " nBuckets=" << m_nBuckets);
+}
+
+LadderScheduler::EventNode *
+LadderScheduler::AllocateNode (void)
+{
+  if (m_freeNodes == 0)
+    {
+      EventNode *block = new EventNode[g_nodesPerBlock];
+      m_blocks.push_back (block);
+      for (uint32_t i = 0; i < g_nodesPerBlock; i++)
+        {
+          block[i].next = m_freeNodes;
+          m_freeNodes = &block[i];
+        }
+      NS_LOG_LOGIC ("pool of " << m_blocks.size () * g_nodesPerBlock << " nodes");
+    }
+  EventNode *node = m_freeNodes;
+  m_freeNodes = node->next;
+  return node;
+}
+
+void
+LadderScheduler::FreeNode (EventNode *node)
+{
+  node->next = m_freeNodes;
+  m_freeNodes = node;
+}
+
+uint64_t
+LadderScheduler::GetSlot (uint64_t ts) const
+{
+  uint64_t slot = ts / m_width;
+  // events in the past, which the simulator never inserts, are kept
+  // sorted in the first bucket of the window
+  return slot < m_firstSlot ? m_firstSlot : slot;
+}
+
+bool
+LadderScheduler::InsertInBucket (const Scheduler::Event &ev, uint64_t slot)
+{
+  uint32_t index = slot % m_nBuckets;
+  Bucket &bucket = m_buckets[index];
+  // look for the position from the tail, where most events go
+  EventNode *prev = bucket.tail;
+  uint32_t scanned = 0;
+  while (prev != 0 && ev.key < prev->ev.key)
+    {
+      if (++scanned > g_maxScan)
+        {
+          return false;
+        }
+      prev = prev->prev;
+    }
+
+  EventNode *node = AllocateNode ();
+  node->ev = ev;
+  node->prev = prev;
+  if (prev == 0)
+    {
+      node->next = bucket.head;
+      bucket.head = node;
+    }
+  else
+    {
+      node->next = prev->next;
+      prev->next = node;
+    }
+  if (node->next == 0)
+    {
+      bucket.tail = node;
+    }
+  else
+    {
+      node->next->prev = node;
+    }
+  m_occupied[index / g_bucketsPerWord] |= (uint64_t)1 << (index % g_bucketsPerWord);
+  m_nearSize++;
+  return true;
+}
+
+Scheduler::Event
+LadderScheduler::RemoveFromBucket (uint64_t slot)
+{
+  uint32_t index = slot % m_nBuckets;
+  Bucket &bucket = m_buckets[index];
+  EventNode *node = bucket.head;
+  NS_ASSERT (node != 0);
+  bucket.head = node->next;
+  if (bucket.head == 0)
+    {
+      bucket.tail = 0;
+      m_occupied[index / g_bucketsPerWord] &= ~((uint64_t)1 << (index % g_bucketsPerWord));
+    }
+  else
+    {
+      bucket.head->prev = 0;
+    }
+  m_nearSize--;
+  Scheduler::Event ev = node->ev;
+  FreeNode (node);
+  return ev;
+}
+
+uint64_t
+LadderScheduler::FindFirstSlot (void) const
+{
+  NS_ASSERT (m_nearSize > 0);
+  uint32_t start = m_firstSlot % m_nBuckets;
+  uint32_t index = start;
+  while (true)
+    {
+      uint32_t word = index / g_bucketsPerWord;
+      uint64_t bits = m_occupied[word] >> (index % g_bucketsPerWord);
+      if (bits != 0)
+        {
+          uint32_t found = index + __builtin_ctzll (bits);
+          return m_firstSlot + (found + m_nBuckets - start) % m_nBuckets;
+        }
+      // wrap around to the intervals of the window which follow the last bucket
+      index = (word + 1) * g_bucketsPerWord;
+      if (index >= m_nBuckets)
+        {
+          index = 0;
+        }
+    }
+}
+
+void
+LadderScheduler::Advance (uint64_t slot)
+{
+  NS_LOG_FUNCTION (this << slot);
+  NS_ASSERT (slot >= m_firstSlot);
+  uint64_t oldEndSlot = m_firstSlot + m_nBuckets;
+  m_firstSlot = slot;
+  if (m_overflow.empty ())
+    {
+      return;
+    }
+  // the overflow events before the old end of the window did not fit in
+  // their buckets, and they stay in the map
+  uint64_t endSlot = m_firstSlot + m_nBuckets;
+  Scheduler::EventKey key;
+  key.m_ts = oldEndSlot * m_width;
+  key.m_uid = 0;
+  key.m_context = 0;
+  EventMap::iterator i = m_overflow.lower_bound (key);
+  while (i != m_overflow.end () && i->first.m_ts / m_width < endSlot)
+    {
+      Scheduler::Event ev;
+      ev.impl = i->second;
+      ev.key = i->first;
+      if (InsertInBucket (ev, i->first.m_ts / m_width))
+        {
+          m_overflow.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (m_buckets.empty ())
+    {
+      Init ();
+    }
+  uint64_t slot = GetSlot (ev.key.m_ts);
+  if (slot >= m_firstSlot + m_nBuckets || !InsertInBucket (ev, slot))
+    {
+      std::pair<EventMap::iterator, bool> result;
+      result = m_overflow.insert (std::make_pair (ev.key, ev.impl));
+      NS_ASSERT (result.second);
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nearSize == 0 && m_overflow.empty ();
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_nearSize > 0)
+    {
+      const Scheduler::Event &ev = m_buckets[FindFirstSlot () % m_nBuckets].head->ev;
+      if (m_overflow.empty () || ev.key < m_overflow.begin ()->first)
+        {
+          return ev;
+        }
+    }
+  Scheduler::Event ev;
+  ev.impl = m_overflow.begin ()->second;
+  ev.key = m_overflow.begin ()->first;
+  return ev;
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_nearSize > 0)
+    {
+      uint64_t slot = FindFirstSlot ();
+      if (m_overflow.empty ()
+          || m_buckets[slot % m_nBuckets].head->ev.key < m_overflow.begin ()->first)
+        {
+          if (slot != m_firstSlot)
+            {
+              Advance (slot);
+            }
+          Scheduler::Event ev = RemoveFromBucket (slot);
+          NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", uid=" << ev.key.m_uid);
+          return ev;
+        }
+    }
+
+  Scheduler::Event ev;
+  ev.impl = m_overflow.begin ()->second;
+  ev.key = m_overflow.begin ()->first;
+  m_overflow.erase (m_overflow.begin ());
+  if (m_nearSize == 0)
+    {
+      // jump to the interval of the event
+      Advance (GetSlot (ev.key.m_ts));
+    }
+  NS_LOG_LOGIC ("remove overflow ts=" << ev.key.m_ts << ", uid=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t slot = GetSlot (ev.key.m_ts);
+  if (slot < m_firstSlot + m_nBuckets)
+    {
+      uint32_t index = slot % m_nBuckets;
+      Bucket &bucket = m_buckets[index];
+      EventNode *node = bucket.head;
+      while (node != 0 && node->ev.key < ev.key)
+        {
+          node = node->next;
+        }
+      if (node != 0 && node->ev.key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (node->ev.impl == ev.impl);
+          if (node->prev == 0)
+            {
+              bucket.head = node->next;
+            }
+          else
+            {
+              node->prev->next = node->next;
+            }
+          if (node->next == 0)
+            {
+              bucket.tail = node->prev;
+            }
+          else
+            {
+              node->next->prev = node->prev;
+            }
+          if (bucket.head == 0)
+            {
+              m_occupied[index / g_bucketsPerWord] &= ~((uint64_t)1 << (index % g_bucketsPerWord));
+            }
+          m_nearSize--;
+          FreeNode (node);
+          return;
+        }
+    }
+
+  // an event after the window, or which did not fit in its bucket
+  EventMap::iterator i = m_overflow.find (ev.key);
+  NS_ASSERT (i != m_overflow.end ());
+  NS_ASSERT (i->second == ev.impl);
+  m_overflow.erase (i);
+}
+
+} // namespace ns3
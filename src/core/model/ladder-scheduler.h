@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include "nstime.h"
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a two-tier event scheduler, for workloads of periodic
+ * short-horizon events
+ *
+ * The events of the near future, i.e., of the next NumBuckets intervals
+ * of duration BucketWidth, are kept in an array of buckets, each
+ * holding the events of one interval in a sorted list.  A new event
+ * usually follows all the others of its interval, and it is appended
+ * at the tail of the list, and the next event is the head of the first
+ * bucket which is not empty, found with a bitmap of the buckets.  Both
+ * operations thus take constant time.
+ *
+ * The events beyond this window are kept in an overflow std::map, and
+ * move to the buckets as the window advances.  Each event moves at most
+ * once, and the simulations with a few distant timers pay the log N
+ * cost of the map only for those.  The map also takes the events which
+ * would go deep inside a crowded bucket, so that a workload which does
+ * not match the buckets costs no more than the MapScheduler.
+ *
+ * The list nodes come from a pool, which is never shrunk, so that the
+ * steady state of a simulation does not allocate any memory for the
+ * buckets.
+ *
+ * The defaults are tuned for the mmWave frame structures: the buckets
+ * of 1 us are shorter than an OFDM symbol, so that the events of a
+ * bucket are at most those of the same symbol, and the window of about
+ * 33 ms covers the slot, subframe, HARQ and RLC timers, which fall at
+ * most a few tens of milliseconds in the future.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A node of the list of a bucket. */
+  struct EventNode
+  {
+    Scheduler::Event ev;   /**< The event. */
+    EventNode *prev;       /**< The previous node, or 0. */
+    EventNode *next;       /**< The next node, or 0, or the next free node. */
+  };
+  /** A bucket: a list of events sorted by key. */
+  struct Bucket
+  {
+    EventNode *head;       /**< The first node, or 0 if empty. */
+    EventNode *tail;       /**< The last node, or 0 if empty. */
+  };
+
+  /** Allocate the buckets, the first time that an event is inserted. */
+  void Init (void);
+  /**
+   * Get a node from the pool, which grows if empty.
+   *
+   * \returns The node.
+   */
+  EventNode * AllocateNode (void);
+  /**
+   * Return a node to the pool.
+   *
+   * \param [in] node The node.
+   */
+  void FreeNode (EventNode *node);
+  /**
+   * Get the interval of an event in the window.
+   *
+   * \param [in] ts The event time stamp.
+   * \returns The absolute index of the interval, not before the
+   *          first interval of the window.
+   */
+  uint64_t GetSlot (uint64_t ts) const;
+  /**
+   * Insert an event in the bucket of its interval, which must be in
+   * the window, unless it would go deep inside the bucket.
+   *
+   * \param [in] ev The event.
+   * \param [in] slot The interval of the event.
+   * \returns \c false if the event was not inserted.
+   */
+  bool InsertInBucket (const Scheduler::Event &ev, uint64_t slot);
+  /**
+   * Remove the first event of a bucket.
+   *
+   * \param [in] slot The interval of the bucket.
+   * \returns The event.
+   */
+  Scheduler::Event RemoveFromBucket (uint64_t slot);
+  /**
+   * Find the first bucket which is not empty.
+   *
+   * This method cannot be invoked if there are no events in the window.
+   *
+   * \returns The absolute index of its interval.
+   */
+  uint64_t FindFirstSlot (void) const;
+  /**
+   * Move the window to start at a new interval, and move to the buckets
+   * the overflow events which enter the window.  The buckets of the
+   * intervals before the new start must be empty.
+   *
+   * \param [in] slot The first interval of the window, not after the
+   *        first event.
+   */
+  void Advance (uint64_t slot);
+
+  /** Overflow type: a std::map from EventKey to EventImpl. */
+  typedef std::map<Scheduler::EventKey, EventImpl*> EventMap;
+
+  /** The duration of the interval of a bucket. */
+  Time m_bucketWidth;
+  /** The number of buckets of the window. */
+  uint32_t m_nBuckets;
+  /** The duration of the interval of a bucket, in time steps. */
+  uint64_t m_width;
+  /** The buckets, indexed by the interval modulo m_nBuckets. */
+  std::vector<Bucket> m_buckets;
+  /** A bitmap of the buckets which are not empty. */
+  std::vector<uint64_t> m_occupied;
+  /** The absolute index of the first interval of the window. */
+  uint64_t m_firstSlot;
+  /** The number of events in the buckets. */
+  uint32_t m_nearSize;
+  /**
+   * The events after the window, and those which did not fit in the
+   * buckets.
+   */
+  EventMap m_overflow;
+  /** The blocks of nodes allocated for the pool. */
+  std::vector<EventNode *> m_blocks;
+  /** The list of free nodes of the pool, linked by EventNode::next. */
+  EventNode *m_freeNodes;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -108,6 +108,25 @@ MakeObjectMapAccessor (U T::*memberVector)
       // quiet compiler.
       return 0;
     }
+    virtual Ptr<Object> DoFind (const ObjectBase *object, uint32_t index) const {
+      const T *obj = dynamic_cast<const T *> (object);
+      if (obj == 0)
+        {
+          return 0;
+        }
+      typename U::key_type key = index;
+      if (static_cast<uint32_t> (key) != index)
+        {
+          // not representable by the key type
+          return 0;
+        }
+      typename U::const_iterator it = (obj->*m_memberVector).find (key);
+      if (it == (obj->*m_memberVector).end ())
+        {
+          return 0;
+        }
+      return (*it).second;
+    }
     U T::*m_memberVector;
   } *spec = new MemberStdContainer ();
   spec->m_memberVector = memberVector;
@@ -220,6 +220,16 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get the instance of the container with the given index, without
+   * copying all the instances into an ObjectPtrContainerValue.
+   *
+   * \param [in] object The container object.
+   * \param [in] index The index of the desired instance.
+   * \returns The instance, or 0 if the container has no instance
+   *          with this index.
+   */
+  Ptr<Object> Find (const ObjectBase *object, uint32_t index) const;
 private:
   /**
    * Get the number of instances in the container.
@@ -238,6 +248,18 @@ private:
    * \returns The index requested.
    */
   virtual Ptr<Object> DoGet (const ObjectBase *object, uint32_t i, uint32_t *index) const = 0;
+  /**
+   * Get an instance from the container, identified by its index rather
+   * than by its position.  The default implementation looks first at the
+   * instance in position \p index, which has this index in the vector
+   * containers, and then at all the instances.
+   *
+   * \param [in] object The container object.
+   * \param [in] index The index of the desired instance.
+   * \returns The instance, or 0 if the container has no instance
+   *          with this index.
+   */
+  virtual Ptr<Object> DoFind (const ObjectBase *object, uint32_t index) const;
 };
 
 template <typename T, typename U, typename INDEX>
@@ -27,12 +27,14 @@
 #include "ns3/singleton.h"
 #include "ns3/object.h"
 #include "ns3/object-vector.h"
+#include "ns3/object-map.h"
 #include "ns3/names.h"
 #include "ns3/pointer.h"
 #include "ns3/log.h"
 
 
 #include <sstream>
+#include <map>
 
 /**
  * \file
@@ -273,6 +275,49 @@ DerivedConfigObject::GetTypeId (void)
   return tid;
 }
 
+/**
+ * \ingroup config-tests
+ * An object with a map of test objects.
+ */
+class MapConfigTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * Add a node to the map
+   * \param key the key of the node
+   * \param node the test object
+   */
+  void AddNode (uint16_t key, Ptr<ConfigTestObject> node);
+
+private:
+  std::map<uint16_t, Ptr<ConfigTestObject> > m_nodes; //!< NodesMap attribute target.
+};
+
+TypeId
+MapConfigTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("MapConfigTestObject")
+    .SetParent<Object> ()
+    .AddAttribute ("NodesMap", "",
+                   ObjectMapValue (),
+                   MakeObjectMapAccessor (&MapConfigTestObject::m_nodes),
+                   MakeObjectMapChecker<ConfigTestObject> ())
+    ;
+  return tid;
+}
+
+void
+MapConfigTestObject::AddNode (uint16_t key, Ptr<ConfigTestObject> node)
+{
+  m_nodes[key] = node;
+}
+
 
 /**
  * \ingroup config-tests
@@ -821,6 +866,82 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test the paths which select an element of an ObjectMap or of an
+ * ObjectVector with a plain index, which are looked up by key rather
+ * than by position.
+ */
+class ObjectMapIndexConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ObjectMapIndexConfigTestCase ();
+  /** Destructor. */
+  virtual ~ObjectMapIndexConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+ObjectMapIndexConfigTestCase::ObjectMapIndexConfigTestCase ()
+  : TestCase ("Check that a plain index selects the element of a map with that key")
+{
+}
+
+void
+ObjectMapIndexConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<MapConfigTestObject> root = CreateObject<MapConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+
+  //
+  // Keys 3 and 7 are in positions 0 and 1 of the map.
+  //
+  Ptr<ConfigTestObject> obj3 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj7 = CreateObject<ConfigTestObject> ();
+  root->AddNode (7, obj7);
+  root->AddNode (3, obj3);
+  Ptr<ConfigTestObject> obj70 = CreateObject<ConfigTestObject> ();
+  obj7->AddNodeA (obj70);
+
+  Config::Set ("/NodesMap/7/A", IntegerValue (-11));
+  obj7->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -11, "Object Attribute \"A\" not set as expected");
+  obj3->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+
+  //
+  // There is no key 0 or 1, although there are elements in these positions.
+  //
+  Config::Set ("/NodesMap/0/A", IntegerValue (-12));
+  Config::Set ("/NodesMap/1/A", IntegerValue (-12));
+  Config::Set ("/NodesMap/65539/A", IntegerValue (-12));
+  obj7->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -11, "Object Attribute \"A\" unexpectedly set");
+  obj3->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 10, "Object Attribute \"A\" unexpectedly set");
+
+  //
+  // An index with leading zeros, and a vector below a map element.
+  //
+  Config::Set ("/NodesMap/003/NodesA/0/A", IntegerValue (-13));
+  Config::Set ("/NodesMap/007/NodesA/0/A", IntegerValue (-13));
+  Config::Set ("/NodesMap/7/NodesA/1/A", IntegerValue (-14));
+  obj70->GetAttribute ("A", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -13, "Object Attribute \"A\" not set as expected");
+
+  //
+  // The resolved paths of the callbacks with context contain the keys.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/NodesMap/7/NodesA/0/");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Wrong number of matches");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodesMap/7/NodesA/0/", "Wrong resolved path");
+  NS_TEST_ASSERT_MSG_EQ ((matches.Get (0) == obj70), true, "Wrong matched object");
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -839,6 +960,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new ObjectMapIndexConfigTestCase);
 }
 
 /**
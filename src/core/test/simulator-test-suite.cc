@@ -23,6 +23,13 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +466,142 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class LadderSchedulerTestCase : public TestCase
+{
+public:
+  LadderSchedulerTestCase ();
+  virtual void DoRun (void);
+};
+
+LadderSchedulerTestCase::LadderSchedulerTestCase ()
+  : TestCase ("Check the order of the events of a LadderScheduler with a small window against a MapScheduler")
+{
+}
+
+void
+LadderSchedulerTestCase::DoRun (void)
+{
+  // a window of 16 buckets of 100 ns, so that many events go to the
+  // overflow, and the near events crowd a few buckets in random order,
+  // thus some of them do not fit in the buckets
+  ObjectFactory factory;
+  factory.SetTypeId (LadderScheduler::GetTypeId ());
+  factory.Set ("NumBuckets", UintegerValue (16));
+  factory.Set ("BucketWidth", TimeValue (NanoSeconds (100)));
+  Ptr<Scheduler> ladder = factory.Create<Scheduler> ();
+  Ptr<Scheduler> map = CreateObject<MapScheduler> ();
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  std::vector<Scheduler::Event> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      double action = uniform->GetValue ();
+      if (action < 0.5 || pending.empty ())
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          // same time, near future, far future
+          double horizon = uniform->GetValue ();
+          uint64_t delay = horizon < 0.1 ? 0 : horizon < 0.8 ? uniform->GetInteger (0, 200) : uniform->GetInteger (0, 100000);
+          ev.key.m_ts = now + delay;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          ladder->Insert (ev);
+          map->Insert (ev);
+          pending.push_back (ev);
+        }
+      else if (action < 0.6)
+        {
+          uint32_t j = uniform->GetInteger (0, pending.size () - 1);
+          ladder->Remove (pending[j]);
+          map->Remove (pending[j]);
+          pending[j] = pending.back ();
+          pending.pop_back ();
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_EQ (ladder->PeekNext ().key.m_uid, map->PeekNext ().key.m_uid, "wrong next event");
+          Scheduler::Event next = ladder->RemoveNext ();
+          Scheduler::Event expected = map->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.key.m_uid, "wrong order of the events");
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_ts, expected.key.m_ts, "wrong time of the event");
+          now = next.key.m_ts;
+          for (uint32_t j = 0; j < pending.size (); j++)
+            {
+              if (pending[j].key.m_uid == next.key.m_uid)
+                {
+                  pending[j] = pending.back ();
+                  pending.pop_back ();
+                  break;
+                }
+            }
+        }
+    }
+  while (!map->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (ladder->IsEmpty (), false, "missing events");
+      NS_TEST_ASSERT_MSG_EQ (ladder->RemoveNext ().key.m_uid, map->RemoveNext ().key.m_uid, "wrong order of the events");
+    }
+  NS_TEST_ASSERT_MSG_EQ (ladder->IsEmpty (), true, "unexpected events");
+}
+
+class EventTraceTestCase : public TestCase
+{
+public:
+  EventTraceTestCase ();
+  virtual void DoRun (void);
+  void Schedule (void);
+  void Nop (void);
+};
+
+EventTraceTestCase::EventTraceTestCase ()
+  : TestCase ("Check the event trace of the DefaultSimulatorImpl")
+{
+}
+
+void
+EventTraceTestCase::Schedule (void)
+{
+  Simulator::ScheduleNow (&EventTraceTestCase::Nop, this);
+  Simulator::ScheduleWithContext (7, MicroSeconds (5), &EventTraceTestCase::Nop, this);
+  Simulator::Schedule (MilliSeconds (1), &EventTraceTestCase::Nop, this);
+}
+
+void
+EventTraceTestCase::Nop (void)
+{
+}
+
+void
+EventTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("events.bin");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventTraceFilename", StringValue (filename));
+  Simulator::Schedule (MicroSeconds (10), &EventTraceTestCase::Schedule, this);
+  Simulator::Schedule (NanoSeconds (3), &EventTraceTestCase::Nop, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventTraceFilename", StringValue (""));
+
+  std::vector<DefaultSimulatorImpl::EventTraceRecord> records;
+  NS_TEST_ASSERT_MSG_EQ (DefaultSimulatorImpl::ReadEventTrace (filename, records), true, "cannot read " << filename);
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 5, "wrong number of events");
+
+  uint64_t insertTs[5] = {0, 0, 10000, 10000, 10000};
+  uint64_t eventTs[5] = {10000, 3, 10000, 15000, 1010000};
+  uint32_t context[5] = {Simulator::NO_CONTEXT, Simulator::NO_CONTEXT, Simulator::NO_CONTEXT, 7, Simulator::NO_CONTEXT};
+  for (uint32_t i = 0; i < records.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (records[i].insertTs, (uint64_t) NanoSeconds (insertTs[i]).GetTimeStep (), "wrong insertion time of event " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].eventTs, (uint64_t) NanoSeconds (eventTs[i]).GetTimeStep (), "wrong time of event " << i);
+      NS_TEST_ASSERT_MSG_EQ (records[i].context, context[i], "wrong context of event " << i);
+    }
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +618,9 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new LadderSchedulerTestCase (), TestCase::QUICK);
+    AddTestCase (new EventTraceTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
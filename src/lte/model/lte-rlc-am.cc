@@ -46,11 +46,12 @@ LteRlcAm::LteRlcAm ()
   NS_LOG_FUNCTION (this);
 
   // Buffers
-  m_txonBufferSize = 0;
-  m_retxSegBuffer.resize (1024);
-  m_retxBuffer.resize (1024);
+  TxedPdu emptyPdu;
+  emptyPdu.m_retxCount = 0;
+  emptyPdu.m_retx = false;
+  emptyPdu.m_lastSegSent = false;
+  m_retxStore.resize (1024, emptyPdu);
   m_retxBufferSize = 0;
-  m_txedBuffer.resize (1024);
   m_txedBufferSize = 0;
 
   m_lastRxPacketTime = Seconds(0);
@@ -110,14 +111,14 @@ LteRlcAm::LteRlcAm ()
 void
 LteRlcAm::BufferSizeTrace()
 {
-  NS_LOG_LOGIC("BufferSizeTrace " << Simulator::Now().GetSeconds() << " " << m_rnti << " " << m_lcid << " " << m_txonBufferSize);
+  NS_LOG_LOGIC("BufferSizeTrace " << Simulator::Now().GetSeconds() << " " << m_rnti << " " << m_lcid << " " << m_txonBuffer.GetNBytes ());
   // write to file
   if(!m_bufferSizeFile.is_open())
   {
     m_bufferSizeFile.open(GetBufferSizeFilename().c_str(), std::ofstream::app);
     NS_LOG_LOGIC("File opened");
   }
-  m_bufferSizeFile << Simulator::Now().GetSeconds() << " " << m_rnti << " " << (uint16_t) m_lcid << " " << m_txonBufferSize << std::endl;
+  m_bufferSizeFile << Simulator::Now().GetSeconds() << " " << m_rnti << " " << (uint16_t) m_lcid << " " << m_txonBuffer.GetNBytes () << std::endl;
 
   m_traceBufferSizeEvent = Simulator::Schedule(MilliSeconds(10), &LteRlcAm::BufferSizeTrace, this);
 }
@@ -202,11 +203,9 @@ LteRlcAm::DoDispose ()
   m_statusProhibitTimer.Cancel ();
   m_rbsTimer.Cancel ();
 
-  m_txonBuffer.clear ();
-  m_txonBufferSize = 0;
-  m_txedBuffer.clear ();
+  m_txonBuffer.Clear ();
+  m_retxStore.clear ();
   m_txedBufferSize = 0;
-  m_retxBuffer.clear ();
   m_retxBufferSize = 0;
   m_rxonBuffer.clear ();
   m_sdusBuffer.clear ();
@@ -254,7 +253,7 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
 
   if(m_enableAqm == false)
   {
-    if (m_txonBufferSize + p->GetSize () <= m_maxTxBufferSize)
+    if (m_txonBuffer.GetNBytes () + p->GetSize () <= m_maxTxBufferSize)
     {
       /** Store arrival time */
       Time now = Simulator::Now ();
@@ -268,17 +267,16 @@ LteRlcAm::DoTransmitPdcpPdu (Ptr<Packet> p)
       p->AddPacketTag (tag);
 
       NS_LOG_INFO ("Txon Buffer: New packet added");
-      m_txonBuffer.push_back (p);
-      m_txonBufferSize += p->GetSize ();
-      NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.size() );
-      NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+      m_txonBuffer.PushBack (p);
+      NS_LOG_LOGIC ("NumOfBuffers = " << m_txonBuffer.GetNSdus () );
+      NS_LOG_LOGIC ("txonBufferSize = " << m_txonBuffer.GetNBytes ());
     }
     else
     {
       // Discard full RLC SDU
       NS_LOG_LOGIC ("TxBuffer is full. RLC SDU discarded");
       NS_LOG_LOGIC ("MaxTxBufferSize = " << m_maxTxBufferSize);
-      NS_LOG_LOGIC ("txonBufferSize    = " << m_txonBufferSize);
+      NS_LOG_LOGIC ("txonBufferSize    = " << m_txonBuffer.GetNBytes ());
       NS_LOG_LOGIC ("packet size     = " << p->GetSize ());
     }  
   }
@@ -435,24 +433,25 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
       for (sn = m_vtA; sn < m_vtS; sn++) 
         {
           uint16_t seqNumberValue = sn.GetValue ();
-          NS_LOG_LOGIC ("SN = " << seqNumberValue << " m_pdu " << m_retxBuffer.at (seqNumberValue).m_pdu);
+          TxedPdu &txedPdu = m_retxStore.at (seqNumberValue);
+          NS_LOG_LOGIC ("SN = " << seqNumberValue << " m_pdu " << txedPdu.m_pdu << " retx " << txedPdu.m_retx);
 
-          if (m_retxSegBuffer.at (seqNumberValue).m_lastSegSent)
+          if (txedPdu.m_lastSegSent)
           {
             return; // all segments sent, need to wait for ACK or reorder timer to expire
           }
 
           Ptr<Packet> packet;
           bool segment = false;
-          if (m_retxSegBuffer.at (seqNumberValue).m_pdu != 0)
+          if (txedPdu.m_segment != 0)
           {
-            packet = m_retxSegBuffer.at (seqNumberValue).m_pdu->Copy ();
+            packet = txedPdu.m_segment->Copy ();
             found = true;
             segment = true;
           }
-          else if (m_retxBuffer.at (seqNumberValue).m_pdu != 0)
+          else if (IsInRetxBuffer (seqNumberValue))
           {
-            packet = m_retxBuffer.at (seqNumberValue).m_pdu->Copy ();
+            packet = txedPdu.m_pdu->Copy ();
             found = true;
           }
           if (found == true)
@@ -470,18 +469,18 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                     NS_LOG_INFO ("Sending last RLC PDU segment, sn= " << seqNumberValue << " offset= " << rlcAmHeader.GetSegmentOffset()
                                                      << " size= " << rlcAmHeader.GetLastOffset()-rlcAmHeader.GetSegmentOffset());
                     // opportunity is large enough to transmit remaining segment, so clear segment buffer
-                    m_retxSegBuffer.at(seqNumberValue).m_pdu = 0;
-                    m_retxSegBuffer.at(seqNumberValue).m_lastSegSent = true;
+                    txedPdu.m_segment = 0;
+                    txedPdu.m_lastSegSent = true;
                     rlcAmHeader.SetLastSegmentFlag (LteRlcAmHeader::LAST_PDU_SEGMENT);
                   }
 
                   // Calculate the Polling Bit (5.2.2.1)
                   rlcAmHeader.SetPollingBit (LteRlcAmHeader::STATUS_REPORT_NOT_REQUESTED);
 
-                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.empty () 
+                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.IsEmpty () 
                                 << " retxBufferSize="  << m_retxBufferSize
                                 << " packet->GetSize ()=" << packet->GetSize ());
-                  if (((m_txonBuffer.empty ()) && (m_txonQueue->GetNPackets ()==0) && (m_retxBufferSize == packet->GetSize () + rlcAmHeader.GetSerializedSize ()))
+                  if (((m_txonBuffer.IsEmpty ()) && (m_txonQueue->GetNPackets ()==0) && (m_retxBufferSize == packet->GetSize () + rlcAmHeader.GetSerializedSize ()))
                       || (m_vtS >= m_vtMs)
                       || m_pollRetransmitTimerJustExpired)
                     {
@@ -524,27 +523,22 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                   
                   m_macSapProvider->TransmitPdu (params);
 
-                  m_retxBuffer.at (seqNumberValue).m_retxCount++;
+                  txedPdu.m_retxCount++;
                   NS_LOG_INFO ("Incr RETX_COUNT for SN = " << seqNumberValue);
-                  if (m_retxBuffer.at (seqNumberValue).m_retxCount >= m_maxRetxThreshold)
+                  if (txedPdu.m_retxCount >= m_maxRetxThreshold)
                     {
                       NS_LOG_INFO ("Max RETX_COUNT for SN = " << seqNumberValue);
                     }
 
                   NS_LOG_INFO ("Move SN = " << seqNumberValue << " back to txedBuffer");
-                  m_txedBuffer.at (seqNumberValue).m_pdu = m_retxBuffer.at (seqNumberValue).m_pdu->Copy ();
-                  m_txedBuffer.at (seqNumberValue).m_retxCount = m_retxBuffer.at (seqNumberValue).m_retxCount;
-                  NS_ASSERT_MSG(m_txedBuffer.at (seqNumberValue).m_pdu != 0, "Just inserted an invalid pointer");
-                  m_txedBufferSize += m_txedBuffer.at (seqNumberValue).m_pdu->GetSize ();
-
-                  m_retxBufferSize -= m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
-                  m_retxBuffer.at (seqNumberValue).m_pdu = 0;
-                  m_retxBuffer.at (seqNumberValue).m_retxCount = 0;
-                  
+                  NS_ASSERT_MSG (txedPdu.m_pdu != 0 && txedPdu.m_retx, "No PDU considered for retx for SN " << seqNumberValue);
+                  txedPdu.m_retx = false;
+                  m_txedBufferSize += txedPdu.m_pdu->GetSize ();
+                  m_retxBufferSize -= txedPdu.m_pdu->GetSize ();
+
                   // reset segment buffer
-                  m_retxSegBuffer.at (seqNumberValue).m_pdu = 0;
-                  m_retxSegBuffer.at (seqNumberValue).m_retxCount = 0;
-                  m_retxSegBuffer.at (seqNumberValue).m_lastSegSent = 0;
+                  txedPdu.m_segment = 0;
+                  txedPdu.m_lastSegSent = false;
 
                   NS_LOG_LOGIC ("retxBufferSize = " << m_retxBufferSize);
 
@@ -569,10 +563,10 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                   // Calculate the Polling Bit (5.2.2.1)
                   firstSegHdr.SetPollingBit (LteRlcAmHeader::STATUS_REPORT_NOT_REQUESTED);
 
-                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.empty ()
+                  NS_LOG_LOGIC ("polling conditions: m_txonBuffer.empty=" << m_txonBuffer.IsEmpty ()
                                 << " retxBufferSize="  << m_retxBufferSize
                                 << " packet->GetSize ()=" << packet->GetSize ());
-                  if (((m_txonBuffer.empty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == packet->GetSize () + firstSegHdr.GetSerializedSize ()))
+                  if (((m_txonBuffer.IsEmpty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == packet->GetSize () + firstSegHdr.GetSerializedSize ()))
                       || (m_vtS >= m_vtMs)
                       || m_pollRetransmitTimerJustExpired)
                   {
@@ -635,7 +629,7 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
                   nextSeg->AddHeader (nextSegHdr);
 
                   // add next segment to reTX segment buffer
-                  m_retxSegBuffer.at (seqNumberValue).m_pdu = nextSeg;
+                  txedPdu.m_segment = nextSeg;
 
                   NS_LOG_LOGIC ("new AM RLC header: " << firstSegHdr);
 
@@ -657,24 +651,6 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
                   m_macSapProvider->TransmitPdu (params);
 
-                  //m_retxSegBuffer.at (seqNumberValue).m_pdu
-
-//                  m_retxBuffer.at (seqNumberValue).m_retxCount++;
-//                  NS_LOG_INFO ("Incr RETX_COUNT for SN = " << seqNumberValue);
-//                  if (m_retxBuffer.at (seqNumberValue).m_retxCount >= m_maxRetxThreshold)
-//                  {
-//                    NS_LOG_INFO ("Max RETX_COUNT for SN = " << seqNumberValue);
-//                  }
-//
-//                  NS_LOG_INFO ("Move SN = " << seqNumberValue << " back to txedBuffer");
-//                  m_txedBuffer.at (seqNumberValue).m_pdu = m_retxBuffer.at (seqNumberValue).m_pdu->Copy ();
-//                  m_txedBuffer.at (seqNumberValue).m_retxCount = m_retxBuffer.at (seqNumberValue).m_retxCount;
-//                  m_txedBufferSize += m_txedBuffer.at (seqNumberValue).m_pdu->GetSize ();
-//
-//                  m_retxBufferSize -= m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
-//                  m_retxBuffer.at (seqNumberValue).m_pdu = 0;
-//                  m_retxBuffer.at (seqNumberValue).m_retxCount = 0;
-
                   NS_LOG_LOGIC ("retxBufferSize = " << m_retxBufferSize);
 
                   return;
@@ -683,7 +659,7 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
         }
       NS_ASSERT_MSG (found, "m_retxBufferSize > 0, but no PDU considered for retx found");
     }
-  else if ( m_txonBufferSize + m_txonQueue->GetNBytes() > 0 )
+  else if ( m_txonBuffer.GetNBytes () + m_txonQueue->GetNBytes() > 0 )
     {
       if (bytes < 7)
       {
@@ -738,27 +714,23 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
 
   // Remove the first packet from the transmission buffer.
   // If only a segment of the packet is taken, then the remaining is given back later
-  if ( m_txonBuffer.size () + m_txonQueue->GetNBytes() == 0 )
+  if ( m_txonBuffer.GetNSdus () + m_txonQueue->GetNBytes() == 0 )
     {
       NS_LOG_LOGIC ("No data pending");
       return;
     }
 
-  NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.size ());
-  NS_LOG_LOGIC ("First SDU buffer  = " << *(m_txonBuffer.begin()));
-  NS_LOG_LOGIC ("First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-  NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
-  NS_LOG_LOGIC ("Remove SDU from TxBuffer");
-
-  if (m_txonBuffer.empty())
+  if (m_txonBuffer.IsEmpty ())
   {
     Ptr<Packet> tempP = m_txonQueue->Dequeue()->GetPacket();
-    m_txonBuffer.push_back (tempP);
-    m_txonBufferSize += tempP->GetSize ();
+    m_txonBuffer.PushBack (tempP);
   }
 
-  Ptr<Packet> firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
-  
+  NS_LOG_LOGIC ("SDUs in TxonBuffer  = " << m_txonBuffer.GetNSdus ());
+  NS_LOG_LOGIC ("First SDU buffer  = " << m_txonBuffer.PeekFront ());
+  NS_LOG_LOGIC ("First SDU size    = " << m_txonBuffer.GetSduSize (0));
+  NS_LOG_LOGIC ("Next segment size = " << nextSegmentSize);
+
   // LL HO
   // tricky: store the incomplete Rlc SDU for forwarding to 
   // target eNB in lossless HO. This will reduce the work of 
@@ -766,102 +738,40 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   Ptr<Packet> entireSdu ;
   // store complete the last complete SDU of the txonBuffer.
   if (!is_fragmented){
-    NS_LOG_DEBUG ("Last complete SDU in txonBuffer size = " << firstSegment->GetSize() << " SEQ = " << m_vtS );
-    entireSdu = (*(m_txonBuffer.begin ()))->Copy ();
+    NS_LOG_DEBUG ("Last complete SDU in txonBuffer size = " << m_txonBuffer.GetSduSize (0) << " SEQ = " << m_vtS );
+    entireSdu = m_txonBuffer.PeekFront ()->Copy ();
   }
 
-  m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-  NS_LOG_LOGIC ("txBufferSize      = " << m_txonBufferSize );
-  m_txonBuffer.erase (m_txonBuffer.begin ());
-
-  while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
+  // The SDUs (or the remaining segment of the first one) are taken from the
+  // head of the transmission buffer, which keeps track of the segmentation
+  while ( !m_txonBuffer.IsEmpty () && (nextSegmentSize > 0) )
     {
-      NS_LOG_LOGIC ("WHILE ( firstSegment && firstSegment->GetSize > 0 && nextSegmentSize > 0 )");
-      NS_LOG_LOGIC ("    firstSegment size = " << firstSegment->GetSize ());
+      uint32_t firstSegmentSize = m_txonBuffer.GetSduSize (0);
+      NS_LOG_LOGIC ("WHILE ( txonBuffer.size > 0 && nextSegmentSize > 0 )");
+      NS_LOG_LOGIC ("    firstSegment size = " << firstSegmentSize);
       NS_LOG_LOGIC ("    nextSegmentSize   = " << nextSegmentSize);
-      if ( (firstSegment->GetSize () > nextSegmentSize) ||
+      if ( (firstSegmentSize > nextSegmentSize) ||
            // Segment larger than 2047 octets can only be mapped to the end of the Data field
-           (firstSegment->GetSize () > 2047)
+           (firstSegmentSize > 2047)
          )
         {
           // Take the minimum size, due to the 2047-bytes 3GPP exception
           // This exception is due to the length of the LI field (just 11 bits)
-          uint32_t currSegmentSize = std::min (firstSegment->GetSize (), nextSegmentSize);
+          uint32_t currSegmentSize = std::min (firstSegmentSize, nextSegmentSize);
 
           NS_LOG_LOGIC ("    IF ( firstSegment > nextSegmentSize ||");
           NS_LOG_LOGIC ("         firstSegment > 2047 )");
 
-          // Segment txBuffer.FirstBuffer and
-          // Give back the remaining segment to the transmission buffer
-          Ptr<Packet> newSegment = firstSegment->CreateFragment (0, currSegmentSize);
+          // Segment txBuffer.FirstBuffer: the remaining segment stays in the
+          // transmission buffer, and the status tag of the new segment is set
+          // according to its position in the SDU
+          Ptr<Packet> newSegment = m_txonBuffer.PopFront (currSegmentSize);
           // LL HO: This firstSegment is fragmented. Update the status variable.
-          is_fragmented = 1;        
+          is_fragmented = 1;
 
           NS_LOG_LOGIC ("    newSegment size   = " << newSegment->GetSize ());
-
-          // Status tag of the new and remaining segments
-          // Note: This is the only place where a PDU is segmented and
-          // therefore its status can change
-          LteRlcSduStatusTag oldTag, newTag;
-          firstSegment->RemovePacketTag (oldTag);
-          newSegment->RemovePacketTag (newTag);
-          if (oldTag.GetStatus () == LteRlcSduStatusTag::FULL_SDU)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::FIRST_SEGMENT);
-              oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-          else if (oldTag.GetStatus () == LteRlcSduStatusTag::LAST_SEGMENT)
-            {
-              newTag.SetStatus (LteRlcSduStatusTag::MIDDLE_SEGMENT);
-              //oldTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-            }
-
-          // Give back the remaining segment to the transmission buffer
-          firstSegment->RemoveAtStart (currSegmentSize);
-          NS_LOG_LOGIC ("    firstSegment size (after RemoveAtStart) = " << firstSegment->GetSize ());
-          if (firstSegment->GetSize () > 0)
-            {
-              firstSegment->AddPacketTag (oldTag);
-
-              //LL HO Mark the first SDU is txonBuffer is fragmented. This maybe not needed.
-              is_fragmented = 1;
-
-              // m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
-              
-              if(m_txonBuffer.empty())
-              {
-                m_txonBuffer.push_back(firstSegment);
-              }
-              else
-              {
-                m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
-              }
-
-              m_txonBufferSize += (*(m_txonBuffer.begin()))->GetSize ();
-
-              NS_LOG_LOGIC ("    Txon buffer: Give back the remaining segment");
-              NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.size ());
-              NS_LOG_LOGIC ("    Front buffer size = " << (*(m_txonBuffer.begin()))->GetSize ());
-              NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBufferSize );
-            }
-          else
-            {
-              // Whole segment was taken, so adjust tag
-              if (newTag.GetStatus () == LteRlcSduStatusTag::FIRST_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::FULL_SDU);
-                }
-              else if (newTag.GetStatus () == LteRlcSduStatusTag::MIDDLE_SEGMENT)
-                {
-                  newTag.SetStatus (LteRlcSduStatusTag::LAST_SEGMENT);
-                }
-            }
-          // Segment is completely taken or
-          // the remaining segment is given back to the transmission buffer
-          firstSegment = 0;
-
-          // Put status tag once it has been adjusted
-          newSegment->AddPacketTag (newTag);
+          NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.GetNSdus ());
+          NS_LOG_LOGIC ("    txonBufferSize = " << m_txonBuffer.GetNBytes () );
 
           // Add Segment to Data field
           dataFieldAddedSize = newSegment->GetSize ();
@@ -880,18 +790,18 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           // nextSegmentSize MUST be zero (only if segment is smaller or equal to 2047)
 
           // (NO more segments) ? exit
-          // break;
+          break;
         }
-      else if ( (nextSegmentSize - firstSegment->GetSize () <= 2) 
-        || (m_txonBuffer.size () + m_txonQueue->GetNPackets() == 0) )
+      else if ( (nextSegmentSize - firstSegmentSize <= 2) 
+        || (m_txonBuffer.GetNSdus () - 1 + m_txonQueue->GetNPackets() == 0) )
         {
           NS_LOG_LOGIC ("    IF nextSegmentSize - firstSegment->GetSize () <= 2 || txonBuffer.size == 0");
 
           // Add txBuffer.FirstBuffer to DataField
+          Ptr<Packet> firstSegment = m_txonBuffer.PopFront (firstSegmentSize);
           dataFieldAddedSize = firstSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
           dataField.push_back (firstSegment);
-          firstSegment = 0;
 
           // ExtensionBit (Next_Segment - 1) = 0
           rlcAmHeader.PushExtensionBit (LteRlcAmHeader::DATA_FIELD_FOLLOWS);
@@ -901,23 +811,19 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () + m_txonQueue->GetNPackets() > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-            }
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.GetNSdus ());
           NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
 
           // nextSegmentSize <= 2 (only if txBuffer is not empty)
 
           // (NO more segments) ? exit
-          // break;
+          break;
         }
       else // (firstSegment->GetSize () < m_nextSegmentSize) && (m_txBuffer.size () > 0)
         {
           NS_LOG_LOGIC ("    IF firstSegment < NextSegmentSize && txonBuffer.size > 0");
           // Add txBuffer.FirstBuffer to DataField
+          Ptr<Packet> firstSegment = m_txonBuffer.PopFront (firstSegmentSize);
           dataFieldAddedSize = firstSegment->GetSize ();
           dataFieldTotalSize += dataFieldAddedSize;
           dataField.push_back (firstSegment);
@@ -931,31 +837,24 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
           nextSegmentSize -= ((nextSegmentId % 2) ? (2) : (1)) + dataFieldAddedSize;
           nextSegmentId++;
 
-          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.size ());
-          if (m_txonBuffer.size () + m_txonQueue->GetNPackets() > 0)
-            {
-              NS_LOG_LOGIC ("        First SDU buffer  = " << *(m_txonBuffer.begin()));
-              NS_LOG_LOGIC ("        First SDU size    = " << (*(m_txonBuffer.begin()))->GetSize ());
-            }
-          NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
-          NS_LOG_LOGIC ("        Remove SDU from TxBuffer");
-
           // (more segments)
 
-          if(m_txonBuffer.empty())
+          if(m_txonBuffer.IsEmpty ())
           {
             Ptr<Packet> tempP = m_txonQueue->Dequeue()->GetPacket();
-            m_txonBuffer.push_back (tempP);
-            m_txonBufferSize += tempP->GetSize ();
+            m_txonBuffer.PushBack (tempP);
           }
 
-          firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
+          NS_LOG_LOGIC ("        SDUs in TxBuffer  = " << m_txonBuffer.GetNSdus ());
+          NS_LOG_LOGIC ("        First SDU buffer  = " << m_txonBuffer.PeekFront ());
+          NS_LOG_LOGIC ("        First SDU size    = " << m_txonBuffer.GetSduSize (0));
+          NS_LOG_LOGIC ("        Next segment size = " << nextSegmentSize);
           
           // LL HO
           // New complete SDU is taken from txonBuffer so reset the 
           // status is_fragmented.
           is_fragmented = 0;
-          m_txedRlcSduBuffer.push_back((*(m_txonBuffer.begin()))->Copy());
+          m_txedRlcSduBuffer.push_back(m_txonBuffer.PeekFront ()->Copy());
           NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size());
           if (m_txedRlcSduBuffer.size() > 1024){
             NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size() << " clear and resize");
@@ -964,11 +863,7 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
             NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size() << " after clear and resize");
           }
           // Store the last complete SDU before segmentation in txonBuffer.
-          entireSdu = (*(m_txonBuffer.begin ()))->Copy ();
-
-          m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-          m_txonBuffer.erase (m_txonBuffer.begin ());
-          NS_LOG_LOGIC ("        txBufferSize = " << m_txonBufferSize );
+          entireSdu = m_txonBuffer.PeekFront ()->Copy ();
         }
     }
 
@@ -1050,12 +945,12 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   NS_LOG_LOGIC ("BYTE_WITHOUT_POLL = " << m_byteWithoutPoll);
 
   // if ( (m_pduWithoutPoll >= m_pollPdu) || (m_byteWithoutPoll >= m_pollByte) ||
-  //      ( (m_txonBuffer.empty ()) && (m_retxBufferSize == 0) ) ||
+  //      ( (m_txonBuffer.IsEmpty ()) && (m_retxBufferSize == 0) ) ||
   //      (m_vtS >= m_vtMs)
   //      || m_pollRetransmitTimerJustExpired
   //    )
   if ( (m_pduWithoutPoll >= m_pollPdu) || (m_byteWithoutPoll >= m_pollByte) ||
-       ( (m_txonBuffer.empty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == 0) ) ||
+       ( (m_txonBuffer.IsEmpty ()) && (m_txonQueue->GetNPackets () == 0) && (m_retxBufferSize == 0) ) ||
        (m_vtS >= m_vtMs)
        || m_pollRetransmitTimerJustExpired
      )  
@@ -1093,9 +988,10 @@ LteRlcAm::DoNotifyTxOpportunity (uint32_t bytes, uint8_t layer, uint8_t harqId)
   // Store new PDU into the Transmitted PDU Buffer
   NS_LOG_LOGIC ("Put transmitted PDU in the txedBuffer");
   m_txedBufferSize += packet->GetSize ();
-  m_txedBuffer.at ( rlcAmHeader.GetSequenceNumber ().GetValue () ).m_pdu = packet->Copy ();
-  m_txedBuffer.at ( rlcAmHeader.GetSequenceNumber ().GetValue () ).m_retxCount = 0;
-  NS_ASSERT_MSG(m_txedBuffer.at (rlcAmHeader.GetSequenceNumber ().GetValue ()).m_pdu != 0, "Just inserted an invalid pointer");
+  TxedPdu &txedPdu = m_retxStore.at (rlcAmHeader.GetSequenceNumber ().GetValue ());
+  txedPdu.m_pdu = packet->Copy ();
+  txedPdu.m_retxCount = 0;
+  txedPdu.m_retx = false;
 
   // Sender timestamp
   RlcTag rlcTag (Simulator::Now ());
@@ -1119,9 +1015,8 @@ LteRlcAm::GetTxBuffer()
   std::vector < Ptr<Packet> > toBeReturned;
   if(!m_enableAqm)
   {
-    toBeReturned.insert(toBeReturned.begin(), m_txonBuffer.begin(), m_txonBuffer.end());
-    m_txonBuffer.clear();
-    m_txonBufferSize = 0;
+    toBeReturned = m_txonBuffer.GetSdus ();
+    m_txonBuffer.Clear ();
   }
   else
   {
@@ -1134,15 +1029,22 @@ LteRlcAm::GetTxBuffer()
 }
 uint32_t LteRlcAm::GetTxBufferSize()
 {
-  return m_txonBufferSize + m_txonQueue->GetNBytes();
+  return m_txonBuffer.GetNBytes () + m_txonQueue->GetNBytes();
 }
 
 std::vector < LteRlcAm::RetxPdu > 
 LteRlcAm::GetTxedBuffer()
 {
-  //std::vector < LteRlcAm::RetxPdu > toBeReturned;
-  //toBeReturned.insert(toBeReturned.begin(), m_txedBuffer.begin(), m_txedBuffer.end());
-  return m_txedBuffer;
+  std::vector < LteRlcAm::RetxPdu > toBeReturned (m_retxStore.size ());
+  for (uint16_t sn = 0; sn < m_retxStore.size (); sn++)
+  {
+    if (IsInTxedBuffer (sn))
+    {
+      toBeReturned.at (sn).m_pdu = m_retxStore.at (sn).m_pdu;
+      toBeReturned.at (sn).m_retxCount = m_retxStore.at (sn).m_retxCount;
+    }
+  }
+  return toBeReturned;
 }
 uint32_t 
 LteRlcAm::GetTxedBufferSize()
@@ -1153,8 +1055,15 @@ LteRlcAm::GetTxedBufferSize()
 std::vector < LteRlcAm::RetxPdu > 
 LteRlcAm::GetRetxBuffer()
 {
-  std::vector < LteRlcAm::RetxPdu > toBeReturned;
-  toBeReturned.insert(toBeReturned.begin(), m_retxBuffer.begin(), m_retxBuffer.end());
+  std::vector < LteRlcAm::RetxPdu > toBeReturned (m_retxStore.size ());
+  for (uint16_t sn = 0; sn < m_retxStore.size (); sn++)
+  {
+    if (IsInRetxBuffer (sn))
+    {
+      toBeReturned.at (sn).m_pdu = m_retxStore.at (sn).m_pdu;
+      toBeReturned.at (sn).m_retxCount = m_retxStore.at (sn).m_retxCount;
+    }
+  }
   return toBeReturned;
 }
 
@@ -1212,6 +1121,33 @@ LteRlcAm::IsInsideTransmittingWindow(SequenceNumber10 sn)
 }
 
 
+void
+LteRlcAm::MoveToRetxBuffer (uint16_t seqNumberValue)
+{
+  TxedPdu &txedPdu = m_retxStore.at (seqNumberValue);
+  if (txedPdu.m_pdu != 0 && !txedPdu.m_retx)
+  {
+    NS_LOG_INFO ("Move SN = " << seqNumberValue << " to retxBuffer");
+    txedPdu.m_retx = true;
+    m_retxBufferSize += txedPdu.m_pdu->GetSize ();
+    m_txedBufferSize -= txedPdu.m_pdu->GetSize ();
+  }
+}
+
+bool
+LteRlcAm::IsInTxedBuffer (uint16_t seqNumberValue) const
+{
+  const TxedPdu &txedPdu = m_retxStore.at (seqNumberValue);
+  return txedPdu.m_pdu != 0 && !txedPdu.m_retx;
+}
+
+bool
+LteRlcAm::IsInRetxBuffer (uint16_t seqNumberValue) const
+{
+  const TxedPdu &txedPdu = m_retxStore.at (seqNumberValue);
+  return txedPdu.m_pdu != 0 && txedPdu.m_retx;
+}
+
 void
 LteRlcAm::DoNotifyHarqDeliveryFailure ()
 {
@@ -1228,18 +1164,8 @@ LteRlcAm::DoNotifyDlHarqDeliveryFailure (uint8_t harqId)
   NS_ASSERT (it != m_harqIdToSnMap.end ());
 
   uint16_t seqNumberValue = it->second;
-  if (m_txedBuffer.at (seqNumberValue).m_pdu != 0)
-  {
-    NS_LOG_INFO ("Move SN = " << seqNumberValue << " to retxBuffer");
-    m_retxBuffer.at (seqNumberValue).m_pdu = m_txedBuffer.at (seqNumberValue).m_pdu->Copy ();
-    m_retxBuffer.at (seqNumberValue).m_retxCount = m_txedBuffer.at (seqNumberValue).m_retxCount;
-    m_retxBufferSize += m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
-
-    m_txedBufferSize -= m_txedBuffer.at (seqNumberValue).m_pdu->GetSize ();
-    m_txedBuffer.at (seqNumberValue).m_pdu = 0;
-    m_txedBuffer.at (seqNumberValue).m_retxCount = 0;
-  }
-  NS_ASSERT (m_retxBuffer.at (seqNumberValue).m_pdu != 0);
+  MoveToRetxBuffer (seqNumberValue);
+  NS_ASSERT (IsInRetxBuffer (seqNumberValue));
 */
 }
 
@@ -2235,53 +2161,41 @@ LteRlcAm::DoReceivePdu (Ptr<Packet> p)
 
               incrementVtA = false;
 
-              if (m_txedBuffer.at (seqNumberValue).m_pdu != 0)
-                {
-                  NS_LOG_INFO ("Move SN = " << seqNumberValue << " to retxBuffer");
-                  m_retxBuffer.at (seqNumberValue).m_pdu = m_txedBuffer.at (seqNumberValue).m_pdu->Copy ();
-                  m_retxBuffer.at (seqNumberValue).m_retxCount = m_txedBuffer.at (seqNumberValue).m_retxCount;
-                  m_retxBufferSize += m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
-
-                  m_txedBufferSize -= m_txedBuffer.at (seqNumberValue).m_pdu->GetSize ();
-                  m_txedBuffer.at (seqNumberValue).m_pdu = 0;
-                  m_txedBuffer.at (seqNumberValue).m_retxCount = 0;
-                }
+              MoveToRetxBuffer (seqNumberValue);
 
               // TODOIAB it may happen that a CTRL PDU is received 
               // out of order, i.e., it NACKs or ACKs packets already ACKED
-              // NS_ASSERT (m_retxBuffer.at (seqNumberValue).m_pdu != 0);
+              // NS_ASSERT (IsInRetxBuffer (seqNumberValue));
               
             }
           else
             {
               NS_LOG_LOGIC ("sn " << sn << " is ACKed");
 
-              if (m_txedBuffer.at (seqNumberValue).m_pdu)
+              TxedPdu &txedPdu = m_retxStore.at (seqNumberValue);
+              if (IsInTxedBuffer (seqNumberValue))
                 {
                   NS_LOG_INFO ("ACKed SN = " << seqNumberValue << " from txedBuffer");
-                  //               NS_LOG_INFO ("m_txedBuffer( " << m_vtA << " )->GetSize = " << m_txedBuffer.at (m_vtA.GetValue ())->GetSize ());
                   NS_LOG_LOGIC("m_txCompletedCallback " << m_rnti);
-                  m_txCompletedCallback(m_rnti, m_lcid, m_txedBuffer.at (seqNumberValue).m_pdu->GetSize (), 0); // 0 retransmissions at the RLC layer
+                  m_txCompletedCallback(m_rnti, m_lcid, txedPdu.m_pdu->GetSize (), 0); // 0 retransmissions at the RLC layer
 
-                  m_txedBufferSize -= m_txedBuffer.at (seqNumberValue).m_pdu->GetSize ();
-                  m_txedBuffer.at (seqNumberValue).m_pdu = 0;
-                  NS_ASSERT (m_retxBuffer.at (seqNumberValue).m_pdu == 0);
+                  m_txedBufferSize -= txedPdu.m_pdu->GetSize ();
+                  txedPdu.m_pdu = 0;
                 }
-
-              if (m_retxBuffer.at (seqNumberValue).m_pdu)
+              else if (IsInRetxBuffer (seqNumberValue))
                 {
                   NS_LOG_INFO ("ACKed SN = " << seqNumberValue << " from retxBuffer");
-                  m_retxBufferSize -= m_retxBuffer.at (seqNumberValue).m_pdu->GetSize ();
+                  m_retxBufferSize -= txedPdu.m_pdu->GetSize ();
                   NS_LOG_LOGIC("m_txCompletedCallback " << m_rnti);
 
-                  m_txCompletedCallback(m_rnti, m_lcid, m_retxBuffer.at (seqNumberValue).m_pdu->GetSize (), m_retxBuffer.at (seqNumberValue).m_retxCount);
+                  m_txCompletedCallback(m_rnti, m_lcid, txedPdu.m_pdu->GetSize (), txedPdu.m_retxCount);
 
-                  m_retxBuffer.at (seqNumberValue).m_pdu = 0;
-                  m_retxBuffer.at (seqNumberValue).m_retxCount = 0;
+                  txedPdu.m_pdu = 0;
+                  txedPdu.m_retxCount = 0;
+                  txedPdu.m_retx = false;
                   // reset segment buffer
-                  m_retxSegBuffer.at (seqNumberValue).m_pdu = 0;
-                  m_retxSegBuffer.at (seqNumberValue).m_retxCount = 0;
-                  m_retxSegBuffer.at (seqNumberValue).m_lastSegSent = 0;
+                  txedPdu.m_segment = 0;
+                  txedPdu.m_lastSegSent = false;
                 }
 
             }
@@ -2778,7 +2692,7 @@ LteRlcAm::DoReportBufferStatus (void)
 
   Time now = Simulator::Now ();
 
-  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBuffer.GetNBytes ());
   NS_LOG_LOGIC ("retxBufferSize = " << m_retxBufferSize);
   NS_LOG_LOGIC ("txedBufferSize = " << m_txedBufferSize);
   NS_LOG_LOGIC ("VT(A) = " << m_vtA);
@@ -2786,10 +2700,10 @@ LteRlcAm::DoReportBufferStatus (void)
 
   // Transmission Queue HOL time
   Time txonQueueHolDelay (0);
-  if ( m_txonBufferSize > 0 )
+  if ( m_txonBuffer.GetNBytes () > 0 )
     {
       RlcTag txonQueueHolTimeTag;
-      m_txonBuffer.front ()->PeekPacketTag (txonQueueHolTimeTag);
+      m_txonBuffer.PeekFront ()->PeekPacketTag (txonQueueHolTimeTag);
       txonQueueHolDelay = now - txonQueueHolTimeTag.GetSenderTimestamp ();
     }
 
@@ -2798,14 +2712,8 @@ LteRlcAm::DoReportBufferStatus (void)
   RlcTag retxQueueHolTimeTag;
   if ( m_retxBufferSize > 0 )
     {
-      if (m_retxBuffer.at (m_vtA.GetValue ()).m_pdu != 0)
-        {
-          m_retxBuffer.at (m_vtA.GetValue ()).m_pdu->PeekPacketTag (retxQueueHolTimeTag);
-        }
-      else
-        {
-          m_txedBuffer.at (m_vtA.GetValue ()).m_pdu->PeekPacketTag (retxQueueHolTimeTag);
-        }      
+      // the PDU at VT(A) is either considered for retransmission or waiting for an ACK
+      m_retxStore.at (m_vtA.GetValue ()).m_pdu->PeekPacketTag (retxQueueHolTimeTag);
       retxQueueHolDelay = now - retxQueueHolTimeTag.GetSenderTimestamp ();
     }
   else 
@@ -2816,21 +2724,19 @@ LteRlcAm::DoReportBufferStatus (void)
   LteMacSapProvider::ReportBufferStatusParameters r;
   r.rnti = m_rnti;
   r.lcid = m_lcid;
-  r.txQueueSize = m_txonBufferSize + m_txonQueue->GetNBytes();
+  r.txQueueSize = m_txonBuffer.GetNBytes () + m_txonQueue->GetNBytes();
   r.txQueueHolDelay = txonQueueHolDelay.GetMilliSeconds ();
   r.retxQueueSize = m_retxBufferSize;// + m_txedBufferSize;
   r.retxQueueHolDelay = retxQueueHolDelay.GetMilliSeconds ();
   
   // from UM low lat TODO check
-  for (unsigned i = 0; i < m_txonBuffer.size(); i++)
+  // only include up to the first 20 packets
+  LteRlcSduQueue::ConstIterator sduIt = m_txonBuffer.Begin ();
+  for (unsigned i = 0; sduIt != m_txonBuffer.End () && i < 20; ++sduIt, i++)
   {
-    if (i == 20)  // only include up to the first 20 packets
-    {
-      break;
-    }
-    r.txPacketSizes.push_back (m_txonBuffer[i]->GetSize ());
+    r.txPacketSizes.push_back (i == 0 ? m_txonBuffer.GetSduSize (0) : (*sduIt)->GetSize ());
     RlcTag holTimeTag;
-    m_txonBuffer[i]->PeekPacketTag (holTimeTag);
+    (*sduIt)->PeekPacketTag (holTimeTag);
     Time holDelay = Simulator::Now () - holTimeTag.GetSenderTimestamp ();
     r.txPacketDelays.push_back (holDelay.GetMicroSeconds ());
   }
@@ -2913,7 +2819,7 @@ LteRlcAm::ExpirePollRetransmitTimer (void)
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("PollRetransmit Timer has expired");
 
-  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBufferSize);
+  NS_LOG_LOGIC ("txonBufferSize = " << m_txonBuffer.GetNBytes ());
   NS_LOG_LOGIC ("retxBufferSize = " << m_retxBufferSize);
   NS_LOG_LOGIC ("txedBufferSize = " << m_txedBufferSize);
   NS_LOG_LOGIC ("statusPduRequested = " << m_statusPduRequested);
@@ -2924,7 +2830,7 @@ LteRlcAm::ExpirePollRetransmitTimer (void)
   // note the difference between Rel 8 and Rel 11 specs; we follow Rel 11 here
   NS_ASSERT (m_vtS <= m_vtMs);
   //if ((m_txonBufferSize == 0 && m_retxBufferSize == 0)
-  if ((m_txonBufferSize + m_txonQueue->GetNBytes() == 0 && m_retxBufferSize == 0)
+  if ((m_txonBuffer.GetNBytes () + m_txonQueue->GetNBytes() == 0 && m_retxBufferSize == 0)
       || (m_vtS == m_vtMs))
     {
       NS_LOG_INFO ("txonBuffer and retxBuffer empty. Move PDUs up to = " << m_vtS.GetValue () - 1 << " to retxBuffer");
@@ -2935,55 +2841,19 @@ LteRlcAm::ExpirePollRetransmitTimer (void)
         {
       for ( sn = m_vtA.GetValue(); sn < m_vtS.GetValue (); sn++ )
       {
-        bool pduAvailable = m_txedBuffer.at (sn).m_pdu != 0;
-
-         if ( pduAvailable )
-         {
-           NS_LOG_INFO ("Move PDU " << sn << " from txedBuffer to retxBuffer");
-           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu->Copy ();
-           m_retxBuffer.at (sn).m_retxCount = m_txedBuffer.at (sn).m_retxCount;
-           m_retxBufferSize += m_retxBuffer.at (sn).m_pdu->GetSize ();
-
-           m_txedBufferSize -= m_txedBuffer.at (sn).m_pdu->GetSize ();
-           m_txedBuffer.at (sn).m_pdu = 0;
-           m_txedBuffer.at (sn).m_retxCount = 0;
-         }
+        MoveToRetxBuffer (sn);
        }
          }
        else//If overflow happened, we retransmit from acked sequence to 1023, then from 0 to sent sequence.
          {
        for ( sn = m_vtA.GetValue(); sn < 1024; sn++ )
          {
-         bool pduAvailable = m_txedBuffer.at (sn).m_pdu != 0;
-
-         if ( pduAvailable )
-         {
-           NS_LOG_INFO ("Move PDU " << sn << " from txedBuffer to retxBuffer");
-           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu->Copy ();
-           m_retxBuffer.at (sn).m_retxCount = m_txedBuffer.at (sn).m_retxCount;
-           m_retxBufferSize += m_retxBuffer.at (sn).m_pdu->GetSize ();
-
-           m_txedBufferSize -= m_txedBuffer.at (sn).m_pdu->GetSize ();
-           m_txedBuffer.at (sn).m_pdu = 0;
-           m_txedBuffer.at (sn).m_retxCount = 0;
-         }
+         MoveToRetxBuffer (sn);
       }
 
       for ( sn = 0; sn < m_vtS.GetValue (); sn++ )
       {
-        bool pduAvailable = m_txedBuffer.at (sn).m_pdu != 0;
-
-         if ( pduAvailable )
-         {
-           NS_LOG_INFO ("Move PDU " << sn << " from txedBuffer to retxBuffer");
-           m_retxBuffer.at (sn).m_pdu = m_txedBuffer.at (sn).m_pdu->Copy ();
-           m_retxBuffer.at (sn).m_retxCount = m_txedBuffer.at (sn).m_retxCount;
-           m_retxBufferSize += m_retxBuffer.at (sn).m_pdu->GetSize ();
-
-           m_txedBufferSize -= m_txedBuffer.at (sn).m_pdu->GetSize ();
-           m_txedBuffer.at (sn).m_pdu = 0;
-           m_txedBuffer.at (sn).m_retxCount = 0;
-         }
+        MoveToRetxBuffer (sn);
       }
         }
     }
@@ -3003,7 +2873,7 @@ LteRlcAm::ExpireRbsTimer (void)
 {
   NS_LOG_LOGIC ("RBS Timer expires");
 
-  if (m_txonBufferSize + m_txonQueue->GetNBytes() + m_txedBufferSize + m_retxBufferSize > 0)
+  if (m_txonBuffer.GetNBytes () + m_txonQueue->GetNBytes() + m_txedBufferSize + m_retxBufferSize > 0)
     {
       DoReportBufferStatus ();
       m_rbsTimer = Simulator::Schedule (m_rbsTimerValue, &LteRlcAm::ExpireRbsTimer, this);
@@ -27,6 +27,7 @@
 #include <ns3/event-id.h>
 #include <ns3/lte-rlc-sequence-number.h>
 #include <ns3/lte-rlc.h>
+#include <ns3/lte-rlc-sdu-queue.h>
 #include <ns3/epc-x2-sap.h>
 #include <ns3/lte-pdcp-header.h>
 
@@ -128,6 +129,22 @@ private:
   bool IsInsideReceivingWindow (SequenceNumber10 seqNumber);
   bool IsInsideTransmittingWindow(SequenceNumber10 seqNumber);
 
+  /**
+   * Mark a transmitted PDU as to be retransmitted, if it is not already
+   * \param seqNumberValue the SN of the PDU
+   */
+  void MoveToRetxBuffer (uint16_t seqNumberValue);
+  /**
+   * \param seqNumberValue the SN
+   * \return true if a transmitted PDU which is not considered for retransmission is stored for the SN
+   */
+  bool IsInTxedBuffer (uint16_t seqNumberValue) const;
+  /**
+   * \param seqNumberValue the SN
+   * \return true if a PDU considered for retransmission is stored for the SN
+   */
+  bool IsInRetxBuffer (uint16_t seqNumberValue) const;
+
   // LL HO
   bool IsInsideTransmittingWindow ();
   //Create RlcSduBuffer <seqNumber, RlcSDU> based on m_transmittingRlcSdus.
@@ -150,13 +167,20 @@ private:
   void BufferSizeTrace();
 
 private:
-    std::vector < Ptr<Packet> > m_txonBuffer;       // Transmission buffer
-
-    struct RetxSegPdu
+    LteRlcSduQueue m_txonBuffer;       // Transmission buffer
+
+    /**
+     * Entry of the retransmission store. A PDU is stored once, when it is
+     * transmitted for the first time, and then moves between the transmitted
+     * (waiting for an ACK) and the to-be-retransmitted states by flag
+     */
+    struct TxedPdu
     {
-      Ptr<Packet> m_pdu;
+      Ptr<Packet> m_pdu;          ///< the PDU, 0 if the SN is not in use
       uint16_t    m_retxCount;
-      bool      m_lastSegSent;    // all segments sent, waiting for ACK
+      bool        m_retx;         ///< true if the PDU is considered for retransmission
+      Ptr<Packet> m_segment;      ///< remaining segment of a re-segmented PDU
+      bool        m_lastSegSent;  ///< all segments sent, waiting for ACK
     };
 
   // LL HO: store a complete version of the incomplete RLC SDU at the 
@@ -165,11 +189,9 @@ private:
   // to assure no packet is lost.
   Ptr<Packet> m_segmented_rlcsdu;
 
-  std::vector <RetxPdu> m_txedBuffer;  ///< Buffer for transmitted and retransmitted PDUs 
-                                       ///< that have not been acked but are not considered 
-                                       ///< for retransmission 
-  std::vector <RetxPdu> m_retxBuffer;  ///< Buffer for PDUs considered for retransmission
-  std::vector <RetxSegPdu> m_retxSegBuffer;  // buffer for AM PDU segments
+  std::vector <TxedPdu> m_retxStore;  ///< PDUs that have been transmitted and not acked yet,
+                                      ///< indexed by SN. m_txedBufferSize and m_retxBufferSize
+                                      ///< count the bytes in the two states
 
   Ptr<CoDelQueueDisc> m_txonQueue;
 
@@ -179,7 +201,6 @@ private:
   uint32_t m_transmittingRlcSduBufferSize;
   std::map <uint32_t, Ptr <Packet> > m_transmittingRlcSduBuffer;
 
-    uint32_t m_txonBufferSize;
     uint32_t m_retxBufferSize;
     uint32_t m_txedBufferSize;
 
@@ -0,0 +1,162 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/lte-rlc-sdu-queue.h"
+#include "ns3/lte-rlc-sdu-status-tag.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LteRlcSduQueue");
+
+LteRlcSduQueue::LteRlcSduQueue ()
+  : m_frontOffset (0),
+    m_nBytes (0)
+{
+}
+
+void
+LteRlcSduQueue::PushBack (Ptr<Packet> sdu)
+{
+  NS_LOG_FUNCTION (this << sdu->GetSize ());
+  m_sdus.push_back (sdu);
+  m_nBytes += sdu->GetSize ();
+}
+
+Ptr<Packet>
+LteRlcSduQueue::CreateFrontSegment (uint32_t start, uint32_t size) const
+{
+  Ptr<Packet> sdu = m_sdus.front ();
+  Ptr<Packet> segment = sdu->CreateFragment (start, size);
+
+  LteRlcSduStatusTag tag;
+  segment->RemovePacketTag (tag);
+  bool first = (start == 0);
+  bool last = (start + size == sdu->GetSize ());
+  if (first)
+    {
+      tag.SetStatus (last ? LteRlcSduStatusTag::FULL_SDU : LteRlcSduStatusTag::FIRST_SEGMENT);
+    }
+  else
+    {
+      tag.SetStatus (last ? LteRlcSduStatusTag::LAST_SEGMENT : LteRlcSduStatusTag::MIDDLE_SEGMENT);
+    }
+  segment->AddPacketTag (tag);
+  return segment;
+}
+
+Ptr<Packet>
+LteRlcSduQueue::PopFront (uint32_t maxSize)
+{
+  NS_LOG_FUNCTION (this << maxSize);
+  NS_ASSERT_MSG (!m_sdus.empty (), "No SDUs in the queue");
+  NS_ASSERT (maxSize > 0);
+
+  Ptr<Packet> sdu = m_sdus.front ();
+  uint32_t remaining = sdu->GetSize () - m_frontOffset;
+  uint32_t size = std::min (remaining, maxSize);
+
+  Ptr<Packet> segment;
+  if (m_frontOffset == 0 && size == remaining)
+    {
+      // the whole SDU is taken, no need for a fragment
+      segment = sdu;
+    }
+  else
+    {
+      segment = CreateFrontSegment (m_frontOffset, size);
+    }
+
+  m_nBytes -= size;
+  if (size == remaining)
+    {
+      m_sdus.pop_front ();
+      m_frontOffset = 0;
+    }
+  else
+    {
+      m_frontOffset += size;
+    }
+  NS_LOG_LOGIC ("segment size " << size << ", " << m_sdus.size () << " SDUs and " << m_nBytes << " bytes left");
+  return segment;
+}
+
+Ptr<Packet>
+LteRlcSduQueue::PeekFront (void) const
+{
+  NS_ASSERT_MSG (!m_sdus.empty (), "No SDUs in the queue");
+  return m_sdus.front ();
+}
+
+LteRlcSduQueue::ConstIterator
+LteRlcSduQueue::Begin (void) const
+{
+  return m_sdus.begin ();
+}
+
+LteRlcSduQueue::ConstIterator
+LteRlcSduQueue::End (void) const
+{
+  return m_sdus.end ();
+}
+
+uint32_t
+LteRlcSduQueue::GetSduSize (uint32_t i) const
+{
+  NS_ASSERT (i < m_sdus.size ());
+  return m_sdus[i]->GetSize () - (i == 0 ? m_frontOffset : 0);
+}
+
+bool
+LteRlcSduQueue::IsEmpty (void) const
+{
+  return m_sdus.empty ();
+}
+
+uint32_t
+LteRlcSduQueue::GetNSdus (void) const
+{
+  return m_sdus.size ();
+}
+
+uint32_t
+LteRlcSduQueue::GetNBytes (void) const
+{
+  return m_nBytes;
+}
+
+std::vector < Ptr<Packet> >
+LteRlcSduQueue::GetSdus (void) const
+{
+  std::vector < Ptr<Packet> > sdus (m_sdus.begin (), m_sdus.end ());
+  if (m_frontOffset > 0)
+    {
+      sdus.front () = CreateFrontSegment (m_frontOffset, m_sdus.front ()->GetSize () - m_frontOffset);
+    }
+  return sdus;
+}
+
+void
+LteRlcSduQueue::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sdus.clear ();
+  m_frontOffset = 0;
+  m_nBytes = 0;
+}
+
+} // namespace ns3
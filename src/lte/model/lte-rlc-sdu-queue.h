@@ -0,0 +1,125 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LTE_RLC_SDU_QUEUE_H
+#define LTE_RLC_SDU_QUEUE_H
+
+#include "ns3/packet.h"
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup lte
+ *
+ * \brief FIFO of the RLC SDUs waiting for transmission
+ *
+ * The SDUs are stored in a deque, so that they are added and removed in
+ * constant time also when the queue holds tens of thousands of them. The
+ * segmentation of the SDU at the head of the queue is tracked with a byte
+ * offset: the stored SDU is never modified, and every segment is created
+ * as a fragment of it, with the LteRlcSduStatusTag of the segment. The SDUs
+ * are expected to carry a FULL_SDU status tag when they are enqueued.
+ */
+class LteRlcSduQueue
+{
+public:
+  /// iterator over the SDUs, as they were enqueued
+  typedef std::deque < Ptr<Packet> >::const_iterator ConstIterator;
+
+  LteRlcSduQueue ();
+
+  /**
+   * \brief Add an SDU at the tail of the queue
+   * \param sdu the SDU
+   */
+  void PushBack (Ptr<Packet> sdu);
+
+  /**
+   * \brief Remove the first bytes of the SDU at the head of the queue
+   *
+   * The head SDU is dequeued when all its bytes have been taken. An SDU
+   * which is taken entirely is returned without any copy.
+   *
+   * \param maxSize the maximum size of the segment
+   * \return the segment, with the status tag updated
+   */
+  Ptr<Packet> PopFront (uint32_t maxSize);
+
+  /**
+   * \return the SDU at the head of the queue, as it was enqueued
+   */
+  Ptr<Packet> PeekFront (void) const;
+
+  /**
+   * \return an iterator to the SDU at the head of the queue
+   */
+  ConstIterator Begin (void) const;
+
+  /**
+   * \return an iterator past the SDU at the tail of the queue
+   */
+  ConstIterator End (void) const;
+
+  /**
+   * \param i the position in the queue
+   * \return the size of the i-th SDU, without the bytes already transmitted
+   */
+  uint32_t GetSduSize (uint32_t i) const;
+
+  /**
+   * \return true if there are no SDUs in the queue
+   */
+  bool IsEmpty (void) const;
+
+  /**
+   * \return the number of SDUs (including the partially transmitted one)
+   */
+  uint32_t GetNSdus (void) const;
+
+  /**
+   * \return the number of bytes waiting for transmission
+   */
+  uint32_t GetNBytes (void) const;
+
+  /**
+   * \return the SDUs in the queue, where the partially transmitted one is
+   * replaced by its remaining segment
+   */
+  std::vector < Ptr<Packet> > GetSdus (void) const;
+
+  /**
+   * \brief Remove all the SDUs
+   */
+  void Clear (void);
+
+private:
+  /**
+   * \param start the offset of the segment in the head SDU
+   * \param size the size of the segment
+   * \return the segment of the head SDU with its status tag
+   */
+  Ptr<Packet> CreateFrontSegment (uint32_t start, uint32_t size) const;
+
+  std::deque < Ptr<Packet> > m_sdus; ///< the SDUs
+  uint32_t m_frontOffset; ///< bytes of the head SDU already transmitted
+  uint32_t m_nBytes; ///< bytes waiting for transmission
+};
+
+} // namespace ns3
+
+#endif // LTE_RLC_SDU_QUEUE_H
@@ -30,6 +30,7 @@
 
 #include "ns3/lte-rlc-sequence-number.h"
 #include "ns3/lte-rlc.h"
+#include "ns3/lte-rlc-sdu-queue.h"
 #include <ns3/epc-x2-sap.h>
  
 #include <ns3/event-id.h>
@@ -69,7 +70,7 @@ public:
   std::vector < Ptr<Packet> > GetTxBuffer();
   uint32_t GetTxBufferSize()
   {
-    return m_txBufferSize;
+    return m_txBuffer.GetNBytes ();
   }
 
   virtual void SetMaxTxBufferSize(uint32_t maxTxBufSize);
@@ -91,8 +92,7 @@ private:
 
 private:
   uint32_t m_maxTxBufferSize;
-  uint32_t m_txBufferSize;
-  std::vector < Ptr<Packet> > m_txBuffer;       // Transmission buffer
+  LteRlcSduQueue m_txBuffer;       // Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; // Reception buffer
   std::vector < Ptr<Packet> > m_reasBuffer;     // Reassembling buffer
 
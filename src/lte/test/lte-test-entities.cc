@@ -713,6 +713,12 @@ EpcTestRrc::DoPathSwitchRequestAcknowledge (EpcEnbS1SapUser::PathSwitchRequestAc
 
 }
 
+void
+EpcTestRrc::DoNotifyNumIabPerRnti (EpcEnbS1SapUser::NotifyNumIabPerRntiParameters params)
+{
+
+}
+
 
 } // namespace ns3
 
@@ -0,0 +1,208 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/lte-rlc-am.h"
+#include "ns3/lte-mac-sap.h"
+#include "ns3/lte-rlc-sap.h"
+
+#include <iostream>
+#include <sstream>
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteRlcAmBenchmark");
+
+/**
+ * MAC SAP provider which delivers the PDUs of an RLC entity to its peer
+ * after one slot, without any loss
+ */
+class LteRlcAmBenchmarkMac : public LteMacSapProvider
+{
+public:
+  LteRlcAmBenchmarkMac (Time delay)
+    : m_peer (0),
+      m_delay (delay)
+  {
+  }
+
+  virtual void TransmitPdu (TransmitPduParameters params)
+  {
+    Simulator::Schedule (m_delay, &LteMacSapUser::ReceivePdu, m_peer, params.pdu);
+  }
+
+  virtual void ReportBufferStatus (ReportBufferStatusParameters params)
+  {
+  }
+
+  LteMacSapUser* m_peer; ///< MAC SAP user of the peer RLC entity
+
+private:
+  Time m_delay;
+};
+
+/**
+ * RLC SAP user which counts the bytes of the received SDUs
+ */
+class LteRlcAmBenchmarkSink : public LteRlcSapUser
+{
+public:
+  LteRlcAmBenchmarkSink ()
+    : m_rxBytes (0)
+  {
+  }
+
+  virtual void ReceivePdcpPdu (Ptr<Packet> p)
+  {
+    m_rxBytes += p->GetSize ();
+  }
+
+  uint64_t m_rxBytes;
+};
+
+/**
+ * Drive a single LteRlcAm entity with a 10 Gbps offered load, served at a
+ * lower rate so that the transmission buffer stays full, and report the
+ * wall-clock time per simulated second. The PDUs are acknowledged by a peer
+ * LteRlcAm entity.
+ */
+class LteRlcAmBenchmarkTestCase : public TestCase
+{
+public:
+  LteRlcAmBenchmarkTestCase (uint32_t maxTxBufferSize);
+  virtual ~LteRlcAmBenchmarkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Slot (void);
+
+  uint32_t m_maxTxBufferSize;
+  Ptr<LteRlcAm> m_txRlc;
+  Ptr<LteRlcAm> m_rxRlc;
+  uint64_t m_txBytes;
+  uint32_t m_maxSdus;
+
+  static const uint32_t m_sduSize = 1400;
+  static const uint32_t m_offeredBytesPerSlot = 156250; // 10 Gbps with 125 us slots
+  static const uint32_t m_grantBytesPerSlot = 125000; // 8 Gbps
+};
+
+static std::string
+BuildNameString (uint32_t maxTxBufferSize)
+{
+  std::ostringstream oss;
+  oss << "10 Gbps offered load, MaxTxBufferSize " << maxTxBufferSize << " bytes";
+  return oss.str ();
+}
+
+LteRlcAmBenchmarkTestCase::LteRlcAmBenchmarkTestCase (uint32_t maxTxBufferSize)
+  : TestCase (BuildNameString (maxTxBufferSize)),
+    m_maxTxBufferSize (maxTxBufferSize),
+    m_txBytes (0),
+    m_maxSdus (0)
+{
+}
+
+LteRlcAmBenchmarkTestCase::~LteRlcAmBenchmarkTestCase ()
+{
+}
+
+void
+LteRlcAmBenchmarkTestCase::Slot (void)
+{
+  LteRlcSapProvider::TransmitPdcpPduParameters params;
+  params.rnti = 1;
+  params.lcid = 3;
+  for (uint32_t offered = 0; offered < m_offeredBytesPerSlot; offered += m_sduSize)
+    {
+      params.pdcpPdu = Create<Packet> (m_sduSize);
+      m_txRlc->GetLteRlcSapProvider ()->TransmitPdcpPdu (params);
+    }
+  m_maxSdus = std::max (m_maxSdus, m_txRlc->GetTxBufferSize () / m_sduSize);
+
+  m_txRlc->GetLteMacSapUser ()->NotifyTxOpportunity (m_grantBytesPerSlot, 0, 0);
+  // room for the STATUS PDUs
+  m_rxRlc->GetLteMacSapUser ()->NotifyTxOpportunity (1000, 0, 0);
+  Simulator::Schedule (MicroSeconds (125), &LteRlcAmBenchmarkTestCase::Slot, this);
+}
+
+void
+LteRlcAmBenchmarkTestCase::DoRun (void)
+{
+  LteRlcAmBenchmarkMac txMac (MicroSeconds (125));
+  LteRlcAmBenchmarkMac rxMac (MicroSeconds (125));
+  LteRlcAmBenchmarkSink sink;
+
+  m_txRlc = CreateObject<LteRlcAm> ();
+  m_rxRlc = CreateObject<LteRlcAm> ();
+  Ptr<LteRlcAm> rlcs[2] = {m_txRlc, m_rxRlc};
+  LteRlcAmBenchmarkMac *macs[2] = {&txMac, &rxMac};
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      rlcs[i]->SetRnti (1);
+      rlcs[i]->SetLcId (3);
+      rlcs[i]->SetAttribute ("MaxTxBufferSize", UintegerValue (m_maxTxBufferSize));
+      rlcs[i]->SetAttribute ("BufferSizeFilename", StringValue ("/dev/null"));
+      rlcs[i]->SetLteRlcSapUser (&sink);
+      rlcs[i]->SetLteMacSapProvider (macs[i]);
+    }
+  txMac.m_peer = m_rxRlc->GetLteMacSapUser ();
+  rxMac.m_peer = m_txRlc->GetLteMacSapUser ();
+
+  Time duration = MilliSeconds (100);
+  Simulator::Schedule (MicroSeconds (125), &LteRlcAmBenchmarkTestCase::Slot, this);
+  Simulator::Stop (duration);
+
+  std::clock_t start = std::clock ();
+  Simulator::Run ();
+  double elapsed = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+
+  NS_TEST_ASSERT_MSG_GT (sink.m_rxBytes, 0, "no SDUs delivered");
+  std::cout << GetName () << ": " << elapsed / duration.GetSeconds ()
+            << " s per simulated second, " << sink.m_rxBytes * 8 / duration.GetSeconds () / 1e9
+            << " Gbps delivered, up to " << m_maxSdus << " SDUs in the buffer" << std::endl;
+
+  m_txRlc->Dispose ();
+  m_rxRlc->Dispose ();
+  m_txRlc = 0;
+  m_rxRlc = 0;
+  Simulator::Destroy ();
+}
+
+
+class LteRlcAmBenchmarkTestSuite : public TestSuite
+{
+public:
+  LteRlcAmBenchmarkTestSuite ();
+};
+
+LteRlcAmBenchmarkTestSuite::LteRlcAmBenchmarkTestSuite ()
+  : TestSuite ("lte-rlc-am-benchmark", PERFORMANCE)
+{
+  uint32_t maxTxBufferSizes[] = {1024 * 1024, 10 * 1024 * 1024, 50 * 1024 * 1024};
+  for (uint32_t i = 0; i < sizeof (maxTxBufferSizes) / sizeof (maxTxBufferSizes[0]); i++)
+    {
+      AddTestCase (new LteRlcAmBenchmarkTestCase (maxTxBufferSizes[i]), TestCase::QUICK);
+    }
+}
+
+static LteRlcAmBenchmarkTestSuite lteRlcAmBenchmarkTestSuite;
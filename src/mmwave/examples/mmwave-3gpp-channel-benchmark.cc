@@ -0,0 +1,192 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Micro-benchmark of the MmWave3gppChannel spectrum propagation loss model.
+ * A grid of buildings is populated with one wired gNB, numEnb-1 IAB nodes and
+ * numUe UEs (the default values give the 100-UE / 10-gNB IAB grid). The
+ * benchmark measures the wall-clock time needed to
+ *  - generate the channels and the initial beamforming vectors of all the
+ *    UE-gNB pairs (MmWave3gppChannel::Initial);
+ *  - compute the received PSD of every UE-gNB pair, in downlink and uplink,
+ *    repeated numRep times, which is the per-slot hot path of the model.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/buildings-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+#include "ns3/mmwave-spectrum-value-helper.h"
+#include "ns3/mmwave-3gpp-channel.h"
+#include "ns3/system-wall-clock-ms.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWave3gppChannelBenchmark");
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t numEnb = 10;
+  uint32_t numUe = 100;
+  uint32_t numRep = 10;
+  uint32_t run = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("numEnb", "Number of gNBs (1 wired, the others are IAB nodes)", numEnb);
+  cmd.AddValue ("numUe", "Number of UEs", numUe);
+  cmd.AddValue ("numRep", "Number of times each link is evaluated", numRep);
+  cmd.AddValue ("run", "Run number for the RNG", run);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (numEnb < 1, "At least one gNB is needed");
+
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (run);
+
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+
+  Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper> ();
+  mmwaveHelper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppBuildingsPropagationLossModel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  mmwaveHelper->SetEpcHelper (epcHelper);
+  mmwaveHelper->Initialize ();
+
+  // 4x4 grid of buildings, as in scratch/mmwave-iab-grid.cc
+  uint32_t numBuildingsRow = 4;
+  double streetWidth = 10;
+  double buildingWidth = 50;
+  double buildingHeight = 10;
+  for (uint32_t rowIndex = 0; rowIndex < numBuildingsRow; ++rowIndex)
+    {
+      for (uint32_t colIndex = 0; colIndex < numBuildingsRow; ++colIndex)
+        {
+          double minX = colIndex * (buildingWidth + streetWidth);
+          double minY = rowIndex * (buildingWidth + streetWidth);
+          Ptr<Building> building = Create<Building> ();
+          building->SetBoundaries (Box (minX, minX + buildingWidth, minY, minY + buildingWidth, 0.0, buildingHeight));
+        }
+    }
+  double side = numBuildingsRow * (buildingWidth + streetWidth) - streetWidth;
+
+  NodeContainer enbNodes;
+  NodeContainer iabNodes;
+  NodeContainer ueNodes;
+  enbNodes.Create (1);
+  iabNodes.Create (numEnb - 1);
+  ueNodes.Create (numUe);
+
+  // gNBs at the (numBuildingsRow-1)^2 street intersections, above the rooftops;
+  // if there are more gNBs than intersections, they are stacked at increasing heights
+  uint32_t numCrossings = (numBuildingsRow - 1) * (numBuildingsRow - 1);
+  Ptr<ListPositionAllocator> enbPositionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < numEnb; ++i)
+    {
+      uint32_t crossing = i % numCrossings;
+      double x = (crossing % (numBuildingsRow - 1) + 1) * (buildingWidth + streetWidth) - streetWidth / 2;
+      double y = (crossing / (numBuildingsRow - 1) + 1) * (buildingWidth + streetWidth) - streetWidth / 2;
+      enbPositionAlloc->Add (Vector (x, y, buildingHeight + 5 + 3 * (i / numCrossings)));
+    }
+  MobilityHelper enbMobility;
+  enbMobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  enbMobility.SetPositionAllocator (enbPositionAlloc);
+  enbMobility.Install (enbNodes);
+  enbMobility.Install (iabNodes);
+
+  Ptr<OutdoorPositionAllocator> uePositionAlloc = CreateObject<OutdoorPositionAllocator> ();
+  Ptr<UniformRandomVariable> xUe = CreateObject<UniformRandomVariable> ();
+  xUe->SetAttribute ("Max", DoubleValue (side));
+  Ptr<UniformRandomVariable> yUe = CreateObject<UniformRandomVariable> ();
+  yUe->SetAttribute ("Max", DoubleValue (side));
+  Ptr<UniformRandomVariable> zUe = CreateObject<UniformRandomVariable> ();
+  zUe->SetAttribute ("Min", DoubleValue (1.6));
+  zUe->SetAttribute ("Max", DoubleValue (1.75));
+  uePositionAlloc->SetX (xUe);
+  uePositionAlloc->SetY (yUe);
+  uePositionAlloc->SetZ (zUe);
+  MobilityHelper ueMobility;
+  ueMobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  ueMobility.SetPositionAllocator (uePositionAlloc);
+  ueMobility.Install (ueNodes);
+
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (iabNodes);
+  BuildingsHelper::Install (ueNodes);
+  BuildingsHelper::MakeMobilityModelConsistent ();
+
+  NetDeviceContainer enbDevs = mmwaveHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer iabDevs = mmwaveHelper->InstallIabDevice (iabNodes);
+  NetDeviceContainer ueDevs = mmwaveHelper->InstallUeDevice (ueNodes);
+  NetDeviceContainer bsDevs (enbDevs, iabDevs);
+
+  Ptr<MmWavePhyMacCommon> config = mmwaveHelper->GetPhyMacConfigurable ();
+  Ptr<MmWave3gppChannel> channel = CreateObject<MmWave3gppChannel> ();
+  channel->SetConfigurationParameters (config);
+  channel->SetPathlossModel (mmwaveHelper->GetPathLossModel ());
+
+  std::vector<int> subChannels;
+  for (uint32_t i = 0; i < config->GetTotalNumChunk (); ++i)
+    {
+      subChannels.push_back (i);
+    }
+  Ptr<const SpectrumValue> txPsd = MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (config, 30, subChannels);
+
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  channel->Initial (ueDevs, bsDevs);
+  int64_t initialMs = clock.End ();
+
+  std::vector<std::pair<Ptr<MobilityModel>, Ptr<MobilityModel> > > links;
+  for (uint32_t u = 0; u < ueNodes.GetN (); ++u)
+    {
+      Ptr<MobilityModel> ueMob = ueNodes.Get (u)->GetObject<MobilityModel> ();
+      for (uint32_t b = 0; b < bsDevs.GetN (); ++b)
+        {
+          Ptr<MobilityModel> bsMob = bsDevs.Get (b)->GetNode ()->GetObject<MobilityModel> ();
+          links.push_back (std::make_pair (bsMob, ueMob));
+          links.push_back (std::make_pair (ueMob, bsMob));
+        }
+    }
+
+  double check = 0;
+  clock.Start ();
+  for (uint32_t rep = 0; rep < numRep; ++rep)
+    {
+      for (uint32_t l = 0; l < links.size (); ++l)
+        {
+          Ptr<SpectrumValue> rxPsd = channel->CalcRxPowerSpectralDensity (txPsd, links[l].first, links[l].second);
+          check += Sum (*rxPsd);
+        }
+    }
+  int64_t psdMs = clock.End ();
+  uint64_t numEval = static_cast<uint64_t> (numRep) * links.size ();
+
+  std::cout << "gNBs " << numEnb << " UEs " << numUe << " links " << links.size ()
+            << " chunks " << config->GetTotalNumChunk () << std::endl;
+  std::cout << "Initial (channel generation + beamforming): " << initialMs << " ms, "
+            << 1e3 * initialMs / (numEnb * numUe) << " us per pair" << std::endl;
+  std::cout << "DoCalcRxPowerSpectralDensity: " << numEval << " evaluations in " << psdMs << " ms, "
+            << 1e3 * psdMs / numEval << " us per link (checksum " << check << ")" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,78 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Converter of the binary RxPacketTrace files, written by MmWavePhyRxTrace
+ * with OutputFormat=Binary, to the tab separated text of OutputFormat=Text.
+ *
+ * Run the simulation with
+ *   --ns3::MmWavePhyRxTrace::OutputFormat=Binary
+ * and then
+ *   ./waf --run "mmwave-rx-packet-trace-converter --input=RxPacketTrace.bin"
+ * which writes RxPacketTrace.txt.
+ *
+ * With --epochStats, the input is instead a binary file of epoch statistics
+ * written by MmWaveBearerStatsCalculator with AggregationMode=true, e.g.
+ *   ./waf --run "mmwave-rx-packet-trace-converter --epochStats --input=DlPdcpStats.bin"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-phy-rx-trace.h"
+#include "ns3/mmwave-bearer-stats-calculator.h"
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveRxPacketTraceConverter");
+
+int
+main (int argc, char *argv[])
+{
+  std::string input = "RxPacketTrace.bin";
+  std::string output = "";
+  bool epochStats = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "Binary RxPacketTrace file to convert", input);
+  cmd.AddValue ("output", "Text file to write, by default the input file with the .txt extension", output);
+  cmd.AddValue ("epochStats", "Convert binary epoch statistics of MmWaveBearerStatsCalculator", epochStats);
+  cmd.Parse (argc, argv);
+
+  if (output.empty ())
+    {
+      size_t dot = input.rfind ('.');
+      size_t slash = input.rfind ('/');
+      bool hasExtension = (dot != std::string::npos && (slash == std::string::npos || dot > slash));
+      output = (hasExtension ? input.substr (0, dot) : input) + ".txt";
+    }
+  NS_ABORT_MSG_IF (output == input, "The output file would overwrite the input file");
+
+  if (epochStats)
+    {
+      uint64_t numRows = MmWaveBearerStatsCalculator::ConvertEpochStats (input, output);
+      std::cout << input << " -> " << output << ": " << numRows << " rows" << std::endl;
+    }
+  else
+    {
+      uint64_t numRecords = MmWavePhyRxTrace::ConvertRxPacketTrace (input, output);
+      std::cout << input << " -> " << output << ": " << numRecords << " TBs" << std::endl;
+    }
+
+  return 0;
+}
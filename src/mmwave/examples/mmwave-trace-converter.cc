@@ -0,0 +1,100 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Offline converter of the text trace files of MmWaveBeamforming and
+ * MmWaveChannelRaytracing to the binary format of MmWaveTraceFile, which is
+ * mapped in memory instead of being parsed at every run.
+ *
+ * Convert the whole BeamFormingMatrix directory (the .bin files are written
+ * next to the .txt ones, and used by MmWaveBeamforming in their place):
+ *   ./waf --run "mmwave-trace-converter --beamformingPath=src/mmwave/model/BeamFormingMatrix"
+ * Convert a single file, e.g., the raytracing traces:
+ *   ./waf --run "mmwave-trace-converter --input=src/mmwave/model/Raytracing/traces10cm.txt
+ *                --output=src/mmwave/model/Raytracing/traces10cm.bin"
+ * and set ns3::MmWaveChannelRaytracing::TraceFile to the binary file.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-trace-file.h"
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceConverter");
+
+static void
+Convert (std::string input, std::string output, bool complex)
+{
+  Ptr<MmWaveTraceFile> table = MmWaveTraceFile::ParseText (input, complex);
+  table->WriteBinary (output);
+
+  // check that the binary file is read back without differences
+  Ptr<const MmWaveTraceFile> binary = MmWaveTraceFile::Load (output, complex);
+  NS_ABORT_MSG_IF (!binary->IsMapped () || binary->GetNRows () != table->GetNRows (), "Cannot read back " << output);
+  for (uint32_t row = 0; row < table->GetNRows (); row++)
+    {
+      NS_ABORT_MSG_IF (complex ? binary->GetComplexRowVector (row) != table->GetComplexRowVector (row)
+                       : binary->GetRowVector (row) != table->GetRowVector (row), "Row " << row << " differs in " << output);
+    }
+  std::cout << input << " -> " << output << ": " << table->GetNRows () << " rows" << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string beamformingPath = "";
+  std::string input = "";
+  std::string output = "";
+  bool complex = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("beamformingPath", "Directory of the MmWaveBeamforming files to convert", beamformingPath);
+  cmd.AddValue ("input", "Text file to convert", input);
+  cmd.AddValue ("output", "Binary file to write, by default the input file with the .bin extension", output);
+  cmd.AddValue ("complex", "Whether the input file stores complex values", complex);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (beamformingPath.empty () && input.empty (), "Set beamformingPath or input");
+
+  if (!beamformingPath.empty ())
+    {
+      Convert (beamformingPath + "/SmallScaleFading.txt", beamformingPath + "/SmallScaleFading.bin", false);
+      std::string complexFiles[] = {"TxAntenna", "RxAntenna", "TxSpatialSigniture", "RxSpatialSigniture"};
+      for (uint32_t i = 0; i < sizeof (complexFiles) / sizeof (complexFiles[0]); i++)
+        {
+          Convert (beamformingPath + "/" + complexFiles[i] + ".txt", beamformingPath + "/" + complexFiles[i] + ".bin", true);
+        }
+    }
+
+  if (!input.empty ())
+    {
+      if (output.empty ())
+        {
+          size_t dot = input.rfind ('.');
+          size_t slash = input.rfind ('/');
+          bool hasExtension = (dot != std::string::npos && (slash == std::string::npos || dot > slash));
+          output = (hasExtension ? input.substr (0, dot) : input) + ".bin";
+        }
+      NS_ABORT_MSG_IF (output == input, "The output file would overwrite the input file");
+      Convert (input, output, complex);
+    }
+
+  return 0;
+}
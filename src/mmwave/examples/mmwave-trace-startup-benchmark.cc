@@ -0,0 +1,249 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * Benchmark of the startup of a large IAB deployment with all the mmWave
+ * traces enabled, which is dominated by the Config paths resolved by the
+ * trace connectors. One wired gNB, numEnb-1 IAB nodes and numUe UEs (1000 by
+ * default) are placed in the building grid of scratch/mmwave-iab-grid.cc, and
+ * the benchmark measures the wall-clock time needed to
+ *  - install the devices;
+ *  - enable the traces (MmWaveHelper::EnableTraces), which connects the
+ *    wildcard paths which go through all the nodes and devices;
+ *  - initialize the objects at the start of the simulation;
+ *  - connect and disconnect the per-UE trace sources with their context
+ *    paths /NodeList/<node>/DeviceList/<device>/..., as the
+ *    MmWaveBearerStatsConnector does for every new UE context.
+ * The attach procedure computes the channel of every UE-gNB pair, thus it is
+ * simulated only with --attach=true, which is practical with a few hundred
+ * UEs. Run with --traces=false to compare with the startup without traces.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/buildings-module.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/mmwave-point-to-point-epc-helper.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceStartupBenchmark");
+
+static uint64_t g_traces = 0;
+
+static void
+CountRxPacketTrace (std::string context, RxPacketTraceParams params)
+{
+  g_traces++;
+}
+
+static void
+CountPdu (std::string context, uint16_t rnti, uint8_t lcid, uint32_t packetSize)
+{
+  g_traces++;
+}
+
+static void
+CountRxPdu (std::string context, uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint64_t delay)
+{
+  g_traces++;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t numEnb = 10;
+  uint32_t numUe = 1000;
+  bool attach = false;
+  double ueAttachDelay = 0.3;
+  double simTime = 0.4;
+  bool traces = true;
+  uint32_t run = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("numEnb", "Number of gNBs (1 wired, the others are IAB nodes)", numEnb);
+  cmd.AddValue ("numUe", "Number of UEs", numUe);
+  cmd.AddValue ("attach", "Simulate the attach of the IAB nodes and of the UEs", attach);
+  cmd.AddValue ("ueAttachDelay", "Time at which the UEs attach, after the IAB nodes [s]", ueAttachDelay);
+  cmd.AddValue ("simTime", "Simulated time [s]", simTime);
+  cmd.AddValue ("traces", "Enable all the mmWave traces", traces);
+  cmd.AddValue ("run", "Run number for the RNG", run);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (numEnb < 1, "At least one gNB is needed");
+
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (run);
+
+  Config::SetDefault ("ns3::MmWave3gppPropagationLossModel::Scenario", StringValue ("UMi-StreetCanyon"));
+
+  SystemWallClockMs clock;
+  clock.Start ();
+
+  Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper> ();
+  mmwaveHelper->SetAttribute ("PathlossModel", StringValue ("ns3::MmWave3gppBuildingsPropagationLossModel"));
+  Ptr<MmWavePointToPointEpcHelper> epcHelper = CreateObject<MmWavePointToPointEpcHelper> ();
+  mmwaveHelper->SetEpcHelper (epcHelper);
+  mmwaveHelper->Initialize ();
+
+  // 4x4 grid of buildings, as in scratch/mmwave-iab-grid.cc
+  uint32_t numBuildingsRow = 4;
+  double streetWidth = 10;
+  double buildingWidth = 50;
+  double buildingHeight = 10;
+  for (uint32_t rowIndex = 0; rowIndex < numBuildingsRow; ++rowIndex)
+    {
+      for (uint32_t colIndex = 0; colIndex < numBuildingsRow; ++colIndex)
+        {
+          double minX = colIndex * (buildingWidth + streetWidth);
+          double minY = rowIndex * (buildingWidth + streetWidth);
+          Ptr<Building> building = Create<Building> ();
+          building->SetBoundaries (Box (minX, minX + buildingWidth, minY, minY + buildingWidth, 0.0, buildingHeight));
+        }
+    }
+  double side = numBuildingsRow * (buildingWidth + streetWidth) - streetWidth;
+
+  NodeContainer enbNodes;
+  NodeContainer iabNodes;
+  NodeContainer ueNodes;
+  enbNodes.Create (1);
+  iabNodes.Create (numEnb - 1);
+  ueNodes.Create (numUe);
+
+  // gNBs at the (numBuildingsRow-1)^2 street intersections, above the rooftops;
+  // if there are more gNBs than intersections, they are stacked at increasing heights
+  uint32_t numCrossings = (numBuildingsRow - 1) * (numBuildingsRow - 1);
+  Ptr<ListPositionAllocator> enbPositionAlloc = CreateObject<ListPositionAllocator> ();
+  for (uint32_t i = 0; i < numEnb; ++i)
+    {
+      uint32_t crossing = i % numCrossings;
+      double x = (crossing % (numBuildingsRow - 1) + 1) * (buildingWidth + streetWidth) - streetWidth / 2;
+      double y = (crossing / (numBuildingsRow - 1) + 1) * (buildingWidth + streetWidth) - streetWidth / 2;
+      enbPositionAlloc->Add (Vector (x, y, buildingHeight + 5 + 3 * (i / numCrossings)));
+    }
+  MobilityHelper enbMobility;
+  enbMobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  enbMobility.SetPositionAllocator (enbPositionAlloc);
+  enbMobility.Install (enbNodes);
+  enbMobility.Install (iabNodes);
+
+  Ptr<OutdoorPositionAllocator> uePositionAlloc = CreateObject<OutdoorPositionAllocator> ();
+  Ptr<UniformRandomVariable> xUe = CreateObject<UniformRandomVariable> ();
+  xUe->SetAttribute ("Max", DoubleValue (side));
+  Ptr<UniformRandomVariable> yUe = CreateObject<UniformRandomVariable> ();
+  yUe->SetAttribute ("Max", DoubleValue (side));
+  Ptr<UniformRandomVariable> zUe = CreateObject<UniformRandomVariable> ();
+  zUe->SetAttribute ("Min", DoubleValue (1.6));
+  zUe->SetAttribute ("Max", DoubleValue (1.75));
+  uePositionAlloc->SetX (xUe);
+  uePositionAlloc->SetY (yUe);
+  uePositionAlloc->SetZ (zUe);
+  MobilityHelper ueMobility;
+  ueMobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  ueMobility.SetPositionAllocator (uePositionAlloc);
+  ueMobility.Install (ueNodes);
+
+  BuildingsHelper::Install (enbNodes);
+  BuildingsHelper::Install (iabNodes);
+  BuildingsHelper::Install (ueNodes);
+  BuildingsHelper::MakeMobilityModelConsistent ();
+
+  NetDeviceContainer enbDevs = mmwaveHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer iabDevs;
+  if (numEnb > 1)
+    {
+      iabDevs = mmwaveHelper->InstallIabDevice (iabNodes);
+    }
+  NetDeviceContainer ueDevs = mmwaveHelper->InstallUeDevice (ueNodes);
+
+  InternetStackHelper internet;
+  internet.Install (ueNodes);
+  epcHelper->AssignUeIpv4Address (ueDevs);
+
+  NetDeviceContainer bsDevs (enbDevs, iabDevs);
+  if (attach)
+    {
+      if (numEnb > 1)
+        {
+          mmwaveHelper->AttachIabToClosestWiredEnb (iabDevs, enbDevs);
+        }
+      mmwaveHelper->AttachToClosestEnbWithDelay (ueDevs, bsDevs, Seconds (ueAttachDelay));
+    }
+  int64_t installMs = clock.End ();
+
+  clock.Start ();
+  if (traces)
+    {
+      mmwaveHelper->EnableTraces ();
+    }
+  int64_t tracesMs = clock.End ();
+
+  // the objects are initialized by the first events of the simulation
+  clock.Start ();
+  Simulator::Stop (attach ? Seconds (simTime) : Seconds (0));
+  Simulator::Run ();
+  int64_t runMs = clock.End ();
+
+  std::vector<std::string> devicePaths;
+  for (uint32_t u = 0; u < ueDevs.GetN (); ++u)
+    {
+      std::ostringstream path;
+      path << "/NodeList/" << ueDevs.Get (u)->GetNode ()->GetId ()
+           << "/DeviceList/" << ueDevs.Get (u)->GetIfIndex ();
+      devicePaths.push_back (path.str ());
+    }
+  clock.Start ();
+  for (uint32_t u = 0; u < devicePaths.size (); ++u)
+    {
+      Config::Connect (devicePaths[u] + "/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe", MakeCallback (&CountRxPacketTrace));
+      Config::Connect (devicePaths[u] + "/LteUeRrc/Srb0/LteRlc/TxPDU", MakeCallback (&CountPdu));
+      Config::Connect (devicePaths[u] + "/LteUeRrc/Srb0/LteRlc/RxPDU", MakeCallback (&CountRxPdu));
+    }
+  for (uint32_t u = 0; u < devicePaths.size (); ++u)
+    {
+      Config::Disconnect (devicePaths[u] + "/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe", MakeCallback (&CountRxPacketTrace));
+      Config::Disconnect (devicePaths[u] + "/LteUeRrc/Srb0/LteRlc/TxPDU", MakeCallback (&CountPdu));
+      Config::Disconnect (devicePaths[u] + "/LteUeRrc/Srb0/LteRlc/RxPDU", MakeCallback (&CountRxPdu));
+    }
+  int64_t connectMs = clock.End ();
+  uint32_t numPaths = 3 * devicePaths.size ();
+
+  std::cout << "gNBs " << numEnb << " UEs " << numUe << " nodes " << NodeList::GetNNodes ()
+            << " traces " << (traces ? "on" : "off") << std::endl;
+  std::cout << "Install: " << installMs << " ms" << std::endl;
+  std::cout << "EnableTraces: " << tracesMs << " ms" << std::endl;
+  if (attach)
+    {
+      std::cout << "Simulation of the attach (" << simTime << " s): " << runMs << " ms" << std::endl;
+    }
+  else
+    {
+      std::cout << "Initialization: " << runMs << " ms" << std::endl;
+    }
+  std::cout << "Config::Connect/Disconnect of " << numPaths << " UE context paths: " << connectMs << " ms, "
+            << 1e3 * connectMs / (2 * numPaths) << " us per path" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -32,10 +32,14 @@
 
 #include "mmwave-bearer-stats-calculator.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 #include "ns3/nstime.h"
 #include <ns3/log.h>
+#include <ns3/abort.h>
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <cmath>
 
 namespace ns3 {
 
@@ -43,17 +47,61 @@ NS_LOG_COMPONENT_DEFINE ("MmWaveBearerStatsCalculator");
 
 NS_OBJECT_ENSURE_REGISTERED ( MmWaveBearerStatsCalculator);
 
+static const char g_epochStatsMagic[8] = {'M', 'M', 'W', 'B', 'E', 'A', 'R', 'S'};
+static const uint32_t g_epochStatsVersion = 1;
+static const uint32_t g_epochStatsByteOrder = 0x01020304;
+static const uint32_t g_epochStatsBufferSize = 1 << 20;
+
+/**
+ * Header of the binary epoch statistics files. It is followed by the
+ * description of each column (its type, 'u' for uint64_t or 'd' for double,
+ * the length of its name and the name) and then by the epoch blocks.
+ */
+struct MmWaveEpochStatsHeader
+{
+  char m_magic[8]; //!< "MMWBEARS"
+  uint32_t m_version; //!< version of the format
+  uint32_t m_byteOrder; //!< 0x01020304 in the byte order of the writer
+  uint32_t m_numColumns; //!< number of columns of each epoch block
+};
+
+/**
+ * Header of an epoch block, followed by each column in turn, with one
+ * 8 bytes value per row
+ */
+struct MmWaveEpochBlockHeader
+{
+  double m_start; //!< start of the epoch, in seconds
+  double m_end; //!< end of the epoch, in seconds
+  uint64_t m_numRows; //!< number of rows (bearers)
+};
+
+/// Columns of the epoch blocks, in the order of the legacy epoch statistics
+static const struct
+{
+  char type;
+  const char *name;
+} g_epochStatsColumns[] = {
+  {'u', "CellId"}, {'u', "IMSI"}, {'u', "RNTI"}, {'u', "LCID"},
+  {'u', "nTxPDUs"}, {'u', "TxBytes"}, {'u', "nRxPDUs"}, {'u', "RxBytes"},
+  {'d', "delay"}, {'d', "delayStdDev"}, {'d', "delayMin"}, {'d', "delayMax"},
+  {'d', "PduSize"}, {'d', "PduSizeStdDev"}, {'d', "PduSizeMin"}, {'d', "PduSizeMax"}
+};
+static const uint32_t g_epochStatsNumColumns = sizeof (g_epochStatsColumns) / sizeof (g_epochStatsColumns[0]);
+
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator ()
   : m_firstWrite (true),
     m_pendingOutput (false), 
-    m_protocolType ("RLC")
+    m_protocolType ("RLC"),
+    m_aggregationMode (false)
 {
   NS_LOG_FUNCTION (this);
 }
 
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator (std::string protocolType)
   : m_firstWrite (true),
-    m_pendingOutput (false)
+    m_pendingOutput (false),
+    m_aggregationMode (false)
 {
   NS_LOG_FUNCTION (this);
   m_protocolType = protocolType;
@@ -101,6 +149,16 @@ MmWaveBearerStatsCalculator::GetTypeId (void)
                    StringValue ("UlPdcpStats.txt"),
                    MakeStringAccessor (&MmWaveBearerStatsCalculator::SetUlPdcpOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("AggregationMode",
+                   "If true, the PDUs of each bearer are counted in dense per-bearer "
+                   "arrays, and at the end of each epoch the counters of all the bearers "
+                   "are appended to the output files as a binary columnar block "
+                   "(the .txt extension of the file names is replaced with .bin). "
+                   "The epochs without PDUs are not written. "
+                   "If false, a text line is written for each received PDU.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveBearerStatsCalculator::m_aggregationMode),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -109,7 +167,11 @@ void
 MmWaveBearerStatsCalculator::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_pendingOutput)
+  if (m_aggregationMode)
+    {
+      StopAggregation ();
+    }
+  else if (m_pendingOutput)
     {
       ShowResults ();
     }
@@ -688,6 +750,382 @@ MmWaveBearerStatsCalculator::GetDlPduSizeStats (uint64_t imsi, uint8_t lcid)
   return stats;
 }
 
+bool
+MmWaveBearerStatsCalculator::GetAggregationMode () const
+{
+  return m_aggregationMode;
+}
+
+uint32_t
+MmWaveBearerStatsCalculator::RegisterBearer (uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t lcid)
+{
+  NS_LOG_FUNCTION (this << cellId << imsi << rnti << (uint32_t) lcid);
+  NS_ASSERT_MSG (m_aggregationMode, "Bearers are registered only in the aggregation mode");
+
+  ImsiLcidPair_t p (imsi, lcid);
+  uint32_t bearer;
+  std::map<ImsiLcidPair_t, uint32_t>::iterator it = m_bearerIndex.find (p);
+  if (it == m_bearerIndex.end ())
+    {
+      if (m_bearerImsi.empty ())
+        {
+          StartAggregation ();
+        }
+      bearer = m_bearerImsi.size ();
+      m_bearerIndex[p] = bearer;
+      m_bearerCellId.push_back (cellId);
+      m_bearerImsi.push_back (imsi);
+      m_bearerRnti.push_back (rnti);
+      m_bearerLcid.push_back (lcid);
+      m_ulColumns.AddBearer ();
+      m_dlColumns.AddBearer ();
+    }
+  else
+    {
+      bearer = it->second;
+      m_bearerCellId[bearer] = cellId;
+      m_bearerRnti[bearer] = rnti;
+    }
+  return bearer;
+}
+
+void
+MmWaveBearerStatsCalculator::UlTxPdu (uint32_t bearer, uint32_t packetSize)
+{
+  NS_LOG_FUNCTION (this << bearer << packetSize);
+  NS_ASSERT (bearer < m_bearerImsi.size ());
+  if (Simulator::Now () >= m_startTime)
+    {
+      m_ulColumns.m_txPackets[bearer]++;
+      m_ulColumns.m_txBytes[bearer] += packetSize;
+      SetPendingAggregation ();
+    }
+}
+
+void
+MmWaveBearerStatsCalculator::UlRxPdu (uint32_t bearer, uint32_t packetSize, uint64_t delay)
+{
+  NS_LOG_FUNCTION (this << bearer << packetSize << delay);
+  NS_ASSERT (bearer < m_bearerImsi.size ());
+  if (Simulator::Now () >= m_startTime)
+    {
+      m_ulColumns.AddRxPdu (bearer, packetSize, delay);
+      SetPendingAggregation ();
+    }
+}
+
+void
+MmWaveBearerStatsCalculator::DlTxPdu (uint32_t bearer, uint32_t packetSize)
+{
+  NS_LOG_FUNCTION (this << bearer << packetSize);
+  NS_ASSERT (bearer < m_bearerImsi.size ());
+  if (Simulator::Now () >= m_startTime)
+    {
+      m_dlColumns.m_txPackets[bearer]++;
+      m_dlColumns.m_txBytes[bearer] += packetSize;
+      SetPendingAggregation ();
+    }
+}
+
+void
+MmWaveBearerStatsCalculator::DlRxPdu (uint32_t bearer, uint32_t packetSize, uint64_t delay)
+{
+  NS_LOG_FUNCTION (this << bearer << packetSize << delay);
+  NS_ASSERT (bearer < m_bearerImsi.size ());
+  if (Simulator::Now () >= m_startTime)
+    {
+      m_dlColumns.AddRxPdu (bearer, packetSize, delay);
+      SetPendingAggregation ();
+    }
+}
+
+void
+MmWaveBearerStatsCalculator::EpochColumns::AddBearer ()
+{
+  m_txPackets.push_back (0);
+  m_txBytes.push_back (0);
+  m_rxPackets.push_back (0);
+  m_rxBytes.push_back (0);
+  m_delayMean.push_back (0);
+  m_delayS.push_back (0);
+  m_delayMin.push_back (0);
+  m_delayMax.push_back (0);
+  m_sizeMean.push_back (0);
+  m_sizeS.push_back (0);
+  m_sizeMin.push_back (0);
+  m_sizeMax.push_back (0);
+}
+
+void
+MmWaveBearerStatsCalculator::EpochColumns::AddRxPdu (uint32_t bearer, uint32_t packetSize, uint64_t delay)
+{
+  uint64_t count = ++m_rxPackets[bearer];
+  m_rxBytes[bearer] += packetSize;
+  double d = delay;
+  double size = packetSize;
+  if (count == 1)
+    {
+      m_delayMean[bearer] = d;
+      m_delayS[bearer] = 0;
+      m_delayMin[bearer] = d;
+      m_delayMax[bearer] = d;
+      m_sizeMean[bearer] = size;
+      m_sizeS[bearer] = 0;
+      m_sizeMin[bearer] = size;
+      m_sizeMax[bearer] = size;
+      return;
+    }
+  // same running mean and variance of MinMaxAvgTotalCalculator
+  double prevMean = m_delayMean[bearer];
+  m_delayMean[bearer] = prevMean + (d - prevMean) / count;
+  m_delayS[bearer] += (d - prevMean) * (d - m_delayMean[bearer]);
+  m_delayMin[bearer] = std::min (m_delayMin[bearer], d);
+  m_delayMax[bearer] = std::max (m_delayMax[bearer], d);
+  prevMean = m_sizeMean[bearer];
+  m_sizeMean[bearer] = prevMean + (size - prevMean) / count;
+  m_sizeS[bearer] += (size - prevMean) * (size - m_sizeMean[bearer]);
+  m_sizeMin[bearer] = std::min (m_sizeMin[bearer], size);
+  m_sizeMax[bearer] = std::max (m_sizeMax[bearer], size);
+}
+
+void
+MmWaveBearerStatsCalculator::EpochColumns::Reset ()
+{
+  std::fill (m_txPackets.begin (), m_txPackets.end (), 0);
+  std::fill (m_txBytes.begin (), m_txBytes.end (), 0);
+  std::fill (m_rxPackets.begin (), m_rxPackets.end (), 0);
+  std::fill (m_rxBytes.begin (), m_rxBytes.end (), 0);
+  // the statistics are reinitialized by the first PDU of the next epoch
+}
+
+std::string
+MmWaveBearerStatsCalculator::GetBinaryFilename (std::string filename)
+{
+  std::string extension = ".txt";
+  if (filename.size () >= extension.size ()
+      && filename.compare (filename.size () - extension.size (), extension.size (), extension) == 0)
+    {
+      filename.erase (filename.size () - extension.size ());
+    }
+  return filename + ".bin";
+}
+
+void
+MmWaveBearerStatsCalculator::StartAggregation ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_epochDuration <= Seconds (0), "The aggregation mode needs a positive EpochDuration");
+
+  MmWaveEpochStatsHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.m_magic, g_epochStatsMagic, sizeof (g_epochStatsMagic));
+  header.m_version = g_epochStatsVersion;
+  header.m_byteOrder = g_epochStatsByteOrder;
+  header.m_numColumns = g_epochStatsNumColumns;
+  std::string columns;
+  for (uint32_t i = 0; i < g_epochStatsNumColumns; i++)
+    {
+      columns += g_epochStatsColumns[i].type;
+      columns += (char) std::strlen (g_epochStatsColumns[i].name);
+      columns += g_epochStatsColumns[i].name;
+    }
+
+  m_ulColumns.m_writer = Create<MmWaveTraceWriter> (GetBinaryFilename (GetUlOutputFilename ()), g_epochStatsBufferSize);
+  m_dlColumns.m_writer = Create<MmWaveTraceWriter> (GetBinaryFilename (GetDlOutputFilename ()), g_epochStatsBufferSize);
+  m_ulColumns.m_writer->Write (&header, sizeof (header));
+  m_ulColumns.m_writer->Write (columns.data (), columns.size ());
+  m_dlColumns.m_writer->Write (&header, sizeof (header));
+  m_dlColumns.m_writer->Write (columns.data (), columns.size ());
+
+  ScheduleEndAggregationEpoch ();
+  Simulator::ScheduleDestroy (&MmWaveBearerStatsCalculator::StopAggregation, Ptr<MmWaveBearerStatsCalculator> (this));
+}
+
+void
+MmWaveBearerStatsCalculator::ScheduleEndAggregationEpoch ()
+{
+  NS_LOG_FUNCTION (this);
+  while (m_startTime + m_epochDuration <= Simulator::Now ())
+    {
+      m_startTime += m_epochDuration;
+    }
+  m_endEpochEvent = Simulator::Schedule (m_startTime + m_epochDuration - Simulator::Now (),
+                                         &MmWaveBearerStatsCalculator::EndAggregationEpoch, this);
+}
+
+void
+MmWaveBearerStatsCalculator::SetPendingAggregation ()
+{
+  if (!m_pendingOutput)
+    {
+      m_pendingOutput = true;
+      if (!m_endEpochEvent.IsRunning ())
+        {
+          ScheduleEndAggregationEpoch ();
+        }
+    }
+}
+
+void
+MmWaveBearerStatsCalculator::WriteEpochBlock (EpochColumns &columns)
+{
+  NS_LOG_FUNCTION (this);
+  MmWaveEpochBlockHeader block;
+  block.m_start = m_startTime.GetNanoSeconds () / 1.0e9;
+  block.m_end = (m_startTime + m_epochDuration).GetNanoSeconds () / 1.0e9;
+  block.m_numRows = m_bearerImsi.size ();
+  Ptr<MmWaveTraceWriter> writer = columns.m_writer;
+  writer->Write (&block, sizeof (block));
+
+  uint32_t numBearers = m_bearerImsi.size ();
+  uint32_t columnSize = numBearers * sizeof (uint64_t);
+  writer->Write (&m_bearerCellId[0], columnSize);
+  writer->Write (&m_bearerImsi[0], columnSize);
+  writer->Write (&m_bearerRnti[0], columnSize);
+  writer->Write (&m_bearerLcid[0], columnSize);
+  writer->Write (&columns.m_txPackets[0], columnSize);
+  writer->Write (&columns.m_txBytes[0], columnSize);
+  writer->Write (&columns.m_rxPackets[0], columnSize);
+  writer->Write (&columns.m_rxBytes[0], columnSize);
+
+  // the statistics of the bearers without PDUs in the epoch are zero
+  const std::vector<uint64_t> &count = columns.m_rxPackets;
+  const std::vector<double> *means[2] = {&columns.m_delayMean, &columns.m_sizeMean};
+  const std::vector<double> *s[2] = {&columns.m_delayS, &columns.m_sizeS};
+  const std::vector<double> *mins[2] = {&columns.m_delayMin, &columns.m_sizeMin};
+  const std::vector<double> *maxs[2] = {&columns.m_delayMax, &columns.m_sizeMax};
+  double scales[2] = {1e-9, 1}; // the delay is written in seconds
+  m_epochColumn.resize (numBearers);
+  for (uint32_t stat = 0; stat < 2; stat++)
+    {
+      for (uint32_t i = 0; i < numBearers; i++)
+        {
+          m_epochColumn[i] = count[i] > 0 ? (*means[stat])[i] * scales[stat] : 0;
+        }
+      writer->Write (&m_epochColumn[0], columnSize);
+      for (uint32_t i = 0; i < numBearers; i++)
+        {
+          m_epochColumn[i] = count[i] > 1 ? std::sqrt ((*s[stat])[i] / (count[i] - 1)) * scales[stat] : 0;
+        }
+      writer->Write (&m_epochColumn[0], columnSize);
+      for (uint32_t i = 0; i < numBearers; i++)
+        {
+          m_epochColumn[i] = count[i] > 0 ? (*mins[stat])[i] * scales[stat] : 0;
+        }
+      writer->Write (&m_epochColumn[0], columnSize);
+      for (uint32_t i = 0; i < numBearers; i++)
+        {
+          m_epochColumn[i] = count[i] > 0 ? (*maxs[stat])[i] * scales[stat] : 0;
+        }
+      writer->Write (&m_epochColumn[0], columnSize);
+    }
+}
+
+void
+MmWaveBearerStatsCalculator::EndAggregationEpoch ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_pendingOutput)
+    {
+      // the next PDU schedules the end of its epoch
+      return;
+    }
+  WriteEpochBlock (m_ulColumns);
+  WriteEpochBlock (m_dlColumns);
+  m_ulColumns.Reset ();
+  m_dlColumns.Reset ();
+  m_pendingOutput = false;
+  m_startTime += m_epochDuration;
+  m_endEpochEvent = Simulator::Schedule (m_epochDuration, &MmWaveBearerStatsCalculator::EndAggregationEpoch, this);
+}
+
+void
+MmWaveBearerStatsCalculator::StopAggregation ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_dlColumns.m_writer == 0)
+    {
+      return;
+    }
+  m_endEpochEvent.Cancel ();
+  if (m_pendingOutput)
+    {
+      WriteEpochBlock (m_ulColumns);
+      WriteEpochBlock (m_dlColumns);
+      m_pendingOutput = false;
+    }
+  m_ulColumns.m_writer->Close ();
+  m_dlColumns.m_writer->Close ();
+  m_ulColumns.m_writer = 0;
+  m_dlColumns.m_writer = 0;
+}
+
+uint64_t
+MmWaveBearerStatsCalculator::ConvertEpochStats (std::string binaryFilename, std::string textFilename)
+{
+  NS_LOG_FUNCTION (binaryFilename << textFilename);
+  std::ifstream binaryFile (binaryFilename.c_str (), std::ifstream::in | std::ifstream::binary);
+  NS_ABORT_MSG_IF (!binaryFile.good (), "Stats file " << binaryFilename << " not found");
+  MmWaveEpochStatsHeader header;
+  binaryFile.read (reinterpret_cast<char*> (&header), sizeof (header));
+  NS_ABORT_MSG_IF (!binaryFile.good () || std::memcmp (header.m_magic, g_epochStatsMagic, sizeof (g_epochStatsMagic)) != 0,
+                   "Stats file " << binaryFilename << " is not a binary epoch statistics file");
+  NS_ABORT_MSG_IF (header.m_byteOrder != g_epochStatsByteOrder, "Stats file " << binaryFilename << " written with a different byte order");
+  NS_ABORT_MSG_IF (header.m_version != g_epochStatsVersion,
+                   "Stats file " << binaryFilename << " has version " << header.m_version << ", expected " << g_epochStatsVersion);
+
+  std::ofstream textFile (textFilename.c_str (), std::ofstream::out | std::ofstream::trunc);
+  NS_ABORT_MSG_IF (!textFile.good (), "Cannot open " << textFilename);
+  std::vector<char> types (header.m_numColumns);
+  textFile << "% start\tend";
+  for (uint32_t i = 0; i < header.m_numColumns; i++)
+    {
+      uint8_t nameLength = 0;
+      binaryFile.read (&types[i], 1);
+      binaryFile.read (reinterpret_cast<char*> (&nameLength), 1);
+      std::string name (nameLength, ' ');
+      binaryFile.read (&name[0], nameLength);
+      NS_ABORT_MSG_IF (!binaryFile.good () || (types[i] != 'u' && types[i] != 'd'),
+                       "Stats file " << binaryFilename << " has a corrupted header");
+      textFile << "\t" << name;
+    }
+  textFile << "\n";
+
+  uint64_t numRows = 0;
+  MmWaveEpochBlockHeader block;
+  std::vector<uint64_t> values;
+  while (binaryFile.read (reinterpret_cast<char*> (&block), sizeof (block)))
+    {
+      values.resize (block.m_numRows * header.m_numColumns);
+      binaryFile.read (reinterpret_cast<char*> (values.data ()), values.size () * sizeof (uint64_t));
+      NS_ABORT_MSG_IF (!binaryFile.good (), "Stats file " << binaryFilename << " is truncated");
+      for (uint64_t row = 0; row < block.m_numRows; row++)
+        {
+          textFile << block.m_start << "\t" << block.m_end << "\t";
+          for (uint32_t column = 0; column < header.m_numColumns; column++)
+            {
+              uint64_t value = values[column * block.m_numRows + row];
+              if (types[column] == 'u')
+                {
+                  textFile << value << "\t";
+                }
+              else
+                {
+                  double d;
+                  std::memcpy (&d, &value, sizeof (d));
+                  textFile << d << "\t";
+                }
+            }
+          textFile << "\n";
+        }
+      numRows += block.m_numRows;
+    }
+  NS_ABORT_MSG_IF (binaryFile.gcount () != 0, "Stats file " << binaryFilename << " is truncated");
+  textFile.close ();
+  NS_ABORT_MSG_IF (textFile.fail (), "Cannot write " << textFilename);
+  return numRows;
+}
+
 std::string
 MmWaveBearerStatsCalculator::GetUlOutputFilename (void)
 {
@@ -35,6 +35,7 @@
 #include "ns3/object.h"
 #include "ns3/basic-data-calculators.h"
 #include "ns3/lte-common.h"
+#include "ns3/mmwave-trace-writer.h"
 #include <string>
 #include <map>
 #include <fstream>
@@ -354,7 +355,161 @@ public:
   std::vector<double>
   GetDlPduSizeStats (uint64_t imsi, uint8_t lcid);
 
+  /**
+   * @returns true if the PDUs are aggregated per bearer and epoch
+   * (AggregationMode attribute), false if a line is written for each PDU
+   */
+  bool GetAggregationMode () const;
+
+  /**
+   * Assign the dense index of a bearer in the aggregation mode, to be
+   * done once, e.g., with its first PDU. The same (IMSI, LCID)
+   * pair always gets the same index, and the cellId and RNTI of the last
+   * registration.
+   * @param cellId CellId of the attached Enb
+   * @param imsi IMSI of the UE
+   * @param rnti C-RNTI of the UE
+   * @param lcid LCID of the bearer
+   * @return the index of the bearer, to notify its PDUs with
+   */
+  uint32_t
+  RegisterBearer (uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t lcid);
+
+  /**
+   * Notifies an uplink transmission of a registered bearer, in the
+   * aggregation mode.
+   * @param bearer index of the bearer, returned by RegisterBearer
+   * @param packetSize size of the PDU in bytes
+   */
+  void
+  UlTxPdu (uint32_t bearer, uint32_t packetSize);
+
+  /**
+   * Notifies an uplink reception of a registered bearer, in the
+   * aggregation mode.
+   * @param bearer index of the bearer, returned by RegisterBearer
+   * @param packetSize size of the PDU in bytes
+   * @param delay RLC to RLC delay in nanoseconds
+   */
+  void
+  UlRxPdu (uint32_t bearer, uint32_t packetSize, uint64_t delay);
+
+  /**
+   * Notifies a downlink transmission of a registered bearer, in the
+   * aggregation mode.
+   * @param bearer index of the bearer, returned by RegisterBearer
+   * @param packetSize size of the PDU in bytes
+   */
+  void
+  DlTxPdu (uint32_t bearer, uint32_t packetSize);
+
+  /**
+   * Notifies a downlink reception of a registered bearer, in the
+   * aggregation mode.
+   * @param bearer index of the bearer, returned by RegisterBearer
+   * @param packetSize size of the PDU in bytes
+   * @param delay RLC to RLC delay in nanoseconds
+   */
+  void
+  DlRxPdu (uint32_t bearer, uint32_t packetSize, uint64_t delay);
+
+  /**
+   * Convert the binary epoch statistics of the aggregation mode to tab
+   * separated text, with a row for each bearer and epoch and the columns
+   * of the legacy epoch statistics.
+   * @param binaryFilename the binary file
+   * @param textFilename the text file to write
+   * @return the number of rows
+   */
+  static uint64_t
+  ConvertEpochStats (std::string binaryFilename, std::string textFilename);
+
 private:
+  /**
+   * Counters of all the registered bearers in one direction, in the
+   * aggregation mode. Each vector has an entry per bearer, and each is
+   * written as a column of the epoch block.
+   */
+  struct EpochColumns
+  {
+    std::vector<uint64_t> m_txPackets; //!< number of TX PDUs
+    std::vector<uint64_t> m_txBytes; //!< TX bytes
+    std::vector<uint64_t> m_rxPackets; //!< number of RX PDUs
+    std::vector<uint64_t> m_rxBytes; //!< RX bytes
+    std::vector<double> m_delayMean; //!< mean delay, in ns
+    std::vector<double> m_delayS; //!< sum of the squared deviations of the delay
+    std::vector<double> m_delayMin; //!< min delay, in ns
+    std::vector<double> m_delayMax; //!< max delay, in ns
+    std::vector<double> m_sizeMean; //!< mean PDU size
+    std::vector<double> m_sizeS; //!< sum of the squared deviations of the PDU size
+    std::vector<double> m_sizeMin; //!< min PDU size
+    std::vector<double> m_sizeMax; //!< max PDU size
+    Ptr<MmWaveTraceWriter> m_writer; //!< output file
+
+    /**
+     * Add the entry of a new bearer
+     */
+    void AddBearer ();
+
+    /**
+     * Count a received PDU, updating the statistics like
+     * MinMaxAvgTotalCalculator
+     * @param bearer index of the bearer
+     * @param packetSize size of the PDU in bytes
+     * @param delay delay of the PDU in nanoseconds
+     */
+    void AddRxPdu (uint32_t bearer, uint32_t packetSize, uint64_t delay);
+
+    /**
+     * Zero all the counters
+     */
+    void Reset ();
+  };
+
+  /**
+   * Open the binary files of the aggregation mode and schedule the end
+   * of the first epoch
+   */
+  void StartAggregation ();
+
+  /**
+   * Write the epoch block of one direction
+   * @param columns the counters of the direction
+   */
+  void WriteEpochBlock (EpochColumns &columns);
+
+  /**
+   * Schedule the end of the epoch on going in the aggregation mode, or of
+   * the first one after StartTime
+   */
+  void ScheduleEndAggregationEpoch ();
+
+  /**
+   * Note that the epoch on going has a PDU, and schedule its end if the
+   * epochs were stopped by one without PDUs
+   */
+  void SetPendingAggregation ();
+
+  /**
+   * End of an epoch in the aggregation mode: write the counters as epoch
+   * blocks, zero them and schedule the end of the next epoch. An epoch
+   * without PDUs is not written and stops the epochs until the next PDU,
+   * thus the end of the epochs does not keep the simulation running
+   */
+  void EndAggregationEpoch ();
+
+  /**
+   * Write the last (partial) epoch and close the files of the aggregation
+   * mode
+   */
+  void StopAggregation ();
+
+  /**
+   * @param filename the name of the text output file
+   * @return the name of the binary file of the aggregation mode
+   */
+  static std::string GetBinaryFilename (std::string filename);
+
   /**
    * Called after each epoch to write collected
    * statistics to output files. During first call
@@ -456,6 +611,21 @@ private:
 
   std::ofstream m_dlOutFile;
   std::ofstream m_ulOutFile;
+
+  /**
+   * true to aggregate the PDUs per bearer and epoch, see the
+   * AggregationMode attribute
+   */
+  bool m_aggregationMode;
+
+  std::map<ImsiLcidPair_t, uint32_t> m_bearerIndex; //!< index of the registered bearers, by (IMSI, LCID) pair
+  std::vector<uint64_t> m_bearerCellId; //!< CellId of each registered bearer
+  std::vector<uint64_t> m_bearerImsi; //!< IMSI of each registered bearer
+  std::vector<uint64_t> m_bearerRnti; //!< RNTI of each registered bearer
+  std::vector<uint64_t> m_bearerLcid; //!< LCID of each registered bearer
+  EpochColumns m_ulColumns; //!< UL counters of the registered bearers
+  EpochColumns m_dlColumns; //!< DL counters of the registered bearers
+  std::vector<double> m_epochColumn; //!< scratch column for the derived statistics
 };
 
 } // namespace ns3
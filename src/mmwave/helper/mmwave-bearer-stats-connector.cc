@@ -98,8 +98,34 @@ public:
   Ptr<MmWaveBearerStatsCalculator> stats;  //!< statistics calculator
   uint64_t imsi; //!< imsi
   uint16_t cellId; //!< cellId
+  std::vector<uint32_t> bearers; //!< index of the bearer of each LCID in the aggregation mode, once registered
 };
 
+/// Entry of MmWaveBoundCallbackArgument::bearers of the LCIDs not registered yet
+static const uint32_t NO_BEARER = 0xFFFFFFFF;
+
+/**
+ * Get the index of a bearer in the aggregation mode of the calculator,
+ * registering it with the first PDU of its LCID on this connection
+ * /param arg
+ * /param rnti
+ * /param lcid
+ * /return the index of the bearer
+ */
+static uint32_t
+GetBearerIndex (Ptr<MmWaveBoundCallbackArgument> arg, uint16_t rnti, uint8_t lcid)
+{
+  if (lcid >= arg->bearers.size ())
+    {
+      arg->bearers.resize (lcid + 1, NO_BEARER);
+    }
+  if (arg->bearers[lcid] == NO_BEARER)
+    {
+      arg->bearers[lcid] = arg->stats->RegisterBearer (arg->cellId, arg->imsi, rnti, lcid);
+    }
+  return arg->bearers[lcid];
+}
+
 struct McMmWaveBoundCallbackArgument : public SimpleRefCount<McMmWaveBoundCallbackArgument>
 {
 public:
@@ -119,6 +145,11 @@ DlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
                  uint16_t rnti, uint8_t lcid, uint32_t packetSize)
 {
   NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize);
+  if (arg->stats->GetAggregationMode ())
+    {
+      arg->stats->DlTxPdu (GetBearerIndex (arg, rnti, lcid), packetSize);
+      return;
+    }
   arg->stats->DlTxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize);
 }
 
@@ -136,6 +167,11 @@ DlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
                  uint16_t rnti, uint8_t lcid, uint32_t packetSize, uint64_t delay)
 {
   NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize << delay);
+  if (arg->stats->GetAggregationMode ())
+    {
+      arg->stats->DlRxPdu (GetBearerIndex (arg, rnti, lcid), packetSize, delay);
+      return;
+    }
   arg->stats->DlRxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize, delay);
 }
 
@@ -153,6 +189,11 @@ UlTxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
 {
   NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize);
  
+  if (arg->stats->GetAggregationMode ())
+    {
+      arg->stats->UlTxPdu (GetBearerIndex (arg, rnti, lcid), packetSize);
+      return;
+    }
   arg->stats->UlTxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize);
 }
 
@@ -171,6 +212,11 @@ UlRxPduCallback (Ptr<MmWaveBoundCallbackArgument> arg, std::string path,
 {
   NS_LOG_FUNCTION (path << rnti << (uint16_t)lcid << packetSize << delay);
  
+  if (arg->stats->GetAggregationMode ())
+    {
+      arg->stats->UlRxPdu (GetBearerIndex (arg, rnti, lcid), packetSize, delay);
+      return;
+    }
   arg->stats->UlRxPdu (arg->cellId, arg->imsi, rnti, lcid, packetSize, delay);
 }
 
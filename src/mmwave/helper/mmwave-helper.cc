@@ -118,6 +118,13 @@ MmWaveHelper::GetTypeId (void)
 					   StringValue ("ns3::MmWave3gppChannel"),
 					   MakeStringAccessor (&MmWaveHelper::SetChannelModelType),
 					   MakeStringChecker ())
+		.AddAttribute ("SpectrumChannel",
+					   "The type of spectrum channel shared by the mmWave devices. "
+					   "ns3::MmWaveSpectrumChannel skips the propagation of the signals "
+					   "which the receivers would discard.",
+					   StringValue ("ns3::MultiModelSpectrumChannel"),
+					   MakeStringAccessor (&MmWaveHelper::SetSpectrumChannelType),
+					   MakeStringChecker ())
 		.AddAttribute ("Scheduler",
 				      "The type of scheduler to be used for MmWave eNBs. "
 				      "The allowed values for this attributes are the type names "
@@ -370,6 +377,14 @@ MmWaveHelper::SetChannelModelType (std::string type)
 	m_channelModelType = type;
 }
 
+void
+MmWaveHelper::SetSpectrumChannelType (std::string type)
+{
+	NS_LOG_FUNCTION (this << type);
+	m_channelFactory = ObjectFactory ();
+	m_channelFactory.SetTypeId (type);
+}
+
 void
 MmWaveHelper::SetSchedulerType (std::string type)
 {
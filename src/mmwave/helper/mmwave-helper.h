@@ -112,6 +112,7 @@ public:
 	void SetAntenna (uint16_t Nrx, uint16_t Ntx);
 	void SetPathlossModelType (std::string type);
 	void SetChannelModelType (std::string type);
+	void SetSpectrumChannelType (std::string type);
 	void SetLtePathlossModelType (std::string type);
 	/**
 	 * Attach mmWave-only ueDevices to the closest enbDevice
@@ -34,7 +34,12 @@
 #include <ns3/log.h>
 #include "mmwave-phy-rx-trace.h"
 #include <ns3/simulator.h>
+#include <ns3/enum.h>
+#include <ns3/string.h>
+#include <ns3/abort.h>
 #include <stdio.h>
+#include <cstring>
+#include <cmath>
 
 namespace ns3 {
 
@@ -42,19 +47,36 @@ NS_LOG_COMPONENT_DEFINE ("MmWavePhyRxTrace");
 
 NS_OBJECT_ENSURE_REGISTERED (MmWavePhyRxTrace);
 
-std::ofstream MmWavePhyRxTrace::m_rxPacketTraceFile;
-std::string MmWavePhyRxTrace::m_rxPacketTraceFilename;
+Ptr<MmWaveTraceWriter> MmWavePhyRxTrace::m_rxPacketTraceWriter;
+bool MmWavePhyRxTrace::m_rxPacketTraceBinary = false;
+std::ostringstream MmWavePhyRxTrace::m_rxPacketTraceLine;
+std::set<std::string> MmWavePhyRxTrace::m_rxPacketTraceFilenames;
+
+static const char g_rxPacketTraceMagic[8] = {'M', 'M', 'W', 'R', 'X', 'P', 'K', 'T'};
+static const uint32_t g_rxPacketTraceVersion = 1;
+static const uint32_t g_rxPacketTraceByteOrder = 0x01020304;
+static const uint32_t g_rxPacketTraceBufferSize = 4 << 20;
+static const std::string g_rxPacketTraceColumns = "\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler\n";
+
+/**
+ * Header of the binary RxPacketTrace files, followed by the records
+ */
+struct MmWaveRxPacketTraceHeader
+{
+	char m_magic[8];
+	uint32_t m_version;
+	uint32_t m_byteOrder;
+	uint32_t m_recordSize;
+	uint32_t m_reserved;
+};
 
 MmWavePhyRxTrace::MmWavePhyRxTrace()
+	: m_outputFormat (TEXT)
 {
 }
 
 MmWavePhyRxTrace::~MmWavePhyRxTrace()
 {
-	if (m_rxPacketTraceFile.is_open ())
-	{
-		m_rxPacketTraceFile.close ();
-	}
 }
 
 TypeId
@@ -63,6 +85,19 @@ MmWavePhyRxTrace::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::MmWavePhyRxTrace")
     .SetParent<Object> ()
     .AddConstructor<MmWavePhyRxTrace> ()
+    .AddAttribute ("OutputFormat",
+                   "Format of the RxPacketTrace file: a tab separated line per TB, or a fixed size "
+                   "binary record per TB, which mmwave-rx-packet-trace-converter turns into the text lines",
+                   EnumValue (MmWavePhyRxTrace::TEXT),
+                   MakeEnumAccessor (&MmWavePhyRxTrace::m_outputFormat),
+                   MakeEnumChecker (MmWavePhyRxTrace::TEXT, "Text",
+                                    MmWavePhyRxTrace::BINARY, "Binary"))
+    .AddAttribute ("OutputFilename",
+                   "Name of the RxPacketTrace file. If empty, RxPacketTrace.txt or RxPacketTrace.bin, "
+                   "depending on OutputFormat",
+                   StringValue (""),
+                   MakeStringAccessor (&MmWavePhyRxTrace::m_outputFilename),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -178,21 +213,123 @@ MmWavePhyRxTrace::ReportDLTbSize (uint64_t imsi, uint64_t tbSize)
 }
 */
 void
-MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
+MmWavePhyRxTrace::WriteRxPacketTrace (Ptr<MmWavePhyRxTrace> phyStats, const RxPacketTraceParams &params, bool downlink)
+{
+	MmWaveRxPacketTraceRecord record;
+	std::memset (&record, 0, sizeof (record));
+	record.m_cellId = params.m_cellId;
+	record.m_sinr = params.m_sinr;
+	record.m_tbler = params.m_tbler;
+	record.m_frameNum = params.m_frameNum;
+	record.m_tbSize = params.m_tbSize;
+	record.m_rnti = params.m_rnti;
+	record.m_downlink = downlink;
+	record.m_sfNum = params.m_sfNum;
+	record.m_slotNum = params.m_slotNum;
+	record.m_symStart = params.m_symStart;
+	record.m_numSym = params.m_numSym;
+	record.m_mcs = params.m_mcs;
+	record.m_rv = params.m_rv;
+	record.m_corrupt = params.m_corrupt;
+
+	if (m_rxPacketTraceWriter == 0)
+	{
+		m_rxPacketTraceBinary = (phyStats->m_outputFormat == BINARY);
+		std::string filename = phyStats->m_outputFilename;
+		if (filename.empty ())
+		{
+			filename = m_rxPacketTraceBinary ? "RxPacketTrace.bin" : "RxPacketTrace.txt";
+		}
+		// the file is truncated only by the first simulation which writes it
+		bool reopened = !m_rxPacketTraceFilenames.insert (filename).second;
+		m_rxPacketTraceWriter = Create<MmWaveTraceWriter> (filename, g_rxPacketTraceBufferSize, reopened);
+		Simulator::ScheduleDestroy (&MmWavePhyRxTrace::CloseRxPacketTraceFile);
+		if (!reopened && m_rxPacketTraceBinary)
+		{
+			MmWaveRxPacketTraceHeader header;
+			std::memset (&header, 0, sizeof (header));
+			std::memcpy (header.m_magic, g_rxPacketTraceMagic, sizeof (g_rxPacketTraceMagic));
+			header.m_version = g_rxPacketTraceVersion;
+			header.m_byteOrder = g_rxPacketTraceByteOrder;
+			header.m_recordSize = sizeof (MmWaveRxPacketTraceRecord);
+			m_rxPacketTraceWriter->Write (&header, sizeof (header));
+		}
+		else if (!reopened && !downlink)
+		{
+			m_rxPacketTraceWriter->Write (g_rxPacketTraceColumns.data (), g_rxPacketTraceColumns.size ());
+		}
+	}
+
+	if (m_rxPacketTraceBinary)
+	{
+		m_rxPacketTraceWriter->Write (&record, sizeof (record));
+	}
+	else
+	{
+		m_rxPacketTraceLine.str ("");
+		PrintRxPacketTraceRecord (m_rxPacketTraceLine, record);
+		const std::string &line = m_rxPacketTraceLine.str ();
+		m_rxPacketTraceWriter->Write (line.data (), line.size ());
+	}
+}
+
+void
+MmWavePhyRxTrace::CloseRxPacketTraceFile ()
 {
-	if (!m_rxPacketTraceFile.is_open())
+	if (m_rxPacketTraceWriter != 0)
 	{
-		m_rxPacketTraceFilename = "RxPacketTrace.txt";
-		m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str ());
-		if (!m_rxPacketTraceFile.is_open())
+		m_rxPacketTraceWriter->Close ();
+		m_rxPacketTraceWriter = 0;
+	}
+}
+
+void
+MmWavePhyRxTrace::PrintRxPacketTraceRecord (std::ostream &os, const MmWaveRxPacketTraceRecord &record)
+{
+	os << (record.m_downlink ? "DL\t" : "UL\t") << record.m_frameNum << "\t" << (unsigned)record.m_sfNum << "\t" << (unsigned)record.m_symStart
+			<< "\t" << (unsigned)record.m_numSym << "\t" << record.m_cellId
+			<< "\t" << record.m_rnti << "\t" << record.m_tbSize << "\t" << (unsigned)record.m_mcs << "\t" << (unsigned)record.m_rv << "\t"
+			<< 10*std::log10(record.m_sinr) << (record.m_downlink ? "\t \t" : " \t") << (unsigned)record.m_corrupt << "\t" << record.m_tbler << "\n";
+}
+
+uint64_t
+MmWavePhyRxTrace::ConvertRxPacketTrace (std::string binaryFilename, std::string textFilename)
+{
+	NS_LOG_FUNCTION (binaryFilename << textFilename);
+	std::ifstream binaryFile (binaryFilename.c_str (), std::ifstream::in | std::ifstream::binary);
+	NS_ABORT_MSG_IF (!binaryFile.good (), "Trace file " << binaryFilename << " not found");
+	MmWaveRxPacketTraceHeader header;
+	binaryFile.read (reinterpret_cast<char*> (&header), sizeof (header));
+	NS_ABORT_MSG_IF (!binaryFile.good () || std::memcmp (header.m_magic, g_rxPacketTraceMagic, sizeof (g_rxPacketTraceMagic)) != 0,
+			"Trace file " << binaryFilename << " is not a binary RxPacketTrace file");
+	NS_ABORT_MSG_IF (header.m_byteOrder != g_rxPacketTraceByteOrder, "Trace file " << binaryFilename << " written with a different byte order");
+	NS_ABORT_MSG_IF (header.m_version != g_rxPacketTraceVersion || header.m_recordSize != sizeof (MmWaveRxPacketTraceRecord),
+			"Trace file " << binaryFilename << " has version " << header.m_version << ", expected " << g_rxPacketTraceVersion);
+
+	std::ofstream textFile (textFilename.c_str (), std::ofstream::out | std::ofstream::trunc);
+	NS_ABORT_MSG_IF (!textFile.good (), "Cannot open " << textFilename);
+	uint64_t numRecords = 0;
+	MmWaveRxPacketTraceRecord record;
+	while (binaryFile.read (reinterpret_cast<char*> (&record), sizeof (record)))
+	{
+		// the text file has the column names if it was opened by an UL TB
+		if (numRecords == 0 && !record.m_downlink)
 		{
-			NS_FATAL_ERROR ("Could not open tracefile");
+			textFile << g_rxPacketTraceColumns;
 		}
+		PrintRxPacketTraceRecord (textFile, record);
+		numRecords++;
 	}
-	m_rxPacketTraceFile << "DL\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
-			<< "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
-			<< "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-			<< 10*std::log10(params.m_sinr) << "\t" << " \t" << params.m_corrupt << "\t" <<  params.m_tbler << std::endl;
+	NS_ABORT_MSG_IF (binaryFile.gcount () != 0, "Trace file " << binaryFilename << " is truncated");
+	textFile.close ();
+	NS_ABORT_MSG_IF (textFile.fail (), "Cannot write " << textFilename);
+	return numRecords;
+}
+
+void
+MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
+{
+	WriteRxPacketTrace (phyStats, params, true);
 
 	if (params.m_corrupt)
 	{
@@ -205,20 +342,7 @@ MmWavePhyRxTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::
 void
 MmWavePhyRxTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
 {
-	if (!m_rxPacketTraceFile.is_open())
-	{
-		m_rxPacketTraceFilename = "RxPacketTrace.txt";
-		m_rxPacketTraceFile.open(m_rxPacketTraceFilename.c_str ());
-		m_rxPacketTraceFile << "\tframe\tsubF\t1stSym\tsymbol#\tcellId\trnti\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler" << std::endl;
-		if (!m_rxPacketTraceFile.is_open())
-		{
-			NS_FATAL_ERROR ("Could not open tracefile");
-		}
-	}
-	m_rxPacketTraceFile << "UL\t" << params.m_frameNum << "\t" << (unsigned)params.m_sfNum << "\t" << (unsigned)params.m_symStart
-				<< "\t" << (unsigned)params.m_numSym << "\t" << params.m_cellId
-				<< "\t" << params.m_rnti << "\t" << params.m_tbSize << "\t" << (unsigned)params.m_mcs << "\t" << (unsigned)params.m_rv << "\t"
-				<< 10*std::log10(params.m_sinr) << " \t" << params.m_corrupt << "\t" << params.m_tbler << std::endl;
+	WriteRxPacketTrace (phyStats, params, false);
 
 		if (params.m_corrupt)
 		{
@@ -31,14 +31,49 @@
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include "mmwave-trace-writer.h"
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <set>
 
 namespace ns3 {
 
+/**
+ * Record of a TB in the binary RxPacketTrace file, with the fields of a line
+ * of the text file. The SINR is linear, it is converted to dB by the converter
+ */
+struct MmWaveRxPacketTraceRecord
+{
+	uint64_t m_cellId;
+	double m_sinr;
+	double m_tbler;
+	uint32_t m_frameNum;
+	uint32_t m_tbSize;
+	uint16_t m_rnti;
+	uint8_t m_downlink;
+	uint8_t m_sfNum;
+	uint8_t m_slotNum;
+	uint8_t m_symStart;
+	uint8_t m_numSym;
+	uint8_t m_mcs;
+	uint8_t m_rv;
+	uint8_t m_corrupt;
+	uint8_t m_reserved[6];
+};
+
 class MmWavePhyRxTrace : public Object
 {
 public:
+	/**
+	 * Format of the RxPacketTrace file
+	 */
+	enum OutputFormat_t
+	{
+		TEXT,	///< a tab separated line per TB
+		BINARY	///< a MmWaveRxPacketTraceRecord per TB
+	};
+
 	MmWavePhyRxTrace();
 	virtual ~MmWavePhyRxTrace();
 	static TypeId GetTypeId (void);
@@ -53,14 +88,48 @@ public:
 	static void RxPacketTraceUeCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
 	static void RxPacketTraceEnbCallback (Ptr<MmWavePhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
 
+	/**
+	 * Write the buffered TBs and close the RxPacketTrace file. It is called
+	 * by Simulator::Destroy, the next TB opens the file again and appends to
+	 * it, thus the simulations run by a process go to the same file, as
+	 * long as it has the same name
+	 */
+	static void CloseRxPacketTraceFile ();
+
+	/**
+	 * Print a TB as a line of the text RxPacketTrace file
+	 * @params the output stream
+	 * @params the record of the TB
+	 */
+	static void PrintRxPacketTraceRecord (std::ostream &os, const MmWaveRxPacketTraceRecord &record);
+
+	/**
+	 * Convert a binary RxPacketTrace file to the text format
+	 * @params the name of the binary file
+	 * @params the name of the text file
+	 * @returns the number of TBs
+	 */
+	static uint64_t ConvertRxPacketTrace (std::string binaryFilename, std::string textFilename);
+
 private:
 	//void ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr);
 	//void ReportPacketCountUe (UePhyPacketCountParameter param);
 	//void ReportPacketCountEnb (EnbPhyPacketCountParameter param);
 	//void ReportDLTbSize (uint64_t imsi, uint64_t tbSize);
 
-	static std::ofstream m_rxPacketTraceFile;
-	static std::string m_rxPacketTraceFilename;
+	/**
+	 * Append a TB to the RxPacketTrace file, opening it with the format and
+	 * the name of phyStats if needed
+	 */
+	static void WriteRxPacketTrace (Ptr<MmWavePhyRxTrace> phyStats, const RxPacketTraceParams &params, bool downlink);
+
+	OutputFormat_t m_outputFormat;
+	std::string m_outputFilename;
+
+	static Ptr<MmWaveTraceWriter> m_rxPacketTraceWriter;
+	static bool m_rxPacketTraceBinary;
+	static std::ostringstream m_rxPacketTraceLine;	///< text line being formatted
+	static std::set<std::string> m_rxPacketTraceFilenames;	///< files already opened, to append to
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,162 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-trace-writer.h"
+#include <ns3/core-config.h>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceWriter");
+
+MmWaveTraceWriter::MmWaveTraceWriter (std::string filename, uint32_t bufferSize, bool append)
+	: m_filename (filename),
+	  m_active (0),
+	  m_used (0),
+	  m_pendingSize (0),
+	  m_failed (false),
+	  m_closed (false),
+	  m_stop (false)
+{
+	NS_LOG_FUNCTION (this << filename << bufferSize << append);
+	m_file.open (filename.c_str (), std::ofstream::out | std::ofstream::binary | (append ? std::ofstream::app : std::ofstream::trunc));
+	NS_ABORT_MSG_IF (!m_file.is_open (), "Could not open tracefile " << filename);
+	m_buffers[0].resize (std::max (bufferSize, 1u));
+	m_buffers[1].resize (std::max (bufferSize, 1u));
+#ifdef HAVE_PTHREAD_H
+	m_writer = std::thread (&MmWaveTraceWriter::WriterLoop, this);
+#endif
+}
+
+MmWaveTraceWriter::~MmWaveTraceWriter ()
+{
+	NS_LOG_FUNCTION (this);
+	Close ();
+}
+
+std::string
+MmWaveTraceWriter::GetFilename () const
+{
+	return m_filename;
+}
+
+void
+MmWaveTraceWriter::Write (const void *data, uint32_t size)
+{
+	NS_ASSERT_MSG (!m_closed, "Trace file " << m_filename << " already closed");
+	const char *bytes = static_cast<const char*> (data);
+	while (size > 0)
+	{
+		if (m_used == m_buffers[m_active].size ())
+		{
+			SwapBuffers ();
+		}
+		uint32_t chunk = std::min<uint32_t> (size, m_buffers[m_active].size () - m_used);
+		std::memcpy (&m_buffers[m_active][m_used], bytes, chunk);
+		m_used += chunk;
+		bytes += chunk;
+		size -= chunk;
+	}
+}
+
+void
+MmWaveTraceWriter::SwapBuffers ()
+{
+	if (m_used == 0)
+	{
+		return;
+	}
+	if (!m_writer.joinable ())
+	{
+		WriteBuffer (m_buffers[m_active], m_used);
+		m_used = 0;
+		return;
+	}
+	std::unique_lock<std::mutex> lock (m_mutex);
+	while (m_pendingSize > 0)
+	{
+		m_writtenCondition.wait (lock);
+	}
+	m_pendingSize = m_used;
+	m_active = 1 - m_active;
+	m_used = 0;
+	lock.unlock ();
+	m_pendingCondition.notify_one ();
+}
+
+void
+MmWaveTraceWriter::WriteBuffer (const std::vector<char> &buffer, uint32_t size)
+{
+	m_file.write (&buffer[0], size);
+	m_failed = m_failed || m_file.fail ();
+}
+
+void
+MmWaveTraceWriter::WriterLoop ()
+{
+	std::unique_lock<std::mutex> lock (m_mutex);
+	while (true)
+	{
+		while (m_pendingSize == 0 && !m_stop)
+		{
+			m_pendingCondition.wait (lock);
+		}
+		if (m_pendingSize == 0)
+		{
+			return;
+		}
+		// the simulation thread fills the other buffer meanwhile
+		uint32_t size = m_pendingSize;
+		uint32_t index = 1 - m_active;
+		lock.unlock ();
+		WriteBuffer (m_buffers[index], size);
+		lock.lock ();
+		m_pendingSize = 0;
+		m_writtenCondition.notify_one ();
+	}
+}
+
+void
+MmWaveTraceWriter::Close ()
+{
+	if (m_closed)
+	{
+		return;
+	}
+	NS_LOG_FUNCTION (this);
+	SwapBuffers ();
+	if (m_writer.joinable ())
+	{
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			m_stop = true;
+		}
+		m_pendingCondition.notify_one ();
+		m_writer.join ();
+	}
+	m_file.close ();
+	m_closed = true;
+	NS_ABORT_MSG_IF (m_failed || m_file.fail (), "Could not write tracefile " << m_filename);
+}
+
+} // namespace ns3
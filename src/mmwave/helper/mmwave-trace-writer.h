@@ -0,0 +1,105 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_TRACE_WRITER_H
+#define MMWAVE_TRACE_WRITER_H
+
+#include <ns3/simple-ref-count.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace ns3 {
+
+/**
+ * Output file of a trace sink, written through two large buffers: the sink
+ * fills one of them while a background thread writes the other to the
+ * file, thus the simulation thread neither formats nor flushes anything but
+ * when both buffers are full.
+ *
+ * The data is written in the order of the calls to Write, and all of it is
+ * in the file after Close (or the destruction of the writer).
+ *
+ * Without the threading support of ns-3 (pthread.h), the full buffers are
+ * written in the calling thread.
+ */
+class MmWaveTraceWriter : public SimpleRefCount<MmWaveTraceWriter>
+{
+public:
+	/**
+	 * Open the file
+	 * @params the name of the file
+	 * @params the size of each of the two buffers, in bytes
+	 * @params whether to append to the file, instead of truncating it
+	 */
+	MmWaveTraceWriter (std::string filename, uint32_t bufferSize, bool append = false);
+	~MmWaveTraceWriter ();
+
+	/**
+	 * Append data to the file
+	 * @params the data
+	 * @params the size of the data, in bytes
+	 */
+	void Write (const void *data, uint32_t size);
+
+	/**
+	 * Write all the buffered data and close the file
+	 */
+	void Close ();
+
+	/**
+	 * @returns the name of the file
+	 */
+	std::string GetFilename () const;
+
+private:
+	/**
+	 * Hand the buffer being filled to the background thread, after it has
+	 * written the previous one
+	 */
+	void SwapBuffers ();
+	/**
+	 * Write a buffer to the file, and record the errors for Close
+	 */
+	void WriteBuffer (const std::vector<char> &buffer, uint32_t size);
+	void WriterLoop ();
+
+	std::string m_filename;
+	std::ofstream m_file;
+	std::vector<char> m_buffers[2];
+	uint32_t m_active;	///< index of the buffer filled by Write
+	uint32_t m_used;	///< bytes of the active buffer
+	uint32_t m_pendingSize;	///< bytes of the other buffer still to be written, if any
+	bool m_failed;
+	bool m_closed;
+
+	std::thread m_writer;
+	std::mutex m_mutex;
+	std::condition_variable m_pendingCondition;
+	std::condition_variable m_writtenCondition;
+	bool m_stop;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_TRACE_WRITER_H */
@@ -29,6 +29,7 @@
 #include <ns3/math.h>
 #include <ns3/simulator.h>
 #include "ns3/double.h"
+#include <algorithm>
 
 
 NS_LOG_COMPONENT_DEFINE ("AntennaArrayModel");
@@ -37,6 +38,10 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (AntennaArrayModel);
 
+const uint16_t AntennaArrayModel::CODEBOOK_MIN_ELEVATION;
+const uint16_t AntennaArrayModel::CODEBOOK_MAX_ELEVATION;
+const uint16_t AntennaArrayModel::CODEBOOK_ELEVATION_STEP;
+
 static const double Enb22DegreeBFVectorReal[8][64] = {
 		{1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,1.000000,-0.998179,0.992721,-0.983647,0.970990,-0.954796,0.935123,-0.912045,},
 		{1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,1.000000,-0.863083,0.489825,0.017564,-0.520144,0.880290,-0.999383,0.844811,},
@@ -401,6 +406,12 @@ AntennaArrayModel::GetAntennaLocation(uint8_t index, uint8_t* antennaNum)
 
 void
 AntennaArrayModel::SetSector (uint8_t sector, uint8_t *antennaNum, double elevation)
+{
+	m_beamformingVector = GetSteeringVector (sector, antennaNum, elevation);
+}
+
+complexVector_t
+AntennaArrayModel::GetSteeringVector (uint8_t sector, uint8_t *antennaNum, double elevation)
 {
 	complexVector_t tempVector;
 	double hAngle_radian = M_PI*(double)sector/(double)antennaNum[1]-0.5*M_PI;
@@ -415,9 +426,270 @@ AntennaArrayModel::SetSector (uint8_t sector, uint8_t *antennaNum, double elevat
 							+ cos(vAngle_radian)*loc.z);
 		tempVector.push_back(exp(std::complex<double>(0, phase))*power);
 	}
-	m_beamformingVector = tempVector;
+	return tempVector;
+}
+
+/**
+ * The geometry of an array, which identifies its codebook
+ */
+struct CodebookGeometry
+{
+	uint8_t m_antennaNum[2];
+	double m_disH;
+	double m_disV;
+
+	bool operator< (const CodebookGeometry &o) const
+	{
+		if (m_antennaNum[0] != o.m_antennaNum[0])
+		{
+			return m_antennaNum[0] < o.m_antennaNum[0];
+		}
+		if (m_antennaNum[1] != o.m_antennaNum[1])
+		{
+			return m_antennaNum[1] < o.m_antennaNum[1];
+		}
+		if (m_disH != o.m_disH)
+		{
+			return m_disH < o.m_disH;
+		}
+		return m_disV < o.m_disV;
+	}
+};
+
+static std::map<CodebookGeometry, ComplexTensor>&
+GetCodebookCache ()
+{
+	static std::map<CodebookGeometry, ComplexTensor> codebooks;
+	return codebooks;
+}
+
+static uint16_t
+GetNumCodebookElevations ()
+{
+	return (AntennaArrayModel::CODEBOOK_MAX_ELEVATION - AntennaArrayModel::CODEBOOK_MIN_ELEVATION)
+			/ AntennaArrayModel::CODEBOOK_ELEVATION_STEP + 1;
+}
+
+const ComplexTensor&
+AntennaArrayModel::GetCodebook (uint8_t *antennaNum)
+{
+	CodebookGeometry geometry;
+	geometry.m_antennaNum[0] = antennaNum[0];
+	geometry.m_antennaNum[1] = antennaNum[1];
+	geometry.m_disH = m_disH;
+	geometry.m_disV = m_disV;
+
+	std::map<CodebookGeometry, ComplexTensor>::iterator it = GetCodebookCache ().find (geometry);
+	if (it != GetCodebookCache ().end ())
+	{
+		return it->second;
+	}
+
+	uint16_t numSector = antennaNum[1] + 1;
+	uint16_t size = antennaNum[0]*antennaNum[1];
+	NS_LOG_LOGIC ("Create the codebook of a " << (uint16_t)antennaNum[0] << "x" << (uint16_t)antennaNum[1] << " array");
+	ComplexTensor &codebook = GetCodebookCache ()[geometry];
+	codebook.Resize (GetNumCodebookElevations () * numSector, size);
+	for (uint16_t codeword = 0; codeword < codebook.GetNumRows (); codeword++)
+	{
+		uint8_t sector;
+		double elevation;
+		GetCodewordSector (codeword, antennaNum, sector, elevation);
+		complexVector_t steering = GetSteeringVector (sector, antennaNum, elevation);
+		std::copy (steering.begin (), steering.end (), codebook.GetRow (codeword));
+	}
+	return codebook;
 }
 
+void
+AntennaArrayModel::SetCodeword (uint16_t codeword, uint8_t *antennaNum)
+{
+	const ComplexTensor &codebook = GetCodebook (antennaNum);
+	NS_ASSERT_MSG (codeword < codebook.GetNumRows (), "codeword " << codeword << " is not in the codebook");
+	m_beamformingVector.assign (codebook.GetRow (codeword), codebook.GetRow (codeword) + codebook.GetNumCols ());
+}
 
+void
+AntennaArrayModel::GetCodewordSector (uint16_t codeword, uint8_t *antennaNum, uint8_t &sector, double &elevation)
+{
+	uint16_t numSector = antennaNum[1] + 1;
+	sector = codeword % numSector;
+	elevation = CODEBOOK_MIN_ELEVATION + (codeword / numSector) * CODEBOOK_ELEVATION_STEP;
+}
+
+/**
+ * Evaluate the wideband long term power sum_n |rxW^H H_n txW|^2 of all the
+ * pairs of candidate codewords and return the best one. In case of ties, the
+ * first pair in (tx, rx) order is returned, as in the original sector sweep.
+ */
+static std::pair<uint16_t, uint16_t>
+EvaluateCodewords (const ComplexTensor &channel,
+		const ComplexTensor &txCodebook, const std::vector<uint16_t> &txCandidates,
+		const ComplexTensor &rxCodebook, const std::vector<uint16_t> &rxCandidates)
+{
+	//channel[rx][tx][cluster]
+	std::size_t rxSize = channel.GetDimSize (0);
+	std::size_t txSize = channel.GetDimSize (1);
+	std::size_t numCluster = channel.GetDimSize (2);
+	NS_ASSERT_MSG (rxCodebook.GetNumCols () == rxSize && txCodebook.GetNumCols () == txSize,
+			"the codebooks do not match the size of the channel matrix");
+	std::size_t numRx = rxCandidates.size ();
+	std::size_t numTx = txCandidates.size ();
+
+	// rxH[r][s][n] = sum_u conj(rxW_r[u]) H[u][s][n]
+	ComplexTensor rxH (numRx, txSize, numCluster);
+	for (std::size_t r = 0; r < numRx; r++)
+	{
+		const std::complex<double> *rxW = rxCodebook.GetRow (rxCandidates[r]);
+		for (std::size_t u = 0; u < rxSize; u++)
+		{
+			std::complex<double> rxWConj = std::conj (rxW[u]);
+			for (std::size_t s = 0; s < txSize; s++)
+			{
+				const std::complex<double> *h = channel.GetRow (u, s);
+				std::complex<double> *g = rxH.GetRow (r, s);
+				for (std::size_t n = 0; n < numCluster; n++)
+				{
+					g[n] += rxWConj*h[n];
+				}
+			}
+		}
+	}
+
+	// power[t][r] = sum_n |sum_s rxH[r][s][n] txW_t[s]|^2
+	std::vector<double> power (numTx * numRx);
+	complexVector_t longTerm (numCluster);
+	for (std::size_t r = 0; r < numRx; r++)
+	{
+		for (std::size_t t = 0; t < numTx; t++)
+		{
+			const std::complex<double> *txW = txCodebook.GetRow (txCandidates[t]);
+			std::fill (longTerm.begin (), longTerm.end (), std::complex<double> (0,0));
+			for (std::size_t s = 0; s < txSize; s++)
+			{
+				const std::complex<double> *g = rxH.GetRow (r, s);
+				for (std::size_t n = 0; n < numCluster; n++)
+				{
+					longTerm[n] += g[n]*txW[s];
+				}
+			}
+			double sum = 0;
+			for (std::size_t n = 0; n < numCluster; n++)
+			{
+				sum += std::norm (longTerm[n]);
+			}
+			power[t * numRx + r] = sum;
+		}
+	}
+
+	double max = 0;
+	std::pair<uint16_t, uint16_t> best (txCandidates[0], rxCandidates[0]);
+	for (std::size_t t = 0; t < numTx; t++)
+	{
+		for (std::size_t r = 0; r < numRx; r++)
+		{
+			if (max < power[t * numRx + r])
+			{
+				max = power[t * numRx + r];
+				best = std::make_pair (txCandidates[t], rxCandidates[r]);
+			}
+		}
+	}
+	NS_LOG_LOGIC ("Evaluated " << numTx << "x" << numRx << " codewords, max gain " << max);
+	return best;
+}
+
+/**
+ * Indices 0, step, 2*step, ... and num-1
+ */
+static std::vector<int>
+GetCoarseIndices (int num, int step)
+{
+	std::vector<int> indices;
+	for (int i = 0; i < num; i += step)
+	{
+		indices.push_back (i);
+	}
+	if (indices.back () != num - 1)
+	{
+		indices.push_back (num - 1);
+	}
+	return indices;
+}
+
+/**
+ * Codewords of the coarse search: every elevationStep-th elevation and every
+ * sectorStep-th sector, including the last ones
+ */
+static std::vector<uint16_t>
+GetCoarseCodewords (uint8_t *antennaNum, int elevationStep, int sectorStep)
+{
+	int numSector = antennaNum[1] + 1;
+	std::vector<int> elevations = GetCoarseIndices (GetNumCodebookElevations (), elevationStep);
+	std::vector<int> sectors = GetCoarseIndices (numSector, sectorStep);
+	std::vector<uint16_t> codewords;
+	for (std::size_t e = 0; e < elevations.size (); e++)
+	{
+		for (std::size_t sec = 0; sec < sectors.size (); sec++)
+		{
+			codewords.push_back (elevations[e] * numSector + sectors[sec]);
+		}
+	}
+	return codewords;
+}
+
+/**
+ * Codewords of the fine search: those within elevationWindow elevations and
+ * sectorWindow sectors of the center codeword
+ */
+static std::vector<uint16_t>
+GetFineCodewords (uint8_t *antennaNum, uint16_t center, int elevationWindow, int sectorWindow)
+{
+	int numSector = antennaNum[1] + 1;
+	int numElevation = GetNumCodebookElevations ();
+	int centerSector = center % numSector;
+	int centerElevation = center / numSector;
+	std::vector<uint16_t> codewords;
+	for (int e = std::max (0, centerElevation - elevationWindow); e <= std::min (numElevation - 1, centerElevation + elevationWindow); e++)
+	{
+		for (int sec = std::max (0, centerSector - sectorWindow); sec <= std::min (numSector - 1, centerSector + sectorWindow); sec++)
+		{
+			codewords.push_back (e * numSector + sec);
+		}
+	}
+	return codewords;
+}
+
+std::pair<uint16_t, uint16_t>
+AntennaArrayModel::SearchCodebook (const ComplexTensor &channel,
+		const ComplexTensor &txCodebook, uint8_t *txAntennaNum,
+		const ComplexTensor &rxCodebook, uint8_t *rxAntennaNum, bool hierarchical)
+{
+	if (!hierarchical)
+	{
+		std::vector<uint16_t> txCandidates (txCodebook.GetNumRows ());
+		std::vector<uint16_t> rxCandidates (rxCodebook.GetNumRows ());
+		for (uint16_t i = 0; i < txCandidates.size (); i++)
+		{
+			txCandidates[i] = i;
+		}
+		for (uint16_t i = 0; i < rxCandidates.size (); i++)
+		{
+			rxCandidates[i] = i;
+		}
+		return EvaluateCodewords (channel, txCodebook, txCandidates, rxCodebook, rxCandidates);
+	}
+
+	// coarse search over the elevations 60, 90, 120 and every other sector,
+	// then exhaustive search in the neighborhood of the best coarse pair
+	const int elevationStep = 3;
+	const int sectorStep = 2;
+	std::pair<uint16_t, uint16_t> coarse = EvaluateCodewords (channel,
+			txCodebook, GetCoarseCodewords (txAntennaNum, elevationStep, sectorStep),
+			rxCodebook, GetCoarseCodewords (rxAntennaNum, elevationStep, sectorStep));
+	return EvaluateCodewords (channel,
+			txCodebook, GetFineCodewords (txAntennaNum, coarse.first, elevationStep - 1, sectorStep - 1),
+			rxCodebook, GetFineCodewords (rxAntennaNum, coarse.second, elevationStep - 1, sectorStep - 1));
+}
 
 } /* namespace ns3 */
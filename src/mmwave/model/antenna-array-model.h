@@ -27,6 +27,7 @@
 #include <ns3/antenna-model.h>
 #include <complex>
 #include <ns3/net-device.h>
+#include <ns3/complex-tensor.h>
 #include <map>
 
 namespace ns3 {
@@ -53,7 +54,56 @@ public:
 	void SetSector (uint8_t sector, uint8_t *antennaNum, double elevation = 90);
 	Ptr<NetDevice> GetCurrentDevice();
 
+	/// elevations (in degrees) of the codewords used by the beam search
+	static const uint16_t CODEBOOK_MIN_ELEVATION = 60;
+	static const uint16_t CODEBOOK_MAX_ELEVATION = 120;
+	static const uint16_t CODEBOOK_ELEVATION_STEP = 10;
+
+	/**
+	 * Get the beam search codebook, i.e., the BF vectors of SetSector for the sectors
+	 * 0, 1, ..., antennaNum[1] and the elevations CODEBOOK_MIN_ELEVATION, ...,
+	 * CODEBOOK_MAX_ELEVATION. Codeword c = elevationIndex*(antennaNum[1]+1)+sector is
+	 * stored in row c of the returned matrix.
+	 * The codebook is computed once for each array geometry and shared by all the arrays
+	 * @params the number of antenna elements in each direction
+	 * @returns the codebook
+	 */
+	const ComplexTensor& GetCodebook (uint8_t *antennaNum);
+	/**
+	 * Set the BF vector to a codeword of GetCodebook
+	 * @params the codeword index
+	 * @params the number of antenna elements in each direction
+	 */
+	void SetCodeword (uint16_t codeword, uint8_t *antennaNum);
+	/**
+	 * @params the codeword index
+	 * @params the number of antenna elements in each direction
+	 * @params the sector of the codeword (output)
+	 * @params the elevation of the codeword, in degrees (output)
+	 */
+	static void GetCodewordSector (uint16_t codeword, uint8_t *antennaNum, uint8_t &sector, double &elevation);
+	/**
+	 * Find the pair of codewords which maximizes the wideband long term power
+	 * sum_n |rxW^H H_n txW|^2 of the channel H[u][s][n]. The gains of all the
+	 * candidate pairs are evaluated at once as the product rxCodebook^H H txCodebook.
+	 * With the hierarchical search, a coarse search over every other sector and over
+	 * the elevations 60, 90 and 120 degrees is followed by an exhaustive search
+	 * around the best coarse pair.
+	 * @params the channel matrix H[u][s][n], u (s) being the rx (tx) antenna index
+	 * @params the tx codebook
+	 * @params the number of tx antenna elements in each direction
+	 * @params the rx codebook
+	 * @params the number of rx antenna elements in each direction
+	 * @params true for the hierarchical search, false for the exhaustive one
+	 * @returns the pair (tx codeword, rx codeword)
+	 */
+	static std::pair<uint16_t, uint16_t> SearchCodebook (const ComplexTensor &channel,
+			const ComplexTensor &txCodebook, uint8_t *txAntennaNum,
+			const ComplexTensor &rxCodebook, uint8_t *rxAntennaNum, bool hierarchical);
+
 private:
+	complexVector_t GetSteeringVector (uint8_t sector, uint8_t *antennaNum, double elevation);
+
 	bool m_omniTx;
 	double m_minAngle;
 	double m_maxAngle;
@@ -0,0 +1,76 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "complex-tensor.h"
+
+namespace ns3 {
+
+const std::size_t ComplexTensor::ALIGNMENT;
+
+ComplexTensor::ComplexTensor ()
+{
+	m_dim[0] = m_dim[1] = m_dim[2] = 0;
+	m_stride[0] = m_stride[1] = m_stride[2] = 0;
+}
+
+ComplexTensor::ComplexTensor (std::size_t rows, std::size_t cols)
+{
+	Resize (1, rows, cols);
+}
+
+ComplexTensor::ComplexTensor (std::size_t d0, std::size_t d1, std::size_t d2)
+{
+	Resize (d0, d1, d2);
+}
+
+void
+ComplexTensor::Resize (std::size_t rows, std::size_t cols)
+{
+	Resize (1, rows, cols);
+}
+
+void
+ComplexTensor::Resize (std::size_t d0, std::size_t d1, std::size_t d2)
+{
+	// pad the inner dimension to a whole number of cache lines, so that every
+	// row starts on an aligned address
+	const std::size_t perLine = ALIGNMENT / sizeof (value_type);
+	std::size_t paddedRow = ((d2 + perLine - 1) / perLine) * perLine;
+
+	m_dim[0] = d0;
+	m_dim[1] = d1;
+	m_dim[2] = d2;
+	m_stride[2] = 1;
+	m_stride[1] = paddedRow;
+	m_stride[0] = paddedRow * d1;
+
+	m_data.clear ();
+	m_data.resize (d0 * m_stride[0], value_type (0.0, 0.0));
+}
+
+void
+ComplexTensor::Clear ()
+{
+	m_data.clear ();
+	m_data.shrink_to_fit ();
+	m_dim[0] = m_dim[1] = m_dim[2] = 0;
+	m_stride[0] = m_stride[1] = m_stride[2] = 0;
+}
+
+} // namespace ns3
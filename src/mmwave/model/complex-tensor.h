@@ -0,0 +1,205 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef COMPLEX_TENSOR_H_
+#define COMPLEX_TENSOR_H_
+
+#include <complex>
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+#include <ns3/assert.h>
+
+namespace ns3 {
+
+/**
+ * Minimal C++11 allocator returning storage aligned to Alignment bytes,
+ * so that the rows of a ComplexTensor start on a cache line boundary.
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+	typedef T value_type;
+
+	template <typename U>
+	struct rebind
+	{
+		typedef AlignedAllocator<U, Alignment> other;
+	};
+
+	AlignedAllocator () {}
+	template <typename U>
+	AlignedAllocator (const AlignedAllocator<U, Alignment> &) {}
+
+	T* allocate (std::size_t n)
+	{
+		void *p = 0;
+		if (posix_memalign (&p, Alignment, n * sizeof (T)) != 0)
+		{
+			throw std::bad_alloc ();
+		}
+		return static_cast<T*> (p);
+	}
+
+	void deallocate (T *p, std::size_t)
+	{
+		free (p);
+	}
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator== (const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return true; }
+template <typename T, typename U, std::size_t A>
+bool operator!= (const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) { return false; }
+
+/**
+ * \brief Dense, cache-aligned storage for complex channel coefficients.
+ *
+ * A rank-3 tensor T[i][j][k] (e.g., the channel H[u][s][n] of the 3GPP model)
+ * is kept in a single allocation. The innermost dimension is contiguous and
+ * padded to a whole number of cache lines, so that GetRow (i, j) returns a
+ * pointer to an aligned, unit-stride view of T[i][j][:].
+ * A matrix M[r][c] is stored as a rank-3 tensor with a single slice.
+ */
+class ComplexTensor
+{
+public:
+	typedef std::complex<double> value_type;
+
+	/// alignment (in bytes) of the storage and of each row
+	static const std::size_t ALIGNMENT = 64;
+
+	ComplexTensor ();
+	/**
+	 * Create a zero-filled matrix
+	 * @param the number of rows
+	 * @param the number of columns
+	 */
+	ComplexTensor (std::size_t rows, std::size_t cols);
+	/**
+	 * Create a zero-filled rank-3 tensor
+	 * @param the size of the outer dimension
+	 * @param the size of the middle dimension
+	 * @param the size of the inner (contiguous) dimension
+	 */
+	ComplexTensor (std::size_t d0, std::size_t d1, std::size_t d2);
+
+	/**
+	 * Resize the tensor to the given dimensions, all the elements are reset to 0
+	 */
+	void Resize (std::size_t d0, std::size_t d1, std::size_t d2);
+	void Resize (std::size_t rows, std::size_t cols);
+
+	/**
+	 * Release the storage, IsEmpty () returns true afterwards
+	 */
+	void Clear ();
+	bool IsEmpty () const
+	{
+		return m_data.empty ();
+	}
+
+	/**
+	 * @param the dimension (0, 1 or 2)
+	 * @returns the number of elements along the dimension
+	 */
+	std::size_t GetDimSize (uint8_t dim) const
+	{
+		NS_ASSERT (dim < 3);
+		return m_dim[dim];
+	}
+	/**
+	 * @param the dimension (0, 1 or 2)
+	 * @returns the distance, in elements, between two consecutive indices of the dimension
+	 */
+	std::size_t GetStride (uint8_t dim) const
+	{
+		NS_ASSERT (dim < 3);
+		return m_stride[dim];
+	}
+	/// number of rows of a matrix, or of each slice of a rank-3 tensor
+	std::size_t GetNumRows () const
+	{
+		return m_dim[1];
+	}
+	/// number of columns of a matrix, or of each slice of a rank-3 tensor
+	std::size_t GetNumCols () const
+	{
+		return m_dim[2];
+	}
+
+	value_type& operator() (std::size_t i, std::size_t j, std::size_t k)
+	{
+		NS_ASSERT (i < m_dim[0] && j < m_dim[1] && k < m_dim[2]);
+		return m_data[i * m_stride[0] + j * m_stride[1] + k];
+	}
+	const value_type& operator() (std::size_t i, std::size_t j, std::size_t k) const
+	{
+		NS_ASSERT (i < m_dim[0] && j < m_dim[1] && k < m_dim[2]);
+		return m_data[i * m_stride[0] + j * m_stride[1] + k];
+	}
+	value_type& operator() (std::size_t row, std::size_t col)
+	{
+		NS_ASSERT (m_dim[0] == 1);
+		return operator() (0, row, col);
+	}
+	const value_type& operator() (std::size_t row, std::size_t col) const
+	{
+		NS_ASSERT (m_dim[0] == 1);
+		return operator() (0, row, col);
+	}
+
+	/**
+	 * @returns a pointer to the GetNumCols () contiguous elements of T[i][j][:]
+	 */
+	value_type* GetRow (std::size_t i, std::size_t j)
+	{
+		NS_ASSERT (i < m_dim[0] && j < m_dim[1]);
+		return &m_data[i * m_stride[0] + j * m_stride[1]];
+	}
+	const value_type* GetRow (std::size_t i, std::size_t j) const
+	{
+		NS_ASSERT (i < m_dim[0] && j < m_dim[1]);
+		return &m_data[i * m_stride[0] + j * m_stride[1]];
+	}
+	/**
+	 * @returns a pointer to the GetNumCols () contiguous elements of row M[row][:] of a matrix
+	 */
+	value_type* GetRow (std::size_t row)
+	{
+		NS_ASSERT (m_dim[0] == 1);
+		return GetRow (0, row);
+	}
+	const value_type* GetRow (std::size_t row) const
+	{
+		NS_ASSERT (m_dim[0] == 1);
+		return GetRow (0, row);
+	}
+
+private:
+	std::vector<value_type, AlignedAllocator<value_type, ALIGNMENT> > m_data;
+	std::size_t m_dim[3];
+	std::size_t m_stride[3];
+};
+
+} // namespace ns3
+
+#endif /* COMPLEX_TENSOR_H_ */
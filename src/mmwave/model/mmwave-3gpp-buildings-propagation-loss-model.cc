@@ -25,6 +25,7 @@
 #include "mmwave-3gpp-buildings-propagation-loss-model.h"
 
 #include "mmwave-3gpp-propagation-loss-model.h"
+#include "mmwave-building-index.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/double.h"
@@ -39,6 +40,9 @@
 #include <ns3/mmwave-iab-net-device.h>
 #include <ns3/node.h>
 #include "ns3/boolean.h"
+#include <algorithm>
+#include <cstring>
+#include <cmath>
 
 NS_LOG_COMPONENT_DEFINE ("MmWave3gppBuildingsPropagationLossModel");
 
@@ -57,6 +61,7 @@ MmWave3gppBuildingsPropagationLossModel::MmWave3gppBuildingsPropagationLossModel
 	m_3gppNlos = CreateObject<MmWave3gppPropagationLossModel> ();
 	m_3gppNlos->SetAttribute("ChannelCondition", StringValue ("n"));
 	m_prevTime = Time(0);
+	m_losCacheNumBuildings = 0;
 
 	if(!m_enbUeLocTrace.is_open())
 	{
@@ -78,6 +83,16 @@ MmWave3gppBuildingsPropagationLossModel::~MmWave3gppBuildingsPropagationLossMode
 	}
 }
 
+void
+MmWave3gppBuildingsPropagationLossModel::DoDispose ()
+{
+	m_mobilityIndex.clear ();
+	m_mobilityModels.clear ();
+	m_conditionTable.clear ();
+	m_losCache.clear ();
+	BuildingsPropagationLossModel::DoDispose ();
+}
+
 TypeId
 MmWave3gppBuildingsPropagationLossModel::GetTypeId (void)
 {
@@ -89,6 +104,12 @@ MmWave3gppBuildingsPropagationLossModel::GetTypeId (void)
 					BooleanValue (true),
 					MakeBooleanAccessor (&MmWave3gppBuildingsPropagationLossModel::m_updateCondition),
 					MakeBooleanChecker ())
+		.AddAttribute ("LosCacheResolution",
+					"Resolution (m) of the grid on which the positions of the outdoor links are quantized to cache their LOS condition. "
+					"With 0, the condition is only reused for exactly the same positions",
+					DoubleValue (0),
+					MakeDoubleAccessor (&MmWave3gppBuildingsPropagationLossModel::m_losCacheResolution),
+					MakeDoubleChecker<double> (0))
 	;
 	return tid;
 }
@@ -112,11 +133,11 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
 	NS_ASSERT_MSG ((a1 != 0) && (b1 != 0), "MmWave3gppBuildingsPropagationLossModel only works with MobilityBuildingInfo");
 
 	double loss = 0.0;
-	channelConditionMap_t::const_iterator it;
-	it = m_conditionMap.find(std::make_pair(a,b));
-	//it == m_conditionMap.end () check whether it is the first transmission, if yes determine the channel condition
-	//m_updateCondition refresh conditionMap very transmission.
-	if (it == m_conditionMap.end () || m_updateCondition)
+	channelCondition &entry = GetConditionEntry (a, b);
+	//!known check whether it is the first transmission, if yes determine the channel condition
+	//m_updateCondition refresh the condition table every transmission.
+	bool known = (entry.m_channelCondition != 0);
+	if (!known || m_updateCondition)
 	{
 		channelCondition condition;
 		/* The IsOutdoor and IsIndoor function is only based on the initial node position,
@@ -151,7 +172,7 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
 			//Here we assume the indoor nodes are all NLOS O2I.
 			condition.m_channelCondition = 'i';
 			//Compute the addition indoor pathloss term when this is the first transmission, or the node moves from outdoor to indoor.
-			if(it == m_conditionMap.end () || (*it).second.m_channelCondition != 'i')
+			if(!known || entry.m_channelCondition != 'i')
 			{
 				double lossIndoor = 0;
 				double PL_tw;
@@ -225,47 +246,37 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
 			}
 			else
 			{
-				condition.m_shadowing = (*it).second.m_shadowing;
+				condition.m_shadowing = entry.m_shadowing;
 			}
 		}
 
 
-		if (it == m_conditionMap.end ())
+		if (!known || entry.m_channelCondition != condition.m_channelCondition)
 		{
-			//First transmission. Generate the channel condition and insert to the map
-			m_conditionMap.insert (std::make_pair(std::make_pair (a,b), condition));
-			m_conditionMap.insert (std::make_pair(std::make_pair (b,a), condition));
-			it = m_conditionMap.find(std::make_pair(a,b));
-		}
-		else if ((*it).second.m_channelCondition != condition.m_channelCondition)
-		{
-			//m_updateCondition enabled and the channel condition changed. Update the conditionMap.
-			m_conditionMap.erase (std::make_pair (a,b));
-			m_conditionMap.erase (std::make_pair (b,a));
-			m_conditionMap.insert (std::make_pair(std::make_pair (a,b), condition));
-			m_conditionMap.insert (std::make_pair(std::make_pair (b,a), condition));
-			it = m_conditionMap.find(std::make_pair(a,b));
+			//First transmission, or m_updateCondition enabled and the channel condition changed.
+			//The entry is shared by both directions of the link.
+			entry = condition;
 		}
 
 	}
 
-	if((*it).second.m_channelCondition == 'l')
+	if(entry.m_channelCondition == 'l')
 	{
 		//LoS channel condition
 		loss = m_3gppLos->GetLoss (a,b);
 
 	}
-	else if ((*it).second.m_channelCondition == 'n')
+	else if (entry.m_channelCondition == 'n')
 	{
 		//NLoS channel condition
 		loss = m_3gppNlos->GetLoss (a,b);
 
 	}
-	else if ((*it).second.m_channelCondition == 'i')
+	else if (entry.m_channelCondition == 'i')
 	{
 		//for simplicity, the pathloss formulat still use d_2D instead of d_2D_out.
 		//All the indoor pathloss terms are stored in the m_shadowing.
-		loss =  m_3gppNlos->GetLoss (a,b) + (*it).second.m_shadowing;
+		loss =  m_3gppNlos->GetLoss (a,b) + entry.m_shadowing;
 	}
 	else
 	{
@@ -287,7 +298,7 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
 			// 	NS_LOG_INFO("UE->ENB Link");
 			// 	ueLoc = a->GetPosition();
 			// 	enbLoc = b->GetPosition();
-			// 	LocationTrace(enbLoc, ueLoc, (*it).second.m_channelCondition == 'l');
+			// 	LocationTrace(enbLoc, ueLoc, entry.m_channelCondition == 'l');
 
 			// }
 		}
@@ -299,14 +310,14 @@ MmWave3gppBuildingsPropagationLossModel::GetLoss (Ptr<MobilityModel> a, Ptr<Mobi
 				NS_LOG_INFO("ENB->UE Link");
 				enbLoc = a->GetPosition();
 				ueLoc = b->GetPosition();
-				LocationTrace(enbLoc, ueLoc, (*it).second.m_channelCondition == 'l');
+				LocationTrace(enbLoc, ueLoc, entry.m_channelCondition == 'l');
 			}
 			else if((DynamicCast<MmWaveIabNetDevice> (b->GetObject<Node> ()->GetDevice (0)) !=0))
 			{
 				NS_LOG_INFO("ENB->IAB Link");
 				enbLoc = a->GetPosition();
 				Vector iabLoc = b->GetPosition();
-				LocationTrace(enbLoc, iabLoc, (*it).second.m_channelCondition == 'l');
+				LocationTrace(enbLoc, iabLoc, entry.m_channelCondition == 'l');
 			}
 		}
 
@@ -330,42 +341,91 @@ MmWave3gppBuildingsPropagationLossModel::mmWaveNlosLoss (Ptr<MobilityModel> a, P
 bool
 MmWave3gppBuildingsPropagationLossModel::IsLineIntersectBuildings(Vector L1, Vector L2 ) const
 {
-	for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+	// the cache is emptied when buildings are added, or when it grows too much with mobile nodes
+	static const size_t maxLosCacheSize = 1000000;
+	uint32_t numBuildings = BuildingList::GetNBuildings ();
+	if (numBuildings != m_losCacheNumBuildings || m_losCache.size () >= maxLosCacheSize)
+	{
+		m_losCache.clear ();
+		m_losCacheNumBuildings = numBuildings;
+	}
+
+	LosCacheKey key;
+	int64_t end1[3] = {QuantizeCoordinate (L1.x), QuantizeCoordinate (L1.y), QuantizeCoordinate (L1.z)};
+	int64_t end2[3] = {QuantizeCoordinate (L2.x), QuantizeCoordinate (L2.y), QuantizeCoordinate (L2.z)};
+	bool swap = std::lexicographical_compare (end2, end2 + 3, end1, end1 + 3);
+	std::copy (swap ? end2 : end1, (swap ? end2 : end1) + 3, key.m_coord);
+	std::copy (swap ? end1 : end2, (swap ? end1 : end2) + 3, key.m_coord + 3);
+
+	std::unordered_map<LosCacheKey, bool, LosCacheKeyHash>::const_iterator it = m_losCache.find (key);
+	if (it != m_losCache.end ())
+	{
+		return it->second;
+	}
+	bool intersect = MmWaveBuildingIndex::IsLineIntersectBuildings (L1, L2);
+	m_losCache.insert (std::make_pair (key, intersect));
+	return intersect;
+}
+
+int64_t
+MmWave3gppBuildingsPropagationLossModel::QuantizeCoordinate (double coordinate) const
+{
+	if (m_losCacheResolution > 0)
+	{
+		return std::llround (coordinate / m_losCacheResolution);
+	}
+	// exact position, +0.0 and -0.0 are the same
+	coordinate += 0.0;
+	int64_t bits;
+	std::memcpy (&bits, &coordinate, sizeof (bits));
+	return bits;
+}
+
+bool
+MmWave3gppBuildingsPropagationLossModel::LosCacheKey::operator== (const LosCacheKey &other) const
+{
+	return std::equal (m_coord, m_coord + 6, other.m_coord);
+}
+
+size_t
+MmWave3gppBuildingsPropagationLossModel::LosCacheKeyHash::operator() (const LosCacheKey &key) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (uint32_t i = 0; i < 6; i++)
 	{
-		Box boundaries = (*bit)->GetBoundaries ();
-
-		Vector boxSize (0.5*(boundaries.xMax - boundaries.xMin),
-				0.5*(boundaries.yMax - boundaries.yMin),
-				0.5*(boundaries.zMax - boundaries.zMin));
-		Vector boxCenter (boundaries.xMin + boxSize.x,
-				boundaries.yMin + boxSize.y,
-				boundaries.zMin + boxSize.z);
-
-		// Put line in box space
-		Vector LB1 (L1.x-boxCenter.x, L1.y-boxCenter.y, L1.z-boxCenter.z);
-		Vector LB2 (L2.x-boxCenter.x, L2.y-boxCenter.y, L2.z-boxCenter.z);
-
-		// Get line midpoint and extent
-		Vector LMid (0.5*(LB1.x+LB2.x), 0.5*(LB1.y+LB2.y), 0.5*(LB1.z+LB2.z));
-		Vector L (LB1.x - LMid.x, LB1.y - LMid.y, LB1.z - LMid.z);
-		Vector LExt ( std::abs(L.x), std::abs(L.y), std::abs(L.z) );
-
-		// Use Separating Axis Test
-		// Separation vector from box center to line center is LMid, since the line is in box space
-		// If the line did not intersect this building, jump to the next building.
-		if ( std::abs( LMid.x ) > boxSize.x + LExt.x ) continue;
-		if ( std::abs( LMid.y ) > boxSize.y + LExt.y ) continue;
-		if ( std::abs( LMid.z ) > boxSize.z + LExt.z ) continue;
-		// Crossproducts of line and each axis
-		if ( std::abs( LMid.y * L.z - LMid.z * L.y)  >  (boxSize.y * LExt.z + boxSize.z * LExt.y) ) continue;
-		if ( std::abs( LMid.x * L.z - LMid.z * L.x)  >  (boxSize.x * LExt.z + boxSize.z * LExt.x) ) continue;
-		if ( std::abs( LMid.x * L.y - LMid.y * L.x)  >  (boxSize.x * LExt.y + boxSize.y * LExt.x) ) continue;
-
-		// No separating axis, the line intersects
-		// If the line intersect this building, return true.
-		return true;
+		hash = (hash ^ (uint64_t) key.m_coord[i]) * 1099511628211ULL;
+		hash ^= hash >> 29;
 	}
-	return false;
+	return hash;
+}
+
+uint32_t
+MmWave3gppBuildingsPropagationLossModel::GetMobilityIndex (Ptr<MobilityModel> mobility) const
+{
+	std::unordered_map<MobilityModel*, uint32_t>::const_iterator it = m_mobilityIndex.find (PeekPointer (mobility));
+	if (it != m_mobilityIndex.end ())
+	{
+		return it->second;
+	}
+	uint32_t index = m_mobilityModels.size ();
+	m_mobilityIndex.insert (std::make_pair (PeekPointer (mobility), index));
+	// the model is kept alive, so that its address is not reused by another one
+	m_mobilityModels.push_back (mobility);
+	channelCondition unknown;
+	unknown.m_channelCondition = 0;
+	unknown.m_shadowing = 0;
+	unknown.m_hE = 0;
+	unknown.m_carPenetrationLoss = 0;
+	m_conditionTable.push_back (std::vector<channelCondition> (index + 1, unknown));
+	return index;
+}
+
+channelCondition&
+MmWave3gppBuildingsPropagationLossModel::GetConditionEntry (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const
+{
+	uint32_t indexA = GetMobilityIndex (a);
+	uint32_t indexB = GetMobilityIndex (b);
+	return m_conditionTable[std::max (indexA, indexB)][std::min (indexA, indexB)];
 }
 
 void
@@ -400,13 +460,12 @@ MmWave3gppBuildingsPropagationLossModel::GetScenario ()
 char
 MmWave3gppBuildingsPropagationLossModel::GetChannelCondition(Ptr<MobilityModel> a, Ptr<MobilityModel> b)
 {
-	channelConditionMap_t::const_iterator it;
-	it = m_conditionMap.find(std::make_pair(a,b));
-	if (it == m_conditionMap.end ())
+	const channelCondition &entry = GetConditionEntry (a, b);
+	if (entry.m_channelCondition == 0)
 	{
 		NS_FATAL_ERROR ("Cannot find the link in the map");
 	}
-	return (*it).second.m_channelCondition;
+	return entry.m_channelCondition;
 
 }
 
@@ -30,6 +30,8 @@
 #include <ns3/simulator.h>
 #include "mmwave-phy-mac-common.h"
 #include <fstream>
+#include <vector>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -48,10 +50,49 @@ public:
 	std::string GetScenario();
 	char GetChannelCondition(Ptr<MobilityModel> a, Ptr<MobilityModel> b);
 
+protected:
+	virtual void DoDispose ();
+
 private:
-	//The IsLineIntersectBuildings method is based on
-	//ISLineInBox method implemented in Bounding Box Types.
-	//Link: http://www.3dkingdoms.com/weekly/weekly.php?a=21.
+	/**
+	 * Key of the LOS cache: the quantized positions of the two ends of the
+	 * link, sorted so that both directions have the same key
+	 */
+	struct LosCacheKey
+	{
+		int64_t m_coord[6];
+		bool operator== (const LosCacheKey &other) const;
+	};
+
+	struct LosCacheKeyHash
+	{
+		size_t operator() (const LosCacheKey &key) const;
+	};
+
+	/**
+	 * Get the entry of the link in the condition table, which is shared by
+	 * the two directions of the link
+	 * @params the mobility model of one end
+	 * @params the mobility model of the other end
+	 * @returns the entry, with m_channelCondition equal to 0 if the
+	 * condition was never computed
+	 */
+	channelCondition& GetConditionEntry (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
+
+	/**
+	 * @params the mobility model
+	 * @returns the index of the mobility model in the condition table
+	 */
+	uint32_t GetMobilityIndex (Ptr<MobilityModel> mobility) const;
+
+	/**
+	 * @params the position
+	 * @returns the position on the grid of the LOS cache
+	 */
+	int64_t QuantizeCoordinate (double coordinate) const;
+
+	//The IsLineIntersectBuildings method uses the shared MmWaveBuildingIndex,
+	//see MmWaveBuildingIndex::IsLineIntersectBox for the intersection test.
 	bool IsLineIntersectBuildings (Vector L1, Vector L2 ) const;
 	void LocationTrace (Vector enbLoc, Vector ueLoc, bool los) const;
 	double mmWaveLosLoss (Ptr<MobilityModel> a, Ptr<MobilityModel> b) const;
@@ -62,7 +103,12 @@ private:
 	static std::ofstream m_enbUeLocTrace;
 	Ptr<MmWave3gppPropagationLossModel> m_3gppLos;
 	Ptr<MmWave3gppPropagationLossModel> m_3gppNlos;
-	mutable channelConditionMap_t m_conditionMap;
+	mutable std::unordered_map<MobilityModel*, uint32_t> m_mobilityIndex;
+	mutable std::vector<Ptr<MobilityModel> > m_mobilityModels;	///< indexed by the mobility index
+	mutable std::vector<std::vector<channelCondition> > m_conditionTable;	///< row i holds the links (i, j) with j <= i
+	mutable std::unordered_map<LosCacheKey, bool, LosCacheKeyHash> m_losCache;	///< true if the link intersects a building
+	mutable uint32_t m_losCacheNumBuildings;
+	double m_losCacheResolution;
 	bool m_updateCondition;
 	mutable Time m_prevTime;
 	Ptr<MmWavePhyMacCommon> m_phyMacConfig;
@@ -30,6 +30,7 @@
 #include <ns3/mmwave-phy.h>
 #include <ns3/mmwave-net-device.h>
 #include <ns3/node.h>
+#include <ns3/node-list.h>
 #include <ns3/mmwave-ue-net-device.h>
 #include <ns3/mc-ue-net-device.h>
 #include <ns3/mmwave-enb-net-device.h>
@@ -41,6 +42,7 @@
 #include <random>       // std::default_random_engine
 #include <ns3/boolean.h>
 #include <ns3/integer.h>
+#include <ns3/enum.h>
 #include "mmwave-spectrum-value-helper.h"
 
 namespace ns3{
@@ -172,6 +174,7 @@ MmWave3gppChannel::MmWave3gppChannel ()
 	m_normalRvBlockage->SetAttribute ("Mean", DoubleValue (0));
 	m_normalRvBlockage->SetAttribute ("Variance", DoubleValue (1));
 	m_forceInitialBfComputation = false;
+	m_linkTableSize = 0;
 }
 
 TypeId
@@ -184,11 +187,21 @@ MmWave3gppChannel::GetTypeId (void)
 				TimeValue (MilliSeconds (0)),
 				MakeTimeAccessor (&MmWave3gppChannel::m_updatePeriod),
 				MakeTimeChecker ())
+	.AddAttribute ("UpdatePeriodJitter",
+				"Maximum random delay added to the UpdatePeriod of each link, to spread the updates of the links created at the same time",
+				TimeValue (MilliSeconds (0)),
+				MakeTimeAccessor (&MmWave3gppChannel::m_updatePeriodJitter),
+				MakeTimeChecker ())
 	.AddAttribute ("CellScan",
 				"Use beam search method to determine beamforming vector, the default is long-term covariance matrix method",
 				BooleanValue (false),
 				MakeBooleanAccessor (&MmWave3gppChannel::m_cellScan),
 				MakeBooleanChecker ())
+	.AddAttribute ("HierarchicalBeamSearch",
+				"If CellScan is true, search the codebook with a coarse search followed by a fine one, instead of an exhaustive search",
+				BooleanValue (false),
+				MakeBooleanAccessor (&MmWave3gppChannel::m_hierarchicalBeamSearch),
+				MakeBooleanChecker ())
 	.AddAttribute ("Blockage",
 				"Enable blockage model A (sec 7.6.4.1)",
 				BooleanValue (false),
@@ -209,6 +222,17 @@ MmWave3gppChannel::GetTypeId (void)
 				BooleanValue (true),
 				MakeBooleanAccessor (&MmWave3gppChannel::m_portraitMode),
 				MakeBooleanChecker ())
+	.AddAttribute ("BeamformingGainKernel",
+				"Implementation of the per-subband beamforming gain computation. "
+				"Simd selects the fastest rotating phasor kernel supported by the CPU (AVX-512, AVX2 or Scalar), "
+				"Reference evaluates exp () for every subband and cluster",
+				EnumValue (MmWaveBeamformingGainKernel::SIMD),
+				MakeEnumAccessor (&MmWave3gppChannel::m_bfGainKernel),
+				MakeEnumChecker (MmWaveBeamformingGainKernel::SIMD, "Simd",
+								 MmWaveBeamformingGainKernel::SCALAR, "Scalar",
+								 MmWaveBeamformingGainKernel::AVX2, "Avx2",
+								 MmWaveBeamformingGainKernel::AVX512, "Avx512",
+								 MmWaveBeamformingGainKernel::REFERENCE, "Reference"))
 	;
 	return tid;
 }
@@ -222,6 +246,11 @@ void
 MmWave3gppChannel::DoDispose ()
 {
 	NS_LOG_FUNCTION (this);
+	m_devices.clear ();
+	m_links.clear ();
+	m_linkTableSize = 0;
+	m_refreshEvent.Cancel ();
+	m_refreshQueue.clear ();
 }
 
 void
@@ -442,422 +471,223 @@ MmWave3gppChannel::Initial(NetDeviceContainer ueDevices, NetDeviceContainer enbD
 
 }
 
-std::tuple<uint8_t, uint8_t, uint8_t, uint8_t, Ptr<AntennaArrayModel>, Ptr<AntennaArrayModel>, Vector,
-bool, bool, double>
-MmWave3gppChannel::GetTxRxInfo(Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
+const MmWave3gppChannel::DeviceDescriptor&
+MmWave3gppChannel::GetDeviceDescriptor (Ptr<Node> node) const
 {
-	Ptr<NetDevice> txDevice = a->GetObject<Node> ()->GetDevice (0);
-	Ptr<NetDevice> rxDevice = b->GetObject<Node> ()->GetDevice (0);
-
-	Ptr<MmWaveEnbNetDevice> txEnb =
-					DynamicCast<MmWaveEnbNetDevice> (txDevice);
-	Ptr<MmWaveEnbNetDevice> rxEnb = 
-					DynamicCast<MmWaveEnbNetDevice> (rxDevice);
-
-	uint8_t txAntennaNum[2];
-	uint8_t rxAntennaNum[2];
-	Ptr<AntennaArrayModel> txAntennaArray, rxAntennaArray;
+	uint32_t id = node->GetId ();
+	if (id >= m_devices.size ())
+	{
+		// all the existing nodes are added, so that the descriptors already
+		// returned for this link are not moved by the lookup of the other node
+		DeviceDescriptor unresolved;
+		unresolved.m_resolved = false;
+		unresolved.m_role = ROLE_OTHER;
+		unresolved.m_accessAntennaNum = 0;
+		unresolved.m_backhaulAntennaNum = 0;
+		m_devices.resize (std::max (id + 1, NodeList::GetNNodes ()), unresolved);
+	}
 
-	Vector locUT;
+	DeviceDescriptor &desc = m_devices.at (id);
+	if (desc.m_resolved)
+	{
+		return desc;
+	}
 
-	bool skipBf = true;
-	bool connectedPair = false;
+	desc.m_resolved = true;
+	desc.m_device = node->GetDevice (0);
 
-	double hBS = 0;
+	Ptr<MmWaveEnbNetDevice> enbDev = DynamicCast<MmWaveEnbNetDevice> (desc.m_device);
+	Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice> (desc.m_device);
+	Ptr<McUeNetDevice> mcDev = DynamicCast<McUeNetDevice> (desc.m_device);
+	Ptr<MmWaveIabNetDevice> iabDev = DynamicCast<MmWaveIabNetDevice> (desc.m_device);
 
-	// check if they are the same
-	if(txDevice == rxDevice)
+	if (enbDev != 0)
 	{
-		return std::make_tuple(0,0,0,0,txAntennaArray,rxAntennaArray,locUT, false, true, 0);
+		desc.m_role = ROLE_ENB;
+		desc.m_accessAntennaNum = sqrt (enbDev->GetAntennaNum ());
+		desc.m_accessAntenna = DynamicCast<AntennaArrayModel> (
+					enbDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
 	}
-
-	if(txEnb != 0 && rxEnb == 0)
+	else if (ueDev != 0)
 	{
-		// downlink tranmission from the eNB to something
-		Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice>(rxDevice);
-		Ptr<MmWaveIabNetDevice> iabDev = DynamicCast<MmWaveIabNetDevice>(rxDevice); // backhaul
-		Ptr<McUeNetDevice> mcDev = DynamicCast<McUeNetDevice>(rxDevice);
+		desc.m_role = ROLE_UE;
+		desc.m_accessAntennaNum = sqrt (ueDev->GetAntennaNum ());
+		desc.m_accessAntenna = DynamicCast<AntennaArrayModel> (
+					ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
+	}
+	else if (mcDev != 0)
+	{
+		desc.m_role = ROLE_MC_UE;
+		desc.m_accessAntennaNum = sqrt (mcDev->GetAntennaNum ());
+		desc.m_accessAntenna = DynamicCast<AntennaArrayModel> (
+					mcDev->GetMmWavePhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
+	}
+	else if (iabDev != 0)
+	{
+		desc.m_role = ROLE_IAB;
+		desc.m_accessAntennaNum = sqrt (iabDev->GetAccessAntennaNum ());
+		desc.m_accessAntenna = DynamicCast<AntennaArrayModel> (
+					iabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
+		desc.m_backhaulAntennaNum = sqrt (iabDev->GetBackhaulAntennaNum ());
+		desc.m_backhaulAntenna = DynamicCast<AntennaArrayModel> (
+					iabDev->GetBackhaulPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
+	}
+	NS_LOG_LOGIC ("Node " << id << " has role " << desc.m_role);
 
-		if(ueDev != 0)
-		{
-			// eNB to UE, downlink
-			NS_LOG_INFO ("this is downlink case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-			// downlink = true;
-			txAntennaNum[0] = sqrt (txEnb->GetAntennaNum ());
-			txAntennaNum[1] = sqrt (txEnb->GetAntennaNum ());
-			rxAntennaNum[0] = sqrt (ueDev->GetAntennaNum ());
-			rxAntennaNum[1] = sqrt (ueDev->GetAntennaNum ());
+	return desc;
+}
 
-			txAntennaArray = DynamicCast<AntennaArrayModel> (
-						txEnb->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			rxAntennaArray = DynamicCast<AntennaArrayModel> (
-						ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			locUT = b->GetPosition();
+const MmWave3gppChannel::LinkDescriptor&
+MmWave3gppChannel::GetLinkDescriptor (const DeviceDescriptor &tx, const DeviceDescriptor &rx,
+		uint32_t txId, uint32_t rxId) const
+{
+	if (txId >= m_linkTableSize || rxId >= m_linkTableSize)
+	{
+		// a node was created after the table was built, the links are resolved again
+		m_linkTableSize = std::max (std::max (txId, rxId) + 1, NodeList::GetNNodes ());
+		LinkDescriptor unresolved;
+		unresolved.m_type = LINK_UNRESOLVED;
+		unresolved.m_txBackhaul = false;
+		unresolved.m_rxBackhaul = false;
+		unresolved.m_setBsHeight = false;
+		m_links.assign (m_linkTableSize * m_linkTableSize, unresolved);
+	}
 
-			// check if the devices are connected
-			if(txEnb == ueDev->GetTargetEnb() && txAntennaArray->GetCurrentDevice() == ueDev)
- 			{
-				connectedPair = true;
-			}
-			skipBf = false;
+	LinkDescriptor &link = m_links[txId * m_linkTableSize + rxId];
+	if (link.m_type != LINK_UNRESOLVED)
+	{
+		return link;
+	}
 
-			hBS = a->GetPosition().z;
-		}
-		else if(iabDev != 0)
+	bool txBs = (tx.m_role == ROLE_ENB || tx.m_role == ROLE_IAB);
+	bool rxBs = (rx.m_role == ROLE_ENB || rx.m_role == ROLE_IAB);
+	if (txId == rxId || (!txBs && !rxBs) || (tx.m_role == ROLE_ENB && rx.m_role == ROLE_ENB))
+	{
+		// same device, UE to UE or eNB to eNB, not need to compute BF & stuff
+		link.m_type = LINK_SKIP;
+	}
+	else if (tx.m_role == ROLE_ENB)
+	{
+		// downlink from the eNB to something, the IABs use the backhaul
+		if (rx.m_role == ROLE_OTHER)
 		{
-			// wired eNB to IAB, downlink
-			NS_LOG_INFO ("this is downlink backhaul between eNB and IAB, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-			// downlink = true;
-			txAntennaNum[0] = sqrt (txEnb->GetAntennaNum ());
-			txAntennaNum[1] = sqrt (txEnb->GetAntennaNum ());
-			rxAntennaNum[0] = sqrt (iabDev->GetBackhaulAntennaNum ());
-			rxAntennaNum[1] = sqrt (iabDev->GetBackhaulAntennaNum ());
-
-			txAntennaArray = DynamicCast<AntennaArrayModel> (
-						txEnb->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			rxAntennaArray = DynamicCast<AntennaArrayModel> (
-						iabDev->GetBackhaulPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			locUT = b->GetPosition();
-
-			// check if the devices are connected
-			if(txEnb == iabDev->GetBackhaulTargetEnb() && txAntennaArray->GetCurrentDevice() == iabDev)
-			{
-				connectedPair = true;
-			}
-			skipBf = false;
-
-			hBS = a->GetPosition().z;
+			NS_FATAL_ERROR("Invalid case");
 		}
-		else if(mcDev != 0)
+		link.m_type = LINK_BS_TO_UT;
+		link.m_rxBackhaul = (rx.m_role == ROLE_IAB);
+		link.m_setBsHeight = true;
+	}
+	else if (rx.m_role == ROLE_ENB)
+	{
+		// uplink from something to the eNB
+		if (tx.m_role == ROLE_OTHER)
 		{
-			// eNB to MC UE, downlink
-			NS_LOG_INFO ("this is downlink between eNB and MC UE case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-			// downlink = true;
-			txAntennaNum[0] = sqrt (txEnb->GetAntennaNum ());
-			txAntennaNum[1] = sqrt (txEnb->GetAntennaNum ());
-			rxAntennaNum[0] = sqrt (mcDev->GetAntennaNum ());
-			rxAntennaNum[1] = sqrt (mcDev->GetAntennaNum ());
-
-			txAntennaArray = DynamicCast<AntennaArrayModel> (
-						txEnb->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			rxAntennaArray = DynamicCast<AntennaArrayModel> (
-						mcDev->GetMmWavePhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			locUT = b->GetPosition();
-
-			// check if the devices are connected
-			if(txEnb == mcDev->GetMmWaveTargetEnb() && txAntennaArray->GetCurrentDevice() == mcDev)
-			{
-				connectedPair = true;
-			}
-			skipBf = false;
-
-			hBS = a->GetPosition().z;
+			NS_FATAL_ERROR("Invalid case");
 		}
-		else
+		link.m_type = LINK_UT_TO_BS;
+		link.m_txBackhaul = (tx.m_role == ROLE_IAB);
+		link.m_setBsHeight = (tx.m_role != ROLE_IAB);
+	}
+	else if (tx.m_role == ROLE_IAB && rx.m_role == ROLE_IAB)
+	{
+		link.m_type = LINK_IAB_TO_IAB;
+		link.m_setBsHeight = true;
+	}
+	else if (tx.m_role == ROLE_IAB)
+	{
+		// downlink access for the IAB device
+		if (rx.m_role == ROLE_OTHER)
 		{
 			NS_FATAL_ERROR("Invalid case");
 		}
+		link.m_type = LINK_BS_TO_UT;
+		link.m_setBsHeight = true;
 	}
-	else if(rxEnb !=0 && txEnb == 0)
+	else
 	{
-		// uplink tranmission from something to the eNB
-		Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice>(txDevice);
-		Ptr<MmWaveIabNetDevice> iabDev = DynamicCast<MmWaveIabNetDevice>(txDevice); // backhaul
-		Ptr<McUeNetDevice> mcDev = DynamicCast<McUeNetDevice>(txDevice);
-
-		if(ueDev != 0)
+		// uplink from something to the IAB access
+		if (tx.m_role == ROLE_OTHER)
 		{
-			// UE to eNB, uplink
-			NS_LOG_INFO ("this is uplink case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-			// downlink = false;
-			rxAntennaNum[0] = sqrt (rxEnb->GetAntennaNum ());
-			rxAntennaNum[1] = sqrt (rxEnb->GetAntennaNum ());
-			txAntennaNum[0] = sqrt (ueDev->GetAntennaNum ());
-			txAntennaNum[1] = sqrt (ueDev->GetAntennaNum ());
-
-			rxAntennaArray = DynamicCast<AntennaArrayModel> (
-						rxEnb->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			txAntennaArray = DynamicCast<AntennaArrayModel> (
-						ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			locUT = a->GetPosition();
+			NS_FATAL_ERROR("Invalid case");
+		}
+		link.m_type = LINK_UT_TO_BS;
+		link.m_setBsHeight = true;
+	}
+	NS_LOG_LOGIC ("Link from node " << txId << " to node " << rxId << " has type " << (uint16_t) link.m_type);
 
-			// check if the devices are connected
-			if(rxEnb == ueDev->GetTargetEnb() && rxAntennaArray->GetCurrentDevice() == ueDev)
- 			{
-				connectedPair = true;
-			}
-			skipBf = false;
+	return link;
+}
 
-			hBS = b->GetPosition().z;
-		}
-		else if(iabDev != 0)
-		{
-			// IAB to wired eNB, uplink
-			NS_LOG_INFO ("this is uplink backhaul between eNB and IAB, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-			// downlink = true;
-			rxAntennaNum[0] = sqrt (rxEnb->GetAntennaNum ());
-			rxAntennaNum[1] = sqrt (rxEnb->GetAntennaNum ());
-			txAntennaNum[0] = sqrt (iabDev->GetBackhaulAntennaNum ());
-			txAntennaNum[1] = sqrt (iabDev->GetBackhaulAntennaNum ());
+Ptr<NetDevice>
+MmWave3gppChannel::GetTargetBs (const DeviceDescriptor &ut)
+{
+	switch (ut.m_role)
+	{
+	case ROLE_UE:
+		return StaticCast<MmWaveUeNetDevice> (ut.m_device)->GetTargetEnb ();
+	case ROLE_MC_UE:
+		return StaticCast<McUeNetDevice> (ut.m_device)->GetMmWaveTargetEnb ();
+	case ROLE_IAB:
+		return StaticCast<MmWaveIabNetDevice> (ut.m_device)->GetBackhaulTargetEnb ();
+	default:
+		return 0;
+	}
+}
 
-			rxAntennaArray = DynamicCast<AntennaArrayModel> (
-						rxEnb->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			txAntennaArray = DynamicCast<AntennaArrayModel> (
-						iabDev->GetBackhaulPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			locUT = a->GetPosition();
+std::tuple<uint8_t, uint8_t, uint8_t, uint8_t, Ptr<AntennaArrayModel>, Ptr<AntennaArrayModel>, Vector,
+bool, bool, double>
+MmWave3gppChannel::GetTxRxInfo(Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
+{
+	Ptr<Node> txNode = a->GetObject<Node> ();
+	Ptr<Node> rxNode = b->GetObject<Node> ();
+	const DeviceDescriptor &tx = GetDeviceDescriptor (txNode);
+	const DeviceDescriptor &rx = GetDeviceDescriptor (rxNode);
+	const LinkDescriptor &link = GetLinkDescriptor (tx, rx, txNode->GetId (), rxNode->GetId ());
 
-			// check if the devices are connected
-			if(rxEnb == iabDev->GetBackhaulTargetEnb() && rxAntennaArray->GetCurrentDevice() == iabDev)
-			{
-				connectedPair = true;
-			}
-			skipBf = false;
-		}
-		else if(mcDev != 0)
-		{
-			// MC UE to eNB, uplink
-			NS_LOG_INFO ("this is uplink between eNB and MC UE case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-			// downlink = true;
-			rxAntennaNum[0] = sqrt (rxEnb->GetAntennaNum ());
-			rxAntennaNum[1] = sqrt (rxEnb->GetAntennaNum ());
-			txAntennaNum[0] = sqrt (mcDev->GetAntennaNum ());
-			txAntennaNum[1] = sqrt (mcDev->GetAntennaNum ());
+	if (link.m_type == LINK_SKIP)
+	{
+		return std::make_tuple(0,0,0,0,Ptr<AntennaArrayModel> (),Ptr<AntennaArrayModel> (),Vector (), false, true, 0);
+	}
 
-			rxAntennaArray = DynamicCast<AntennaArrayModel> (
-						rxEnb->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			txAntennaArray = DynamicCast<AntennaArrayModel> (
-						mcDev->GetMmWavePhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-			locUT = a->GetPosition();
+	bool txBackhaul = link.m_txBackhaul;
+	bool rxBackhaul = link.m_rxBackhaul;
+	// the BS side and the UT side of the link
+	const DeviceDescriptor *bs = &tx;
+	const DeviceDescriptor *ut = &rx;
+	Vector locUT = b->GetPosition();
+	double hBS = a->GetPosition().z;
 
-			// check if the devices are connected
-			if(rxEnb == mcDev->GetMmWaveTargetEnb() && rxAntennaArray->GetCurrentDevice() == mcDev)
-			{
-				connectedPair = true;
-			}
-			skipBf = false;
-			hBS = b->GetPosition().z;
-		}
-		else
-		{
-			NS_FATAL_ERROR("Invalid case");
-		}
+	if (link.m_type == LINK_UT_TO_BS)
+	{
+		bs = &rx;
+		ut = &tx;
+		locUT = a->GetPosition();
+		hBS = link.m_setBsHeight ? b->GetPosition().z : 0;
 	}
-	else if(rxEnb != 0 && txEnb !=0)
+	else if (link.m_type == LINK_IAB_TO_IAB && GetTargetBs (rx) != tx.m_device)
 	{
-		skipBf = true; // eNB to eNB, not need to compute BF & stuff
+		// uplink from backhaul to access or interference between IABs
+		txBackhaul = true;
+		rxBackhaul = false;
 	}
-	else // both 0 -> it could be an IAB link
+	else if (link.m_type == LINK_IAB_TO_IAB)
 	{
-		// all the cases with the IAB as the access
-
-		Ptr<MmWaveIabNetDevice> txIabDev = DynamicCast<MmWaveIabNetDevice>(txDevice);
-
-		if(txIabDev != 0)
-		{
-			// downlink access for the IAB device
-			Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice>(rxDevice);
-			Ptr<MmWaveIabNetDevice> rxIabDev = DynamicCast<MmWaveIabNetDevice>(rxDevice);
-			Ptr<McUeNetDevice> mcDev = DynamicCast<McUeNetDevice>(rxDevice);
-
-			if(ueDev != 0)
-			{
-				// IAB to UE, downlink
-				NS_LOG_INFO ("this is downlink case in the IAB access, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-				// downlink = true;
-				txAntennaNum[0] = sqrt (txIabDev->GetAccessAntennaNum ());
-				txAntennaNum[1] = sqrt (txIabDev->GetAccessAntennaNum ());
-				rxAntennaNum[0] = sqrt (ueDev->GetAntennaNum ());
-				rxAntennaNum[1] = sqrt (ueDev->GetAntennaNum ());
-
-				txAntennaArray = DynamicCast<AntennaArrayModel> (
-							txIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-				rxAntennaArray = DynamicCast<AntennaArrayModel> (
-							ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-				locUT = b->GetPosition();
-
-				// check if the devices are connected
-				if(txIabDev == ueDev->GetTargetEnb() && txAntennaArray->GetCurrentDevice() == ueDev) 
-	 			{
-					connectedPair = true;
-				}
-				skipBf = false;
-				hBS = a->GetPosition().z;
-			}
-			else if(rxIabDev != 0)
-			{
-				// IAB to IAB
-				// we need to check if it is a downlink case (from IAB access to IAB backhaul)
-				// or an uplink case (from IAB backhaul to IAB access)
-				if(rxIabDev->GetBackhaulTargetEnb() == txIabDev) // downlink from access to backhaul
-				{
-					NS_LOG_INFO ("this is downlink backhaul between IAB and IAB, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-					txAntennaNum[0] = sqrt (txIabDev->GetAccessAntennaNum ());
-					txAntennaNum[1] = sqrt (txIabDev->GetAccessAntennaNum ());
-					rxAntennaNum[0] = sqrt (rxIabDev->GetBackhaulAntennaNum ());
-					rxAntennaNum[1] = sqrt (rxIabDev->GetBackhaulAntennaNum ());
-
-					txAntennaArray = DynamicCast<AntennaArrayModel> (
-								txIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					rxAntennaArray = DynamicCast<AntennaArrayModel> (
-								rxIabDev->GetBackhaulPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					locUT = b->GetPosition();
-
-					// check if the devices are connected
-					if(txIabDev == rxIabDev->GetBackhaulTargetEnb() && txAntennaArray->GetCurrentDevice() == rxIabDev)
-					{
-						connectedPair = true;
-					}
-					skipBf = false;
-					hBS = a->GetPosition().z;
-				}
-				else // uplink from backhaul to access or downlink interference or uplink interference
-				{
-					NS_LOG_INFO ("this is uplink backhaul between IAB and IAB (or interference), a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-					txAntennaNum[0] = sqrt (txIabDev->GetBackhaulAntennaNum ());
-					txAntennaNum[1] = sqrt (txIabDev->GetBackhaulAntennaNum ());
-					rxAntennaNum[0] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					rxAntennaNum[1] = sqrt (rxIabDev->GetAccessAntennaNum ());
-
-					txAntennaArray = DynamicCast<AntennaArrayModel> (
-								txIabDev->GetBackhaulPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					rxAntennaArray = DynamicCast<AntennaArrayModel> (
-								rxIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					locUT = b->GetPosition();
-
-					// check if the devices are connected
-					if(txIabDev == rxIabDev->GetBackhaulTargetEnb() && txAntennaArray->GetCurrentDevice() == rxIabDev)
-					{
-						connectedPair = true;
-					}
-					skipBf = false;
-					hBS = a->GetPosition().z;
-				}
-
-			}
-			else if(mcDev != 0)
-			{
-				// eNB to MC UE, downlink
-				NS_LOG_INFO ("this is downlink between IAB and MC UE case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-				// downlink = true;
-				txAntennaNum[0] = sqrt (txIabDev->GetAccessAntennaNum ());
-				txAntennaNum[1] = sqrt (txIabDev->GetAccessAntennaNum ());
-				rxAntennaNum[0] = sqrt (mcDev->GetAntennaNum ());
-				rxAntennaNum[1] = sqrt (mcDev->GetAntennaNum ());
-
-				txAntennaArray = DynamicCast<AntennaArrayModel> (
-							txIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-				rxAntennaArray = DynamicCast<AntennaArrayModel> (
-							mcDev->GetMmWavePhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-				locUT = b->GetPosition();
+		// downlink from access to backhaul
+		rxBackhaul = true;
+	}
 
-				// check if the devices are connected
-				if(txIabDev == mcDev->GetMmWaveTargetEnb() && txAntennaArray->GetCurrentDevice() == mcDev)
-				{
-					connectedPair = true;
-				}
-				skipBf = false;
-				hBS = a->GetPosition().z;				
-			}
-			else
-			{
-				NS_FATAL_ERROR("Invalid case");
-			}
-		}
-		else
-		{
-			// uplink access for IAB
-			Ptr<MmWaveIabNetDevice> rxIabDev = DynamicCast<MmWaveIabNetDevice>(rxDevice); 
+	uint8_t txNum = txBackhaul ? tx.m_backhaulAntennaNum : tx.m_accessAntennaNum;
+	uint8_t rxNum = rxBackhaul ? rx.m_backhaulAntennaNum : rx.m_accessAntennaNum;
+	Ptr<AntennaArrayModel> txAntennaArray = txBackhaul ? tx.m_backhaulAntenna : tx.m_accessAntenna;
+	Ptr<AntennaArrayModel> rxAntennaArray = rxBackhaul ? rx.m_backhaulAntenna : rx.m_accessAntenna;
+	Ptr<AntennaArrayModel> bsAntennaArray = (bs == &tx) ? txAntennaArray : rxAntennaArray;
 
-			if(rxIabDev != 0)
-			{
-				// uplink tranmission from something to the IAB access
-				Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice>(txDevice);
-				Ptr<MmWaveIabNetDevice> iabDev = DynamicCast<MmWaveIabNetDevice>(txDevice);
-				Ptr<McUeNetDevice> mcDev = DynamicCast<McUeNetDevice>(txDevice);
+	NS_LOG_INFO ("link of type " << (uint16_t) link.m_type << " a tx " << a->GetPosition() << " b rx " << b->GetPosition());
 
-				if(ueDev != 0)
-				{
-					// UE to IAB access, uplink
-					NS_LOG_INFO ("this is uplink case for IAB device, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-					// downlink = true;
-					rxAntennaNum[0] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					rxAntennaNum[1] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					txAntennaNum[0] = sqrt (ueDev->GetAntennaNum ());
-					txAntennaNum[1] = sqrt (ueDev->GetAntennaNum ());
-
-					rxAntennaArray = DynamicCast<AntennaArrayModel> (
-								rxIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					txAntennaArray = DynamicCast<AntennaArrayModel> (
-								ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					locUT = a->GetPosition();
-
-					// check if the devices are connected
-					if(rxIabDev == ueDev->GetTargetEnb() && rxAntennaArray->GetCurrentDevice() == ueDev)
-		 			{
-						connectedPair = true;
-					}
-					skipBf = false;
-					hBS = b->GetPosition().z;
-				}
-				else if(iabDev != 0)
-				{
-					NS_FATAL_ERROR("This case should never happen here, but in the previous if");
-
-					// // IAB to IAB, uplink
-					// NS_LOG_INFO ("this is uplink backhaul between IAB and IAB, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-					// // downlink = true;
-					// rxAntennaNum[0] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					// rxAntennaNum[1] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					// txAntennaNum[0] = sqrt (iabDev->GetBackhaulAntennaNum ());
-					// txAntennaNum[1] = sqrt (iabDev->GetBackhaulAntennaNum ());
-
-					// rxAntennaArray = DynamicCast<AntennaArrayModel> (
-					// 			rxIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					// txAntennaArray = DynamicCast<AntennaArrayModel> (
-					// 			iabDev->GetBackhaulPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					// locUT = a->GetPosition();
-
-					// // check if the devices are connected
-					// if(rxIabDev == iabDev->GetBackhaulTargetEnb() && rxAntennaArray->GetCurrentDevice() == iabDev)
-					// {
-					// 	connectedPair = true;
-					// }
-					// skipBf = false;
-					// hBS = b->GetPosition().z;
-				}
-				else if(mcDev != 0)
-				{
-					// MC UE to eNB, uplink
-					NS_LOG_INFO ("this is uplink between IAB and MC UE case, a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-					// downlink = true;
-					rxAntennaNum[0] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					rxAntennaNum[1] = sqrt (rxIabDev->GetAccessAntennaNum ());
-					txAntennaNum[0] = sqrt (mcDev->GetAntennaNum ());
-					txAntennaNum[1] = sqrt (mcDev->GetAntennaNum ());
-
-					rxAntennaArray = DynamicCast<AntennaArrayModel> (
-								rxIabDev->GetAccessPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					txAntennaArray = DynamicCast<AntennaArrayModel> (
-								mcDev->GetMmWavePhy ()->GetDlSpectrumPhy ()->GetRxAntenna ());
-					locUT = a->GetPosition();
-
-					// check if the devices are connected
-					if(rxIabDev == mcDev->GetMmWaveTargetEnb() && rxAntennaArray->GetCurrentDevice() == mcDev)
-					{
-						connectedPair = true;
-					}
-					skipBf = false;
-					hBS = b->GetPosition().z;
-				}
-				else
-				{
-					NS_FATAL_ERROR("Invalid case");
-				}
-			}
-		}
-	}
+	// check if the devices are connected
+	bool connectedPair = GetTargetBs (*ut) == bs->m_device && bsAntennaArray->GetCurrentDevice() == ut->m_device;
 
-	return std::make_tuple(txAntennaNum[0], txAntennaNum[1], rxAntennaNum[0], rxAntennaNum[1], txAntennaArray, rxAntennaArray, locUT, connectedPair, skipBf, hBS);
+	return std::make_tuple(txNum, txNum, rxNum, rxNum, txAntennaArray, rxAntennaArray, locUT, connectedPair, false, hBS);
 }
 
 
@@ -869,6 +699,34 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 	NS_LOG_FUNCTION (this);
 	Ptr<SpectrumValue> rxPsd = Copy (txPsd);
 
+	BeamformingGainJob job;
+	if (!PrepareBeamformingGain (a, b, job))
+	{
+		return rxPsd;
+	}
+
+	Ptr<SpectrumValue> bfPsd = Copy<SpectrumValue> (rxPsd);
+	ApplyBeamformingGain (job, &(*bfPsd->ValuesBegin ()), bfPsd->GetSpectrumModel ()->GetNumBands ());
+
+	SpectrumValue bfGain = (*bfPsd)/(*rxPsd);
+	uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
+	if (job.m_reverseLink == false)
+	{
+		NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain)/nbands << " RX PSD " << Sum(*rxPsd)/nbands); // print avg bf gain
+	}
+	else
+	{
+		NS_LOG_DEBUG ("****** UL BF gain == " << Sum (bfGain)/nbands << " RX PSD " << Sum(*rxPsd)/nbands);
+	}
+	return bfPsd;
+}
+
+bool
+MmWave3gppChannel::PrepareBeamformingGain (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b,
+		BeamformingGainJob &job) const
+{
+	NS_LOG_FUNCTION (this);
+
 	Ptr<NetDevice> txDevice = a->GetObject<Node> ()->GetDevice (0);
 	Ptr<NetDevice> rxDevice = b->GetObject<Node> ()->GetDevice (0);
 
@@ -896,13 +754,13 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 	if(skipBf)
 	{
 		NS_LOG_INFO ("enb to enb or ue to ue transmission, skip beamforming a tx " << a->GetPosition() << " b rx " << b->GetPosition());
-		return rxPsd;
+		return false;
 	}
 
 	if(txAntennaArray->IsOmniTx() || rxAntennaArray->IsOmniTx() )
 	{
 		//omi transmission, do nothing.
-		return rxPsd;
+		return false;
 	}
 
 	NS_ASSERT_MSG(a->GetDistanceFrom(b)!=0, "the position of tx and rx devices cannot be the same");
@@ -914,6 +772,8 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 	key_t key = std::make_pair(txDevice,rxDevice);
 	key_t keyReverse = std::make_pair(rxDevice,txDevice);
 
+	// the refresh event of this time may run after this transmission
+	ExpireChannels ();
 	std::map< key_t, Ptr<Params3gpp> >::iterator it = m_channelMap.find (key);
 	std::map< key_t, Ptr<Params3gpp> >::iterator itReverse = m_channelMap.find (keyReverse);
 
@@ -961,13 +821,13 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 
 	//I only update the fowrad channel.
 	if ((it == m_channelMap.end () && itReverse == m_channelMap.end ()) ||
-			(it != m_channelMap.end () && it->second->m_channel.size() == 0)||
+			(it != m_channelMap.end () && it->second->m_channel.IsEmpty ())||
 			(it != m_channelMap.end () && it->second->m_los != los))
 	{
 		NS_LOG_INFO("Update or create the forward channel");
 		NS_LOG_LOGIC("it == m_channelMap.end () " << (it == m_channelMap.end ()));
 		NS_LOG_LOGIC("itReverse == m_channelMap.end () " << (itReverse == m_channelMap.end ()));
-		NS_LOG_LOGIC("it->second->m_channel.size() == 0 " << (it->second->m_channel.size() == 0));
+		NS_LOG_LOGIC("it->second->m_channel.IsEmpty () " << (it->second->m_channel.IsEmpty ()));
 		NS_LOG_LOGIC("it->second->m_los != los" << (it->second->m_los != los));
 		
 		//Step 1: The parameters are configured in the example code.
@@ -990,21 +850,21 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 
 		// Step 4-11 are performed in function GetNewChannel()
 		if((it == m_channelMap.end () && itReverse == m_channelMap.end ()) ||
-				(it != m_channelMap.end () && it->second->m_channel.size() == 0))
+				(it != m_channelMap.end () && it->second->m_channel.IsEmpty ()))
 		{
 			//delete the channel parameter to cause the channel to be updated again.
 			//The m_updatePeriod can be configured to be relatively large in order to disable updates.
 			if(m_updatePeriod.GetMilliSeconds() > 0)
 			{
 				NS_LOG_INFO("Time " << Simulator::Now().GetSeconds() << " schedule delete for a " << a->GetPosition() << " b " << b->GetPosition());
-				Simulator::Schedule (m_updatePeriod, &MmWave3gppChannel::DeleteChannel,this,a,b);
+				ScheduleChannelRefresh (key);
 			}
 		}
 
 		double distance3D = a->GetDistanceFrom(b);
 
 		bool channelUpdate = false;
-		if(it != m_channelMap.end () && it->second->m_channel.size() == 0)
+		if(it != m_channelMap.end () && it->second->m_channel.IsEmpty ())
 		{
 			//if the channel map is not empty, we only update the channel.
 			NS_LOG_DEBUG ("Update forward channel consistently between device " << a << " " << b);
@@ -1026,6 +886,13 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 			NS_LOG_INFO("Create new channel");
 			channelParams = GetNewChannel(table3gpp, locUT, los, o2i, txAntennaArray, rxAntennaArray,
 					txAntennaNum, rxAntennaNum, rxAngle, txAngle, relativeSpeed, distance2D, distance3D);
+			if (it != m_channelMap.end ())
+			{
+				// LOS/NLOS switch: the BF vectors of the previous channel of this link
+				// are the starting point of the power method
+				channelParams->m_txEigenW = it->second->m_txEigenW;
+				channelParams->m_rxEigenW = it->second->m_rxEigenW;
+			}
 		}
 		
 		// the connected pair is set in the GetTxRxInfo method
@@ -1080,7 +947,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 				" channelUpdate " << channelUpdate);
 			if(m_cellScan)
 			{
-				BeamSearchBeamforming (rxPsd, channelParams,txAntennaArray,rxAntennaArray, txAntennaNum, rxAntennaNum);
+				BeamSearchBeamforming (channelParams,txAntennaArray,rxAntennaArray, txAntennaNum, rxAntennaNum);
 			}
 			else
 			{
@@ -1099,7 +966,7 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 				NS_LOG_INFO("channelParams->m_txW.size() == 0 " << (channelParams->m_txW.size() == 0));
 				NS_LOG_INFO("channelParams->m_rxW.size() == 0 " << (channelParams->m_rxW.size() == 0));
 				m_channelMap[key] = channelParams;
-				return rxPsd;
+				return false;
 			}
 		}
 
@@ -1116,224 +983,192 @@ MmWave3gppChannel::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
 		channelParams = (*itReverse).second;
 	}
 
-	Ptr<SpectrumValue> bfPsd = CalBeamformingGain(rxPsd, channelParams, relativeSpeed);
-
-	SpectrumValue bfGain = (*bfPsd)/(*rxPsd);
-	uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-	if (reverseLink == false)
-	{
-		NS_LOG_DEBUG ("****** DL BF gain == " << Sum (bfGain)/nbands << " RX PSD " << Sum(*rxPsd)/nbands); // print avg bf gain
-	}
-	else
+	//the update of Doppler is simplified by only taking the center angle of each cluster in to consideration.
+	uint8_t numCluster = channelParams->m_delay.size();
+	double slotTime = Simulator::Now ().GetSeconds ();
+	job.m_clusterGain.clear ();
+	for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
 	{
-		NS_LOG_DEBUG ("****** UL BF gain == " << Sum (bfGain)/nbands << " RX PSD " << Sum(*rxPsd)/nbands);
-	}
-	return bfPsd;
+		//cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
+		double temp_doppler = 2*M_PI*(sin(channelParams->m_angle.at(ZOA_INDEX).at(cIndex)*M_PI/180)*cos(channelParams->m_angle.at(AOA_INDEX).at(cIndex)*M_PI/180)*relativeSpeed.x
+				+ sin(channelParams->m_angle.at(ZOA_INDEX).at(cIndex)*M_PI/180)*sin(channelParams->m_angle.at(AOA_INDEX).at(cIndex)*M_PI/180)*relativeSpeed.y
+				+ cos(channelParams->m_angle.at(ZOA_INDEX).at(cIndex)*M_PI/180)*relativeSpeed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
+		job.m_clusterGain.push_back(channelParams->m_longTerm.at(cIndex)*exp(std::complex<double> (0, temp_doppler)));
+	}
+	job.m_params = channelParams;
+	job.m_f0 = m_phyMacConfig->GetCenterFrequency () - GetSystemBandwidth ()/2;
+	job.m_df = m_phyMacConfig->GetChunkWidth ();
+	job.m_reverseLink = reverseLink;
+	return true;
 }
 
-void
-MmWave3gppChannel::LongTermCovMatrixBeamforming(Ptr<Params3gpp> params) const
-{
-	//generate transmitter side spatial correlation matrix
-	uint8_t txSize = params->m_channel.at(0).size();
-	uint8_t rxSize = params->m_channel.size();
-	complex2DVector_t txQ;
-	txQ.resize(txSize);
+/**
+ * Build the spatial correlation matrix of one side of the link, i.e.,
+ * txQ = sum_n H_n^H H_n (txSide = true) or rxQ = sum_n H_n H_n^H (txSide = false).
+ * The matrix is Hermitian, so only the upper triangle is computed, in blocks of
+ * CORR_BLOCK columns which share the loads of the row they are correlated with,
+ * and the lower triangle is filled with the conjugate.
+ */
+static const uint8_t CORR_BLOCK = 4;
 
-	for (uint8_t txIndex = 0; txIndex < txSize; txIndex++)
-	{
-		txQ.at(txIndex).resize(txSize);
-	}
+static void
+BuildCorrelationMatrix (const ComplexTensor &channel, bool txSide, ComplexTensor &q)
+{
+	//channel[rx][tx][cluster]
+	std::size_t size = channel.GetDimSize (txSide ? 1 : 0);
+	std::size_t otherSize = channel.GetDimSize (txSide ? 0 : 1);
+	std::size_t numCluster = channel.GetDimSize (2);
+	q.Resize (size, size);
 
-	//compute the transmitter side spatial correlation matrix txQ = H*H, where H is the sum of H_n over n clusters.
-	for (uint8_t t1Index = 0; t1Index < txSize; t1Index++)
+	// g[i][j] = sum_k sum_n conj(h_ik[n])*h_jk[n], where i,j index the antennas of
+	// the side of interest and k those of the other side
+	for (std::size_t k = 0; k < otherSize; k++)
 	{
-		for (uint8_t t2Index = 0; t2Index < txSize; t2Index++)
+		for (std::size_t i = 0; i < size; i++)
 		{
-			for(uint8_t rxIndex = 0; rxIndex < rxSize; rxIndex++)
+			const std::complex<double> *h1 = txSide ? channel.GetRow (k, i) : channel.GetRow (i, k);
+			std::complex<double> *g = q.GetRow (i);
+			std::size_t j = i;
+			for (; j + CORR_BLOCK <= size; j += CORR_BLOCK)
 			{
-				std::complex<double> cSum (0,0);
-				for (uint8_t cIndex = 0; cIndex < params->m_channel.at(rxIndex).at(t1Index).size(); cIndex++)
+				const std::complex<double> *h2[CORR_BLOCK];
+				std::complex<double> cSum[CORR_BLOCK];
+				for (uint8_t b = 0; b < CORR_BLOCK; b++)
 				{
-					cSum = cSum + std::conj(params->m_channel.at(rxIndex).at(t1Index).at(cIndex))*
-							(params->m_channel.at(rxIndex).at(t2Index).at(cIndex));
+					h2[b] = txSide ? channel.GetRow (k, j + b) : channel.GetRow (j + b, k);
+					cSum[b] = std::complex<double> (0,0);
+				}
+				for (std::size_t cIndex = 0; cIndex < numCluster; cIndex++)
+				{
+					std::complex<double> h1Conj = std::conj (h1[cIndex]);
+					for (uint8_t b = 0; b < CORR_BLOCK; b++)
+					{
+						cSum[b] = cSum[b] + h1Conj*h2[b][cIndex];
+					}
+				}
+				for (uint8_t b = 0; b < CORR_BLOCK; b++)
+				{
+					g[j + b] += cSum[b];
 				}
-				txQ[t1Index][t2Index] += cSum;
 			}
-
-		}
-	}
-
-
-	//calculate beamforming vector from spatial correlation matrix.
-	complexVector_t antennaWeights;
-	uint8_t txAntenna = txQ.size ();
-	for (uint8_t eIndex = 0; eIndex < txAntenna; eIndex++)
-	{
-		antennaWeights.push_back(txQ.at (0).at (eIndex));
-	}
-
-
-	int iter = 10;
-	double diff = 1;
-	while(iter != 0 && diff>1e-10)
-	{
-		complexVector_t antennaWeights_New;
-
-		for(uint8_t row = 0; row<txAntenna; row++)
-		{
-			std::complex<double> sum(0,0);
-			for (uint8_t col = 0; col< txAntenna; col++)
+			for (; j < size; j++)
 			{
-				sum += txQ.at (row).at (col)*antennaWeights.at (col);
+				const std::complex<double> *h2 = txSide ? channel.GetRow (k, j) : channel.GetRow (j, k);
+				std::complex<double> cSum (0,0);
+				for (std::size_t cIndex = 0; cIndex < numCluster; cIndex++)
+				{
+					cSum = cSum + std::conj (h1[cIndex])*h2[cIndex];
+				}
+				g[j] += cSum;
 			}
-
-		    antennaWeights_New.push_back(sum);
-		}
-		//normalize antennaWeights;
-		double weightSum = 0;
-		for (uint8_t i = 0; i< txAntenna; i++)
-		{
-			weightSum += norm(antennaWeights_New. at(i));
 		}
-		for (uint8_t i = 0; i< txAntenna; i++)
-		{
-			antennaWeights_New. at(i) = antennaWeights_New. at(i)/sqrt(weightSum);
-		}
-		diff = 0;
-		for (uint8_t i = 0; i< txAntenna; i++)
-		{
-			diff += std::norm(antennaWeights_New. at(i)-antennaWeights. at(i));
-		}
-		iter--;
-		antennaWeights = antennaWeights_New;
-	}
-
-	params->m_txW = antennaWeights;
-
-	//compute the receiver side spatial correlation matrix rxQ = HH*, where H is the sum of H_n over n clusters.
-	complex2DVector_t rxQ;
-	rxQ.resize(rxSize);
-	for (uint8_t r1Index = 0; r1Index < rxSize; r1Index++)
-	{
-		rxQ.at(r1Index).resize(rxSize);
 	}
 
-	for (uint8_t r1Index = 0; r1Index < rxSize; r1Index++)
+	// txQ = g, rxQ = conj(g)
+	for (std::size_t i = 0; i < size; i++)
 	{
-		for (uint8_t r2Index = 0; r2Index < rxSize; r2Index++)
+		for (std::size_t j = i; j < size; j++)
 		{
-			for(uint8_t txIndex = 0; txIndex < txSize; txIndex++)
-            {
-				std::complex<double> cSum (0,0);
-				for (uint8_t cIndex = 0; cIndex < params->m_channel.at(r1Index).at(txIndex).size(); cIndex++)
-				{
-					cSum = cSum + params->m_channel.at(r1Index).at(txIndex).at(cIndex)*
-							std::conj(params->m_channel.at(r2Index).at(txIndex).at(cIndex));
-				}
-				rxQ[r1Index][r2Index] += cSum;
-            }
-
+			std::complex<double> upper = txSide ? q (i, j) : std::conj (q (i, j));
+			q (i, j) = upper;
+			q (j, i) = std::conj (upper);
 		}
 	}
+}
 
-	//calculate beamforming vector from spatial correlation matrix.
-	antennaWeights.clear();
-	uint8_t rxAntenna = rxQ.size ();
-	for (uint8_t eIndex = 0; eIndex < rxAntenna; eIndex++)
+/**
+ * Power method for the dominant eigenvector of the Hermitian matrix q.
+ * If w already has the right size (e.g., it is the eigenvector computed for a
+ * previous realization of the same link) it is used as the starting point,
+ * otherwise the iteration starts from the first row of q.
+ */
+static void
+DominantEigenvector (const ComplexTensor &q, complexVector_t &w)
+{
+	std::size_t size = q.GetNumRows ();
+	if (w.size () != size)
 	{
-		antennaWeights.push_back(rxQ.at (0).at (eIndex));
+		w.assign (q.GetRow (0), q.GetRow (0) + size);
 	}
+	complexVector_t wNew (size);
 
-	iter = 10;
-	diff = 1;
-	while(iter != 0 && diff>1e-10)
+	int iter = 10;
+	double diff = 1;
+	while (iter != 0 && diff > 1e-10)
 	{
-		complexVector_t antennaWeights_New;
-
-		for(uint8_t row = 0; row<rxAntenna; row++)
+		for (std::size_t row = 0; row < size; row++)
 		{
-			std::complex<double> sum(0,0);
-			for (uint8_t col = 0; col< rxAntenna; col++)
+			const std::complex<double> *qRow = q.GetRow (row);
+			std::complex<double> sum (0,0);
+			for (std::size_t col = 0; col < size; col++)
 			{
-				sum += rxQ.at (row).at (col)*antennaWeights.at (col);
+				sum += qRow[col]*w[col];
 			}
-
-		    antennaWeights_New.push_back(sum);
+			wNew[row] = sum;
 		}
-
 		//normalize antennaWeights;
 		double weightSum = 0;
-		for (uint8_t i = 0; i< rxAntenna; i++)
+		for (std::size_t i = 0; i < size; i++)
 		{
-			weightSum += norm(antennaWeights_New. at(i));
-		}
-		for (uint8_t i = 0; i< rxAntenna; i++)
-		{
-			antennaWeights_New. at(i) = antennaWeights_New. at(i)/sqrt(weightSum);
+			weightSum += norm (wNew[i]);
 		}
+		double weightNorm = sqrt (weightSum);
 		diff = 0;
-		for (uint8_t i = 0; i< rxAntenna; i++)
+		for (std::size_t i = 0; i < size; i++)
 		{
-			diff += std::norm(antennaWeights_New. at(i)-antennaWeights. at(i));
+			wNew[i] = wNew[i]/weightNorm;
+			diff += std::norm (wNew[i] - w[i]);
 		}
 		iter--;
-		antennaWeights = antennaWeights_New;
+		w.swap (wNew);
 	}
-
-	params->m_rxW = antennaWeights;
 }
 
-Ptr<SpectrumValue>
-MmWave3gppChannel::CalBeamformingGain (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Vector speed) const
+void
+MmWave3gppChannel::LongTermCovMatrixBeamforming(Ptr<Params3gpp> params) const
 {
-	NS_LOG_FUNCTION (this);
-
-	Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue> (txPsd);
-
-	//NS_ASSERT_MSG (params->m_delay.size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and delay spread should be the same");
-	//NS_ASSERT_MSG (params->m_txW.size()==params->m_channel.at(0).size(), "the tx antenna size of channel and antenna weights should be the same");
-	//NS_ASSERT_MSG (params->m_rxW.size()==params->m_channel.size(), "the rx antenna size of channel and antenna weights should be the same");
-	//NS_ASSERT_MSG (params->m_angle.at(0).size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and AOA should be the same");
-	//NS_ASSERT_MSG (params->m_angle.at(1).size()==params->m_channel.at(0).at(0).size(), "the cluster number of channel and ZOA should be the same");
+	// the eigenvectors only depend on the channel matrix, which does not change
+	// until the channel is updated at a new m_generatedTime
+	if (params->m_eigenGeneratedTime == params->m_generatedTime
+			&& !params->m_txEigenW.empty () && !params->m_rxEigenW.empty ())
+	{
+		NS_LOG_LOGIC ("Channel generated at " << params->m_generatedTime.GetSeconds () << " unchanged, reuse the BF vectors");
+		params->m_txW = params->m_txEigenW;
+		params->m_rxW = params->m_rxEigenW;
+		return;
+	}
+
+	//generate transmitter side spatial correlation matrix txQ = H*H, where H is the sum of H_n over n clusters,
+	//and the receiver side spatial correlation matrix rxQ = HH*
+	ComplexTensor txQ;
+	BuildCorrelationMatrix (params->m_channel, true, txQ);
+	ComplexTensor rxQ;
+	BuildCorrelationMatrix (params->m_channel, false, rxQ);
+
+	//calculate beamforming vectors from spatial correlation matrix, warm started from the previous ones.
+	DominantEigenvector (txQ, params->m_txEigenW);
+	DominantEigenvector (rxQ, params->m_rxEigenW);
+	params->m_eigenGeneratedTime = params->m_generatedTime;
+
+	params->m_txW = params->m_txEigenW;
+	params->m_rxW = params->m_rxEigenW;
+}
 
-	//channel[rx][tx][cluster]
-	uint8_t numCluster = params->m_delay.size();
-	//uint8_t txAntenna = params->m_txW.size();
-	//uint8_t rxAntenna = params->m_rxW.size();
-	//the update of Doppler is simplified by only taking the center angle of each cluster in to consideration.
-	Values::iterator vit = tempPsd->ValuesBegin ();
-	uint16_t iSubband = 0;
-	double slotTime = Simulator::Now ().GetSeconds ();
-	complexVector_t doppler;
-	for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+void
+MmWave3gppChannel::ApplyBeamformingGain (const BeamformingGainJob &job, double *psd, uint32_t numBands) const
+{
+	//the subbands are evaluated by MmWaveBeamformingGainKernel, which applies the delay of each cluster
+	//to the center frequency of each subband
+	std::size_t numCluster = job.m_clusterGain.size ();
+	if (numCluster > 0 && numBands > 0)
 	{
-		//cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
-		double temp_doppler = 2*M_PI*(sin(params->m_angle.at(ZOA_INDEX).at(cIndex)*M_PI/180)*cos(params->m_angle.at(AOA_INDEX).at(cIndex)*M_PI/180)*speed.x
-				+ sin(params->m_angle.at(ZOA_INDEX).at(cIndex)*M_PI/180)*sin(params->m_angle.at(AOA_INDEX).at(cIndex)*M_PI/180)*speed.y
-				+ cos(params->m_angle.at(ZOA_INDEX).at(cIndex)*M_PI/180)*speed.z)*slotTime*m_phyMacConfig->GetCenterFrequency ()/3e8;
-		doppler.push_back(exp(std::complex<double> (0, temp_doppler)));
-
+		MmWaveBeamformingGainKernel::Compute (m_bfGainKernel, &job.m_clusterGain[0], &job.m_params->m_delay[0], numCluster,
+				job.m_f0, job.m_df, psd, psd, numBands);
 	}
-
-	while (vit != tempPsd->ValuesEnd ())
+	else
 	{
-		std::complex<double> subsbandGain (0.0,0.0);
-		if ((*vit) != 0.00)
-		{
-			double fsb = m_phyMacConfig->GetCenterFrequency () - GetSystemBandwidth ()/2 + m_phyMacConfig->GetChunkWidth ()*iSubband ;
-			for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
-			{
-				double delay = -2*M_PI*fsb*(params->m_delay.at (cIndex));
-				std::complex<double> txSum(0,0);
-				subsbandGain = subsbandGain + params->m_longTerm.at(cIndex)*doppler.at(cIndex)*exp(std::complex<double>(0, delay));
-			}
-			*vit = (*vit)*(norm (subsbandGain));
-		}
-		vit++;
-		iSubband++;
+		std::fill (psd, psd + numBands, 0.0);
 	}
-	return tempPsd;
 }
 
 double
@@ -1363,6 +1198,24 @@ MmWave3gppChannel::SetPathlossModel (Ptr<PropagationLossModel> pathloss)
 }
 
 
+Time
+MmWave3gppChannel::GetChannelGenerationTime (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
+{
+	Ptr<NetDevice> aDevice = a->GetObject<Node> ()->GetDevice (0);
+	Ptr<NetDevice> bDevice = b->GetObject<Node> ()->GetDevice (0);
+	ExpireChannels ();
+	std::map< key_t, Ptr<Params3gpp> >::const_iterator it = m_channelMap.find (std::make_pair (aDevice, bDevice));
+	if (it == m_channelMap.end ())
+	{
+		it = m_channelMap.find (std::make_pair (bDevice, aDevice));
+	}
+	if (it == m_channelMap.end () || it->second->m_channel.IsEmpty ())
+	{
+		return Seconds (-1);
+	}
+	return it->second->m_generatedTime;
+}
+
 void
 MmWave3gppChannel::CalLongTerm (Ptr<Params3gpp> params) const
 {
@@ -1374,19 +1227,20 @@ MmWave3gppChannel::CalLongTerm (Ptr<Params3gpp> params) const
 	complexVector_t longTerm;
 	uint8_t numCluster = params->m_delay.size();
 
-	for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+	// walk H[u][s][:] row by row, so that the innermost loop runs over contiguous memory
+	longTerm.resize (numCluster, std::complex<double> (0,0));
+	for (uint8_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
 	{
-		std::complex<double> txSum(0,0);
+		std::complex<double> rxW = std::conj (params->m_rxW[rxIndex]);
 		for(uint8_t txIndex = 0; txIndex < txAntenna; txIndex++)
 		{
-			std::complex<double> rxSum(0,0);
-			for (uint8_t rxIndex = 0; rxIndex < rxAntenna; rxIndex++)
+			std::complex<double> w = rxW*params->m_txW[txIndex];
+			const std::complex<double> *h = params->m_channel.GetRow (rxIndex, txIndex);
+			for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
 			{
-				rxSum = rxSum + std::conj(params->m_rxW.at(rxIndex))*params->m_channel.at(rxIndex).at(txIndex).at(cIndex);
+				longTerm[cIndex] += w*h[cIndex];
 			}
-			txSum = txSum + params->m_txW.at(txIndex)*rxSum;
 		}
-		longTerm.push_back(txSum);
 	}
 	params->m_longTerm = longTerm;
 
@@ -1581,17 +1435,50 @@ MmWave3gppChannel::Get3gppTable (bool los, bool o2i, double hBS, double hUT, dou
 }
 
 void
-MmWave3gppChannel::DeleteChannel(Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const
+MmWave3gppChannel::ScheduleChannelRefresh (key_t key) const
+{
+	Time refreshTime = Simulator::Now () + m_updatePeriod;
+	if (m_updatePeriodJitter.IsStrictlyPositive ())
+	{
+		// created only when needed, not to change the streams of the other random variables
+		if (m_jitterRv == 0)
+		{
+			m_jitterRv = CreateObject<UniformRandomVariable> ();
+		}
+		refreshTime += Seconds (m_jitterRv->GetValue (0, m_updatePeriodJitter.GetSeconds ()));
+	}
+	m_refreshQueue.insert (std::make_pair (refreshTime, key));
+
+	if (!m_refreshEvent.IsRunning () || refreshTime < Simulator::Now () + Simulator::GetDelayLeft (m_refreshEvent))
+	{
+		m_refreshEvent.Cancel ();
+		m_refreshEvent = Simulator::Schedule (refreshTime - Simulator::Now (), &MmWave3gppChannel::RefreshChannels, this);
+	}
+}
+
+void
+MmWave3gppChannel::RefreshChannels () const
+{
+	NS_LOG_FUNCTION (this << m_refreshQueue.size ());
+	ExpireChannels ();
+	if (!m_refreshQueue.empty ())
+	{
+		m_refreshEvent = Simulator::Schedule (m_refreshQueue.begin ()->first - Simulator::Now (),
+				&MmWave3gppChannel::RefreshChannels, this);
+	}
+}
+
+void
+MmWave3gppChannel::ExpireChannels () const
 {
-	Ptr<NetDevice> dev1 = a->GetObject<Node> ()->GetDevice (0);
-	Ptr<NetDevice> dev2 = b->GetObject<Node> ()->GetDevice (0);
-	NS_LOG_INFO("a position " << a->GetPosition() << " b " << b->GetPosition());
-	Ptr<Params3gpp> params = m_channelMap.find(std::make_pair(dev1,dev2))->second;
-	NS_LOG_INFO("params " << params);
-	NS_LOG_INFO("params m_channel size" << params->m_channel.size());
-	NS_ASSERT_MSG(m_channelMap.find(std::make_pair(dev1,dev2)) != m_channelMap.end(), "Channel not found");
-	params->m_channel.clear();
-	m_channelMap[std::make_pair(dev1,dev2)] = params;
+	while (!m_refreshQueue.empty () && m_refreshQueue.begin ()->first <= Simulator::Now ())
+	{
+		std::map< key_t, Ptr<Params3gpp> >::iterator it = m_channelMap.find (m_refreshQueue.begin ()->second);
+		NS_ASSERT_MSG (it != m_channelMap.end (), "Channel not found");
+		NS_LOG_INFO ("params " << it->second << " m_channel size " << it->second->m_channel.GetDimSize (0));
+		it->second->m_channel.Clear ();
+		m_refreshQueue.erase (m_refreshQueue.begin ());
+	}
 }
 
 Ptr<Params3gpp>
@@ -2135,8 +2022,8 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 
 	//Step 11: Generate channel coefficients for each cluster n and each receiver and transmitter element pair u,s.
 
-	complex3DVector_t H_NLOS; // channel coefficients H_NLOS [u][s][n],
-							  // where u and s are receive and transmit antenna element, n is cluster index.
+	// channel coefficients H [u][s][n],
+	// where u and s are receive and transmit antenna element, n is cluster index.
 	uint16_t uSize = rxAntennaNum[0]*rxAntennaNum[1];
 	uint16_t sSize = txAntennaNum[0]*txAntennaNum[1];
 
@@ -2162,18 +2049,18 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 
 	NS_LOG_INFO ("1st strongest cluster:"<<(int)cluster1st<<", 2nd strongest cluster:"<<(int)cluster2nd);
 
-	complex3DVector_t H_usn; //channel coffecient H_usn[u][s][n];
 	//Since each of the strongest 2 clusters are divided into 3 sub-clusters, the total cluster will be numReducedCLuster + 4.
-
-	H_usn.resize(uSize);
-	for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
-	{
-		H_usn.at(uIndex).resize(sSize);
-		for (uint16_t sIndex = 0; sIndex < sSize; sIndex++)
-		{
-			H_usn.at(uIndex).at(sIndex).resize(numReducedCluster);
-		}
-	}
+	//The sub-clusters are stored after the N reduced clusters, first the ones of the strongest cluster
+	//with the lowest index, in the same order of the delays and angles appended at the end of this function.
+	uint8_t numSubCluster = (cluster1st == cluster2nd) ? 2 : 4;
+	uint8_t numTotalCluster = numReducedCluster + numSubCluster;
+	uint8_t subClusterOffset[2];
+	subClusterOffset[0] = numReducedCluster;
+	subClusterOffset[1] = numReducedCluster + numSubCluster - 2;
+	uint8_t clusterMaxIndex = std::max (cluster1st, cluster2nd);
+
+	ComplexTensor &H_usn = channelParams->m_channel; //channel coffecient H_usn[u][s][n];
+	H_usn.Resize (uSize, sSize, numTotalCluster);
 	//double slotTime = Simulator::Now ().GetSeconds ();
 	// The following for loops computes the channel coefficients
 	for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
@@ -2215,7 +2102,7 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 					}
 					//rays *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
 					rays *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
-					H_usn.at(uIndex).at(sIndex).at(nIndex) = rays;
+					H_usn (uIndex, sIndex, nIndex) = rays;
 				}
 				else //(7.5-28)
 				{
@@ -2284,9 +2171,10 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 					raysSub1 *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
 					raysSub2 *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
 					raysSub3 *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
-					H_usn.at(uIndex).at(sIndex).at(nIndex) = raysSub1;
-					H_usn.at(uIndex).at(sIndex).push_back(raysSub2);
-					H_usn.at(uIndex).at(sIndex).push_back(raysSub3);
+					uint8_t subIndex = subClusterOffset[(cluster1st != cluster2nd && nIndex == clusterMaxIndex) ? 1 : 0];
+					H_usn (uIndex, sIndex, nIndex) = raysSub1;
+					H_usn (uIndex, sIndex, subIndex) = raysSub2;
+					H_usn (uIndex, sIndex, subIndex + 1) = raysSub3;
 
 				}
 			}
@@ -2311,11 +2199,11 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 
 				double K_linear = pow(10,K_factor/10);
 				// the LOS path should be attenuated if blockage is enabled.
-				H_usn.at(uIndex).at(sIndex).at(0) = sqrt(1/(K_linear+1))*H_usn.at(uIndex).at(sIndex).at(0)+sqrt(K_linear/(1+K_linear))*ray/pow(10,attenuation_dB.at (0)/10);  //(7.5-30) for tau = tau1
-				double tempSize = H_usn.at(uIndex).at(sIndex).size();
-				for(uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
+				std::complex<double> *h = H_usn.GetRow (uIndex, sIndex);
+				h[0] = sqrt(1/(K_linear+1))*h[0]+sqrt(K_linear/(1+K_linear))*ray/pow(10,attenuation_dB.at (0)/10);  //(7.5-30) for tau = tau1
+				for(uint8_t nIndex = 1; nIndex < numTotalCluster; nIndex++)
 				{
-					H_usn.at(uIndex).at(sIndex).at(nIndex) *= sqrt(1/(K_linear+1)); //(7.5-30) for tau = tau2...taunN
+					h[nIndex] *= sqrt(1/(K_linear+1)); //(7.5-30) for tau = tau2...taunN
 				}
 
 			}
@@ -2380,7 +2268,7 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 
 	}
 
-	NS_LOG_INFO ("size of coefficient matrix =["<<H_usn.size() << "][" << H_usn.at(0).size() << "][" << H_usn.at (0).at(0).size()<<"]");
+	NS_LOG_INFO ("size of coefficient matrix =["<<H_usn.GetDimSize (0) << "][" << H_usn.GetDimSize (1) << "][" << H_usn.GetDimSize (2)<<"]");
 
 
 	/*std::cout << "Delay:";
@@ -2390,7 +2278,6 @@ MmWave3gppChannel::GetNewChannel(Ptr<ParamsTable>  table3gpp, Vector locUT, bool
 	}
 	std::cout << "\n";*/
 
-	channelParams->m_channel = H_usn;
 	channelParams->m_delay = clusterDelay;
 
 	channelParams->m_angle.clear();
@@ -2779,8 +2666,8 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 
 	//Step 11: Generate channel coefficients for each cluster n and each receiver and transmitter element pair u,s.
 
-	complex3DVector_t H_NLOS; // channel coefficients H_NLOS [u][s][n],
-							  // where u and s are receive and transmit antenna element, n is cluster index.
+	// channel coefficients H [u][s][n],
+	// where u and s are receive and transmit antenna element, n is cluster index.
 	uint16_t uSize = rxAntennaNum[0]*rxAntennaNum[1];
 	uint16_t sSize = txAntennaNum[0]*txAntennaNum[1];
 
@@ -2806,18 +2693,18 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 
 	NS_LOG_INFO ("1st strongest cluster:"<<(int)cluster1st<<", 2nd strongest cluster:"<<(int)cluster2nd);
 
-	complex3DVector_t H_usn; //channel coffecient H_usn[u][s][n];
 	//Since each of the strongest 2 clusters are divided into 3 sub-clusters, the total cluster will be numReducedCLuster + 4.
-
-	H_usn.resize(uSize);
-	for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
-	{
-		H_usn.at(uIndex).resize(sSize);
-		for (uint16_t sIndex = 0; sIndex < sSize; sIndex++)
-		{
-			H_usn.at(uIndex).at(sIndex).resize(params->m_numCluster);
-		}
-	}
+	//The sub-clusters are stored after the N reduced clusters, first the ones of the strongest cluster
+	//with the lowest index, in the same order of the delays and angles appended at the end of this function.
+	uint8_t numSubCluster = (cluster1st == cluster2nd) ? 2 : 4;
+	uint8_t numTotalCluster = params->m_numCluster + numSubCluster;
+	uint8_t subClusterOffset[2];
+	subClusterOffset[0] = params->m_numCluster;
+	subClusterOffset[1] = params->m_numCluster + numSubCluster - 2;
+	uint8_t clusterMaxIndex = std::max (cluster1st, cluster2nd);
+
+	ComplexTensor &H_usn = params->m_channel; //channel coffecient H_usn[u][s][n];
+	H_usn.Resize (uSize, sSize, numTotalCluster);
 	//double slotTime = Simulator::Now ().GetSeconds ();
 	// The following for loops computes the channel coefficients
 	for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
@@ -2859,7 +2746,7 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 					}
 					//rays *= sqrt(clusterPower.at(nIndex))/raysPerCluster;
 					rays *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
-					H_usn.at(uIndex).at(sIndex).at(nIndex) = rays;
+					H_usn (uIndex, sIndex, nIndex) = rays;
 				}
 				else //(7.5-28)
 				{
@@ -2925,9 +2812,10 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 					raysSub1 *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
 					raysSub2 *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
 					raysSub3 *= sqrt(clusterPower.at(nIndex)/raysPerCluster);
-					H_usn.at(uIndex).at(sIndex).at(nIndex) = raysSub1;
-					H_usn.at(uIndex).at(sIndex).push_back(raysSub2);
-					H_usn.at(uIndex).at(sIndex).push_back(raysSub3);
+					uint8_t subIndex = subClusterOffset[(cluster1st != cluster2nd && nIndex == clusterMaxIndex) ? 1 : 0];
+					H_usn (uIndex, sIndex, nIndex) = raysSub1;
+					H_usn (uIndex, sIndex, subIndex) = raysSub2;
+					H_usn (uIndex, sIndex, subIndex + 1) = raysSub3;
 
 				}
 			}
@@ -2952,11 +2840,11 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 
 				double K_linear = pow(10,K_factor/10);
 
-				H_usn.at(uIndex).at(sIndex).at(0) = sqrt(1/(K_linear+1))*H_usn.at(uIndex).at(sIndex).at(0)+sqrt(K_linear/(1+K_linear))*ray/pow(10,attenuation_dB.at (0)/10);  //(7.5-30) for tau = tau1
-				double tempSize = H_usn.at(uIndex).at(sIndex).size();
-				for(uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
+				std::complex<double> *h = H_usn.GetRow (uIndex, sIndex);
+				h[0] = sqrt(1/(K_linear+1))*h[0]+sqrt(K_linear/(1+K_linear))*ray/pow(10,attenuation_dB.at (0)/10);  //(7.5-30) for tau = tau1
+				for(uint8_t nIndex = 1; nIndex < numTotalCluster; nIndex++)
 				{
-					H_usn.at(uIndex).at(sIndex).at(nIndex) *= sqrt(1/(K_linear+1)); //(7.5-30) for tau = tau2...taunN
+					h[nIndex] *= sqrt(1/(K_linear+1)); //(7.5-30) for tau = tau2...taunN
 				}
 
 			}
@@ -3004,7 +2892,7 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 
 	}
 
-	NS_LOG_INFO ("size of coefficient matrix =["<<H_usn.size() << "][" << H_usn.at(0).size() << "][" << H_usn.at (0).at(0).size()<<"]");
+	NS_LOG_INFO ("size of coefficient matrix =["<<H_usn.GetDimSize (0) << "][" << H_usn.GetDimSize (1) << "][" << H_usn.GetDimSize (2)<<"]");
 
 
 	/*std::cout << "Delay:";
@@ -3015,7 +2903,6 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 	std::cout << "\n";*/
 
 	params->m_delay = clusterDelay;
-	params->m_channel = H_usn;
 	params->m_angle.clear();
 	params->m_angle.push_back(clusterAoa);
 	params->m_angle.push_back(clusterZoa);
@@ -3028,51 +2915,23 @@ MmWave3gppChannel::UpdateChannel(Ptr<Params3gpp> params3gpp, Ptr<ParamsTable>  t
 }
 
 void
-MmWave3gppChannel::BeamSearchBeamforming (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
+MmWave3gppChannel::BeamSearchBeamforming (Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
 		Ptr<AntennaArrayModel> rxAntenna, uint8_t *txAntennaNum, uint8_t *rxAntennaNum) const
 {
-	double max = 0, maxTx = 0, maxRx =0, maxTxTheta=0, maxRxTheta=0;
 	NS_LOG_LOGIC("BeamSearchBeamforming method at time " << Simulator::Now().GetSeconds());
-	for (uint16_t txTheta = 60; txTheta < 121; txTheta=txTheta+10)
-	{
-		for(uint16_t tx=0; tx<=txAntennaNum[1]; tx++)
-		{
-			for (uint16_t rxTheta = 60; rxTheta < 121; rxTheta=rxTheta+10)
-			{
-				for(uint16_t rx=0; rx<=rxAntennaNum[1]; rx++)
-				{
-					NS_LOG_LOGIC("txTheta " << txTheta << " rxTheta " << rxTheta << " tx sector " << 
-						(M_PI*(double)tx/(double)txAntennaNum[1]-0.5*M_PI)/(M_PI)*180 << " rx sector " << 
-						(M_PI*(double)rx/(double)rxAntennaNum[1]-0.5*M_PI)/(M_PI)*180);
-
-					txAntenna->SetSector(tx, txAntennaNum, txTheta);
-					rxAntenna->SetSector(rx, rxAntennaNum, rxTheta);
-					params->m_txW = txAntenna->GetBeamformingVector();
-					params->m_rxW = rxAntenna->GetBeamformingVector();
-					CalLongTerm(params);
-					Ptr<SpectrumValue> bfPsd = CalBeamformingGain(txPsd, params, Vector(0,0,0));
-
-					SpectrumValue bfGain = (*bfPsd)/(*txPsd);
-					uint8_t nbands = bfGain.GetSpectrumModel ()->GetNumBands ();
-					double power = Sum (bfGain)/nbands;
-
-					NS_LOG_LOGIC("gain " << power);
-					if (max < power)
-					{
-						max = power;
-						maxTx = tx;
-						maxRx = rx;
-						maxTxTheta = txTheta;
-						maxRxTheta = rxTheta;
-					}
-				}
-			}
-		}
-	}
-	NS_LOG_LOGIC("maxTx " << maxTx << " txAntennaNum[1] " << (uint16_t)txAntennaNum[1]);
-	NS_LOG_LOGIC("max gain " << max << " maxTx " << (M_PI*(double)maxTx/(double)txAntennaNum[1]-0.5*M_PI)/(M_PI)*180 << " maxRx " << (M_PI*(double)maxRx/(double)rxAntennaNum[1]-0.5*M_PI)/(M_PI)*180 << " maxTxTheta " << maxTxTheta << " maxRxTheta " << maxRxTheta);
-	txAntenna->SetSector(maxTx, txAntennaNum, maxTxTheta);
-	rxAntenna->SetSector(maxRx, rxAntennaNum, maxRxTheta);
+	const ComplexTensor &txCodebook = txAntenna->GetCodebook (txAntennaNum);
+	const ComplexTensor &rxCodebook = rxAntenna->GetCodebook (rxAntennaNum);
+	std::pair<uint16_t, uint16_t> best = AntennaArrayModel::SearchCodebook (params->m_channel,
+			txCodebook, txAntennaNum, rxCodebook, rxAntennaNum, m_hierarchicalBeamSearch);
+
+	uint8_t maxTx, maxRx;
+	double maxTxTheta, maxRxTheta;
+	AntennaArrayModel::GetCodewordSector (best.first, txAntennaNum, maxTx, maxTxTheta);
+	AntennaArrayModel::GetCodewordSector (best.second, rxAntennaNum, maxRx, maxRxTheta);
+	NS_LOG_LOGIC("maxTx " << (uint16_t)maxTx << " txAntennaNum[1] " << (uint16_t)txAntennaNum[1]);
+	NS_LOG_LOGIC("maxTx " << (M_PI*(double)maxTx/(double)txAntennaNum[1]-0.5*M_PI)/(M_PI)*180 << " maxRx " << (M_PI*(double)maxRx/(double)rxAntennaNum[1]-0.5*M_PI)/(M_PI)*180 << " maxTxTheta " << maxTxTheta << " maxRxTheta " << maxRxTheta);
+	txAntenna->SetCodeword (best.first, txAntennaNum);
+	rxAntenna->SetCodeword (best.second, rxAntennaNum);
 	params->m_txW = txAntenna->GetBeamformingVector();
 	params->m_rxW = rxAntenna->GetBeamformingVector();
 }
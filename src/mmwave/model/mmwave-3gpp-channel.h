@@ -33,14 +33,18 @@
 #include <ns3/mobility-model.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/net-device.h>
+#include <ns3/node.h>
 #include <map>
 #include <ns3/angles.h>
 #include <ns3/net-device-container.h>
 #include <ns3/random-variable-stream.h>
+#include <ns3/event-id.h>
 #include "ns3/mmwave-phy-mac-common.h"
 #include "ns3/mmwave-3gpp-propagation-loss-model.h"
 #include <ns3/antenna-array-model.h>
 #include "ns3/mmwave-3gpp-buildings-propagation-loss-model.h"
+#include "ns3/complex-tensor.h"
+#include "ns3/mmwave-beamforming-gain-kernel.h"
 
 #define AOA_INDEX 0
 #define ZOA_INDEX 1
@@ -73,7 +77,7 @@ struct Params3gpp : public SimpleRefCount<Params3gpp>
 {
 	complexVector_t 		m_txW; // tx antenna weights.
 	complexVector_t 		m_rxW; // rx antenna weights.
-	complex3DVector_t  		m_channel; // channel matrix H[u][s][n].
+	ComplexTensor  			m_channel; // channel matrix H[u][s][n].
 	doubleVector_t  		m_delay; // cluster delay.
 	double2DVector_t		m_angle; //cluster angle angle[direction][n], where direction = 0(aoa), 1(zoa), 2(aod), 3(zod) in degree.
 	complexVector_t 		m_longTerm; // long term conponet.
@@ -95,6 +99,16 @@ struct Params3gpp : public SimpleRefCount<Params3gpp>
 	Vector m_speed;
 	double m_dis2D;
 	double m_dis3D;
+
+	/*The following parameters cache the result of LongTermCovMatrixBeamforming*/
+	complexVector_t m_txEigenW; // dominant eigenvector of the tx spatial correlation matrix
+	complexVector_t m_rxEigenW; // dominant eigenvector of the rx spatial correlation matrix
+	Time m_eigenGeneratedTime; // m_generatedTime of the channel the eigenvectors refer to
+
+	Params3gpp ()
+		: m_eigenGeneratedTime (Seconds (-1))
+	{
+	}
 };
 
 /**
@@ -219,6 +233,52 @@ public:
 	 */
 	void SetPathlossModel (Ptr<PropagationLossModel> pathloss);
 
+	/**
+	 * Get the time at which the channel between the nodes of a and b (in any direction)
+	 * was generated or last updated
+	 * @param the mobility model of one node
+	 * @param the mobility model of the other node
+	 * @returns the generation time, or a negative time if the channel does not exist
+	 * or will be regenerated at the next evaluation
+	 */
+	Time GetChannelGenerationTime (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const;
+
+	/**
+	 * The BF gain of a link, resolved by PrepareBeamformingGain, which is
+	 * applied to the PSD by ApplyBeamformingGain
+	 */
+	struct BeamformingGainJob
+	{
+		Ptr<Params3gpp> m_params;	///< keeps the cluster delays alive
+		complexVector_t m_clusterGain;	///< long term gain of each cluster, with the Doppler shift
+		double m_f0;	///< center frequency of the first subband
+		double m_df;	///< width of the subbands
+		bool m_reverseLink;
+	};
+
+	/**
+	 * Do all the work of DoCalcRxPowerSpectralDensity which is not thread-safe:
+	 * create, update or look up the channel of the link in m_channelMap, with the
+	 * random variables, set the BF vectors of the antenna arrays and compute the
+	 * gain of each cluster at the current time
+	 * @params the mobility model of the transmitter
+	 * @params the mobility model of the receiver
+	 * @params the job to fill
+	 * @returns false if no BF gain has to be applied to the link
+	 */
+	bool PrepareBeamformingGain (Ptr<const MobilityModel> a, Ptr<const MobilityModel> b,
+			BeamformingGainJob &job) const;
+
+	/**
+	 * Apply the frequency selective BF gain of a job to a PSD, in place.
+	 * It only reads the job and the attributes of the channel, thus the jobs
+	 * of different links can be applied concurrently
+	 * @params the job returned by PrepareBeamformingGain
+	 * @params the values of the PSD
+	 * @params the number of subbands of the PSD
+	 */
+	void ApplyBeamformingGain (const BeamformingGainJob &job, double *psd, uint32_t numBands) const;
+
 private:
 
 	/**
@@ -233,11 +293,91 @@ private:
 														Ptr<const MobilityModel> b) const;
 
 	/**
-	 * Get the Tx and Rx info for the link
+	 * Role of the device 0 of a node in the links of this channel
+	 */
+	enum DeviceRole_t
+	{
+		ROLE_OTHER = 0,
+		ROLE_ENB,
+		ROLE_UE,
+		ROLE_MC_UE,
+		ROLE_IAB
+	};
+
+	/**
+	 * Type of the device 0 of a node, with its antenna arrays and the number
+	 * of antenna elements per row. For the IAB devices, the access antenna
+	 * is the one of the access PHY, for the other devices it is the only one.
+	 */
+	struct DeviceDescriptor
+	{
+		bool m_resolved;
+		DeviceRole_t m_role;
+		Ptr<NetDevice> m_device;
+		Ptr<AntennaArrayModel> m_accessAntenna;
+		uint8_t m_accessAntennaNum;
+		Ptr<AntennaArrayModel> m_backhaulAntenna;
+		uint8_t m_backhaulAntennaNum;
+	};
+
+	/**
+	 * Type of a directed link, which only depends on the roles of its devices
+	 */
+	enum LinkType_t
+	{
+		LINK_UNRESOLVED = 0,
+		LINK_SKIP,		///< same device, eNB to eNB or UE to UE, no BF
+		LINK_BS_TO_UT,	///< downlink, the transmitter is the BS
+		LINK_UT_TO_BS,	///< uplink, the receiver is the BS
+		LINK_IAB_TO_IAB	///< access to backhaul or backhaul to access, depending on the current attachment
+	};
+
+	/**
+	 * Entry of the table of the directed links, indexed by the pair of node ids
+	 */
+	struct LinkDescriptor
+	{
+		uint8_t m_type;
+		bool m_txBackhaul;	///< use the backhaul antenna of the transmitter
+		bool m_rxBackhaul;	///< use the backhaul antenna of the receiver
+		bool m_setBsHeight;	///< the BS height is not set for the uplink from the IAB backhaul to the eNB
+	};
+
+	/**
+	 * Get the Tx and Rx info for the link.
+	 * The roles, antenna arrays and antenna dimensions of the devices are resolved
+	 * the first time the pair is used, and then read from the link table; only the
+	 * attachment-dependent parts (connected pair, direction of the IAB to IAB links)
+	 * are evaluated at each call
 	 */
 	std::tuple<uint8_t, uint8_t, uint8_t, uint8_t, Ptr<AntennaArrayModel>, Ptr<AntennaArrayModel>, Vector,
 	bool, bool, double> GetTxRxInfo(Ptr<const MobilityModel> a, Ptr<const MobilityModel> b) const;
 
+	/**
+	 * Get the descriptor of the device 0 of a node, resolving it if needed
+	 * @params the node
+	 * @returns the DeviceDescriptor
+	 */
+	const DeviceDescriptor& GetDeviceDescriptor (Ptr<Node> node) const;
+
+	/**
+	 * Get the descriptor of the link between two nodes, resolving it if needed
+	 * @params the descriptor of the transmitter
+	 * @params the descriptor of the receiver
+	 * @params the id of the transmitter node
+	 * @params the id of the receiver node
+	 * @returns the LinkDescriptor
+	 */
+	const LinkDescriptor& GetLinkDescriptor (const DeviceDescriptor &tx, const DeviceDescriptor &rx,
+			uint32_t txId, uint32_t rxId) const;
+
+	/**
+	 * Get the target BS of a UT device
+	 * @params the descriptor of the UT
+	 * @returns the current target BS (the backhaul target for the IAB devices)
+	 */
+	static Ptr<NetDevice> GetTargetBs (const DeviceDescriptor &ut);
+
 	/**
 	 * Get a new realization of the channel
 	 * @params the ParamsTable for the specific scenario
@@ -279,17 +419,25 @@ private:
 
 	/**
 	 * Compute the optimal BF vector with the Power Method (Maximum Ratio Transmission method).
-	 * The vector is stored in the Params3gpp object passed as parameter
+	 * The vector is stored in the Params3gpp object passed as parameter.
+	 * The result is cached until the channel is regenerated, and the power method
+	 * starts from the vector of the previous channel realization of the same link
 	 * @params the channel realizationin as a Params3gpp object
 	 */
 	void LongTermCovMatrixBeamforming (Ptr<Params3gpp> params) const;
 	
 	/**
 	 * Scan all sectors with predefined code book and select the one returns maximum gain.
+	 * The gain of each pair of codewords is the wideband long term power of the channel,
+	 * see AntennaArrayModel::SearchCodebook.
 	 * The BF vector is stored in the Params3gpp object passed as parameter
 	 * @params the channel realizationin as a Params3gpp object
+	 * @params the tx antenna array
+	 * @params the rx antenna array
+	 * @params the number of tx antenna elements in each direction
+	 * @params the number of rx antenna elements in each direction
 	 */
-	void BeamSearchBeamforming (Ptr<const SpectrumValue> txPsd, Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
+	void BeamSearchBeamforming (Ptr<Params3gpp> params, Ptr<AntennaArrayModel> txAntenna,
 			Ptr<AntennaArrayModel> rxAntenna, uint8_t *txAntennaNum, uint8_t *rxAntennaNum) const;
 
 
@@ -299,17 +447,6 @@ private:
 	 */
 	void CalLongTerm (Ptr<Params3gpp> params) const;
 
-	/**
-	 * Compute the BF gain, apply frequency selectivity by phase-shifting with the cluster delays
-	 * and scale the txPsd to get the rxPsd
-	 * @params the tx PSD
-	 * @params the channel realizationin as a Params3gpp object
-	 * @params the relative speed between UE and eNB
-	 * @returns the rx PSD
-	 */
-	Ptr<SpectrumValue> CalBeamformingGain (Ptr<const SpectrumValue> txPsd,
-												Ptr<Params3gpp> params, Vector speed) const;
-	
 	/**
 	 * Returns the bandwidth used in a scenario
 	 * @returns a double with the bandwidth
@@ -330,13 +467,27 @@ private:
 										double hBS, double hUT, double distance2D) const;
 
 	/**
-	 * Delete the m_channel entry associated to the Params3gpp object of pair (a,b)
-	 * but keep the other parameters, so that the spatial consistency procedure can be used
-	 * @params the mobility model of the transmitter
-	 * @params the mobility model of the receiver
+	 * Register the link for the deletion of its m_channel entry after UpdatePeriod
+	 * (plus a random delay up to UpdatePeriodJitter). A single event is scheduled
+	 * for the earliest refresh time of all the links
+	 * @params the key of the link
 	 */
-	void DeleteChannel(Ptr<const MobilityModel> a,
-			Ptr<const MobilityModel> b) const;
+	void ScheduleChannelRefresh (key_t key) const;
+
+	/**
+	 * Expire the channels of the links whose refresh time has come, and
+	 * schedule the event again for the next refresh time
+	 */
+	void RefreshChannels () const;
+
+	/**
+	 * Delete the m_channel entry associated to the Params3gpp object of all the links
+	 * whose refresh time has expired, but keep the other parameters, so that the
+	 * spatial consistency procedure can be used at the next evaluation of the link.
+	 * It is called also before each look up of m_channelMap, since the refresh
+	 * event is scheduled after the transmissions already scheduled at its time
+	 */
+	void ExpireChannels () const;
 	/*
 	 * Returns the attenuation of each cluster in dB after applying blockage model
 	 * @params the channel realizationin as a Params3gpp object
@@ -361,13 +512,23 @@ private:
 	Ptr<PropagationLossModel> m_3gppPathloss;
 	Ptr<ParamsTable> m_table3gpp;
 	Time m_updatePeriod;
+	Time m_updatePeriodJitter;
+	mutable Ptr<UniformRandomVariable> m_jitterRv;
+	mutable std::multimap<Time, key_t> m_refreshQueue;	///< links sorted by refresh time
+	mutable EventId m_refreshEvent;
 	bool m_cellScan;
+	bool m_hierarchicalBeamSearch;
 	bool m_blockage;
 	uint16_t m_numNonSelfBloking; //number of non-self-blocking regions.
 	bool m_portraitMode; //true (portrait mode); false (landscape mode).
 	std::string m_scenario;
 	double m_blockerSpeed;
 	bool m_forceInitialBfComputation;
+	MmWaveBeamformingGainKernel::Type m_bfGainKernel;
+
+	mutable std::vector<DeviceDescriptor> m_devices;	///< indexed by node id
+	mutable std::vector<LinkDescriptor> m_links;	///< indexed by txId * m_linkTableSize + rxId
+	mutable uint32_t m_linkTableSize;
 
 };
 
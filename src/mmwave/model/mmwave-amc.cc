@@ -44,6 +44,7 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (MmWaveAmc);
 
+
 static const double SpectralEfficiencyForCqi[16] = {
 	0.0, // out of range
 	0.15, 0.23, 0.38, 0.6, 0.88, 1.18,
@@ -106,7 +107,11 @@ static const int ModulationSchemeForMcs[32] = {
   6,  // reserved
 };
 
+/// number of MCS in the table of the TB sizes
+static const unsigned g_numTbSizeMcs = 29;
+
 MmWaveAmc::MmWaveAmc ()
+	: m_tbSizeTableSymbols (0)
 {
 	NS_LOG_ERROR ("This construcor should not be invoked");
 }
@@ -115,6 +120,15 @@ MmWaveAmc::MmWaveAmc (Ptr<MmWavePhyMacCommon> ConfigParams)
 : m_phyMacConfig (ConfigParams)
 {
 	NS_LOG_INFO ("Initialze AMC module");
+	m_tbSizeTableSymbols = m_phyMacConfig->GetSymbolsPerSubframe ();
+	m_tbSizeTable.resize (g_numTbSizeMcs * (m_tbSizeTableSymbols + 1));
+	for (unsigned mcs = 0; mcs < g_numTbSizeMcs; mcs++)
+	{
+		for (unsigned nsym = 0; nsym <= m_tbSizeTableSymbols; nsym++)
+		{
+			m_tbSizeTable[mcs * (m_tbSizeTableSymbols + 1) + nsym] = CalcTbSizeFromMcsSymbols (mcs, nsym);
+		}
+	}
 }
 
 MmWaveAmc::~MmWaveAmc ()
@@ -183,7 +197,62 @@ int
 MmWaveAmc::GetTbSizeFromMcsSymbols (unsigned mcs, unsigned nsymb)
 {
 	NS_LOG_FUNCTION (mcs);
-	NS_ASSERT_MSG (mcs < 29, "MCS=" << mcs);
+	NS_ASSERT_MSG (mcs < g_numTbSizeMcs, "MCS=" << mcs);
+	if (nsymb <= m_tbSizeTableSymbols)
+	{
+		return m_tbSizeTable[mcs * (m_tbSizeTableSymbols + 1) + nsymb];
+	}
+	return CalcTbSizeFromMcsSymbols (mcs, nsymb);
+}
+
+unsigned
+MmWaveAmc::GetMinNumSymbolsFromTbsMcs (unsigned bufSize, unsigned mcs, unsigned &tbSize)
+{
+	NS_LOG_FUNCTION (bufSize << mcs);
+	NS_ASSERT_MSG (mcs < g_numTbSizeMcs, "MCS=" << mcs);
+	NS_ASSERT_MSG (m_tbSizeTableSymbols > 0, "The TB size table is empty");
+	// bisection over the row of the MCS, with the probes of the search that the
+	// flex-TTI schedulers ran on GetTbSizeFromMcsSymbols, so that the allocations
+	// do not change: when a probe is exactly bufSize the search stops at the
+	// current upper bound, which may be above the minimum
+	const int *row = &m_tbSizeTable[mcs * (m_tbSizeTableSymbols + 1)];
+	int numSymLow = 0;
+	int numSymHigh = m_tbSizeTableSymbols;
+	unsigned tbBytes = row[numSymHigh] / 8;
+	while (tbBytes > bufSize)
+	{
+		int diff = (numSymHigh - numSymLow) / 2;
+		if (diff == 0)
+		{
+			break;
+		}
+		tbBytes = row[numSymHigh - diff] / 8;
+		if (tbBytes > bufSize)
+		{
+			numSymHigh -= diff;
+		}
+		while (tbBytes < bufSize)
+		{
+			diff = (numSymHigh - numSymLow) / 2;
+			if (diff == 0)
+			{
+				tbSize = row[numSymHigh] / 8;
+				return numSymHigh;
+			}
+			tbBytes = row[numSymLow + diff] / 8;
+			if (tbBytes < bufSize)
+			{
+				numSymLow += diff;
+			}
+		}
+	}
+	tbSize = row[numSymHigh] / 8;
+	return numSymHigh;
+}
+
+int
+MmWaveAmc::CalcTbSizeFromMcsSymbols (unsigned mcs, unsigned nsymb) const
+{
 	//unsigned itb = McsToItbs[mcs];
 	int rscElement = (m_phyMacConfig->GetNumSCperChunk ()*m_phyMacConfig->GetTotalNumChunk()
 			- m_phyMacConfig->GetNumRefScPerSym ())*nsymb;
@@ -479,29 +548,16 @@ MmWaveAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, u
 		}
 		sinrAvg /= chunkId;
 
-		mcs = 0;
-		MmWaveTbStats_t tbStats;
-		while (mcs <= 28)
-		{
-			MmWaveHarqProcessInfoList_t harqInfoList;
-			tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
-			if (tbStats.tbler > 0.1)
-			{
-				break;
-			}
-			mcs++;
-		}
-		if (mcs > 0)
-		{
-			mcs--;
-		}
+		// highest MCS before the first one with a TBLER above 10 %
+		mcs = MmWaveMiErrorModel::GetMaxMcs (sinr, chunkMap, tbSize, 0.1);
 //		MmWaveHarqProcessInfoList_t harqInfoList;
 //		MmWaveTbStats_t tbStatsFinal = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
 //		NS_LOG_UNCOND ("TBLER " << tbStatsFinal.tbler << " for chunks " << chunkMap.size () << " numSym "
 //		               << (unsigned)numSym << " tbSize " << tbSize << " mcs " << (unsigned)mcs << " sinr " << sinrAvg);
 //		NS_LOG_UNCOND (sinr);
-		if ((tbStats.tbler > 0.1)&&(mcs==0))
+		if (mcs == 0)
 		{
+			// either MCS 0 or MCS 1 does not guarantee the 10 % of BLER
 			cqi = 0;
 		}
 		else if (mcs == 28)
@@ -52,6 +52,17 @@ public:
 	int GetTbSizeFromMcs (unsigned mcs, unsigned nprb);
 	int GetTbSizeFromMcsSymbols (unsigned mcs, unsigned nsym);  // for TDMA
 	int GetNumSymbolsFromTbsMcs (unsigned tbSize, unsigned mcs);
+
+	/**
+	 * Get the minimum number of symbols of a TB which carries a buffer, with a
+	 * binary search over the row of the MCS in the table of the TB sizes
+	 * @params the size of the buffer, in bytes
+	 * @params the MCS
+	 * @params the size of the TB with that number of symbols, in bytes
+	 * @returns the number of symbols (at least 1), or the number of symbols of a
+	 * subframe if the buffer does not fit in a subframe
+	 */
+	unsigned GetMinNumSymbolsFromTbsMcs (unsigned bufSize, unsigned mcs, unsigned &tbSize);
 	std::vector<int> CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize);
 	std::vector<int> CreateCqiFeedbacksTdma (const SpectrumValue& sinr, uint8_t numSym);
 	int CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, uint32_t tbs, int &mcsWb);
@@ -61,11 +72,19 @@ public:
 	static const unsigned int m_crcLen=24;
 
 private:
+	int CalcTbSizeFromMcsSymbols (unsigned mcs, unsigned nsym) const;
+
 	  double m_ber;
 	  AmcModel m_amcModel;
 
 	  Ptr<MmWavePhyMacCommon> m_phyMacConfig;
 		Ptr<SpectrumModel> m_lteRbModel;
+
+	  // TB size in bits for each MCS and number of symbols up to a subframe,
+	  // i.e., m_tbSizeTable[mcs * (m_tbSizeTableSymbols + 1) + nsym]. Computed
+	  // at construction time, from the configuration of the schedulers and PHYs
+	  std::vector<int> m_tbSizeTable;
+	  uint32_t m_tbSizeTableSymbols;
 };
 
 } // end namespace ns3
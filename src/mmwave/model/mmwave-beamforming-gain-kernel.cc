@@ -0,0 +1,272 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-beamforming-gain-kernel.h"
+#include "complex-tensor.h"
+#include <ns3/log.h>
+#include <ns3/fatal-error.h>
+#include <algorithm>
+#include <cmath>
+
+// the SIMD kernels are compiled with the GCC/clang target attribute, so that the
+// module does not need to be built with -mavx2 and still runs on older CPUs
+#if (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define MMWAVE_BF_GAIN_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBeamformingGainKernel");
+
+const std::size_t MmWaveBeamformingGainKernel::RESEED_PERIOD;
+
+/// the cluster arrays are padded to a multiple of the widest SIMD register
+static const std::size_t CLUSTER_PADDING = 8;
+
+/**
+ * Phasors of the clusters, in structure-of-arrays layout.
+ * Element n of each array refers to cluster n; the padding clusters have a = 0.
+ */
+struct BfGainPhasors
+{
+	const double *aRe;
+	const double *aIm;
+	double *pRe;
+	double *pIm;
+	const double *rRe;
+	const double *rIm;
+};
+
+static void
+BfGainBlockScalar (BfGainPhasors ph, std::size_t numCluster, std::size_t numBand, double *gain)
+{
+	for (std::size_t b = 0; b < numBand; b++)
+	{
+		double sumRe = 0;
+		double sumIm = 0;
+		for (std::size_t c = 0; c < numCluster; c++)
+		{
+			sumRe += ph.aRe[c] * ph.pRe[c] - ph.aIm[c] * ph.pIm[c];
+			sumIm += ph.aRe[c] * ph.pIm[c] + ph.aIm[c] * ph.pRe[c];
+			double pRe = ph.pRe[c] * ph.rRe[c] - ph.pIm[c] * ph.rIm[c];
+			ph.pIm[c] = ph.pRe[c] * ph.rIm[c] + ph.pIm[c] * ph.rRe[c];
+			ph.pRe[c] = pRe;
+		}
+		gain[b] = sumRe * sumRe + sumIm * sumIm;
+	}
+}
+
+#ifdef MMWAVE_BF_GAIN_X86_SIMD
+
+__attribute__ ((target ("avx2,fma")))
+static void
+BfGainBlockAvx2 (BfGainPhasors ph, std::size_t numCluster, std::size_t numBand, double *gain)
+{
+	for (std::size_t b = 0; b < numBand; b++)
+	{
+		__m256d sumRe = _mm256_setzero_pd ();
+		__m256d sumIm = _mm256_setzero_pd ();
+		for (std::size_t c = 0; c < numCluster; c += 4)
+		{
+			__m256d aRe = _mm256_loadu_pd (ph.aRe + c);
+			__m256d aIm = _mm256_loadu_pd (ph.aIm + c);
+			__m256d pRe = _mm256_loadu_pd (ph.pRe + c);
+			__m256d pIm = _mm256_loadu_pd (ph.pIm + c);
+			__m256d rRe = _mm256_loadu_pd (ph.rRe + c);
+			__m256d rIm = _mm256_loadu_pd (ph.rIm + c);
+			sumRe = _mm256_fmadd_pd (aRe, pRe, sumRe);
+			sumRe = _mm256_fnmadd_pd (aIm, pIm, sumRe);
+			sumIm = _mm256_fmadd_pd (aRe, pIm, sumIm);
+			sumIm = _mm256_fmadd_pd (aIm, pRe, sumIm);
+			_mm256_storeu_pd (ph.pRe + c, _mm256_fmsub_pd (pRe, rRe, _mm256_mul_pd (pIm, rIm)));
+			_mm256_storeu_pd (ph.pIm + c, _mm256_fmadd_pd (pRe, rIm, _mm256_mul_pd (pIm, rRe)));
+		}
+		// horizontal sums: [re0+re1, im0+im1, re2+re3, im2+im3]
+		__m256d pair = _mm256_hadd_pd (sumRe, sumIm);
+		__m128d total = _mm_add_pd (_mm256_castpd256_pd128 (pair), _mm256_extractf128_pd (pair, 1));
+		double sum[2];
+		_mm_storeu_pd (sum, total);
+		gain[b] = sum[0] * sum[0] + sum[1] * sum[1];
+	}
+	// avoid the AVX-SSE transition penalty in the caller, the compiler does
+	// not always insert this instruction (e.g., in unoptimized builds)
+	_mm256_zeroupper ();
+}
+
+__attribute__ ((target ("avx512f")))
+static void
+BfGainBlockAvx512 (BfGainPhasors ph, std::size_t numCluster, std::size_t numBand, double *gain)
+{
+	for (std::size_t b = 0; b < numBand; b++)
+	{
+		__m512d sumRe = _mm512_setzero_pd ();
+		__m512d sumIm = _mm512_setzero_pd ();
+		for (std::size_t c = 0; c < numCluster; c += 8)
+		{
+			__m512d aRe = _mm512_loadu_pd (ph.aRe + c);
+			__m512d aIm = _mm512_loadu_pd (ph.aIm + c);
+			__m512d pRe = _mm512_loadu_pd (ph.pRe + c);
+			__m512d pIm = _mm512_loadu_pd (ph.pIm + c);
+			__m512d rRe = _mm512_loadu_pd (ph.rRe + c);
+			__m512d rIm = _mm512_loadu_pd (ph.rIm + c);
+			sumRe = _mm512_fmadd_pd (aRe, pRe, sumRe);
+			sumRe = _mm512_fnmadd_pd (aIm, pIm, sumRe);
+			sumIm = _mm512_fmadd_pd (aRe, pIm, sumIm);
+			sumIm = _mm512_fmadd_pd (aIm, pRe, sumIm);
+			_mm512_storeu_pd (ph.pRe + c, _mm512_fmsub_pd (pRe, rRe, _mm512_mul_pd (pIm, rIm)));
+			_mm512_storeu_pd (ph.pIm + c, _mm512_fmadd_pd (pRe, rIm, _mm512_mul_pd (pIm, rRe)));
+		}
+		double re = _mm512_reduce_add_pd (sumRe);
+		double im = _mm512_reduce_add_pd (sumIm);
+		gain[b] = re * re + im * im;
+	}
+	_mm256_zeroupper ();
+}
+
+#endif /* MMWAVE_BF_GAIN_X86_SIMD */
+
+bool
+MmWaveBeamformingGainKernel::IsSupported (Type type)
+{
+	switch (type)
+	{
+		case REFERENCE:
+		case SCALAR:
+		case SIMD:
+			return true;
+#ifdef MMWAVE_BF_GAIN_X86_SIMD
+		case AVX2:
+			return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+		case AVX512:
+			return __builtin_cpu_supports ("avx512f");
+#endif
+		default:
+			return false;
+	}
+}
+
+MmWaveBeamformingGainKernel::Type
+MmWaveBeamformingGainKernel::GetBestAvailable ()
+{
+	static Type best = IsSupported (AVX512) ? AVX512 : (IsSupported (AVX2) ? AVX2 : SCALAR);
+	return best;
+}
+
+void
+MmWaveBeamformingGainKernel::Compute (Type type, const std::complex<double> *longTerm, const double *delay,
+		std::size_t numCluster, double f0, double df,
+		const double *inPsd, double *outPsd, std::size_t numBand)
+{
+	if (type == SIMD)
+	{
+		type = GetBestAvailable ();
+	}
+	if (!IsSupported (type))
+	{
+		NS_FATAL_ERROR ("beamforming gain kernel " << type << " is not supported by this CPU");
+	}
+
+	if (type == REFERENCE)
+	{
+		for (std::size_t b = 0; b < numBand; b++)
+		{
+			std::complex<double> subsbandGain (0.0,0.0);
+			if (inPsd[b] != 0.00)
+			{
+				double fsb = f0 + df*b;
+				for (std::size_t c = 0; c < numCluster; c++)
+				{
+					double phase = -2*M_PI*fsb*delay[c];
+					subsbandGain = subsbandGain + longTerm[c]*exp(std::complex<double>(0, phase));
+				}
+			}
+			outPsd[b] = inPsd[b]*norm (subsbandGain);
+		}
+		return;
+	}
+
+	std::size_t padded = ((numCluster + CLUSTER_PADDING - 1) / CLUSTER_PADDING) * CLUSTER_PADDING;
+	std::vector<double, AlignedAllocator<double, ComplexTensor::ALIGNMENT> > buffer (6 * padded, 0.0);
+	BfGainPhasors ph;
+	ph.aRe = &buffer[0];
+	ph.aIm = &buffer[padded];
+	ph.pRe = &buffer[2 * padded];
+	ph.pIm = &buffer[3 * padded];
+	ph.rRe = &buffer[4 * padded];
+	ph.rIm = &buffer[5 * padded];
+	for (std::size_t c = 0; c < numCluster; c++)
+	{
+		buffer[c] = longTerm[c].real ();
+		buffer[padded + c] = longTerm[c].imag ();
+		double step = -2*M_PI*df*delay[c];
+		buffer[4 * padded + c] = cos (step);
+		buffer[5 * padded + c] = sin (step);
+	}
+
+	double gain[RESEED_PERIOD];
+	for (std::size_t start = 0; start < numBand; start += RESEED_PERIOD)
+	{
+		std::size_t blockSize = std::min (RESEED_PERIOD, numBand - start);
+		bool active = false;
+		for (std::size_t b = start; b < start + blockSize && !active; b++)
+		{
+			active = (inPsd[b] != 0.00);
+		}
+		if (!active)
+		{
+			if (outPsd != inPsd)
+			{
+				std::copy (inPsd + start, inPsd + start + blockSize, outPsd + start);
+			}
+			continue;
+		}
+
+		// exact phasors of the first subband of the block
+		double fsb = f0 + df*start;
+		for (std::size_t c = 0; c < numCluster; c++)
+		{
+			double phase = -2*M_PI*fsb*delay[c];
+			ph.pRe[c] = cos (phase);
+			ph.pIm[c] = sin (phase);
+		}
+
+		switch (type)
+		{
+#ifdef MMWAVE_BF_GAIN_X86_SIMD
+			case AVX2:
+				BfGainBlockAvx2 (ph, padded, blockSize, gain);
+				break;
+			case AVX512:
+				BfGainBlockAvx512 (ph, padded, blockSize, gain);
+				break;
+#endif
+			default:
+				BfGainBlockScalar (ph, numCluster, blockSize, gain);
+				break;
+		}
+
+		for (std::size_t b = 0; b < blockSize; b++)
+		{
+			outPsd[start + b] = inPsd[start + b]*gain[b];
+		}
+	}
+}
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_BEAMFORMING_GAIN_KERNEL_H_
+#define MMWAVE_BEAMFORMING_GAIN_KERNEL_H_
+
+#include <complex>
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \brief Frequency-selective beamforming gain of a clustered channel.
+ *
+ * For every subband b, with center frequency f_b = f_0 + b*df, the kernel computes
+ *
+ *   out[b] = in[b] * | sum_n a[n] * exp(-j*2*pi*f_b*tau[n]) |^2
+ *
+ * where a[n] is the long term (beamformed) coefficient of cluster n, including
+ * the Doppler term, and tau[n] its delay. This is the inner loop of
+ * MmWave3gppChannel::CalBeamformingGain.
+ *
+ * The REFERENCE implementation evaluates exp () for every (subband, cluster)
+ * pair. The other implementations use the recurrence
+ * exp(-j*2*pi*f_{b+1}*tau) = exp(-j*2*pi*f_b*tau) * exp(-j*2*pi*df*tau), i.e., a
+ * phasor per cluster which is rotated by a constant step from one subband to
+ * the next. To bound the accumulation of the rounding errors, the phasors are
+ * re-seeded with the exact value every RESEED_PERIOD subbands. The SIMD
+ * implementations process 4 (AVX2) or 8 (AVX-512) clusters at a time and are
+ * selected at runtime according to the capabilities of the CPU.
+ */
+class MmWaveBeamformingGainKernel
+{
+public:
+	enum Type
+	{
+		REFERENCE,  ///< exp () per subband and cluster, as in the original model
+		SCALAR,     ///< rotating phasor, portable C++
+		AVX2,       ///< rotating phasor, 4 clusters per AVX2 instruction
+		AVX512,     ///< rotating phasor, 8 clusters per AVX-512 instruction
+		SIMD        ///< fastest rotating phasor implementation supported by the CPU
+	};
+
+	/// number of subbands after which the rotating phasors are recomputed exactly
+	static const std::size_t RESEED_PERIOD = 32;
+
+	/**
+	 * Compute the beamformed PSD
+	 * @param the implementation to use, SIMD is resolved with GetBestAvailable ()
+	 * @param the long term coefficient of each cluster
+	 * @param the delay of each cluster, in s
+	 * @param the number of clusters
+	 * @param the center frequency of the first subband, in Hz
+	 * @param the spacing between the subbands, in Hz
+	 * @param the input PSD, subbands with zero power are skipped
+	 * @param the output PSD, it may alias the input PSD
+	 * @param the number of subbands
+	 */
+	static void Compute (Type type, const std::complex<double> *longTerm, const double *delay,
+			std::size_t numCluster, double f0, double df,
+			const double *inPsd, double *outPsd, std::size_t numBand);
+
+	/**
+	 * @returns true if the implementation can run on this CPU
+	 */
+	static bool IsSupported (Type type);
+
+	/**
+	 * @returns the fastest implementation supported by this CPU
+	 */
+	static Type GetBestAvailable ();
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_BEAMFORMING_GAIN_KERNEL_H_ */
@@ -42,6 +42,7 @@
 #include <algorithm>
 #include <ns3/double.h>
 #include <ns3/boolean.h>
+#include <ns3/string.h>
 
 namespace ns3{
 
@@ -53,12 +54,6 @@ NS_OBJECT_ENSURE_REGISTERED (MmWaveBeamforming);
 // period of updating channel matrix
 static const uint32_t g_numInstance = 100;
 
-complex2DVector_t g_enbAntennaInstance; //100 instance of txW
-complex2DVector_t g_ueAntennaInstance; //100 instance of rxW
-complex3DVector_t g_enbSpatialInstance; //this stores 100 instance of txE
-complex3DVector_t g_ueSpatialInstance; //this stores 100 instance of rxE
-double2DVector_t g_smallScaleFadingInstance;    //this stores 100 instance of sigma vector
-
 /*
  * The delay spread and Doppler shift is not based on measurement data at this time
  */
@@ -77,10 +72,9 @@ MmWaveBeamforming::MmWaveBeamforming (uint32_t enbAntenna, uint32_t ueAntenna)
 	m_smallScale (true),
 	m_fixSpeed (false),
 	m_ueSpeed (0.0),
-	m_update(true)
+	m_update(true),
+	m_matrixPath ("src/mmwave/model/BeamFormingMatrix")
 {
-	if (g_smallScaleFadingInstance.empty ())
-	LoadFile();
 	m_uniformRV = CreateObject<UniformRandomVariable> ();
 	Initialize();
 }
@@ -111,6 +105,12 @@ MmWaveBeamforming::GetTypeId (void)
 									DoubleValue (0.0),
 									MakeDoubleAccessor (&MmWaveBeamforming::m_ueSpeed),
 									MakeDoubleChecker<double> ())
+	 .AddAttribute ("MatrixPath",
+									"Directory of the files with the channel matrix instances, in the text format "
+									"or in the binary format written by mmwave-trace-converter (.bin, preferred if present)",
+									StringValue ("src/mmwave/model/BeamFormingMatrix"),
+									MakeStringAccessor (&MmWaveBeamforming::m_matrixPath),
+									MakeStringChecker ())
 	;
   	return tid;
 }
@@ -138,215 +138,40 @@ MmWaveBeamforming::GetConfigurationParameters (void) const
 	return m_phyMacConfig;
 }
 
-std::complex<double>
-MmWaveBeamforming::ParseComplex (std::string strCmplx)
-{
-    double re = 0.00;
-    double im = 0.00;
-    size_t findj = 0;
-    std::complex<double> out_complex;
-
-    findj = strCmplx.find("i");
-    if( findj == std::string::npos )
-    {
-        im = -1.00;
-    }
-    else
-    {
-        strCmplx[findj] = '\0';
-    }
-    if( ( strCmplx.find("+",1) == std::string::npos && strCmplx.find("-",1) == std::string::npos ) && im != -1 )
-    {
-        /* No real value */
-        re = -1.00;
-    }
-    std::stringstream stream( strCmplx );
-    if( re != -1.00 )
-    {
-        stream>>re;
-    }
-    else
-    {
-        re = 0;
-    }
-    if( im != -1 )
-    {
-        stream>>im;
-    }
-    else
-    {
-        im = 0.00;
-    }
-    //  std::cout<<" ---  "<<re<<"  "<<im<<std::endl;
-    out_complex = std::complex<double>(re,im);
-    return out_complex;
-}
-
 void
 MmWaveBeamforming::LoadFile()
 {
-	LoadSmallScaleFading ();
-	LoadEnbAntenna ();
-	LoadUeAntenna ();
-	LoadEnbSpatialSignature ();
-	LoadUeSpatialSignature ();
-}
-
-
-void
-MmWaveBeamforming::LoadSmallScaleFading ()
-{
-	std::string filename = "src/mmwave/model/BeamFormingMatrix/SmallScaleFading.txt";
-	NS_LOG_FUNCTION (this << "Loading SmallScaleFading file " << filename);
-	std::ifstream singlefile;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " SmallScaleFading file not found");
-    std::string line;
-    std::string token;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	doubleVector_t path;
-        std::istringstream stream(line);
-        while( getline(stream,token,',') ) //Parse each comma separated string in a line
-        {
-            double sigma = 0.00;
-            std::stringstream stream( token );
-            stream>>sigma;
-        	path.push_back(sigma);
-		}
-        g_smallScaleFadingInstance.push_back (path);
-	}
-	NS_LOG_INFO ("SmallScaleFading[instance:"<<g_smallScaleFadingInstance.size()<<"][path:"<<g_smallScaleFadingInstance[0].size()<<"]");
-}
-
-void
-MmWaveBeamforming::LoadEnbAntenna ()
-{
-	std::string filename = "src/mmwave/model/BeamFormingMatrix/TxAntenna.txt";
-	NS_LOG_FUNCTION (this << "Loading TxAntenna file " << filename);
-	std::ifstream singlefile;
-	std::complex<double> complexVar;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " TxAntenna file not found");
-    std::string line;
-    std::string token;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	complexVector_t txAntenna;
-        std::istringstream stream(line);
-        while( getline(stream,token,',') ) //Parse each comma separated string in a line
-        {
-        	complexVar = ParseComplex(token);
-		    txAntenna.push_back(complexVar);
-		}
-		g_enbAntennaInstance.push_back(txAntenna);
-	}
-    NS_LOG_INFO ("TxAntenna[instance:"<<g_enbAntennaInstance.size()<<"][antennaSize:"<<g_enbAntennaInstance[0].size()<<"]");
-}
-
-
-void
-MmWaveBeamforming::LoadUeAntenna ()
-{
-	std::string filename = "src/mmwave/model/BeamFormingMatrix/RxAntenna.txt";
-	NS_LOG_FUNCTION (this << "Loading RxAntenna file " << filename);
-	std::ifstream singlefile;
-	std::complex<double> complexVar;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " RxAntenna file not found");
-
-    std::string line;
-    std::string token;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	complexVector_t rxAntenna;
-		std::istringstream stream(line);
-		while( getline(stream,token,',') ) //Parse each comma separated string in a line
-		{
-			complexVar = ParseComplex(token);
-		    rxAntenna.push_back(complexVar);
-		}
-		g_ueAntennaInstance.push_back(rxAntenna);
-	}
-    NS_LOG_INFO ("RxAntenna[instance:"<<g_ueAntennaInstance.size()<<"][antennaSize:"<<g_ueAntennaInstance[0].size()<<"]");
-}
-
-void
-MmWaveBeamforming::LoadEnbSpatialSignature ()
-{
-	std::string filename = "src/mmwave/model/BeamFormingMatrix/TxSpatialSigniture.txt";
-	NS_LOG_FUNCTION (this << "Loading TxspatialSigniture file " << filename);
-	std::ifstream singlefile;
-	std::string line;
-	std::string token;
-
-	uint16_t counter = 1;
-	std::complex<double> complexVar;
-	complex2DVector_t txSpatialMatrix;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_ASSERT_MSG (singlefile.good (), "TxSpatialSigniture file not found");
-
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	complexVector_t txSpatialElement;
-		std::istringstream stream(line);
-		while( getline(stream,token,',') ) //Parse each comma separated string in a line
-		{
-			complexVar = ParseComplex(token);
-			txSpatialElement.push_back(complexVar);
-		}
-		txSpatialMatrix.push_back(txSpatialElement);
-		if(counter % m_pathNum ==0 )
-		{
-			g_enbSpatialInstance.push_back(txSpatialMatrix);
-			txSpatialMatrix.clear();
-		}
-	    counter++;
-    }
-    NS_LOG_INFO ("TxspatialSigniture[instance:"<<g_enbSpatialInstance.size()<<"][path:"<<g_enbSpatialInstance[0].size()<<"][antennaSize:"<<g_enbSpatialInstance[0][0].size()<<"]");
+	// the tables are shared by all the instances, and the binary
+	// files written by mmwave-trace-converter are mapped without parsing
+	NS_LOG_FUNCTION (this << "Loading the beamforming files from " << m_matrixPath);
+	m_smallScaleFadingInstance = MmWaveTraceFile::LoadAny (m_matrixPath + "/SmallScaleFading", false);
+	m_enbAntennaInstance = MmWaveTraceFile::LoadAny (m_matrixPath + "/TxAntenna", true);
+	m_ueAntennaInstance = MmWaveTraceFile::LoadAny (m_matrixPath + "/RxAntenna", true);
+	m_enbSpatialInstance = MmWaveTraceFile::LoadAny (m_matrixPath + "/TxSpatialSigniture", true);
+	m_ueSpatialInstance = MmWaveTraceFile::LoadAny (m_matrixPath + "/RxSpatialSigniture", true);
+
+	NS_ABORT_MSG_IF (m_smallScaleFadingInstance->GetNRows () < g_numInstance
+			|| m_enbAntennaInstance->GetNRows () < g_numInstance
+			|| m_ueAntennaInstance->GetNRows () < g_numInstance
+			|| m_enbSpatialInstance->GetNRows () < g_numInstance * m_pathNum
+			|| m_ueSpatialInstance->GetNRows () < g_numInstance * m_pathNum,
+			"The beamforming files store less than " << g_numInstance << " instances");
+	NS_LOG_INFO ("SmallScaleFading[instance:"<<m_smallScaleFadingInstance->GetNRows ()<<"][path:"<<m_smallScaleFadingInstance->GetRowSize (0)<<"]");
+	NS_LOG_INFO ("TxAntenna[instance:"<<m_enbAntennaInstance->GetNRows ()<<"][antennaSize:"<<m_enbAntennaInstance->GetRowSize (0)<<"]");
+	NS_LOG_INFO ("RxAntenna[instance:"<<m_ueAntennaInstance->GetNRows ()<<"][antennaSize:"<<m_ueAntennaInstance->GetRowSize (0)<<"]");
 }
 
-void
-MmWaveBeamforming::LoadUeSpatialSignature ()
+complex2DVector_t
+MmWaveBeamforming::GetSpatialInstance (Ptr<const MmWaveTraceFile> spatial, uint32_t instance) const
 {
-	std::string strFilename = "src/mmwave/model/BeamFormingMatrix/RxSpatialSigniture.txt";
-	NS_LOG_FUNCTION (this << "Loading RxspatialSigniture file " << strFilename);
-	std::ifstream singlefile;
-	std::complex<double> complexVar;
-	complex2DVector_t rxSpatialMatrix;
-	singlefile.open (strFilename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << strFilename);
-	NS_ASSERT_MSG (singlefile.good (), " RxSpatialSigniture file not found");
-
-	std::string line;
-	std::string token;
-	int counter = 1;
-	while (std::getline(singlefile, line) ) //Parse each line of the file
+	// the file stores m_pathNum rows, one for each path, for each instance
+	complex2DVector_t spatialMatrix;
+	spatialMatrix.reserve (m_pathNum);
+	for (uint32_t pathIndex = 0; pathIndex < m_pathNum; pathIndex++)
 	{
-		 complexVector_t rxSpatialElement;
-	     std::istringstream stream(line);
-	     while (getline(stream,token,',') ) //Parse each comma separated string in a line
-	     {
-	    	 complexVar = ParseComplex (token);
-	    	 rxSpatialElement.push_back (complexVar);
-	     }
-	     rxSpatialMatrix.push_back (rxSpatialElement);
-	     if (counter % m_pathNum == 0)
-	     {
-		   	 g_ueSpatialInstance.push_back (rxSpatialMatrix);
-		   	 rxSpatialMatrix.clear ();
-		 }
-	     counter++;
+		spatialMatrix.push_back (spatial->GetComplexRowVector (instance * m_pathNum + pathIndex));
 	}
-	NS_LOG_INFO ("RxspatialSigniture[instance:"<<g_ueSpatialInstance.size()<<"][path:"<<g_ueSpatialInstance[0].size()<<"][antennaSize:"<<g_ueSpatialInstance[0][0].size()<<"]");
+	return spatialMatrix;
 }
 
 
@@ -404,16 +229,20 @@ MmWaveBeamforming::Initial(NetDeviceContainer ueDevices, NetDeviceContainer enbD
 void
 MmWaveBeamforming::SetChannelMatrix (Ptr<NetDevice> ueDevice, Ptr<NetDevice> enbDevice)
 {
+	if (m_smallScaleFadingInstance == 0)
+	{
+		LoadFile ();
+	}
 	key_t key = std::make_pair(ueDevice,enbDevice);
 	int randomInstance = m_uniformRV->GetValue (0, g_numInstance-1);
 	NS_LOG_UNCOND ("************* UPDATING CHANNEL MATRIX (instance " << randomInstance << ") *************");
 
 	Ptr<BeamformingParams> bfParams = Create<BeamformingParams> ();
-	bfParams->m_enbW = g_enbAntennaInstance.at (randomInstance);
-	bfParams->m_ueW = g_ueAntennaInstance.at (randomInstance);
-	bfParams->m_channelMatrix.m_enbSpatialMatrix = g_enbSpatialInstance.at (randomInstance);
-	bfParams->m_channelMatrix.m_ueSpatialMatrix = g_ueSpatialInstance.at (randomInstance);
-	bfParams->m_channelMatrix.m_powerFraction = g_smallScaleFadingInstance.at (randomInstance);
+	bfParams->m_enbW = m_enbAntennaInstance->GetComplexRowVector (randomInstance);
+	bfParams->m_ueW = m_ueAntennaInstance->GetComplexRowVector (randomInstance);
+	bfParams->m_channelMatrix.m_enbSpatialMatrix = GetSpatialInstance (m_enbSpatialInstance, randomInstance);
+	bfParams->m_channelMatrix.m_ueSpatialMatrix = GetSpatialInstance (m_ueSpatialInstance, randomInstance);
+	bfParams->m_channelMatrix.m_powerFraction = m_smallScaleFadingInstance->GetRowVector (randomInstance);
 	bfParams->m_beam = GetLongTermFading (bfParams);
 	std::map< key_t, Ptr<BeamformingParams> >::iterator iter = m_channelMatrixMap.find(key);
 	if (iter != m_channelMatrixMap.end ())
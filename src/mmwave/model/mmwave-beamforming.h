@@ -47,6 +47,7 @@
 #include <ns3/mmwave-phy-mac-common.h>
 #include <ns3/random-variable-stream.h>
 #include <ns3/antenna-array-model.h>
+#include <ns3/mmwave-trace-file.h>
 
 
 
@@ -126,31 +127,12 @@ public:
 
 private:
 	/**
-	* \breif Get complex number from a string
-	* \param strCmplx a string store complex bumber i.e. 3+2i,
-	* \return a complex number of the string
+	* \breif Get an instance of a spatial signature matrix
+	* \param spatial the table of the enb or ue spatial signatures
+	* \param instance the instance
+	* \return the spatial signature matrix [path][antenna]
 	*/
-	std::complex<double> ParseComplex (std::string strCmplx);
-	/**
-	* \breif Load file which store small scale fading sigma vector
-	*/
-	void LoadSmallScaleFading ();
-	/**
-	* \breif Load file which store antenna weights for enb
-	*/
-	void LoadEnbAntenna ();
-	/**
-	* \breif Load file which store antenna weights for ue
-	*/
-	void LoadUeAntenna ();
-	/**
-	* \breif Load file which store spatial signature matrix for  enb
-	*/
-	void LoadEnbSpatialSignature ();
-	/**
-	* \breif Load file which store spatial signature matrix for  ue
-	*/
-	void LoadUeSpatialSignature ();
+	complex2DVector_t GetSpatialInstance (Ptr<const MmWaveTraceFile> spatial, uint32_t instance) const;
 	/**
 	* \breif Calculate beamforming gain and fading distortion in frequency and time
 	* \param txPsd set of values vs frequency representing the
@@ -221,6 +203,13 @@ private:
 	bool m_update;
 	Ptr<UniformRandomVariable> m_uniformRV;
 
+	std::string m_matrixPath;
+	Ptr<const MmWaveTraceFile> m_enbAntennaInstance; // instances of txW
+	Ptr<const MmWaveTraceFile> m_ueAntennaInstance; // instances of rxW
+	Ptr<const MmWaveTraceFile> m_enbSpatialInstance; // instances of txE, m_pathNum rows for each
+	Ptr<const MmWaveTraceFile> m_ueSpatialInstance; // instances of rxE, m_pathNum rows for each
+	Ptr<const MmWaveTraceFile> m_smallScaleFadingInstance; // instances of the sigma vector
+
     //Ptr<ExponentialRandomVariable> m_nextLongTermUpdate;  // next update of long term statistics in microseconds
 };
 
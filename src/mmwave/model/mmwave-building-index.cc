@@ -0,0 +1,325 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-building-index.h"
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/building.h>
+#include <ns3/building-list.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBuildingIndex");
+
+/**
+ * Uniform grid over the footprints of the buildings, in compressed row
+ * format: the buildings of cell (ix, iy) are
+ * m_cellItems[m_cellStart[c]], ..., m_cellItems[m_cellStart[c + 1] - 1],
+ * with c = iy * m_nx + ix
+ */
+class MmWaveBuildingIndexPriv
+{
+public:
+	static MmWaveBuildingIndexPriv& Get ();
+	bool Query (const Vector &l1, const Vector &l2, bool footprint);
+
+private:
+	MmWaveBuildingIndexPriv ();
+	void Update ();
+	void Build ();
+	static void Clear ();
+	uint32_t GetCellX (double x) const;
+	uint32_t GetCellY (double y) const;
+
+	std::vector<Ptr<Building> > m_buildings;
+	std::vector<Box> m_boxes;
+	double m_xMin;
+	double m_xMax;
+	double m_yMin;
+	double m_yMax;
+	double m_cellSize;
+	double m_eps;
+	uint32_t m_nx;
+	uint32_t m_ny;
+	std::vector<uint32_t> m_cellStart;
+	std::vector<uint32_t> m_cellItems;
+	std::vector<uint32_t> m_visited;	///< stamp of the last query which tested each building
+	uint32_t m_stamp;
+	bool m_clearScheduled;
+};
+
+MmWaveBuildingIndexPriv::MmWaveBuildingIndexPriv ()
+	: m_xMin (0),
+	  m_xMax (0),
+	  m_yMin (0),
+	  m_yMax (0),
+	  m_cellSize (1),
+	  m_eps (0),
+	  m_nx (0),
+	  m_ny (0),
+	  m_stamp (0),
+	  m_clearScheduled (false)
+{
+}
+
+MmWaveBuildingIndexPriv&
+MmWaveBuildingIndexPriv::Get ()
+{
+	static MmWaveBuildingIndexPriv index;
+	return index;
+}
+
+void
+MmWaveBuildingIndexPriv::Clear ()
+{
+	MmWaveBuildingIndexPriv &index = Get ();
+	index.m_buildings.clear ();
+	index.m_boxes.clear ();
+	index.m_cellStart.clear ();
+	index.m_cellItems.clear ();
+	index.m_visited.clear ();
+	index.m_nx = 0;
+	index.m_ny = 0;
+	index.m_clearScheduled = false;
+}
+
+void
+MmWaveBuildingIndexPriv::Update ()
+{
+	uint32_t numBuildings = BuildingList::GetNBuildings ();
+	if (numBuildings != m_buildings.size ()
+			|| (numBuildings > 0 && BuildingList::GetBuilding (numBuildings - 1) != m_buildings.back ()))
+	{
+		Build ();
+	}
+}
+
+uint32_t
+MmWaveBuildingIndexPriv::GetCellX (double x) const
+{
+	double cell = std::floor ((x - m_xMin) / m_cellSize);
+	return (uint32_t) std::min (std::max (cell, 0.0), (double) m_nx - 1);
+}
+
+uint32_t
+MmWaveBuildingIndexPriv::GetCellY (double y) const
+{
+	double cell = std::floor ((y - m_yMin) / m_cellSize);
+	return (uint32_t) std::min (std::max (cell, 0.0), (double) m_ny - 1);
+}
+
+void
+MmWaveBuildingIndexPriv::Build ()
+{
+	m_buildings.clear ();
+	m_boxes.clear ();
+	m_xMin = m_yMin = std::numeric_limits<double>::max ();
+	m_xMax = m_yMax = -std::numeric_limits<double>::max ();
+	for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+	{
+		Box boundaries = (*bit)->GetBoundaries ();
+		m_buildings.push_back (*bit);
+		m_boxes.push_back (boundaries);
+		m_xMin = std::min (m_xMin, boundaries.xMin);
+		m_xMax = std::max (m_xMax, boundaries.xMax);
+		m_yMin = std::min (m_yMin, boundaries.yMin);
+		m_yMax = std::max (m_yMax, boundaries.yMax);
+	}
+
+	uint32_t numBuildings = m_boxes.size ();
+	m_cellStart.clear ();
+	m_cellItems.clear ();
+	m_visited.assign (numBuildings, 0);
+	m_stamp = 0;
+	if (numBuildings == 0)
+	{
+		m_nx = m_ny = 0;
+		return;
+	}
+
+	// about one cell per building
+	double width = std::max (m_xMax - m_xMin, 1.0);
+	double height = std::max (m_yMax - m_yMin, 1.0);
+	m_cellSize = std::max (std::sqrt (width * height / numBuildings), 1.0);
+	m_nx = std::ceil (width / m_cellSize);
+	m_ny = std::ceil (height / m_cellSize);
+	// the cells are visited conservatively, the exact test discards the false candidates
+	m_eps = 1e-6 * m_cellSize;
+
+	m_cellStart.assign (m_nx * m_ny + 1, 0);
+	for (uint32_t pass = 0; pass < 2; pass++)
+	{
+		std::vector<uint32_t> fill (m_cellStart.begin (), m_cellStart.end () - 1);
+		for (uint32_t b = 0; b < numBuildings; b++)
+		{
+			const Box &box = m_boxes[b];
+			for (uint32_t iy = GetCellY (box.yMin - m_eps); iy <= GetCellY (box.yMax + m_eps); iy++)
+			{
+				for (uint32_t ix = GetCellX (box.xMin - m_eps); ix <= GetCellX (box.xMax + m_eps); ix++)
+				{
+					if (pass == 0)
+					{
+						m_cellStart[iy * m_nx + ix + 1]++;
+					}
+					else
+					{
+						m_cellItems[fill[iy * m_nx + ix]++] = b;
+					}
+				}
+			}
+		}
+		if (pass == 0)
+		{
+			for (uint32_t c = 0; c < m_nx * m_ny; c++)
+			{
+				m_cellStart[c + 1] += m_cellStart[c];
+			}
+			m_cellItems.resize (m_cellStart.back ());
+		}
+	}
+	NS_LOG_LOGIC ("Indexed " << numBuildings << " buildings in " << m_nx << "x" << m_ny
+			<< " cells of " << m_cellSize << " m, " << m_cellItems.size () << " entries");
+
+	if (!m_clearScheduled)
+	{
+		Simulator::ScheduleDestroy (&MmWaveBuildingIndexPriv::Clear);
+		m_clearScheduled = true;
+	}
+}
+
+bool
+MmWaveBuildingIndexPriv::Query (const Vector &l1, const Vector &l2, bool footprint)
+{
+	Update ();
+	if (m_boxes.empty ())
+	{
+		return false;
+	}
+
+	double x0 = l1.x, y0 = l1.y, x1 = l2.x, y1 = l2.y;
+	if (x0 > x1)
+	{
+		std::swap (x0, x1);
+		std::swap (y0, y1);
+	}
+	if (x1 < m_xMin - m_eps || x0 > m_xMax + m_eps
+			|| std::max (y0, y1) < m_yMin - m_eps || std::min (y0, y1) > m_yMax + m_eps)
+	{
+		return false;
+	}
+
+	if (++m_stamp == 0)
+	{
+		std::fill (m_visited.begin (), m_visited.end (), 0);
+		m_stamp = 1;
+	}
+
+	// visit the columns crossed by the segment, and in each column the cells
+	// between the y coordinates of the segment at the borders of the column
+	uint32_t ixEnd = GetCellX (x1 + m_eps);
+	for (uint32_t ix = GetCellX (x0 - m_eps); ix <= ixEnd; ix++)
+	{
+		double left = (ix == 0) ? x0 : m_xMin + ix * m_cellSize;
+		double right = (ix == m_nx - 1) ? x1 : m_xMin + (ix + 1) * m_cellSize;
+		double xa = std::min (std::max (left, x0), x1);
+		double xb = std::min (std::max (right, x0), x1);
+		double ya = y0;
+		double yb = y1;
+		if (x1 > x0)
+		{
+			ya = y0 + (xa - x0) / (x1 - x0) * (y1 - y0);
+			yb = y0 + (xb - x0) / (x1 - x0) * (y1 - y0);
+		}
+
+		uint32_t iyEnd = GetCellY (std::max (ya, yb) + m_eps);
+		for (uint32_t iy = GetCellY (std::min (ya, yb) - m_eps); iy <= iyEnd; iy++)
+		{
+			uint32_t cell = iy * m_nx + ix;
+			for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; k++)
+			{
+				uint32_t b = m_cellItems[k];
+				if (m_visited[b] == m_stamp)
+				{
+					continue;
+				}
+				m_visited[b] = m_stamp;
+				if (MmWaveBuildingIndex::IsLineIntersectBox (l1, l2, m_boxes[b], footprint))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+
+bool
+MmWaveBuildingIndex::IsLineIntersectBuildings (const Vector &l1, const Vector &l2)
+{
+	return MmWaveBuildingIndexPriv::Get ().Query (l1, l2, false);
+}
+
+bool
+MmWaveBuildingIndex::IsLineIntersectFootprints (const Vector &l1, const Vector &l2)
+{
+	return MmWaveBuildingIndexPriv::Get ().Query (l1, l2, true);
+}
+
+bool
+MmWaveBuildingIndex::IsLineIntersectBox (const Vector &l1, const Vector &l2, const Box &boundaries, bool footprint)
+{
+	Vector boxSize (0.5*(boundaries.xMax - boundaries.xMin),
+			0.5*(boundaries.yMax - boundaries.yMin),
+			0.5*(boundaries.zMax - boundaries.zMin));
+	Vector boxCenter (boundaries.xMin + boxSize.x,
+			boundaries.yMin + boxSize.y,
+			boundaries.zMin + boxSize.z);
+
+	// Put line in box space
+	Vector LB1 (l1.x-boxCenter.x, l1.y-boxCenter.y, l1.z-boxCenter.z);
+	Vector LB2 (l2.x-boxCenter.x, l2.y-boxCenter.y, l2.z-boxCenter.z);
+
+	// Get line midpoint and extent
+	Vector LMid (0.5*(LB1.x+LB2.x), 0.5*(LB1.y+LB2.y), 0.5*(LB1.z+LB2.z));
+	Vector L (LB1.x - LMid.x, LB1.y - LMid.y, LB1.z - LMid.z);
+	Vector LExt ( std::abs(L.x), std::abs(L.y), std::abs(L.z) );
+
+	// Use Separating Axis Test
+	// Separation vector from box center to line center is LMid, since the line is in box space
+	if ( std::abs( LMid.x ) > boxSize.x + LExt.x ) return false;
+	if ( std::abs( LMid.y ) > boxSize.y + LExt.y ) return false;
+	if (!footprint)
+	{
+		if ( std::abs( LMid.z ) > boxSize.z + LExt.z ) return false;
+		// Crossproducts of line and each axis
+		if ( std::abs( LMid.y * L.z - LMid.z * L.y)  >  (boxSize.y * LExt.z + boxSize.z * LExt.y) ) return false;
+		if ( std::abs( LMid.x * L.z - LMid.z * L.x)  >  (boxSize.x * LExt.z + boxSize.z * LExt.x) ) return false;
+	}
+	if ( std::abs( LMid.x * L.y - LMid.y * L.x)  >  (boxSize.x * LExt.y + boxSize.y * LExt.x) ) return false;
+
+	// No separating axis, the line intersects
+	return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,75 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_BUILDING_INDEX_H
+#define MMWAVE_BUILDING_INDEX_H
+
+#include <ns3/vector.h>
+#include <ns3/box.h>
+
+namespace ns3 {
+
+/**
+ * Spatial index of the buildings of the BuildingList, shared by the
+ * propagation loss models that need to know whether a link is blocked.
+ *
+ * The footprints of the buildings are stored in a uniform 2D grid, with
+ * about one cell per building. A query visits only the cells crossed by
+ * the 2D projection of the segment, and runs the exact segment-box
+ * intersection test on the buildings registered in them.
+ *
+ * The index is built at the first query, and built again when buildings
+ * are added to the BuildingList, or after Simulator::Destroy. The buildings
+ * are not expected to be moved once the simulation has started.
+ */
+class MmWaveBuildingIndex
+{
+public:
+	/**
+	 * @params one end of the segment
+	 * @params the other end of the segment
+	 * @returns true if the segment intersects at least one building
+	 */
+	static bool IsLineIntersectBuildings (const Vector &l1, const Vector &l2);
+
+	/**
+	 * Same as IsLineIntersectBuildings, but the buildings are considered
+	 * infinitely tall, i.e., only the 2D projections are tested
+	 * @params one end of the segment
+	 * @params the other end of the segment
+	 * @returns true if the 2D projection of the segment intersects the footprint of at least one building
+	 */
+	static bool IsLineIntersectFootprints (const Vector &l1, const Vector &l2);
+
+	/**
+	 * Exact segment-box intersection, with the separating axis test.
+	 * It is based on the IsLineInBox method implemented in Bounding Box Types,
+	 * http://www.3dkingdoms.com/weekly/weekly.php?a=21
+	 * @params one end of the segment
+	 * @params the other end of the segment
+	 * @params the box
+	 * @params if true, the z axis is ignored
+	 * @returns true if the segment intersects the box
+	 */
+	static bool IsLineIntersectBox (const Vector &l1, const Vector &l2, const Box &box, bool footprint);
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_BUILDING_INDEX_H */
@@ -359,8 +359,8 @@ MmWaveChannelMatrix::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPs
 		}
 
 
-		complex2DVector_t txSpatialMatrix = GenSpatialMatrix (cluster,txAngles,txAntennaNum);
-		complex2DVector_t rxSpatialMatrix = GenSpatialMatrix (cluster,rxAngles,rxAntennaNum);
+		ComplexTensor txSpatialMatrix = GenSpatialMatrix (cluster,txAngles,txAntennaNum);
+		ComplexTensor rxSpatialMatrix = GenSpatialMatrix (cluster,rxAngles,rxAntennaNum);
 		Ptr<ChannelParams> channel = Create<ChannelParams> ();
 
 		channel->m_txSpatialMatrix = txSpatialMatrix;
@@ -487,10 +487,16 @@ MmWaveChannelMatrix::CalcBeamformingVector(complex2DVector_t spatialMatrix) cons
 */
 
 
-complex2DVector_t
+ComplexTensor
 MmWaveChannelMatrix::GenSpatialMatrix (std::vector<uint16_t> cluster, Angles angle, uint8_t* antennaNum) const
 {
-	complex2DVector_t spatialMatrix;
+	uint16_t pathNum = 0;
+	for(unsigned int clusterIndex = 0; clusterIndex < cluster.size (); clusterIndex++)
+	{
+		pathNum += cluster.at (clusterIndex);
+	}
+	ComplexTensor spatialMatrix (pathNum, antennaNum[0]*antennaNum[1]);
+	uint16_t pathIndex = 0;
 	for(unsigned int clusterIndex = 0; clusterIndex < cluster.size (); clusterIndex++)
 	{
 		double azimuthAngle;
@@ -512,7 +518,7 @@ MmWaveChannelMatrix::GenSpatialMatrix (std::vector<uint16_t> cluster, Angles ang
 			complexVector_t singlePath;
 			double subpathAngle = m_expRv->GetValue (0.178,0.7)/2;
 			singlePath = GenSinglePath (azimuthAngle+std::pow(-1,subpathIndex)*subpathAngle, verticalAngle, antennaNum);
-			spatialMatrix.push_back(singlePath);
+			std::copy (singlePath.begin (), singlePath.end (), spatialMatrix.GetRow (pathIndex++));
 		}
 	}
 	return spatialMatrix;
@@ -544,12 +550,33 @@ MmWaveChannelMatrix::GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmWaveB
 {
 	NS_LOG_FUNCTION (this);
 
-	NS_ASSERT(bfParams->m_channelParams->m_rxSpatialMatrix.size () == bfParams->m_channelParams->m_txSpatialMatrix.size ());
-	uint16_t pathNum = bfParams->m_channelParams->m_txSpatialMatrix.size ();
+	NS_ASSERT(bfParams->m_channelParams->m_rxSpatialMatrix.GetNumRows () == bfParams->m_channelParams->m_txSpatialMatrix.GetNumRows ());
+	uint16_t pathNum = bfParams->m_channelParams->m_txSpatialMatrix.GetNumRows ();
 	Time time = Simulator::Now ();
 	double t = time.GetSeconds ();
 	Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue> (txPsd);
 
+	// the beamforming gain of each path does not depend on the subband
+	complexVector_t pathBfGain (pathNum);
+	if(!bfParams->m_txW.empty () && !bfParams->m_rxW.empty ())
+	{
+		for (unsigned int pathIndex = 0; pathIndex < pathNum; pathIndex++)
+		{
+			const std::complex<double> *txRow = bfParams->m_channelParams->m_txSpatialMatrix.GetRow (pathIndex);
+			const std::complex<double> *rxRow = bfParams->m_channelParams->m_rxSpatialMatrix.GetRow (pathIndex);
+			std::complex<double> txSum, rxSum;
+			for (unsigned i = 0; i < bfParams->m_txW.size (); i++)
+			{
+				txSum += std::conj(txRow[i])*bfParams->m_txW[i];
+			}
+			for (unsigned i = 0; i < bfParams->m_rxW.size (); i++)
+			{
+				rxSum += rxRow[i]*std::conj(bfParams->m_rxW[i]);
+			}
+			pathBfGain[pathIndex] = txSum*rxSum;
+		}
+	}
+
 	Values::iterator vit = tempPsd->ValuesBegin ();
 	uint16_t iSubband = 0;
 
@@ -593,16 +620,7 @@ MmWaveChannelMatrix::GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmWaveB
 				else
 				{
 					/* beam forming*/
-					std::complex<double> txSum, rxSum;
-					for (unsigned i = 0; i < bfParams->m_txW.size (); i++)
-					{
-						txSum += std::conj(bfParams->m_channelParams->m_txSpatialMatrix.at (pathIndex).at (i))*bfParams->m_txW.at (i);
-					}
-					for (unsigned i = 0; i < bfParams->m_rxW.size (); i++)
-					{
-						rxSum += bfParams->m_channelParams->m_rxSpatialMatrix.at (pathIndex). at (i)*std::conj(bfParams->m_rxW.at (i));
-					}
-					subsbandGain = subsbandGain + txSum*rxSum*smallScaleFading;
+					subsbandGain = subsbandGain + pathBfGain[pathIndex]*smallScaleFading;
 				}
 			}
 			*vit = (*vit)*(norm (subsbandGain));
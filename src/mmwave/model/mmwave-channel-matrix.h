@@ -42,6 +42,7 @@
 #include <ns3/net-device-container.h>
 #include <ns3/random-variable-stream.h>
 #include "mmwave-phy-mac-common.h"
+#include "complex-tensor.h"
 
 
 
@@ -57,8 +58,8 @@ typedef std::pair<Ptr<NetDevice>, Ptr<NetDevice> > key_t;
 
 struct ChannelParams : public SimpleRefCount<ChannelParams>
 {
-	complex2DVector_t 	m_txSpatialMatrix; // tx side spatial matrix
-	complex2DVector_t 	m_rxSpatialMatrix; // rx side spatial matrix
+	ComplexTensor 		m_txSpatialMatrix; // tx side spatial matrix [path][antenna]
+	ComplexTensor 		m_rxSpatialMatrix; // rx side spatial matrix [path][antenna]
 	doubleVector_t 		m_powerFraction; // store subpath power fraction
 	doubleVector_t 		m_delaySpread; // store delay spread
 	doubleVector_t 		m_doppler; // store doppler
@@ -101,7 +102,7 @@ private:
 														Ptr<const MobilityModel> a,
 														Ptr<const MobilityModel> b) const;
 
-	complex2DVector_t GenSpatialMatrix (std::vector<uint16_t> cluster, Angles angle, uint8_t* antennaNum) const;
+	ComplexTensor GenSpatialMatrix (std::vector<uint16_t> cluster, Angles angle, uint8_t* antennaNum) const;
 	complexVector_t GenSinglePath (double hAngle, double vAngle, uint8_t* antennaNum) const;
 	//complexVector_t CalcBeamformingVector (complex2DVector_t SpatialMatrix) const;
 	Ptr<SpectrumValue> GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmWaveBeamFormingParams> bfParams, double speed) const;
@@ -41,6 +41,8 @@
 #include <ns3/mmwave-ue-phy.h>
 #include <ns3/mmwave-enb-phy.h>
 #include <ns3/double.h>
+#include <ns3/string.h>
+#include <ns3/abort.h>
 #include <algorithm>
 #include <fstream>
 
@@ -52,22 +54,15 @@ NS_LOG_COMPONENT_DEFINE ("MmWaveChannelRaytracing");
 NS_OBJECT_ENSURE_REGISTERED (MmWaveChannelRaytracing);
 
 
-doubleVector_t g_path; //number of multipath
-double2DVector_t g_delay; //delay spread in ns
-double2DVector_t g_pathloss;	//pathloss in DB
-double2DVector_t g_phase;	//???what is this
-double2DVector_t g_aodElevation;	//degree
-double2DVector_t g_aodAzimuth;	//degree
-double2DVector_t g_aoaElevation;	//degree
-double2DVector_t g_aoaAzimuth;	//degree
+// each trace (i.e., each position) is stored in 8 consecutive rows, see TraceRow_t
+static const uint32_t g_rowsPerTrace = 8;
 
 
 MmWaveChannelRaytracing::MmWaveChannelRaytracing ()
-	:m_antennaSeparation(0.5)
+	:m_antennaSeparation(0.5),
+	m_traceFile ("src/mmwave/model/Raytracing/traces10cm.txt")
 {
 	m_uniformRv = CreateObject<UniformRandomVariable> ();
-	LoadTraces();
-
 }
 
 TypeId
@@ -85,6 +80,11 @@ MmWaveChannelRaytracing::GetTypeId (void)
 			   DoubleValue (1.0),
 			   MakeDoubleAccessor (&MmWaveChannelRaytracing::m_speed),
 			   MakeDoubleChecker<double> ())
+	.AddAttribute ("TraceFile",
+			   "File with the raytracing traces, in the text format or in the binary format written by mmwave-trace-converter",
+			   StringValue ("src/mmwave/model/Raytracing/traces10cm.txt"),
+			   MakeStringAccessor (&MmWaveChannelRaytracing::m_traceFile),
+			   MakeStringChecker ())
 	;
 	return tid;
 }
@@ -113,78 +113,33 @@ MmWaveChannelRaytracing::GetConfigurationParameters (void) const
 }
 
 void
-MmWaveChannelRaytracing::LoadTraces()
+MmWaveChannelRaytracing::LoadTraces() const
 {
-	std::string filename = "src/mmwave/model/Raytracing/traces10cm.txt";
-	NS_LOG_FUNCTION (this << "Loading Raytracing file " << filename);
-	std::ifstream singlefile;
-	singlefile.open (filename.c_str (), std::ifstream::in);
-
-	NS_LOG_INFO (this << " File: " << filename);
-	NS_ASSERT_MSG(singlefile.good (), " Raytracing file not found");
-    std::string line;
-    std::string token;
-    uint16_t counter = 0;
-    while( std::getline(singlefile, line) ) //Parse each line of the file
-    {
-    	if(counter == 8)
-    	{
-    		counter = 0;
-    	}
-    	doubleVector_t path;
-        std::istringstream stream(line);
-        while( getline(stream,token,',') ) //Parse each comma separated string in a line
-        {
-            double sigma = 0.00;
-            std::stringstream stream( token );
-            stream>>sigma;
-        	path.push_back(sigma);
-		}
-
-		switch (counter)
-		{
-		case 0:
-			g_path.push_back (path.at (0));
-			break;
-		case 1:
-			g_delay.push_back (path);
-			break;
-		case 2:
-			g_pathloss.push_back (path);
-			break;
-		case 3:
-			g_phase.push_back (path);
-			break;
-		case 4:
-			g_aodElevation.push_back (path);
-			break;
-		case 5:
-			g_aodAzimuth.push_back (path);
-			break;
-		case 6:
-			g_aoaElevation.push_back (path);
-			break;
-		case 7:
-			g_aoaAzimuth.push_back (path);
-			break;
-		default:
-			NS_FATAL_ERROR("Never call this");
-			break;
-		}
-		counter++;
-	}
-
-	/*NS_LOG_UNCOND(g_path.size());
-	NS_LOG_UNCOND(g_delay.size());
-	NS_LOG_UNCOND(g_pathloss.size());
-	NS_LOG_UNCOND(g_phase.size());
-	NS_LOG_UNCOND(g_aodElevation.size());
-	NS_LOG_UNCOND(g_aodAzimuth.size());
-	NS_LOG_UNCOND(g_aoaElevation.size());
-	NS_LOG_UNCOND(g_aoaAzimuth.size());*/
+	// the table is shared by all the instances, and a binary file
+	// written by mmwave-trace-converter is mapped without parsing
+	NS_LOG_FUNCTION (this << "Loading Raytracing file " << m_traceFile);
+	m_traces = MmWaveTraceFile::Load (m_traceFile, false);
+	NS_ABORT_MSG_IF (m_traces->GetNRows () % g_rowsPerTrace != 0, "Raytracing file " << m_traceFile << " is truncated");
+}
 
+uint16_t
+MmWaveChannelRaytracing::GetPathNum (uint64_t traceIndex) const
+{
+	return m_traces->GetRow (traceIndex * g_rowsPerTrace + PATH_NUM)[0];
+}
 
+doubleVector_t
+MmWaveChannelRaytracing::GetTraceRow (uint64_t traceIndex, TraceRow_t row) const
+{
+	return m_traces->GetRowVector (traceIndex * g_rowsPerTrace + row);
+}
 
+double
+MmWaveChannelRaytracing::GetTraceValue (uint64_t traceIndex, TraceRow_t row, uint16_t pathIndex) const
+{
+	uint32_t rowIndex = traceIndex * g_rowsPerTrace + row;
+	NS_ASSERT (pathIndex < m_traces->GetRowSize (rowIndex));
+	return m_traces->GetRow (rowIndex)[pathIndex];
 }
 
 
@@ -352,6 +307,12 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
 	{
 		NS_FATAL_ERROR ("The maximum trace index is 26050");
 	}
+	if (m_traces == 0)
+	{
+		LoadTraces ();
+	}
+	NS_ABORT_MSG_IF ((traceIndex + 1) * g_rowsPerTrace > m_traces->GetNRows (),
+			"The trace index " << traceIndex << " is not in " << m_traceFile);
 	if(traceIndex != currentIndex)
 	{
 		currentIndex = traceIndex;
@@ -362,8 +323,8 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
 	if (it == m_channelMatrixMap.end ())
 	{
 
-		complex2DVector_t txSpatialMatrix;
-		complex2DVector_t rxSpatialMatrix;
+		ComplexTensor txSpatialMatrix;
+		ComplexTensor rxSpatialMatrix;
 		if(dl)
 		{
 			txSpatialMatrix = GenSpatialMatrix (traceIndex,txAntennaNum, true);
@@ -375,7 +336,7 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
 			rxSpatialMatrix = GenSpatialMatrix (traceIndex,rxAntennaNum, true);
 		}
 		doubleVector_t dopplerShift;
-		for (unsigned int i = 0; i < g_path.at(traceIndex); i++)
+		for (unsigned int i = 0; i < GetPathNum (traceIndex); i++)
 		{
 			dopplerShift.push_back(m_uniformRv->GetValue (0,1));
 		}
@@ -384,8 +345,8 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
 
 		channel->m_txSpatialMatrix = txSpatialMatrix;
 		channel->m_rxSpatialMatrix = rxSpatialMatrix;
-		channel->m_powerFraction = g_pathloss.at (traceIndex);
-		channel->m_delaySpread = g_delay.at (traceIndex);
+		channel->m_powerFraction = GetTraceRow (traceIndex, PATH_LOSS);
+		channel->m_delaySpread = GetTraceRow (traceIndex, DELAY);
 		channel->m_doppler = dopplerShift;
 
 
@@ -395,8 +356,8 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
 		Ptr<TraceParams> reverseChannel = Create<TraceParams> ();
 		reverseChannel->m_txSpatialMatrix = rxSpatialMatrix;
 		reverseChannel->m_rxSpatialMatrix = txSpatialMatrix;
-		reverseChannel->m_powerFraction = g_pathloss.at (traceIndex);;
-		reverseChannel->m_delaySpread = g_delay.at (traceIndex);
+		reverseChannel->m_powerFraction = GetTraceRow (traceIndex, PATH_LOSS);
+		reverseChannel->m_delaySpread = GetTraceRow (traceIndex, DELAY);
 		reverseChannel->m_doppler = dopplerShift;
 
 		m_channelMatrixMap.insert(std::make_pair(reverseKey,reverseChannel));
@@ -453,40 +414,32 @@ MmWaveChannelRaytracing::DoCalcRxPowerSpectralDensity (Ptr<const SpectrumValue>
 
 
 complexVector_t
-MmWaveChannelRaytracing::CalcBeamformingVector(complex2DVector_t spatialMatrix, doubleVector_t powerFraction) const
+MmWaveChannelRaytracing::CalcBeamformingVector(const ComplexTensor &spatialMatrix, const doubleVector_t &powerFraction) const
 {
 	complexVector_t antennaWeights;
-	uint16_t antennaNum = spatialMatrix.at (0).size ();
+	uint16_t antennaNum = spatialMatrix.GetNumCols ();
 	for (int i = 0; i< antennaNum; i++)
 	{
-		antennaWeights.push_back(spatialMatrix.at (0).at (i)/sqrt(antennaNum));
+		antennaWeights.push_back(spatialMatrix (0, i)/sqrt(antennaNum));
 	}
 
 	for(int iter = 0; iter<10; iter++)
 	{
-		complexVector_t antennaWeights_New;
+		complexVector_t antennaWeights_New (antennaNum);
 
-		for(unsigned pathIndex = 0; pathIndex<spatialMatrix.size (); pathIndex++)
+		for(unsigned pathIndex = 0; pathIndex<spatialMatrix.GetNumRows (); pathIndex++)
 		{
+			const std::complex<double> *path = spatialMatrix.GetRow (pathIndex);
 			std::complex<double> sum;
 			for (int i = 0; i< antennaNum; i++)
 			{
-				sum += std::conj(spatialMatrix.at (pathIndex).at (i))*antennaWeights.at (i);
+				sum += std::conj(path[i])*antennaWeights[i];
 			}
 
+			double pathPowerLinear = std::pow (10.0, (powerFraction. at(pathIndex)) / 10.0);
 			for (int i = 0; i< antennaNum; i++)
 			{
-                double pathPowerLinear = std::pow (10.0, (powerFraction. at(pathIndex)) / 10.0);
-
-
-				if(pathIndex ==0)
-				{
-					antennaWeights_New.push_back(pathPowerLinear*spatialMatrix.at (pathIndex).at (i)*sum);
-				}
-				else
-				{
-					antennaWeights_New.at (i) += pathPowerLinear*spatialMatrix.at (pathIndex).at (i)*sum;
-				}
+				antennaWeights_New[i] += pathPowerLinear*path[i]*sum;
 			}
 		}
 		//normalize antennaWeights;
@@ -506,28 +459,28 @@ MmWaveChannelRaytracing::CalcBeamformingVector(complex2DVector_t spatialMatrix,
 
 
 
-complex2DVector_t
+ComplexTensor
 MmWaveChannelRaytracing::GenSpatialMatrix (uint64_t traceIndex, uint8_t* antennaNum, bool bs) const
 {
-	complex2DVector_t spatialMatrix;
-	uint16_t pathNum = g_path.at (traceIndex);
+	uint16_t pathNum = GetPathNum (traceIndex);
+	ComplexTensor spatialMatrix (pathNum, antennaNum[0]*antennaNum[1]);
 	for(unsigned int pathIndex = 0; pathIndex < pathNum; pathIndex++)
 	{
 		double azimuthAngle;
 		double verticalAngle;
 		if(bs)
 		{
-			azimuthAngle = g_aodAzimuth.at (traceIndex).at (pathIndex);
-			verticalAngle = g_aodElevation.at (traceIndex).at (pathIndex);
+			azimuthAngle = GetTraceValue (traceIndex, AOD_AZIMUTH, pathIndex);
+			verticalAngle = GetTraceValue (traceIndex, AOD_ELEVATION, pathIndex);
 		}
 		else
 		{
-			azimuthAngle = g_aoaAzimuth.at (traceIndex).at (pathIndex);
-			verticalAngle = g_aoaElevation.at (traceIndex).at (pathIndex);
+			azimuthAngle = GetTraceValue (traceIndex, AOA_AZIMUTH, pathIndex);
+			verticalAngle = GetTraceValue (traceIndex, AOA_ELEVATION, pathIndex);
 		}
 		complexVector_t singlePath;
 		singlePath = GenSinglePath (azimuthAngle*M_PI/180, verticalAngle*M_PI/180, antennaNum);
-		spatialMatrix.push_back(singlePath);
+		std::copy (singlePath.begin (), singlePath.end (), spatialMatrix.GetRow (pathIndex));
 	}
 
 	return spatialMatrix;
@@ -559,8 +512,8 @@ MmWaveChannelRaytracing::GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmW
 {
 	NS_LOG_FUNCTION (this);
 
-	NS_ASSERT(bfParams->m_channelParams->m_rxSpatialMatrix.size () == bfParams->m_channelParams->m_txSpatialMatrix.size ());
-	uint16_t pathNum = bfParams->m_channelParams->m_txSpatialMatrix.size ();
+	NS_ASSERT(bfParams->m_channelParams->m_rxSpatialMatrix.GetNumRows () == bfParams->m_channelParams->m_txSpatialMatrix.GetNumRows ());
+	uint16_t pathNum = bfParams->m_channelParams->m_txSpatialMatrix.GetNumRows ();
 	Time time = Simulator::Now ();
 	double t = time.GetSeconds ();
 	Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue> (txPsd);
@@ -570,6 +523,27 @@ MmWaveChannelRaytracing::GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmW
 		noSpeed = true;
 	}
 
+	// the beamforming gain of each path does not depend on the subband
+	complexVector_t pathBfGain (pathNum);
+	if(!bfParams->m_txW.empty () && !bfParams->m_rxW.empty ())
+	{
+		for (unsigned int pathIndex = 0; pathIndex < pathNum; pathIndex++)
+		{
+			const std::complex<double> *txRow = bfParams->m_channelParams->m_txSpatialMatrix.GetRow (pathIndex);
+			const std::complex<double> *rxRow = bfParams->m_channelParams->m_rxSpatialMatrix.GetRow (pathIndex);
+			std::complex<double> txSum, rxSum;
+			for (unsigned i = 0; i < bfParams->m_txW.size (); i++)
+			{
+				txSum += std::conj(txRow[i])*bfParams->m_txW[i];
+			}
+			for (unsigned i = 0; i < bfParams->m_rxW.size (); i++)
+			{
+				rxSum += rxRow[i]*std::conj(bfParams->m_rxW[i]);
+			}
+			pathBfGain[pathIndex] = txSum*rxSum;
+		}
+	}
+
 	Values::iterator vit = tempPsd->ValuesBegin ();
 	uint16_t iSubband = 0;
 	while (vit != tempPsd->ValuesEnd ())
@@ -607,16 +581,7 @@ MmWaveChannelRaytracing::GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmW
 				else
 				{
 					/* beam forming*/
-					std::complex<double> txSum, rxSum;
-					for (unsigned i = 0; i < bfParams->m_txW.size (); i++)
-					{
-						txSum += std::conj(bfParams->m_channelParams->m_txSpatialMatrix.at (pathIndex).at (i))*bfParams->m_txW.at (i);
-					}
-					for (unsigned i = 0; i < bfParams->m_rxW.size (); i++)
-					{
-						rxSum += bfParams->m_channelParams->m_rxSpatialMatrix.at (pathIndex). at (i)*std::conj(bfParams->m_rxW.at (i));
-					}
-					subsbandGain = subsbandGain + txSum*rxSum*smallScaleFading;
+					subsbandGain = subsbandGain + pathBfGain[pathIndex]*smallScaleFading;
 				}
 			}
 			*vit = (*vit)*(norm (subsbandGain));
@@ -42,6 +42,8 @@
 #include <ns3/net-device-container.h>
 #include <ns3/random-variable-stream.h>
 #include "mmwave-phy-mac-common.h"
+#include "complex-tensor.h"
+#include "mmwave-trace-file.h"
 
 
 
@@ -57,8 +59,8 @@ typedef std::pair<Ptr<NetDevice>, Ptr<NetDevice> > key_t;
 
 struct TraceParams : public SimpleRefCount<TraceParams>
 {
-	complex2DVector_t 	m_txSpatialMatrix; // tx side spatial matrix
-	complex2DVector_t 	m_rxSpatialMatrix; // rx side spatial matrix
+	ComplexTensor 		m_txSpatialMatrix; // tx side spatial matrix [path][antenna]
+	ComplexTensor 		m_rxSpatialMatrix; // rx side spatial matrix [path][antenna]
 	doubleVector_t 		m_powerFraction; // store subpath power fraction
 	doubleVector_t 		m_delaySpread; // store delay spread
 	doubleVector_t 		m_doppler; // store doppler
@@ -84,7 +86,7 @@ public:
 
 	static TypeId GetTypeId (void);
 	void DoDispose ();
-	void LoadTraces();
+	void LoadTraces() const;
 	void ConnectDevices (Ptr<NetDevice> dev1, Ptr<NetDevice> dev2);
 	void Initial(NetDeviceContainer ueDevices, NetDeviceContainer enbDevices);
 
@@ -102,9 +104,25 @@ private:
 														Ptr<const MobilityModel> a,
 														Ptr<const MobilityModel> b) const;
 
-	complex2DVector_t GenSpatialMatrix (uint64_t traceIndex, uint8_t* antennaNum, bool bs) const;
+	// rows of the raytracing file for each trace, i.e., for each position
+	enum TraceRow_t
+	{
+		PATH_NUM = 0, //number of multipath
+		DELAY, //delay spread in ns
+		PATH_LOSS, //pathloss in DB
+		PHASE,
+		AOD_ELEVATION, //degree
+		AOD_AZIMUTH, //degree
+		AOA_ELEVATION, //degree
+		AOA_AZIMUTH //degree
+	};
+	uint16_t GetPathNum (uint64_t traceIndex) const;
+	doubleVector_t GetTraceRow (uint64_t traceIndex, TraceRow_t row) const;
+	double GetTraceValue (uint64_t traceIndex, TraceRow_t row, uint16_t pathIndex) const;
+
+	ComplexTensor GenSpatialMatrix (uint64_t traceIndex, uint8_t* antennaNum, bool bs) const;
 	complexVector_t GenSinglePath (double hAngle, double vAngle, uint8_t* antennaNum) const;
-	complexVector_t CalcBeamformingVector (complex2DVector_t SpatialMatrix, doubleVector_t powerFraction) const;
+	complexVector_t CalcBeamformingVector (const ComplexTensor &spatialMatrix, const doubleVector_t &powerFraction) const;
 	Ptr<SpectrumValue> GetChannelGain (Ptr<const SpectrumValue> txPsd, Ptr<mmWaveBeamFormingTraces> bfParams, double speed) const;
 	double GetSystemBandwidth () const;
 
@@ -115,6 +133,8 @@ private:
 	Ptr<MmWavePhyMacCommon> m_phyMacConfig;
 	uint16_t m_startDistance;
 	double m_speed;
+	std::string m_traceFile;
+	mutable Ptr<const MmWaveTraceFile> m_traces;
 };
 
 
@@ -28,12 +28,89 @@
 
 
 #include <ns3/log.h>
+#include <ns3/global-value.h>
+#include <ns3/boolean.h>
 #include "mmwave-control-messages.h"
+#include <vector>
+#include <new>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("mmWaveControlMessage");
 
+static GlobalValue g_mmWaveControlMessagePool = GlobalValue ("MmWaveControlMessagePool",
+                                                             "Recycle the memory of the mmWave control messages through free lists, "
+                                                             "disable to allocate each message from the heap",
+                                                             BooleanValue (true),
+                                                             MakeBooleanChecker ());
+
+/// the blocks are rounded to multiples of this size, each multiple has its free list
+static const size_t g_messageBlockGranularity = 16;
+/// larger messages are always allocated from the heap
+static const size_t g_maxPooledMessageSize = 1024;
+
+/**
+ * Free lists of the blocks released by the control messages, indexed by
+ * the size of the blocks in units of g_messageBlockGranularity. Each block
+ * is allocated on its own with ::operator new, so that it can be released
+ * to the heap at any time, also if the pool was disabled in the meantime.
+ */
+static std::vector<std::vector<void*> >&
+GetMessageFreeLists ()
+{
+	static std::vector<std::vector<void*> > freeLists (g_maxPooledMessageSize / g_messageBlockGranularity + 1);
+	return freeLists;
+}
+
+bool
+MmWaveControlMessage::IsPoolEnabled (void)
+{
+	static bool enabled = false;
+	static bool initialized = false;
+	if (!initialized)
+	{
+		BooleanValue value;
+		g_mmWaveControlMessagePool.GetValue (value);
+		enabled = value.Get ();
+		initialized = true;
+	}
+	return enabled;
+}
+
+void*
+MmWaveControlMessage::operator new (size_t size)
+{
+	if (size > g_maxPooledMessageSize || !IsPoolEnabled ())
+	{
+		return ::operator new (size);
+	}
+	size_t units = (size + g_messageBlockGranularity - 1) / g_messageBlockGranularity;
+	std::vector<void*> &freeList = GetMessageFreeLists ()[units];
+	if (freeList.empty ())
+	{
+		return ::operator new (units * g_messageBlockGranularity);
+	}
+	void *block = freeList.back ();
+	freeList.pop_back ();
+	return block;
+}
+
+void
+MmWaveControlMessage::operator delete (void *block, size_t size)
+{
+	if (block == 0)
+	{
+		return;
+	}
+	if (size > g_maxPooledMessageSize || !IsPoolEnabled ())
+	{
+		::operator delete (block);
+		return;
+	}
+	size_t units = (size + g_messageBlockGranularity - 1) / g_messageBlockGranularity;
+	GetMessageFreeLists ()[units].push_back (block);
+}
+
 MmWaveControlMessage::MmWaveControlMessage (void)
 {
 	NS_LOG_INFO (this);
@@ -39,6 +39,16 @@
 
 namespace ns3 {
 
+/**
+ * Base class of the control messages exchanged by the mmWave MAC and PHY.
+ *
+ * Several messages (DCIs, CQI reports, HARQ feedback) are created at every
+ * slot and released as soon as they are delivered, thus the memory of all
+ * the subclasses is recycled through free lists, one for each block size,
+ * instead of going back to the heap every time. The pool can be disabled,
+ * e.g., to debug with valgrind, with the global value
+ * MmWaveControlMessagePool, which is read at the first allocation.
+ */
 class MmWaveControlMessage : public SimpleRefCount<MmWaveControlMessage>
 {
 public:
@@ -62,6 +72,25 @@ public:
 
 	messageType GetMessageType (void);
 
+	/**
+	 * Get a block for a message from the pool of the blocks of its size
+	 * @params the size of the message
+	 * @returns the block
+	 */
+	static void* operator new (size_t size);
+
+	/**
+	 * Give the block of a message back to the pool
+	 * @params the block
+	 * @params the size of the message
+	 */
+	static void operator delete (void *block, size_t size);
+
+	/**
+	 * @returns true if the memory of the messages is recycled
+	 */
+	static bool IsPoolEnabled (void);
+
 private:
 	messageType m_messageType;
 };
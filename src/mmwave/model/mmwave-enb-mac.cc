@@ -354,6 +354,11 @@ MmWaveEnbMac::GetTypeId (void)
 					"MAC transmission with tb size and number of retx.",
 					MakeTraceSourceAccessor (&MmWaveEnbMac::m_macDlTxSizeRetx),
 					"ns3::LteRlc::RetransmissionCountCallback")
+	        .AddTraceSource ("HarqCopiedBytes",
+					"Total number of bytes copied to retransmit the PDUs of the DL HARQ buffers, "
+					"when they are still referenced by the PHY or by the channel.",
+					MakeTraceSourceAccessor (&MmWaveEnbMac::m_harqCopiedBytes),
+					"ns3::TracedValueCallback::Uint64")
 	;
 	return tid;
 }
@@ -362,7 +367,8 @@ MmWaveEnbMac::MmWaveEnbMac (void) :
 	 m_frameNum (0),
 	 m_sfNum (0),
 	 m_slotNum (0),
-	 m_tbUid (0)
+	 m_tbUid (0),
+	 m_harqCopiedBytes (0)
 {
 	NS_LOG_FUNCTION (this);
 	m_cmacSapProvider = new MmWaveEnbMacMemberEnbCmacSapProvider (this);
@@ -721,8 +727,7 @@ MmWaveEnbMac::DoDlHarqFeedback (DlHarqInfo params)
   if (params.m_harqStatus == DlHarqInfo::ACK)
   {
   	// discard buffer
-  	Ptr<PacketBurst> emptyBuf = CreateObject <PacketBurst> ();
-  	(*it).second.at (params.m_harqProcessId).m_pktBurst = emptyBuf;
+  	(*it).second.at (params.m_harqProcessId).m_pduBuffer.Clear ();
   	NS_LOG_DEBUG (this << " HARQ-ACK UE " << params.m_rnti << " harqId " << (uint16_t)params.m_harqProcessId);
   }
   else if (params.m_harqStatus == DlHarqInfo::NACK)
@@ -849,8 +854,7 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
 					// new data -> force emptying correspondent harq pkt buffer
 					std::map <uint16_t, MmWaveDlHarqProcessesBuffer_t>::iterator harqIt = m_miDlHarqProcessesPackets.find (rnti);
 					NS_ASSERT(harqIt!=m_miDlHarqProcessesPackets.end());
-					Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-					harqIt->second.at (tbUid).m_pktBurst = pb;
+					harqIt->second.at (tbUid).m_pduBuffer.Clear ();
 					harqIt->second.at (tbUid).m_lcidList.clear ();
 
 					std::map<uint32_t, struct MacPduInfo>::iterator pduMapIt = mapRet.first;
@@ -885,7 +889,7 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
 						NS_LOG_DEBUG("Subheader " << i << " size " << pduMapIt->second.m_macHeader.GetSubheaders().at(i).m_size);
 					}
 					NS_LOG_DEBUG ("Total MAC PDU size " << pduMapIt->second.m_pdu->GetSize());
-					harqIt->second.at (tbUid).m_pktBurst->AddPacket (pduMapIt->second.m_pdu);
+					harqIt->second.at (tbUid).m_pduBuffer.AddPdu (pduMapIt->second.m_pdu);
 
 					m_phySapProvider->SendMacPdu (pduMapIt->second.m_pdu);
 					m_macPduMap.erase (pduMapIt);  // delete map entry
@@ -898,10 +902,11 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
 						// HARQ retransmission -> retrieve TB from HARQ buffer
 						std::map <uint16_t, MmWaveDlHarqProcessesBuffer_t>::iterator it = m_miDlHarqProcessesPackets.find (rnti);
 						NS_ASSERT(it!=m_miDlHarqProcessesPackets.end());
-						Ptr<PacketBurst> pb = it->second.at (tbUid).m_pktBurst;
-						for (std::list<Ptr<Packet> >::const_iterator j = pb->Begin (); j != pb->End (); ++j)
+						MmWaveHarqPduBuffer &pduBuffer = it->second.at (tbUid).m_pduBuffer;
+						uint64_t copiedBytes = 0;
+						for (uint32_t ipdu = 0; ipdu < pduBuffer.GetNPdus (); ipdu++)
 						{
-							Ptr<Packet> pkt = (*j)->Copy ();
+							Ptr<Packet> pkt = pduBuffer.GetPduForUpdate (ipdu, copiedBytes);
 							MmWaveMacPduTag tag; 						// update PDU tag for retransmission
 							if(!pkt->RemovePacketTag (tag))
 							{
@@ -913,6 +918,10 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
 							pkt->AddPacketTag (tag);
 							m_phySapProvider->SendMacPdu (pkt);
 						}
+						if (copiedBytes > 0)
+						{
+							m_harqCopiedBytes += copiedBytes;
+						}
 					}
 				}
 			}
@@ -964,11 +973,6 @@ MmWaveEnbMac::DoAddUe (uint16_t rnti)
 	MmWaveDlHarqProcessesBuffer_t buf;
 	uint16_t harqNum = m_phyMacConfig->GetNumHarqProcess ();
 	buf.resize (harqNum);
-	for (uint8_t i = 0; i < harqNum; i++)
-	{
-		Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-		buf.at (i).m_pktBurst = pb;
-	}
 	m_miDlHarqProcessesPackets.insert (std::pair <uint16_t, MmWaveDlHarqProcessesBuffer_t> (rnti, buf));
 
 }
@@ -38,13 +38,14 @@
 #include <ns3/lte-enb-cmac-sap.h>
 #include <ns3/lte-mac-sap.h>
 #include "mmwave-phy-mac-common.h"
+#include <ns3/traced-value.h>
 
 namespace ns3
 {
 
 	struct MmWaveDlHarqProcessInfo
 	{
-		Ptr<PacketBurst> m_pktBurst;
+		MmWaveHarqPduBuffer m_pduBuffer;
 		// maintain list of LCs contained in this TB
 		// used to signal HARQ failure to RLC handlers
 		std::vector<uint8_t> m_lcidList;
@@ -245,6 +246,8 @@ private:
 
 	TracedCallback<uint16_t, uint16_t, uint32_t, uint8_t> m_macDlTxSizeRetx;
 
+	TracedValue<uint64_t> m_harqCopiedBytes; // bytes copied to retransmit the PDUs of the HARQ buffers
+
 };
 
 }
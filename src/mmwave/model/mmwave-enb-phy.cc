@@ -40,6 +40,7 @@
 #include <ns3/simulator.h>
 #include <ns3/attribute-accessor-helper.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 
 #include "mmwave-enb-phy.h"
 #include "mmwave-ue-phy.h"
@@ -153,10 +154,26 @@ MmWaveEnbPhy::GetTypeId (void)
 				    PointerValue (),
 				    MakePointerAccessor (&MmWaveEnbPhy::GetUlSpectrumPhy),
 				    MakePointerChecker <MmWaveSpectrumPhy> ())
+	.AddAttribute ("IncrementalSinrEstimate",
+	               "If true, the rx PSD of a UE used for the SINR estimate is reused in the next update "
+	               "if the channel, the positions, the beams and the pathloss of the pair did not change",
+	               BooleanValue (true),
+	               MakeBooleanAccessor (&MmWaveEnbPhy::m_incrementalSinrEstimate),
+	               MakeBooleanChecker())
+	.AddAttribute ("SinrEstimatePathlossThreshold",
+	               "Pathloss (in dB) above which the SINR estimate of a UE only accounts for the pathloss, "
+	               "without evaluating the spectrum propagation loss model. The default value disables the pruning",
+	               DoubleValue (1000.0),
+	               MakeDoubleAccessor (&MmWaveEnbPhy::m_sinrEstimatePathlossThreshold),
+	               MakeDoubleChecker<double> ())
 	 .AddTraceSource ("UlSinrTrace",
 					  "UL SINR statistics.",
 					  MakeTraceSourceAccessor (&MmWaveEnbPhy::m_ulSinrTrace),
 					  "ns3::UlSinr::TracedCallback")
+	 .AddTraceSource ("SinrEstimateStats",
+					  "Number of UE-eNB pairs whose rx PSD was recomputed, reused and pruned in an update of the SINR estimate",
+					  MakeTraceSourceAccessor (&MmWaveEnbPhy::m_sinrEstimateStatsTrace),
+					  "ns3::MmWaveEnbPhy::SinrEstimateStatsTracedCallback")
 
 	;
   return tid;
@@ -741,6 +758,14 @@ MmWaveEnbPhy::CallPathloss()
 
 
 
+MmWaveEnbPhy::SinrEstimateCacheEntry::SinrEstimateCacheEntry ()
+	: m_pruned (false),
+	  m_txPower (0),
+	  m_pathLossDb (0),
+	  m_channelTime (Seconds (-1))
+{
+}
+
 void
 MmWaveEnbPhy::UpdateUeSinrEstimate()
 {
@@ -752,57 +777,60 @@ MmWaveEnbPhy::UpdateUeSinrEstimate()
 	Ptr<SpectrumValue> noisePsd = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
 	Ptr<SpectrumValue> totalReceivedPsd = Create <SpectrumValue> (SpectrumValue(noisePsd->GetSpectrumModel()));
 
+	Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
+	Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
+	Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
+	Ptr<MmWave3gppChannel> mmWave3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
+
+	// get this node mobility
+	Ptr<MobilityModel> enbMob = m_netDevice->GetNode()->GetObject<MobilityModel>();
+	NS_LOG_LOGIC("eNB mobility " << enbMob->GetPosition());
+	Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna());
+
+	uint32_t numRecomputed = 0;
+	uint32_t numReused = 0;
+	uint32_t numPruned = 0;
+
 	for(std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin(); ue != m_ueAttachedImsiMap.end(); ++ue)
 	{
-		// distinguish between MC and MmWaveNetDevice
-		Ptr<MmWaveUeNetDevice> ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ue->second);
-		Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
-		Ptr<MmWaveIabNetDevice> iabDev = DynamicCast<MmWaveIabNetDevice> (ue->second);
-		Ptr<MmWaveUePhy> uePhy;
-		// get tx power
-		double ueTxPower = 0;
-		if(ueNetDevice != 0) 
-		{
-			uePhy = ueNetDevice->GetPhy();
-			ueTxPower = uePhy->GetTxPower();
-		}
-		else if (mcUeDev != 0) // it may be a MC device
-		{
-			
-			uePhy = mcUeDev->GetMmWavePhy ();
-			ueTxPower = uePhy->GetTxPower();	
-		}
-		else if (iabDev != 0)
+		SinrEstimateCacheEntry &entry = m_sinrEstimateCache[ue->first];
+		if (entry.m_device != ue->second)
 		{
-			uePhy = iabDev->GetBackhaulPhy();
-			ueTxPower = uePhy->GetTxPower();
-		}
-		else
-		{
-			NS_FATAL_ERROR("Unrecognized device");
+			// distinguish between MC and MmWaveNetDevice, only once for each device
+			entry = SinrEstimateCacheEntry ();
+			entry.m_device = ue->second;
+			entry.m_ueNetDevice = DynamicCast<MmWaveUeNetDevice> (ue->second);
+			entry.m_mcUeDev = DynamicCast<McUeNetDevice> (ue->second);
+			entry.m_iabDev = DynamicCast<MmWaveIabNetDevice> (ue->second);
+			if(entry.m_ueNetDevice != 0)
+			{
+				entry.m_uePhy = entry.m_ueNetDevice->GetPhy();
+			}
+			else if (entry.m_mcUeDev != 0) // it may be a MC device
+			{
+				entry.m_uePhy = entry.m_mcUeDev->GetMmWavePhy ();
+			}
+			else if (entry.m_iabDev != 0)
+			{
+				entry.m_uePhy = entry.m_iabDev->GetBackhaulPhy();
+			}
+			else
+			{
+				NS_FATAL_ERROR("Unrecognized device");
+			}
 		}
+		Ptr<MmWaveUePhy> uePhy = entry.m_uePhy;
+		// get tx power
+		double ueTxPower = uePhy->GetTxPower();
 		NS_LOG_LOGIC("UE Tx power = " << ueTxPower);
-	    double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
-	    double txPowerDensity = 0;
-    	txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth()));
-	    NS_LOG_LOGIC("Linear UE Tx power = " << powerTxW);
-	    NS_LOG_LOGIC("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth());
-	    NS_LOG_LOGIC("txPowerDensity = " << txPowerDensity);
-		// create tx psd
-		Ptr<SpectrumValue> txPsd =						// it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
-			MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
-		NS_LOG_LOGIC("TxPsd " << *txPsd);
 
-		// get this node and remote node mobility
-		Ptr<MobilityModel> enbMob = m_netDevice->GetNode()->GetObject<MobilityModel>(); 
-		NS_LOG_LOGIC("eNB mobility " << enbMob->GetPosition());
+		// get remote node mobility
 		Ptr<MobilityModel> ueMob = ue->second->GetNode()->GetObject<MobilityModel>();
 		NS_LOG_DEBUG("UE mobility " << ueMob->GetPosition());
 		
 		// compute rx psd
 
 		// adjuts beamforming of antenna model wrt user
-		Ptr<AntennaArrayModel> rxAntennaArray = DynamicCast<AntennaArrayModel> (GetDlSpectrumPhy ()->GetRxAntenna());
 		rxAntennaArray->ChangeBeamformingVector (ue->second);									// TODO check if this is the correct antenna
 		Ptr<AntennaArrayModel> txAntennaArray = DynamicCast<AntennaArrayModel> (uePhy->GetDlSpectrumPhy ()->GetRxAntenna());
 																						// Dl, since the Ul is not actually used (TDD device)
@@ -835,66 +863,116 @@ MmWaveEnbPhy::UpdateUeSinrEstimate()
 		}                    
 		//NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");    
 
-		double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-		Ptr<SpectrumValue> rxPsd = txPsd->Copy();
-		*(rxPsd) *= pathGainLinear;              
-
-		Ptr<MmWaveBeamforming> beamforming = DynamicCast<MmWaveBeamforming> (m_spectrumPropagationLossModel);
-		//beamforming->SetBeamformingVector(ue->second, m_netDevice);
-		Ptr<MmWaveChannelMatrix> channelMatrix = DynamicCast<MmWaveChannelMatrix> (m_spectrumPropagationLossModel);
-		Ptr<MmWaveChannelRaytracing> rayTracing = DynamicCast<MmWaveChannelRaytracing> (m_spectrumPropagationLossModel);
-		Ptr<MmWave3gppChannel> mmWave3gpp = DynamicCast<MmWave3gppChannel> (m_spectrumPropagationLossModel);
-		if (beamforming != 0)
+		// the rx PSD of the previous period can be reused if nothing it depends on has changed:
+		// only the 3GPP channel model exposes when the channel was generated, and
+		// the LOS state of the traces of m_losTracker may change at any time
+		bool prune = pathLossDb > m_sinrEstimatePathlossThreshold;
+		Time channelTime = (mmWave3gpp != 0) ? mmWave3gpp->GetChannelGenerationTime (ueMob, enbMob) : Seconds (-1);
+		complexVector_t txBf = txAntennaArray->GetBeamformingVector ();
+		complexVector_t rxBf = rxAntennaArray->GetBeamformingVector ();
+		bool reuse = m_incrementalSinrEstimate && entry.m_rxPsd != 0 && m_losTracker == 0
+				&& entry.m_pruned == prune && entry.m_txPower == ueTxPower && entry.m_pathLossDb == pathLossDb
+				&& CalculateDistance (entry.m_uePosition, ueMob->GetPosition ()) == 0
+				&& CalculateDistance (entry.m_enbPosition, enbMob->GetPosition ()) == 0
+				&& entry.m_txBf == txBf && entry.m_rxBf == rxBf
+				&& (prune || (channelTime.IsPositive () && channelTime == entry.m_channelTime));
+
+		Ptr<SpectrumValue> rxPsd;
+		if (reuse)
 		{
-			rxPsd = beamforming->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
+			rxPsd = entry.m_rxPsd;
+			numReused++;
 		}
-		else if (channelMatrix != 0)
-		{
-			rxPsd = channelMatrix->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}
-		else if (rayTracing != 0)
+		else
 		{
-			rxPsd = rayTracing->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
+		    double powerTxW = std::pow (10., (ueTxPower - 30) / 10);
+		    double txPowerDensity = 0;
+	    	txPowerDensity = (powerTxW / (m_phyMacConfig->GetSystemBandwidth()));
+		    NS_LOG_LOGIC("Linear UE Tx power = " << powerTxW);
+		    NS_LOG_LOGIC("System bandwidth = " << m_phyMacConfig->GetSystemBandwidth());
+		    NS_LOG_LOGIC("txPowerDensity = " << txPowerDensity);
+			// create tx psd
+			Ptr<SpectrumValue> txPsd =						// it is the eNB that dictates the conf, m_listOfSubchannels contains all the subch
+				MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (m_phyMacConfig, ueTxPower, m_listOfSubchannels);
+			NS_LOG_LOGIC("TxPsd " << *txPsd);
+
+			double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+			rxPsd = txPsd->Copy();
+			*(rxPsd) *= pathGainLinear;              
+
+			if (prune)
+			{
+				// the pair is too weak to be worth the evaluation of the beamforming gain
+				NS_LOG_LOGIC("Pathloss " << pathLossDb << " dB above the threshold, skip the channel evaluation");
+				numPruned++;
+			}
+			else
+			{
+				if (beamforming != 0)
+				{
+					rxPsd = beamforming->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+					NS_LOG_LOGIC("RxPsd " << *rxPsd);
+				}
+				else if (channelMatrix != 0)
+				{
+					rxPsd = channelMatrix->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+					NS_LOG_LOGIC("RxPsd " << *rxPsd);
+				}
+				else if (rayTracing != 0)
+				{
+					rxPsd = rayTracing->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+					NS_LOG_LOGIC("RxPsd " << *rxPsd);
+				}
+				else if (mmWave3gpp != 0)
+				{
+					rxPsd = mmWave3gpp->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
+					NS_LOG_LOGIC("RxPsd " << *rxPsd);
+					// the evaluation may have generated a new channel
+					channelTime = mmWave3gpp->GetChannelGenerationTime (ueMob, enbMob);
+				}
+				numRecomputed++;
+			}
+
+			entry.m_rxPsd = rxPsd;
+			entry.m_pruned = prune;
+			entry.m_txPower = ueTxPower;
+			entry.m_pathLossDb = pathLossDb;
+			entry.m_uePosition = ueMob->GetPosition ();
+			entry.m_enbPosition = enbMob->GetPosition ();
+			entry.m_txBf = txBf;
+			entry.m_rxBf = rxBf;
+			entry.m_channelTime = channelTime;
 		}
-		else if (mmWave3gpp != 0)
-		{
-			rxPsd = mmWave3gpp->CalcRxPowerSpectralDensity(rxPsd, ueMob, enbMob);
-			NS_LOG_LOGIC("RxPsd " << *rxPsd);
-		}	
 		m_rxPsdMap[ue->first] = rxPsd;
 		*totalReceivedPsd += *rxPsd;
 
 		// set back the bf vector to the main eNB
-		if(ueNetDevice != 0) 
+		if(entry.m_ueNetDevice != 0) 
 		{														// target not set yet
-			if((ueNetDevice->GetTargetEnb() != m_netDevice) && (ueNetDevice->GetTargetEnb() != 0))
+			if((entry.m_ueNetDevice->GetTargetEnb() != m_netDevice) && (entry.m_ueNetDevice->GetTargetEnb() != 0))
 			{
-				txAntennaArray->ChangeBeamformingVector(ueNetDevice->GetTargetEnb());
+				txAntennaArray->ChangeBeamformingVector(entry.m_ueNetDevice->GetTargetEnb());
 			}
 		}
-		else if (mcUeDev != 0) // it may be a MC device
+		else if (entry.m_mcUeDev != 0) // it may be a MC device
 		{															// target not set yet
-			if((mcUeDev->GetMmWaveTargetEnb() != m_netDevice) && (mcUeDev->GetMmWaveTargetEnb() != 0))
+			if((entry.m_mcUeDev->GetMmWaveTargetEnb() != m_netDevice) && (entry.m_mcUeDev->GetMmWaveTargetEnb() != 0))
 			{
-				txAntennaArray->ChangeBeamformingVector(mcUeDev->GetMmWaveTargetEnb());
+				txAntennaArray->ChangeBeamformingVector(entry.m_mcUeDev->GetMmWaveTargetEnb());
 			}	
 		}
-		else if (iabDev !=0) // it may be an IAB backhaul
+		else if (entry.m_iabDev !=0) // it may be an IAB backhaul
 		{
-			if((iabDev->GetBackhaulTargetEnb() != m_netDevice) && (iabDev->GetBackhaulTargetEnb() != 0))
+			if((entry.m_iabDev->GetBackhaulTargetEnb() != m_netDevice) && (entry.m_iabDev->GetBackhaulTargetEnb() != 0))
 			{
-				txAntennaArray->ChangeBeamformingVector(iabDev->GetBackhaulTargetEnb());
+				txAntennaArray->ChangeBeamformingVector(entry.m_iabDev->GetBackhaulTargetEnb());
 			}
 		}
-		else
-		{
-			NS_FATAL_ERROR("Unrecognized device");
-		}
 
 	}
+	NS_LOG_DEBUG("CellId " << m_cellId << " SINR estimate: " << numRecomputed << " pairs recomputed, "
+			<< numReused << " reused, " << numPruned << " pruned");
+	m_sinrEstimateStatsTrace (m_cellId, numRecomputed, numReused, numPruned);
 
 	for(std::map<uint64_t, Ptr<SpectrumValue> >::iterator ue = m_rxPsdMap.begin(); ue != m_rxPsdMap.end(); ++ue)
 	{
@@ -1237,8 +1315,7 @@ MmWaveEnbPhy::StartSlot (void)
 	m_phySapUser->SubframeIndication (SfnSf (m_frameNum, m_sfNum, m_slotNum));  // trigger MAC
 
 
-	SlotAllocInfo currSlot;
-	currSlot = m_currSfAllocInfo.m_slotAllocInfo[m_slotNum];
+	const SlotAllocInfo &currSlot = m_currSfAllocInfo.m_slotAllocInfo[m_slotNum];
 	m_currSymStart = currSlot.m_dci.m_symStart;
 
 	SfnSf sfn = SfnSf (m_frameNum, m_sfNum, m_slotNum);
@@ -1255,16 +1332,17 @@ MmWaveEnbPhy::StartSlot (void)
 		uint8_t sfAllocationDelay = m_schedulingDelay; // - m_phyMacConfig->GetL1L2CtrlLatency();
 
 		unsigned dlSfNum = (m_sfNum + sfAllocationDelay) % m_phyMacConfig->GetSubframesPerFrame (); // TODOIAB -1..
-		auto futureSfAllocInfo = m_sfAllocInfo[dlSfNum];
-		SfnSf dlSfnSf = futureSfAllocInfo.m_sfnSf;
+		// read the future allocations in place, without copying the slot lists
+		const SfAllocInfo *futureSfAllocInfo = &m_sfAllocInfo[dlSfNum];
+		SfnSf dlSfnSf = futureSfAllocInfo->m_sfnSf;
 		//std::list <Ptr<MmWaveControlMessage > >::iterator it = ctrlMsgs.begin ();
 		// find all DL/UL DCI elements and create DCI messages to be transmitted in DL control period
-		for (unsigned islot = 0; islot < futureSfAllocInfo.m_slotAllocInfo.size (); islot++)
+		for (unsigned islot = 0; islot < futureSfAllocInfo->m_slotAllocInfo.size (); islot++)
 		{
-			if (futureSfAllocInfo.m_slotAllocInfo[islot].m_slotType != SlotAllocInfo::CTRL &&
-					futureSfAllocInfo.m_slotAllocInfo[islot].m_tddMode == SlotAllocInfo::DL_slotAllocInfo)
+			if (futureSfAllocInfo->m_slotAllocInfo[islot].m_slotType != SlotAllocInfo::CTRL &&
+					futureSfAllocInfo->m_slotAllocInfo[islot].m_tddMode == SlotAllocInfo::DL_slotAllocInfo)
 			{
-				DciInfoElementTdma &dciElem = futureSfAllocInfo.m_slotAllocInfo[islot].m_dci;
+				const DciInfoElementTdma &dciElem = futureSfAllocInfo->m_slotAllocInfo[islot].m_dci;
 				NS_ASSERT (dciElem.m_format == DciInfoElementTdma::DL_dci);
 				if (dciElem.m_tbSize > 0)
 				{
@@ -1277,14 +1355,14 @@ MmWaveEnbPhy::StartSlot (void)
 		}
 
 		unsigned ulSfNum = (m_sfNum + sfAllocationDelay) % m_phyMacConfig->GetSubframesPerFrame ();
-		futureSfAllocInfo = m_sfAllocInfo[ulSfNum];
-		SfnSf ulSfnSf = futureSfAllocInfo.m_sfnSf;
-		for (unsigned islot = 0; islot < futureSfAllocInfo.m_slotAllocInfo.size (); islot++)
+		futureSfAllocInfo = &m_sfAllocInfo[ulSfNum];
+		SfnSf ulSfnSf = futureSfAllocInfo->m_sfnSf;
+		for (unsigned islot = 0; islot < futureSfAllocInfo->m_slotAllocInfo.size (); islot++)
 		{
-			if (futureSfAllocInfo.m_slotAllocInfo[islot].m_slotType != SlotAllocInfo::CTRL
-					&& futureSfAllocInfo.m_slotAllocInfo[islot].m_tddMode == SlotAllocInfo::UL_slotAllocInfo)
+			if (futureSfAllocInfo->m_slotAllocInfo[islot].m_slotType != SlotAllocInfo::CTRL
+					&& futureSfAllocInfo->m_slotAllocInfo[islot].m_tddMode == SlotAllocInfo::UL_slotAllocInfo)
 			{
-				DciInfoElementTdma &dciElem = futureSfAllocInfo.m_slotAllocInfo[islot].m_dci;
+				const DciInfoElementTdma &dciElem = futureSfAllocInfo->m_slotAllocInfo[islot].m_dci;
 				NS_ASSERT (dciElem.m_format == DciInfoElementTdma::UL_dci);
 				if (dciElem.m_tbSize > 0)
 				{
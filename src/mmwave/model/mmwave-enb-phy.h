@@ -43,6 +43,7 @@
 #include <ns3/lte-enb-phy-sap.h>
 #include <ns3/lte-enb-cphy-sap.h>
 #include <ns3/mmwave-harq-phy.h>
+#include <complex>
 
 namespace ns3{
 
@@ -52,6 +53,9 @@ class PacketBurst;
 class MmWaveNetDevice;
 class MmWaveUePhy;
 class MmWaveEnbMac;
+class MmWaveUeNetDevice;
+class McUeNetDevice;
+class MmWaveIabNetDevice;
 
 class MmWaveEnbPhy : public MmWavePhy
 {
@@ -133,6 +137,15 @@ public:
 
 	std::vector<double> MakeFilter (std::vector<double> , std::vector<double> , std::pair <uint64_t , uint64_t > );
 
+	/**
+	 * TracedCallback signature for the statistics of an update of the SINR estimate
+	 * @param the cell id
+	 * @param the number of UE-eNB pairs whose rx PSD was recomputed
+	 * @param the number of pairs whose rx PSD was reused from the previous update
+	 * @param the number of pairs pruned because of the pathloss threshold
+	 */
+	typedef void (* SinrEstimateStatsTracedCallback)
+		(uint16_t cellId, uint32_t recomputed, uint32_t reused, uint32_t pruned);
 
 
 private:
@@ -200,6 +213,36 @@ private:
 	uint8_t m_currSymStart;
 
 	TracedCallback< uint64_t, SpectrumValue&, SpectrumValue& > m_ulSinrTrace;
+
+	/**
+	 * The rx PSD of a UE computed by UpdateUeSinrEstimate, together with the
+	 * state of the pair it was computed for
+	 */
+	struct SinrEstimateCacheEntry
+	{
+		Ptr<NetDevice> m_device;
+		Ptr<MmWaveUeNetDevice> m_ueNetDevice;
+		Ptr<McUeNetDevice> m_mcUeDev;
+		Ptr<MmWaveIabNetDevice> m_iabDev;
+		Ptr<MmWaveUePhy> m_uePhy;
+
+		Ptr<SpectrumValue> m_rxPsd;
+		bool m_pruned;
+		double m_txPower;
+		double m_pathLossDb;
+		Vector m_uePosition;
+		Vector m_enbPosition;
+		std::vector< std::complex<double> > m_txBf;
+		std::vector< std::complex<double> > m_rxBf;
+		Time m_channelTime;
+
+		SinrEstimateCacheEntry ();
+	};
+	std::map <uint64_t, SinrEstimateCacheEntry> m_sinrEstimateCache;
+	bool m_incrementalSinrEstimate;
+	double m_sinrEstimatePathlossThreshold;
+
+	TracedCallback<uint16_t, uint32_t, uint32_t, uint32_t> m_sinrEstimateStatsTrace;
 };
 
 }
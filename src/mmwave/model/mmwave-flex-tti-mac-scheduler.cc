@@ -318,12 +318,9 @@ MmWaveFlexTtiMacScheduler::GetMmWaveUeMacCschedSapProvider()
 }
 
 std::string
-MmWaveFlexTtiMacScheduler::PrintSubframeAllocationMask(std::vector<bool> mask)
+MmWaveFlexTtiMacScheduler::PrintSubframeAllocationMask(const SymbolAllocationMask &mask)
 {
-	std::stringstream strStream;
-	for(auto bit : mask)
-		strStream << bit << " ";
-	return strStream.str();
+	return mask.Print();
 }
 
 // IAB methods
@@ -342,16 +339,14 @@ MmWaveFlexTtiMacScheduler::DoIabBackhaulSchedNotify(const struct MmWaveUeMacCsch
 	uint32_t subframe = info.m_sfnSf.m_sfNum;
 	uint32_t frame = info.m_sfnSf.m_frameNum;
 
-	// get the SfIabAllocInfo for this subframe
-	SfIabAllocInfo currentInfo = m_iabBusySubframeAllocation.at(subframe);
-	SfIabAllocInfo newInfo(m_phyMacConfig->GetSymbolsPerSubframe ());
+	// get the SfIabAllocInfo for this subframe, which is updated in place
+	SfIabAllocInfo &newInfo = m_iabBusySubframeAllocation.at(subframe);
 
-	NS_LOG_DEBUG("currentInfo frame " << currentInfo.m_sfnSf.m_frameNum << " subframe " << (uint16_t)currentInfo.m_sfnSf.m_sfNum);
+	NS_LOG_DEBUG("currentInfo frame " << newInfo.m_sfnSf.m_frameNum << " subframe " << (uint16_t)newInfo.m_sfnSf.m_sfNum);
 
-	if(currentInfo.m_sfnSf.m_frameNum == frame)
+	if(newInfo.m_sfnSf.m_frameNum == frame)
 	{
 		// another DCI has already been registered for this subframe
-		newInfo = currentInfo;
 		NS_LOG_DEBUG("This frame/subframe had already a DCI stored with mask " << PrintSubframeAllocationMask(newInfo.m_symAllocationMask));
 			// TODOIAB plot relevant info
 			// , with m_dlSymStart " << 
@@ -360,18 +355,18 @@ MmWaveFlexTtiMacScheduler::DoIabBackhaulSchedNotify(const struct MmWaveUeMacCsch
 	}
 	else
 	{
+		// the entry belongs to an older frame, start from an empty mask
 		newInfo.m_sfnSf = info.m_sfnSf;
+		newInfo.m_valid = true;
+		newInfo.m_symAllocationMask.Clear();
 	}
 
 	uint32_t firstAllocatedIdx = info.m_dciInfoElementTdma.m_symStart;
-	uint32_t nextFreeIdx = firstAllocatedIdx + info.m_dciInfoElementTdma.m_numSym;
+	uint32_t numAllocatedSym = info.m_dciInfoElementTdma.m_numSym;
 
 	// check if it overlaps with already busy regions
-	for(uint32_t index = firstAllocatedIdx; index < nextFreeIdx; index++)
-	{
-		NS_ASSERT_MSG(newInfo.m_symAllocationMask.at(index) == 0, "DCI signals that a symbol is scheduled for IAB, but it was already scheduled");
-		newInfo.m_symAllocationMask.at(index) = 1;
-	}	
+	NS_ASSERT_MSG(!newInfo.m_symAllocationMask.IsAnyBusy(firstAllocatedIdx, numAllocatedSym), "DCI signals that a symbol is scheduled for IAB, but it was already scheduled");
+	newInfo.m_symAllocationMask.SetBusy(firstAllocatedIdx, numAllocatedSym);
 	
 	NS_LOG_DEBUG("Mask " << PrintSubframeAllocationMask(newInfo.m_symAllocationMask));
 
@@ -400,8 +395,6 @@ MmWaveFlexTtiMacScheduler::DoIabBackhaulSchedNotify(const struct MmWaveUeMacCsch
 	// 	NS_LOG_DEBUG("UL Num symbols used " << (uint16_t)info.m_dciInfoElementTdma.m_numSym << " from symbol "
 	// 				<< (uint16_t)info.m_dciInfoElementTdma.m_symStart);	
 	// }
-
-	m_iabBusySubframeAllocation.at(subframe) = newInfo;
 }
 
 void
@@ -731,46 +724,8 @@ MmWaveFlexTtiMacScheduler::UpdateUlHarqProcessId (uint16_t rnti)
 
 unsigned MmWaveFlexTtiMacScheduler::CalcMinTbSizeNumSym (unsigned mcs, unsigned bufSize, unsigned &tbSize)
 {
-	// bisection line search to find minimum number of slots needed to encode entire buffer
-	MmWaveMacPduHeader dummyMacHeader;
-	//unsigned macHdrSize = 10; //dummyMacHeader.GetSerializedSize ();
-	int numSymLow = 0;
-	int numSymHigh = m_phyMacConfig->GetSymbolsPerSubframe();
-
-	int diff = 0;
-	tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8); // start with max value
-	while ((unsigned)tbSize > bufSize)
-	{
-		diff = abs(numSymHigh-numSymLow)/2;
-		if (diff == 0)
-		{
-			tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
-			return numSymHigh;
-		}
-		tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh - diff) / 8);
-		if ((unsigned)tbSize > bufSize)
-		{
-			numSymHigh -= diff;
-		}
-		while ((unsigned)tbSize < bufSize)
-		{
-			diff = abs(numSymHigh-numSymLow)/2;
-			if (diff == 0)
-			{
-				tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
-				return numSymHigh;
-			}
-			//tmp2 = numSym;
-			tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymLow + diff) / 8);
-			if ((unsigned)tbSize < bufSize)
-			{
-				numSymLow += diff;
-			}
-		}
-	}
-
-	tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
-	return (unsigned)numSymHigh;
+	// minimum number of symbols needed to encode entire buffer, from the TB size table of the AMC
+	return m_amc->GetMinNumSymbolsFromTbsMcs (bufSize, mcs, tbSize);
 }
 
 // IAB functionality
@@ -810,7 +765,7 @@ MmWaveFlexTtiMacScheduler::UpdateBusySymbolsForIab(uint8_t sfNum, uint8_t symIdx
 	// get the resources which are already set as busy for this subframe
 	if(m_iabScheduler && !m_split)
 	{
-		SfIabAllocInfo busyResources = m_iabBusySubframeAllocation.at(sfNum);
+		SfIabAllocInfo &busyResources = m_iabBusySubframeAllocation.at(sfNum);
 		NS_LOG_DEBUG("Before check for IAB resources: symIdx " << (uint16_t)symIdx << " symAvail " << symAvail);
 		if(busyResources.m_valid)
 		{
@@ -851,24 +806,19 @@ MmWaveFlexTtiMacScheduler::UpdateBusySymbolsForIab(uint8_t sfNum, uint8_t symIdx
 			// }
 			// symAvail = m_phyMacConfig->GetSymbolsPerSubframe () - 1 - symIdx;
 		}
-		m_iabBusySubframeAllocation.at(sfNum) = busyResources;
 
 		NS_LOG_DEBUG("After check for IAB resources: symIdx " << (uint16_t)symIdx << " symAvail " << symAvail);
 	}
 	else if(m_iabScheduler && m_split)
 	{
 		NS_LOG_LOGIC("Before check for IAB resources: symIdx " << (uint16_t)symIdx << " symAvail " << symAvail);
-		SfIabAllocInfo busyResources = m_iabBusySubframeAllocation.at(sfNum);
+		const SfIabAllocInfo &busyResources = m_iabBusySubframeAllocation.at(sfNum);
 		if(busyResources.m_valid)
 		{
 			m_busyResourcesSchedSubframe = busyResources;
 
 			// count the number of symbols which are busy
-			int numBusySymbols = 0;
-			for(auto symbolIter : m_busyResourcesSchedSubframe.m_symAllocationMask)
-			{
-				numBusySymbols += symbolIter;
-			}
+			int numBusySymbols = m_busyResourcesSchedSubframe.m_symAllocationMask.GetNumBusy();
 
 			symAvail -= numBusySymbols;
 
@@ -2203,22 +2153,9 @@ MmWaveFlexTtiMacScheduler::GetNumFreeSymbols(uint8_t symIdx, int numSymNeeded)
 		return numSymNeeded;
 	}
 
-	int numFreeSymbols = 0;
-	// get the possible overlapping region
-	uint32_t loopEnd = std::min(symIdx + numSymNeeded, (int)m_busyResourcesSchedSubframe.m_symAllocationMask.size());
-	NS_LOG_LOGIC("loopEnd " << loopEnd);
-	for(uint32_t index = symIdx; index < loopEnd; ++index)
-	{
-		if(m_busyResourcesSchedSubframe.m_symAllocationMask.at(index) == 0)
-		{
-			numFreeSymbols++;
-		}
-		else
-		{
-			NS_LOG_LOGIC("Symbol busy, allocated " << numFreeSymbols << " out of " << numSymNeeded);
-			break;
-		}
-	}
+	// the free symbols before the first busy one of the possible overlapping region
+	int numFreeSymbols = m_busyResourcesSchedSubframe.m_symAllocationMask.GetFreeRunLength(symIdx, std::max(numSymNeeded, 0));
+	NS_LOG_LOGIC("Allocated " << numFreeSymbols << " out of " << numSymNeeded);
 	return numFreeSymbols;
 }
 
@@ -2230,10 +2167,7 @@ MmWaveFlexTtiMacScheduler::UpdateResourceMask(uint8_t start, int numSymbols)
 		NS_FATAL_ERROR("Try to update the mask for a non IAB scheduler");
 	}
 
-	for(uint32_t index = start; index < (uint32_t)(start + numSymbols); ++index)
-	{
-		m_busyResourcesSchedSubframe.m_symAllocationMask.at(index) = 1;
-	}
+	m_busyResourcesSchedSubframe.m_symAllocationMask.SetBusy(start, numSymbols);
 		
 }
 
@@ -2247,14 +2181,11 @@ MmWaveFlexTtiMacScheduler::GetFirstFreeSymbol(uint8_t symIdx, int numFreeSymbols
 		return symIdx + numFreeSymbols;
 	}
 
-	int index;
-	for(index = symIdx + numFreeSymbols; index < (int)m_busyResourcesSchedSubframe.m_symAllocationMask.size(); ++index)
+	uint32_t index = symIdx + numFreeSymbols;
+	if(index < m_busyResourcesSchedSubframe.m_symAllocationMask.GetSize())
 	{
-		if(m_busyResourcesSchedSubframe.m_symAllocationMask.at(index) == 0)
-		{
-			NS_LOG_LOGIC("Free symbol found at " << index);
-			break;
-		}
+		index = m_busyResourcesSchedSubframe.m_symAllocationMask.GetFirstFree(index);
+		NS_LOG_LOGIC("Free symbol found at " << index);
 	}
 	return static_cast<uint8_t>(index);
 }
@@ -2269,17 +2200,7 @@ MmWaveFlexTtiMacScheduler::CheckOverlapWithBusyResources(uint8_t symIdx, int num
 		return false;
 	}
 
-	uint32_t loopEnd = std::min(symIdx + numSymNeeded, (int)m_busyResourcesSchedSubframe.m_symAllocationMask.size());
-	NS_LOG_LOGIC("loopEnd " << loopEnd);
-	for(uint32_t index = symIdx; index < loopEnd; ++index)
-	{
-		if(m_busyResourcesSchedSubframe.m_symAllocationMask.at(index) == 1)
-		{
-			NS_LOG_LOGIC("overlapping from symbol " << index);
-			return true;
-		}
-	}
-	return false;
+	return m_busyResourcesSchedSubframe.m_symAllocationMask.IsAnyBusy(symIdx, std::max(numSymNeeded, 0));
 }
 
 
@@ -205,7 +205,7 @@ private:
 	// IAB check if there is an overlapping with the already allocated resources
 	bool CheckOverlapWithBusyResources(uint8_t symIdx, int numSymNeeded);
 	// IAB print the subframe allocation mask
-	std::string PrintSubframeAllocationMask(std::vector<bool> mask);
+	std::string PrintSubframeAllocationMask(const SymbolAllocationMask &mask);
 	// IAB update the number of available symbols considering IAB allocation
 	int UpdateBusySymbolsForIab(uint8_t sfNum, uint8_t symIdx, int symAvail);
 	// HARQ allocation: update the mask with busy resources
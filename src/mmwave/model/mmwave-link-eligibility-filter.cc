@@ -0,0 +1,61 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-link-eligibility-filter.h"
+#include "mmwave-spectrum-phy.h"
+#include <ns3/log.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveLinkEligibilityFilter");
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveLinkEligibilityFilter);
+
+TypeId
+MmWaveLinkEligibilityFilter::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::MmWaveLinkEligibilityFilter")
+		.SetParent<Object> ()
+		.AddConstructor<MmWaveLinkEligibilityFilter> ()
+	;
+	return tid;
+}
+
+MmWaveLinkEligibilityFilter::MmWaveLinkEligibilityFilter ()
+{
+	NS_LOG_FUNCTION (this);
+}
+
+MmWaveLinkEligibilityFilter::~MmWaveLinkEligibilityFilter ()
+{
+	NS_LOG_FUNCTION (this);
+}
+
+bool
+MmWaveLinkEligibilityFilter::IsEligible (Ptr<SpectrumPhy> txPhy, Ptr<SpectrumPhy> rxPhy)
+{
+	Ptr<MmWaveSpectrumPhy> mmWaveRxPhy = DynamicCast<MmWaveSpectrumPhy> (rxPhy);
+	if (mmWaveRxPhy == 0)
+	{
+		return true;
+	}
+	return !mmWaveRxPhy->IsLinkNeglected (txPhy);
+}
+
+} // namespace ns3
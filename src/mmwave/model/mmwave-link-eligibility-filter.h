@@ -0,0 +1,56 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_LINK_ELIGIBILITY_FILTER_H
+#define MMWAVE_LINK_ELIGIBILITY_FILTER_H
+
+#include <ns3/object.h>
+#include <ns3/spectrum-phy.h>
+
+namespace ns3 {
+
+/**
+ * Decides, before any propagation loss is computed, whether the signals of a
+ * transmitter can be of interest for a receiver. It is used by
+ * MmWaveSpectrumChannel to skip the links that the receiver would discard
+ * anyway. Subclasses can implement different rules.
+ *
+ * The default implementation applies the rules of
+ * MmWaveSpectrumPhy::IsLinkNeglected (BS to BS, UE to UE and the invalid
+ * combinations of IAB access and backhaul), and accepts every link whose
+ * receiver is not a MmWaveSpectrumPhy.
+ */
+class MmWaveLinkEligibilityFilter : public Object
+{
+public:
+	static TypeId GetTypeId (void);
+	MmWaveLinkEligibilityFilter ();
+	virtual ~MmWaveLinkEligibilityFilter ();
+
+	/**
+	 * @params the transmitter
+	 * @params the receiver
+	 * @returns true if the signals of the transmitter must be propagated to the receiver
+	 */
+	virtual bool IsEligible (Ptr<SpectrumPhy> txPhy, Ptr<SpectrumPhy> rxPhy);
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_LINK_ELIGIBILITY_FILTER_H */
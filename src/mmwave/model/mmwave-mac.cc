@@ -41,6 +41,52 @@ NS_LOG_COMPONENT_DEFINE ("MmWaveMac");
 
 NS_OBJECT_ENSURE_REGISTERED (MmWaveMac);
 
+MmWaveHarqPduBuffer::MmWaveHarqPduBuffer ()
+	: m_size (0)
+{
+}
+
+void
+MmWaveHarqPduBuffer::Clear ()
+{
+	m_pdus.clear ();
+	m_size = 0;
+}
+
+void
+MmWaveHarqPduBuffer::AddPdu (Ptr<Packet> pdu)
+{
+	m_pdus.push_back (pdu);
+	m_size += pdu->GetSize ();
+}
+
+uint32_t
+MmWaveHarqPduBuffer::GetNPdus () const
+{
+	return m_pdus.size ();
+}
+
+uint32_t
+MmWaveHarqPduBuffer::GetSize () const
+{
+	return m_size;
+}
+
+Ptr<Packet>
+MmWaveHarqPduBuffer::GetPduForUpdate (uint32_t index, uint64_t &copiedBytes)
+{
+	NS_ASSERT (index < m_pdus.size ());
+	Ptr<Packet> &pdu = m_pdus[index];
+	if (pdu->GetReferenceCount () > 1)
+	{
+		// still referenced elsewhere, copy on write
+		NS_LOG_LOGIC ("Copy of HARQ PDU " << pdu->GetUid () << " of " << pdu->GetSize () << " bytes");
+		copiedBytes += pdu->GetSize ();
+		return pdu->Copy ();
+	}
+	return pdu;
+}
+
 MmWaveMac::MmWaveMac ()
 {
 	m_macQueue = CreateObject <PacketBurst> ();
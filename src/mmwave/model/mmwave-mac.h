@@ -76,6 +76,47 @@ namespace ns3 {
 		MmWaveMacPduHeader m_macHeader;
 	};
 
+/**
+ * PDUs of a HARQ process, kept for the retransmissions. The buffer holds
+ * references to the PDUs passed to the PHY, without copying them. Since at
+ * each retransmission the MmWaveMacPduTag must be updated, GetPduForUpdate
+ * gives the stored PDU itself if the buffer is its only owner (i.e., the PHY
+ * and the channel released it after the previous transmission), and a copy
+ * otherwise, so that the packets held by others are never changed.
+ */
+class MmWaveHarqPduBuffer
+{
+public:
+	MmWaveHarqPduBuffer ();
+
+	/**
+	 * Drop the PDUs, e.g., after an ACK or a new transmission
+	 */
+	void Clear ();
+	/**
+	 * @params the PDU passed to the PHY, which must not be changed afterwards
+	 */
+	void AddPdu (Ptr<Packet> pdu);
+	/**
+	 * @returns the number of PDUs
+	 */
+	uint32_t GetNPdus () const;
+	/**
+	 * @returns the total size in bytes of the PDUs
+	 */
+	uint32_t GetSize () const;
+	/**
+	 * @params the index of the PDU
+	 * @params the bytes copied, increased by the size of the PDU if it is copied
+	 * @returns a PDU which can be modified and transmitted again
+	 */
+	Ptr<Packet> GetPduForUpdate (uint32_t index, uint64_t &copiedBytes);
+
+private:
+	std::vector<Ptr<Packet> > m_pdus;
+	uint32_t m_size;
+};
+
 class MmWaveMac : public Object
 {
 public:
@@ -37,6 +37,8 @@
 #include <ns3/pointer.h>
 #include <stdint.h>
 #include <cmath>
+#include <algorithm>
+#include <map>
 #include <stdint.h>
 #include "stdlib.h"
 #include "mmwave-mi-error-model.h"
@@ -50,90 +52,117 @@ namespace ns3 {
 
 
 
+/**
+ * A SINR to MI map, whose SINR axis is uniformly spaced
+ */
+struct MmWaveMiMap
+{
+  const double *mi;
+  const double *axis;
+  uint32_t size;
+  // since the values of the axis are uniformly spaced, we have
+  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+  // the scaling coefficient is always the same, so it is precomputed
+  // to speed up the calculation
+  double scalingCoeff;
+};
+
+static const MmWaveMiMap g_miMaps[3] = {
+  {MI_map_qpsk, MI_map_qpsk_axis, MMWAVE_MI_MAP_QPSK_SIZE,
+   (MMWAVE_MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0])},
+  {MI_map_16qam, MI_map_16qam_axis, MMWAVE_MI_MAP_16QAM_SIZE,
+   (MMWAVE_MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0])},
+  {MI_map_64qam, MI_map_64qam_axis, MMWAVE_MI_MAP_64QAM_SIZE,
+   (MMWAVE_MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0])}
+};
+
+/**
+ * MI of a chunk, without branches on the SINR so that the loops over the
+ * chunks can be vectorized (the table lookup becomes a gather)
+ */
+static inline double
+LookupMi (const MmWaveMiMap &map, double sinrLin)
+{
+  double sinrIndexDouble = (sinrLin - map.axis[0]) * map.scalingCoeff + 1;
+  // the index is clamped, its value is not used above the last value of the axis
+  double clamped = std::min (std::max (0.0, std::floor (sinrIndexDouble)), (double) (map.size - 1));
+  double mi = map.mi[(uint32_t) clamped];
+  return sinrLin > map.axis[map.size - 1] ? 1.0 : mi;
+}
+
+static inline uint8_t
+GetModulationIndex (uint8_t mcs)
+{
+  if (mcs <= MMWAVE_MI_QPSK_MAX_ID)
+    {
+      return 0;
+    }
+  else if (mcs <= MMWAVE_MI_16QAM_MAX_ID)
+    {
+      return 1;
+    }
+  return 2;
+}
+
 double 
 MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
-  
-  double MI;
+
+  const MmWaveMiMap &miMap = g_miMaps[GetModulationIndex (mcs)];
+  const double *sinrLin = &(*sinr.ConstValuesBegin ());
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  
   for (uint32_t i = 0; i < map.size (); i++)
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MMWAVE_MI_QPSK_MAX_ID) // QPSK
-        {
-
-          if (sinrLin > MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE-1])
-            {
-              MI = 1;
-            }
-          else 
-            { 
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-              static const double scalingCoeffQpsk = 
-                (MMWAVE_MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MMWAVE_MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-              uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
-            }
-        }
-      else
-        {
-          if (mcs > MMWAVE_MI_QPSK_MAX_ID && mcs <= MMWAVE_MI_16QAM_MAX_ID )	// 16-QAM
-            {
-              if (sinrLin > MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else 
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam = 
-                    (MMWAVE_MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MMWAVE_MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
-            }
-          else // 64-QAM
-            {
-              if (sinrLin > MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam = 
-                    (MMWAVE_MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MMWAVE_MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MMWAVE_MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
-            }
-        }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+      NS_ASSERT_MSG (map[i] >= 0 && (uint32_t) map[i] < sinr.GetSpectrumModel ()->GetNumBands (), "MI map out of data");
+      double MI = LookupMi (miMap, sinrLin[map[i]]);
+      NS_LOG_LOGIC (" RB " << map[i] << "Minimum SNR = " << 10 * std::log10 (sinrLin[map[i]]) << " dB, " << sinrLin[map[i]] << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
       MIsum += MI;
     }
-  MI = MIsum / map.size ();
+  double MI = MIsum / map.size ();
   NS_LOG_LOGIC (" MI = " << MI);
   return MI;
 }
 
+void
+MmWaveMiErrorModel::MibBatch (const double* sinr, const std::vector<int>& map, double* mi)
+{
+  NS_LOG_FUNCTION (sinr << &map << mi);
+
+  // gather the SINR of the chunks of the TB, then run a tight loop per modulation order
+  std::vector<double> gathered;
+  gathered.reserve (map.size ());
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      gathered.push_back (sinr[map[i]]);
+    }
+  for (uint8_t mod = 0; mod < 3; mod++)
+    {
+      const MmWaveMiMap &miMap = g_miMaps[mod];
+      double MIsum = 0.0;
+      for (uint32_t i = 0; i < gathered.size (); i++)
+        {
+          MIsum += LookupMi (miMap, gathered[i]);
+        }
+      mi[mod] = MIsum / map.size ();
+    }
+  NS_LOG_LOGIC (" MI QPSK " << mi[0] << " 16QAM " << mi[1] << " 64QAM " << mi[2]);
+}
+
+
+/**
+ * \return the index of the BLER curves (in cbMiSizeTable) used for a CB size
+ */
+static int
+GetCbMiSizeIndex (uint32_t cbSize)
+{
+  int cbIndex = 1;
+  while ((cbIndex < 9)&&(cbMiSizeTable[cbIndex]<= cbSize))
+    {
+      cbIndex++;
+    }
+  return cbIndex - 1;
+}
 
 double 
 MmWaveMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
@@ -143,12 +172,7 @@ MmWaveMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
   double c = 0;
 
   NS_ASSERT_MSG (ecrId <= MMWAVE_MI_64QAM_BLER_MAX_ID, "ECR out of range [0..37]: " << (uint16_t) ecrId);
-  int cbIndex = 1;
-  while ((cbIndex < 9)&&(cbMiSizeTable[cbIndex]<= cbSize))
-    {
-      cbIndex++;
-    }
-  cbIndex--;
+  int cbIndex = GetCbMiSizeIndex (cbSize);
   NS_LOG_LOGIC (" ECRid " << (uint16_t)ecrId << " ECR " << BlerCurvesEcrMap[ecrId] << " CB size " << cbSize << " CB size curve " << cbMiSizeTable[cbIndex]);
 
   b = bEcrTable[cbIndex][ecrId];
@@ -179,36 +203,9 @@ MmWaveMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
   return bler;
 }
 
-MmWaveTbStats_t
-MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
+MmWaveCodeBlockSegmentation_t
+MmWaveMiErrorModel::GetCodeBlockSegmentation (uint32_t size)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
-
-  double tbMi = Mib(sinr, map, mcs);
-  double MI = 0.0;
-  double Reff = 0.0;
-  NS_ASSERT (mcs < 29);
-  if (miHistory.size ()>0)
-    {
-      // evaluate R_eff and MI_eff
-      uint32_t codeBitsSum = 0;
-      double miSum = 0.0;
-      for (uint16_t i = 0; i < miHistory.size (); i++)
-        {
-          NS_LOG_DEBUG (" Sum MI " << miHistory.at (i).m_mi << " Ci " << miHistory.at (i).m_codeBits);
-          codeBitsSum += miHistory.at (i).m_codeBits;
-          miSum += (miHistory.at (i).m_mi*miHistory.at (i).m_codeBits);
-        }
-      codeBitsSum += (((double)size*8.0) / McsEcrTable [mcs]);
-      miSum += (tbMi*(((double)size*8.0) / McsEcrTable [mcs]));
-      Reff = miHistory.at (0).m_infoBits / (double)codeBitsSum; // information bits are the size of the first TB
-      MI = miSum / (double)codeBitsSum;
-    }
-  else
-    {
-      MI = tbMi;
-    }
-  NS_LOG_DEBUG (" MI " << MI << " Reff " << Reff << " HARQ " << miHistory.size ());
   // estimate CB size (according to sec 5.1.2 of TS 36.212)
   uint16_t Z = 6144; // max size of a codeblock (including CRC)
   uint32_t B = size * 8;
@@ -301,7 +298,68 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
     }
   NS_LOG_INFO ("--------------------LteMiErrorModel: TB size of " << B << " needs of " << B1 << " bits reparted in " << C << " CBs as "<< Cplus << " block(s) of " << Kplus << " and " << Cminus << " of " << Kminus);
 
+  MmWaveCodeBlockSegmentation_t cbs;
+  cbs.C = C;
+  cbs.Cplus = Cplus;
+  cbs.Kplus = Kplus;
+  cbs.Cminus = Cminus;
+  cbs.Kminus = Kminus;
+  return cbs;
+}
+
+double
+MmWaveMiErrorModel::MappingMiTbler (double mib, uint8_t ecrId, const MmWaveCodeBlockSegmentation_t& cbs)
+{
   double errorRate = 1.0;
+  if (cbs.C!=1)
+    {
+      double cbler = MappingMiBler (mib, ecrId, cbs.Kplus);
+      errorRate *= pow (1.0 - cbler, cbs.Cplus);
+      cbler = MappingMiBler (mib, ecrId, cbs.Kminus);
+      errorRate *= pow (1.0 - cbler, cbs.Cminus);
+      errorRate = 1.0 - errorRate;
+    }
+  else
+    {
+      errorRate = MappingMiBler (mib, ecrId, cbs.Kplus);
+    }
+
+  NS_LOG_LOGIC (" Error rate " << errorRate);
+  return errorRate;
+}
+
+MmWaveTbStats_t
+MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+
+  double tbMi = Mib(sinr, map, mcs);
+  double MI = 0.0;
+  double Reff = 0.0;
+  NS_ASSERT (mcs < 29);
+  if (miHistory.size ()>0)
+    {
+      // evaluate R_eff and MI_eff
+      uint32_t codeBitsSum = 0;
+      double miSum = 0.0;
+      for (uint16_t i = 0; i < miHistory.size (); i++)
+        {
+          NS_LOG_DEBUG (" Sum MI " << miHistory.at (i).m_mi << " Ci " << miHistory.at (i).m_codeBits);
+          codeBitsSum += miHistory.at (i).m_codeBits;
+          miSum += (miHistory.at (i).m_mi*miHistory.at (i).m_codeBits);
+        }
+      codeBitsSum += (((double)size*8.0) / McsEcrTable [mcs]);
+      miSum += (tbMi*(((double)size*8.0) / McsEcrTable [mcs]));
+      Reff = miHistory.at (0).m_infoBits / (double)codeBitsSum; // information bits are the size of the first TB
+      MI = miSum / (double)codeBitsSum;
+    }
+  else
+    {
+      MI = tbMi;
+    }
+  NS_LOG_DEBUG (" MI " << MI << " Reff " << Reff << " HARQ " << miHistory.size ());
+  MmWaveCodeBlockSegmentation_t cbs = GetCodeBlockSegmentation (size);
+
   uint8_t ecrId = 0;
   if (miHistory.size ()==0)
     {
@@ -346,28 +404,174 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
       NS_LOG_DEBUG ("HARQ ECR " << (uint16_t)ecrId);
     }
 
-  if (C!=1)
+  double errorRate = MappingMiTbler (MI, ecrId, cbs);
+  MmWaveTbStats_t ret;
+  ret.tbler = errorRate;
+  ret.mi = tbMi;
+  ret.miTotal = MI;
+  return ret;
+}
+
+
+
+
+/**
+ * mmib thresholds of the BLER curves for a TB size: the first transmission
+ * with MCS m fails (TB error rate above the target) iff the mmib is below
+ * threshold[m]
+ */
+struct MmWaveMcsMiThresholds
+{
+  double threshold[MMWAVE_MI_64QAM_MAX_ID + 1];
+  bool sorted[3]; ///< if the thresholds of each modulation order are non-decreasing with the MCS
+};
+
+/// first and last MCS of each modulation order
+static const uint8_t g_modulationMcs[3][2] = {
+  {0, MMWAVE_MI_QPSK_MAX_ID},
+  {MMWAVE_MI_QPSK_MAX_ID + 1, MMWAVE_MI_16QAM_MAX_ID},
+  {MMWAVE_MI_16QAM_MAX_ID + 1, MMWAVE_MI_64QAM_MAX_ID}
+};
+
+/**
+ * mmib thresholds closer than this to the mmib of a TB are not trusted, and
+ * the TB error rate is evaluated with MappingMiTbler instead
+ */
+static const double g_miThresholdTolerance = 1e-9;
+
+static const MmWaveMcsMiThresholds&
+GetMcsMiThresholds (const MmWaveCodeBlockSegmentation_t& cbs, double maxTbler)
+{
+  // the TB error rate only depends on the number of code blocks and on the BLER
+  // curves of their sizes, so TB sizes with the same key share the thresholds
+  typedef std::pair<std::pair<int, int>, std::pair<uint32_t, uint32_t> > CbKey_t;
+  static std::map<std::pair<CbKey_t, double>, MmWaveMcsMiThresholds> cache;
+  CbKey_t cbKey;
+  if (cbs.C != 1)
     {
-      double cbler = MappingMiBler (MI, ecrId, Kplus);
-      errorRate *= pow (1.0 - cbler, Cplus);
-      cbler = MappingMiBler (MI, ecrId, Kminus);
-      errorRate *= pow (1.0 - cbler, Cminus);
-      errorRate = 1.0 - errorRate;
+      cbKey = CbKey_t (std::make_pair (GetCbMiSizeIndex (cbs.Kplus), GetCbMiSizeIndex (cbs.Kminus)),
+                       std::make_pair (cbs.Cplus, cbs.Cminus));
     }
   else
     {
-      errorRate = MappingMiBler (MI, ecrId, Kplus);
+      cbKey = CbKey_t (std::make_pair (GetCbMiSizeIndex (cbs.Kplus), -1), std::make_pair (1, 0));
+    }
+  std::pair<CbKey_t, double> key (cbKey, maxTbler);
+  std::map<std::pair<CbKey_t, double>, MmWaveMcsMiThresholds>::iterator it = cache.find (key);
+  if (it != cache.end ())
+    {
+      return it->second;
     }
 
-  NS_LOG_LOGIC (" Error rate " << errorRate);
-  MmWaveTbStats_t ret;
-  ret.tbler = errorRate;
-  ret.mi = tbMi;
-  ret.miTotal = MI;
-  return ret;
+  NS_LOG_LOGIC ("Compute the mmib thresholds for " << cbs.C << " CBs and TBLER " << maxTbler);
+  MmWaveMcsMiThresholds thresholds;
+  for (uint8_t mcs = 0; mcs <= MMWAVE_MI_64QAM_MAX_ID; mcs++)
+    {
+      uint8_t ecrId = McsEcrBlerTableMapping[mcs];
+      // the TB error rate decreases with the mmib, which is in [0, 1]
+      if (MmWaveMiErrorModel::MappingMiTbler (1.0, ecrId, cbs) > maxTbler)
+        {
+          thresholds.threshold[mcs] = 2.0; // always fails
+        }
+      else if (MmWaveMiErrorModel::MappingMiTbler (0.0, ecrId, cbs) <= maxTbler)
+        {
+          thresholds.threshold[mcs] = -1.0; // never fails
+        }
+      else
+        {
+          double low = 0.0;  // fails
+          double high = 1.0; // does not fail
+          while (high - low > g_miThresholdTolerance / 100)
+            {
+              double mid = (low + high) / 2;
+              if (MmWaveMiErrorModel::MappingMiTbler (mid, ecrId, cbs) > maxTbler)
+                {
+                  low = mid;
+                }
+              else
+                {
+                  high = mid;
+                }
+            }
+          thresholds.threshold[mcs] = high;
+        }
+    }
+  for (uint8_t mod = 0; mod < 3; mod++)
+    {
+      thresholds.sorted[mod] = true;
+      for (uint8_t mcs = g_modulationMcs[mod][0] + 1; mcs <= g_modulationMcs[mod][1]; mcs++)
+        {
+          if (thresholds.threshold[mcs] < thresholds.threshold[mcs - 1])
+            {
+              thresholds.sorted[mod] = false;
+            }
+        }
+    }
+  return cache.insert (std::make_pair (key, thresholds)).first->second;
 }
 
+uint8_t
+MmWaveMiErrorModel::GetMaxMcs (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, double maxTbler)
+{
+  NS_LOG_FUNCTION (sinr << &map << size << maxTbler);
+
+  MmWaveCodeBlockSegmentation_t cbs = GetCodeBlockSegmentation (size);
+  const MmWaveMcsMiThresholds &thresholds = GetMcsMiThresholds (cbs, maxTbler);
+  // the mmib only depends on the modulation order
+  double miPerModulation[3];
+  MibBatch (&(*sinr.ConstValuesBegin ()), map, miPerModulation);
 
+  for (uint8_t mod = 0; mod < 3; mod++)
+    {
+      uint8_t first = g_modulationMcs[mod][0];
+      uint8_t last = g_modulationMcs[mod][1];
+      double mi = miPerModulation[mod];
+
+      // first MCS of this modulation order which fails, last + 1 if none
+      uint8_t failed = last + 1;
+      bool exact = true;
+      for (uint8_t mcs = first; mcs <= last; mcs++)
+        {
+          if (std::abs (mi - thresholds.threshold[mcs]) < g_miThresholdTolerance)
+            {
+              exact = false;
+            }
+        }
+      if (!exact)
+        {
+          // the mmib is too close to a threshold, compute the error rates
+          for (uint8_t mcs = first; mcs <= last && failed > last; mcs++)
+            {
+              if (MappingMiTbler (mi, McsEcrBlerTableMapping[mcs], cbs) > maxTbler)
+                {
+                  failed = mcs;
+                }
+            }
+        }
+      else if (thresholds.sorted[mod])
+        {
+          failed = std::upper_bound (thresholds.threshold + first, thresholds.threshold + last + 1, mi)
+            - thresholds.threshold;
+        }
+      else
+        {
+          for (uint8_t mcs = first; mcs <= last && failed > last; mcs++)
+            {
+              if (mi < thresholds.threshold[mcs])
+                {
+                  failed = mcs;
+                }
+            }
+        }
+      NS_LOG_LOGIC ("Modulation " << (uint16_t) mod << " MI " << mi << " first failed MCS " << (uint16_t) failed);
+
+      if (failed <= last)
+        {
+          return failed > 0 ? failed - 1 : 0;
+        }
+    }
+  return MMWAVE_MI_64QAM_MAX_ID;
+}
 
 
 } // namespace ns3
@@ -62,6 +62,19 @@ struct MmWaveTbStats_t
   double mi;
   double miTotal;
 };
+
+/**
+ * Segmentation of a TB in code blocks (sec 5.1.2 of TS 36.212): Cplus
+ * blocks of Kplus bits and Cminus blocks of Kminus bits
+ */
+struct MmWaveCodeBlockSegmentation_t
+{
+  uint32_t C;
+  uint32_t Cplus;
+  uint32_t Kplus;
+  uint32_t Cminus;
+  uint32_t Kminus;
+};
   
 // global table of the effective code rates (ECR)s that have BLER performance curves
 static const double BlerCurvesEcrMap[38] = {
@@ -332,6 +345,15 @@ public:
    * \return the mmib
    */
   static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
+  /**
+   * \brief find the mmib of the specified TB for the three modulations at once,
+   * with a single gather of the SINR of the active RBs; it keeps no state
+   * between the calls, thus it can run in several threads at once
+   * \param sinr the perceived sinrs in the whole bandwidth, as a contiguous array
+   * \param map the actives RBs for the TB
+   * \param mi the output array of 3 elements, filled with the mmib for QPSK, 16-QAM and 64-QAM
+   */
+  static void MibBatch (const double* sinr, const std::vector<int>& map, double* mi);
   /** 
    * \brief map the mmib (mean mutual information per bit) for different MCS
    * \param mib mean mutual information per bit of a code-block
@@ -351,6 +373,37 @@ public:
    */
   static MmWaveTbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory);
 
+  /**
+   * \brief segment a TB in code blocks
+   * \param size the size in bytes of the TB
+   * \return the number and size of the code blocks
+   */
+  static MmWaveCodeBlockSegmentation_t GetCodeBlockSegmentation (uint32_t size);
+
+  /**
+   * \brief map the mmib of a TB to its error rate
+   * \param mib mean mutual information per bit of the TB
+   * \param ecrId Effective Code Rate ID
+   * \param cbs the code blocks of the TB
+   * \return the TB error rate
+   */
+  static double MappingMiTbler (double mib, uint8_t ecrId, const MmWaveCodeBlockSegmentation_t& cbs);
+
+  /**
+   * \brief find the highest MCS, starting from MCS 0, before the first one
+   * whose TB error rate (first transmission) is above maxTbler.
+   * It gives the same result as calling GetTbDecodificationStats for
+   * increasing MCSs, but the mmib is computed once per modulation order,
+   * and the MCS is looked up in the mmib thresholds of the BLER curves,
+   * which are computed once per code block segmentation
+   * \param sinr the perceived sinrs in the whole bandwidth
+   * \param map the actives RBs for the TB
+   * \param size the size in bytes of the TB
+   * \param maxTbler the maximum TB error rate
+   * \return the MCS, 0 also if MCS 0 does not meet maxTbler
+   */
+  static uint8_t GetMaxMcs (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, double maxTbler);
+
 
 //private:
 
@@ -37,6 +37,8 @@
 #include <ns3/string.h>
 #include <ns3/attribute-accessor-helper.h>
 #include <ns3/simulator.h>
+#include <algorithm>
+#include <sstream>
 
 namespace ns3
 {
@@ -193,6 +195,162 @@ MmWavePhyMacCommon::MmWavePhyMacCommon ()
 	NS_LOG_INFO ("Initialized MmWavePhyMacCommon");
 }
 
+static const uint32_t g_bitsPerWord = 64;
+
+SymbolAllocationMask::SymbolAllocationMask ()
+	: m_numSymbols (0)
+{
+}
+
+SymbolAllocationMask::SymbolAllocationMask (uint32_t numSymbols)
+	: m_numSymbols (numSymbols),
+	  m_words ((numSymbols + g_bitsPerWord - 1) / g_bitsPerWord, 0)
+{
+}
+
+uint32_t
+SymbolAllocationMask::GetSize () const
+{
+	return m_numSymbols;
+}
+
+void
+SymbolAllocationMask::Clear ()
+{
+	std::fill (m_words.begin (), m_words.end (), 0);
+}
+
+bool
+SymbolAllocationMask::IsBusy (uint32_t symbol) const
+{
+	NS_ASSERT_MSG (symbol < m_numSymbols, "Symbol " << symbol << " out of " << m_numSymbols);
+	return (m_words[symbol / g_bitsPerWord] >> (symbol % g_bitsPerWord)) & 1;
+}
+
+void
+SymbolAllocationMask::SetBusy (uint32_t start, uint32_t numSymbols)
+{
+	NS_ASSERT_MSG ((uint64_t) start + numSymbols <= m_numSymbols,
+			"Symbols " << start << "+" << numSymbols << " out of " << m_numSymbols);
+	uint32_t end = start + numSymbols;
+	while (start < end)
+	{
+		uint32_t bit = start % g_bitsPerWord;
+		uint32_t numBits = std::min (g_bitsPerWord - bit, end - start);
+		uint64_t bits = (numBits == g_bitsPerWord) ? ~(uint64_t) 0 : (((uint64_t) 1 << numBits) - 1);
+		m_words[start / g_bitsPerWord] |= bits << bit;
+		start += numBits;
+	}
+}
+
+bool
+SymbolAllocationMask::IsAnyBusy (uint32_t start, uint32_t numSymbols) const
+{
+	if (start >= m_numSymbols)
+	{
+		return false;
+	}
+	uint64_t end = std::min ((uint64_t) start + numSymbols, (uint64_t) m_numSymbols);
+	return GetFirstBusy (start) < end;
+}
+
+uint32_t
+SymbolAllocationMask::GetNumBusy () const
+{
+	uint32_t numBusy = 0;
+	for (std::vector<uint64_t>::const_iterator it = m_words.begin (); it != m_words.end (); ++it)
+	{
+		numBusy += __builtin_popcountll (*it);
+	}
+	return numBusy;
+}
+
+uint32_t
+SymbolAllocationMask::GetFirstBusy (uint32_t start) const
+{
+	if (start >= m_numSymbols)
+	{
+		return m_numSymbols;
+	}
+	uint32_t word = start / g_bitsPerWord;
+	// the busy symbols before start are masked out of the first word
+	uint64_t bits = m_words[word] & (~(uint64_t) 0 << (start % g_bitsPerWord));
+	while (bits == 0)
+	{
+		if (++word == m_words.size ())
+		{
+			return m_numSymbols;
+		}
+		bits = m_words[word];
+	}
+	// the bits after the last symbol are never set
+	return word * g_bitsPerWord + __builtin_ctzll (bits);
+}
+
+uint32_t
+SymbolAllocationMask::GetFirstFree (uint32_t start) const
+{
+	if (start >= m_numSymbols)
+	{
+		return m_numSymbols;
+	}
+	uint32_t word = start / g_bitsPerWord;
+	uint64_t bits = ~m_words[word] & (~(uint64_t) 0 << (start % g_bitsPerWord));
+	while (bits == 0)
+	{
+		if (++word == m_words.size ())
+		{
+			return m_numSymbols;
+		}
+		bits = ~m_words[word];
+	}
+	// the bits after the last symbol look free, thus clip to the size
+	return std::min (word * g_bitsPerWord + __builtin_ctzll (bits), m_numSymbols);
+}
+
+uint32_t
+SymbolAllocationMask::GetFreeRunLength (uint32_t start, uint32_t maxLength) const
+{
+	if (start >= m_numSymbols)
+	{
+		return 0;
+	}
+	uint64_t end = std::min ((uint64_t) start + maxLength, (uint64_t) m_numSymbols);
+	return std::min ((uint64_t) GetFirstBusy (start), end) - start;
+}
+
+uint32_t
+SymbolAllocationMask::FindFreeRun (uint32_t start, uint32_t length) const
+{
+	if (length == 0)
+	{
+		return std::min (start, m_numSymbols);
+	}
+	// jump from one free run to the next, each run is found a word at a time
+	uint32_t runStart = GetFirstFree (start);
+	while ((uint64_t) runStart + length <= m_numSymbols)
+	{
+		uint32_t runEnd = GetFirstBusy (runStart);
+		if (runEnd - runStart >= length)
+		{
+			return runStart;
+		}
+		runStart = GetFirstFree (runEnd);
+	}
+	return m_numSymbols;
+}
+
+std::string
+SymbolAllocationMask::Print () const
+{
+	std::stringstream strStream;
+	for (uint32_t symbol = 0; symbol < m_numSymbols; symbol++)
+	{
+		strStream << IsBusy (symbol) << " ";
+	}
+	return strStream.str ();
+}
+
 }
 
 
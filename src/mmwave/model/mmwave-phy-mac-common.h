@@ -309,6 +309,95 @@ struct SfAllocInfo
 	bool m_valid;
 };
 
+/**
+ * Busy symbols of a subframe, one bit for each symbol, packed in 64-bit
+ * words so that the free and busy runs are found a word at a time with
+ * count-trailing-zeros instead of symbol by symbol. Used by the IAB
+ * schedulers to skip the symbols already allocated to the backhaul.
+ * All the searches are clipped to the size of the mask, and return the
+ * size if nothing is found.
+ */
+class SymbolAllocationMask
+{
+public:
+	SymbolAllocationMask ();
+
+	/**
+	 * @params the number of symbols of the subframe, all free
+	 */
+	SymbolAllocationMask (uint32_t numSymbols);
+
+	/**
+	 * @returns the number of symbols
+	 */
+	uint32_t GetSize () const;
+
+	/**
+	 * Mark all the symbols as free
+	 */
+	void Clear ();
+
+	/**
+	 * @params the symbol
+	 * @returns true if the symbol is busy
+	 */
+	bool IsBusy (uint32_t symbol) const;
+
+	/**
+	 * Mark a run of symbols as busy
+	 * @params the first symbol
+	 * @params the number of symbols
+	 */
+	void SetBusy (uint32_t start, uint32_t numSymbols);
+
+	/**
+	 * @params the first symbol
+	 * @params the number of symbols
+	 * @returns true if at least one of the symbols is busy
+	 */
+	bool IsAnyBusy (uint32_t start, uint32_t numSymbols) const;
+
+	/**
+	 * @returns the number of busy symbols
+	 */
+	uint32_t GetNumBusy () const;
+
+	/**
+	 * @params the first symbol
+	 * @returns the first busy symbol from start on
+	 */
+	uint32_t GetFirstBusy (uint32_t start) const;
+
+	/**
+	 * @params the first symbol
+	 * @returns the first free symbol from start on
+	 */
+	uint32_t GetFirstFree (uint32_t start) const;
+
+	/**
+	 * @params the first symbol
+	 * @params the maximum length of the run
+	 * @returns the number of consecutive free symbols from start, up to maxLength
+	 */
+	uint32_t GetFreeRunLength (uint32_t start, uint32_t maxLength) const;
+
+	/**
+	 * @params the first symbol
+	 * @params the number of consecutive free symbols needed
+	 * @returns the first symbol from start on which begins a run of length free symbols
+	 */
+	uint32_t FindFreeRun (uint32_t start, uint32_t length) const;
+
+	/**
+	 * @returns the mask as a list of 0 (free) and 1 (busy)
+	 */
+	std::string Print () const;
+
+private:
+	uint32_t m_numSymbols;
+	std::vector<uint64_t> m_words; ///< bit i % 64 of word i / 64 is set if symbol i is busy
+};
+
 struct SfIabAllocInfo
 {
 	SfIabAllocInfo () : m_sfnSf (SfnSf()), m_valid(true)
@@ -316,23 +405,20 @@ struct SfIabAllocInfo
 
 	}
 
-	SfIabAllocInfo (uint32_t size) : m_sfnSf (SfnSf()), m_valid(true)
+	SfIabAllocInfo (uint32_t size) : m_sfnSf (SfnSf()), m_symAllocationMask (size), m_valid(true)
 	{
-		m_symAllocationMask = std::vector<bool>(size, false);
 	}
 
-	SfIabAllocInfo (SfnSf sfn, uint32_t size) : m_sfnSf (sfn), m_valid(true)
+	SfIabAllocInfo (SfnSf sfn, uint32_t size) : m_sfnSf (sfn), m_symAllocationMask (size), m_valid(true)
 	{
-		m_symAllocationMask = std::vector<bool>(size, false);
 	}
 
-	SfIabAllocInfo (SfnSf sfn, bool valid, uint32_t size) : m_sfnSf (sfn), m_valid(valid)
+	SfIabAllocInfo (SfnSf sfn, bool valid, uint32_t size) : m_sfnSf (sfn), m_symAllocationMask (size), m_valid(valid)
 	{
-		m_symAllocationMask = std::vector<bool>(size, false);
 	}
 
 	SfnSf m_sfnSf;
-	std::vector<bool> m_symAllocationMask; // vector of bools, 
+	SymbolAllocationMask m_symAllocationMask; // busy symbols
 	// uint32_t m_ulNumSymAlloc;  // number of allocated slots in the IAB uplink
 	// uint32_t m_ulSymStart;		 // start of UL IAB region
 	// uint32_t m_dlNumSymAlloc;  // number of allocated slots in the IAB downlink
@@ -53,9 +53,9 @@ public:
 
 	virtual void SendRachPreamble(uint8_t PreambleId, uint8_t Rnti) = 0;
 
-	virtual void SetDlSfAllocInfo (SfAllocInfo sfAllocInfo) = 0;
+	virtual void SetDlSfAllocInfo (const SfAllocInfo &sfAllocInfo) = 0;
 
-	virtual void SetUlSfAllocInfo (SfAllocInfo sfAllocInfo) = 0;
+	virtual void SetUlSfAllocInfo (const SfAllocInfo &sfAllocInfo) = 0;
 };
 
 /* Phy to Mac comm */
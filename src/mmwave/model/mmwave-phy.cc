@@ -60,9 +60,9 @@ public:
 
 	virtual void SendRachPreamble(uint8_t PreambleId, uint8_t Rnti);
 
-	virtual void SetDlSfAllocInfo (SfAllocInfo sfAllocInfo);
+	virtual void SetDlSfAllocInfo (const SfAllocInfo &sfAllocInfo);
 
-	virtual void SetUlSfAllocInfo (SfAllocInfo sfAllocInfo);
+	virtual void SetUlSfAllocInfo (const SfAllocInfo &sfAllocInfo);
 
 private:
 	MmWavePhy* m_phy;
@@ -93,13 +93,13 @@ MmWaveMemberPhySapProvider::SendRachPreamble(uint8_t PreambleId, uint8_t Rnti)
 }
 
 void
-MmWaveMemberPhySapProvider::SetDlSfAllocInfo (SfAllocInfo sfAllocInfo)
+MmWaveMemberPhySapProvider::SetDlSfAllocInfo (const SfAllocInfo &sfAllocInfo)
 {
 	m_phy->SetDlSfAllocInfo (sfAllocInfo);
 }
 
 void
-MmWaveMemberPhySapProvider::SetUlSfAllocInfo (SfAllocInfo sfAllocInfo)
+MmWaveMemberPhySapProvider::SetUlSfAllocInfo (const SfAllocInfo &sfAllocInfo)
 {
 	m_phy->SetUlSfAllocInfo (sfAllocInfo);
 }
@@ -325,7 +325,7 @@ MmWavePhy::GetSfAllocInfo (uint8_t subframeNum)
 }
 
 void
-MmWavePhy::SetDlSfAllocInfo (SfAllocInfo sfAllocInfo)
+MmWavePhy::SetDlSfAllocInfo (const SfAllocInfo &sfAllocInfo)
 {
 	// get previously enqueued SfAllocInfo and set DL slot allocations
 	//SfAllocInfo &sf = m_sfAllocInfo[sfAllocInfo.m_sfnSf.m_sfNum];
@@ -353,7 +353,7 @@ MmWavePhy::SetDlSfAllocInfo (SfAllocInfo sfAllocInfo)
 }
 
 void
-MmWavePhy::SetUlSfAllocInfo (SfAllocInfo sfAllocInfo)
+MmWavePhy::SetUlSfAllocInfo (const SfAllocInfo &sfAllocInfo)
 {
 	// add new SfAllocInfo with UL slot allocation
 	//m_sfAllocInfo[sfAllocInfo.m_sfnSf.m_sfNum] = sfAllocInfo;
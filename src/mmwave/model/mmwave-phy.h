@@ -117,8 +117,8 @@ public:
 	void UpdateCurrentAllocationAndSchedule (uint32_t frame, uint32_t sf);
 
 	SfAllocInfo GetSfAllocInfo (uint8_t subframeNum);
-	void SetDlSfAllocInfo (SfAllocInfo sfAllocInfo);
-	void SetUlSfAllocInfo (SfAllocInfo sfAllocInfo);
+	void SetDlSfAllocInfo (const SfAllocInfo &sfAllocInfo);
+	void SetUlSfAllocInfo (const SfAllocInfo &sfAllocInfo);
 
 	// hacks needed to compute SINR at eNB for each UE, without pilots
 	void AddSpectrumPropagationLossModel(Ptr<SpectrumPropagationLossModel> model);
@@ -0,0 +1,451 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-spectrum-channel.h"
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/pointer.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
+#include <ns3/mobility-model.h>
+#include <ns3/antenna-model.h>
+#include <ns3/angles.h>
+#include <ns3/propagation-loss-model.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveSpectrumChannel);
+
+TypeId
+MmWaveSpectrumChannel::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::MmWaveSpectrumChannel")
+		.SetParent<MultiModelSpectrumChannel> ()
+		.AddConstructor<MmWaveSpectrumChannel> ()
+		.AddAttribute ("LinkEligibilityFilter",
+		               "The filter which discards the links that the receiver would neglect, "
+		               "before any propagation loss is computed. If null, all the links are eligible",
+		               PointerValue (),
+		               MakePointerAccessor (&MmWaveSpectrumChannel::SetLinkEligibilityFilter,
+		                                    &MmWaveSpectrumChannel::GetLinkEligibilityFilter),
+		               MakePointerChecker<MmWaveLinkEligibilityFilter> ())
+		.AddAttribute ("MaxRange",
+		               "Maximum distance (in m) between a transmitter and a receiver for the signal "
+		               "to be propagated. It is also the size of the cells of the spatial index. "
+		               "0 disables the spatial culling",
+		               DoubleValue (0.0),
+		               MakeDoubleAccessor (&MmWaveSpectrumChannel::m_maxRange),
+		               MakeDoubleChecker<double> (0.0))
+		.AddAttribute ("MinRxPower",
+		               "Minimum received power (in dBm) for the signal to be propagated, computed with "
+		               "the single-frequency propagation loss and antenna models only, i.e., without "
+		               "the beamforming gain of the SpectrumPropagationLossModel. Leave a margin for it",
+		               DoubleValue (-1.0e9),
+		               MakeDoubleAccessor (&MmWaveSpectrumChannel::m_minRxPowerDbm),
+		               MakeDoubleChecker<double> ())
+		.AddAttribute ("NumThreads",
+		               "Number of threads which apply the BF gains of the links of a transmission, "
+		               "when the SpectrumPropagationLossModel is a MmWave3gppChannel. "
+		               "1 computes the received PSDs one by one in the simulation thread",
+		               UintegerValue (1),
+		               MakeUintegerAccessor (&MmWaveSpectrumChannel::SetNumThreads,
+		                                     &MmWaveSpectrumChannel::GetNumThreads),
+		               MakeUintegerChecker<uint32_t> (1))
+		.AddAttribute ("StatsPeriod",
+		               "Period of the CullingStats trace",
+		               TimeValue (Seconds (1.0)),
+		               MakeTimeAccessor (&MmWaveSpectrumChannel::m_statsPeriod),
+		               MakeTimeChecker ())
+		.AddTraceSource ("CullingStats",
+		                 "Number of links whose propagation was evaluated, and of links discarded by the "
+		                 "eligibility filter, the range and the power threshold, in the last StatsPeriod",
+		                 MakeTraceSourceAccessor (&MmWaveSpectrumChannel::m_cullingStatsTrace),
+		                 "ns3::MmWaveSpectrumChannel::CullingStatsTracedCallback")
+	;
+	return tid;
+}
+
+MmWaveSpectrumChannel::MmWaveSpectrumChannel ()
+	: m_maxRange (0),
+	  m_minRxPowerDbm (-1.0e9),
+	  m_statsStart (Seconds (0)),
+	  m_evaluated (0),
+	  m_filtered (0),
+	  m_outOfRange (0),
+	  m_belowThreshold (0),
+	  m_totalEvaluated (0),
+	  m_totalSaved (0),
+	  m_numThreads (1)
+{
+	NS_LOG_FUNCTION (this);
+	m_linkFilter = CreateObject<MmWaveLinkEligibilityFilter> ();
+	m_applyRxPsdJob = MakeCallback (&MmWaveSpectrumChannel::ApplyRxPsdJob, this);
+}
+
+MmWaveSpectrumChannel::~MmWaveSpectrumChannel ()
+{
+	NS_LOG_FUNCTION (this);
+}
+
+void
+MmWaveSpectrumChannel::DoDispose ()
+{
+	NS_LOG_FUNCTION (this);
+	m_linkFilter = 0;
+	m_grids.clear ();
+	m_threadPool = 0;
+	m_rxPsdChannel = 0;
+	m_rxPsdJobs.clear ();
+	m_applyRxPsdJob.Nullify ();
+	MultiModelSpectrumChannel::DoDispose ();
+}
+
+void
+MmWaveSpectrumChannel::SetLinkEligibilityFilter (Ptr<MmWaveLinkEligibilityFilter> filter)
+{
+	m_linkFilter = filter;
+}
+
+Ptr<MmWaveLinkEligibilityFilter>
+MmWaveSpectrumChannel::GetLinkEligibilityFilter () const
+{
+	return m_linkFilter;
+}
+
+void
+MmWaveSpectrumChannel::SetNumThreads (uint32_t numThreads)
+{
+	NS_LOG_FUNCTION (this << numThreads);
+	m_numThreads = numThreads;
+	m_threadPool = 0;
+}
+
+uint32_t
+MmWaveSpectrumChannel::GetNumThreads () const
+{
+	return m_numThreads;
+}
+
+uint64_t
+MmWaveSpectrumChannel::GetNumEvaluatedLinks () const
+{
+	return m_totalEvaluated;
+}
+
+uint64_t
+MmWaveSpectrumChannel::GetNumSavedLinks () const
+{
+	return m_totalSaved;
+}
+
+void
+MmWaveSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
+{
+	NS_LOG_FUNCTION (this << phy);
+	MultiModelSpectrumChannel::AddRx (phy);
+	// the phy may have moved to another RX spectrum model
+	for (std::map<SpectrumModelUid_t, SpatialGrid>::iterator it = m_grids.begin (); it != m_grids.end (); ++it)
+	{
+		it->second.m_valid = false;
+	}
+}
+
+MmWaveSpectrumChannel::GridCell_t
+MmWaveSpectrumChannel::GetGridCell (const Vector &position) const
+{
+	return GridCell_t ((int64_t) std::floor (position.x / m_maxRange),
+			(int64_t) std::floor (position.y / m_maxRange));
+}
+
+void
+MmWaveSpectrumChannel::GetCandidateReceivers (SpectrumModelUid_t rxSpectrumModelUid, const std::set<Ptr<SpectrumPhy> > &rxPhySet,
+		Ptr<MobilityModel> txMobility, std::vector<Ptr<SpectrumPhy> > &candidates)
+{
+	candidates.clear ();
+	if (m_maxRange <= 0 || txMobility == 0)
+	{
+		candidates.assign (rxPhySet.begin (), rxPhySet.end ());
+		return;
+	}
+
+	SpatialGrid &grid = m_grids[rxSpectrumModelUid];
+	if (!grid.m_valid || grid.m_buildTime != Simulator::Now ())
+	{
+		NS_LOG_LOGIC ("Rebuild the spatial index of SpectrumModelUid " << rxSpectrumModelUid);
+		grid.m_cells.clear ();
+		grid.m_unlocated.clear ();
+		for (std::set<Ptr<SpectrumPhy> >::const_iterator it = rxPhySet.begin (); it != rxPhySet.end (); ++it)
+		{
+			Ptr<MobilityModel> mobility = (*it)->GetMobility ();
+			if (mobility != 0)
+			{
+				grid.m_cells[GetGridCell (mobility->GetPosition ())].push_back (*it);
+			}
+			else
+			{
+				grid.m_unlocated.push_back (*it);
+			}
+		}
+		grid.m_buildTime = Simulator::Now ();
+		grid.m_valid = true;
+	}
+
+	// the cells are as large as the range, thus only the neighbors of the cell of the transmitter are needed
+	GridCell_t txCell = GetGridCell (txMobility->GetPosition ());
+	for (int64_t dx = -1; dx <= 1; dx++)
+	{
+		for (int64_t dy = -1; dy <= 1; dy++)
+		{
+			std::map<GridCell_t, std::vector<Ptr<SpectrumPhy> > >::const_iterator cell =
+					grid.m_cells.find (GridCell_t (txCell.first + dx, txCell.second + dy));
+			if (cell != grid.m_cells.end ())
+			{
+				candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
+			}
+		}
+	}
+	candidates.insert (candidates.end (), grid.m_unlocated.begin (), grid.m_unlocated.end ());
+	// visit the receivers in the order of the std::set, so that the models which
+	// draw random variables for new links behave as with MultiModelSpectrumChannel
+	std::sort (candidates.begin (), candidates.end ());
+}
+
+void
+MmWaveSpectrumChannel::UpdateStats ()
+{
+	Time elapsed = Simulator::Now () - m_statsStart;
+	if (elapsed >= m_statsPeriod && elapsed.IsStrictlyPositive ())
+	{
+		uint64_t saved = m_filtered + m_outOfRange + m_belowThreshold;
+		NS_LOG_INFO ("Propagation evaluations in the last " << elapsed.GetSeconds () << " s: " << m_evaluated
+				<< ", saved " << saved << " (" << saved / elapsed.GetSeconds () << " per s)");
+		m_cullingStatsTrace (elapsed, m_evaluated, m_filtered, m_outOfRange, m_belowThreshold);
+		m_statsStart = Simulator::Now ();
+		m_evaluated = 0;
+		m_filtered = 0;
+		m_outOfRange = 0;
+		m_belowThreshold = 0;
+	}
+}
+
+void
+MmWaveSpectrumChannel::ApplyRxPsdJob (uint32_t index)
+{
+	// this runs in the threads of the pool, thus no logging
+	const RxPsdJob &job = m_rxPsdJobs[index];
+	m_rxPsdChannel->ApplyBeamformingGain (job.m_job, job.m_psd, job.m_numBands);
+}
+
+void
+MmWaveSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
+{
+	NS_LOG_FUNCTION (this << txParams);
+
+	NS_ASSERT (txParams->txPhy);
+	NS_ASSERT (txParams->psd);
+
+	UpdateStats ();
+
+	Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
+	SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
+	TxSpectrumModelInfoMap_t::const_iterator txInfoIterator = FindAndEventuallyAddTxSpectrumModel (txParams->psd->GetSpectrumModel ());
+	NS_ASSERT (txInfoIterator != m_txSpectrumModelInfoMap.end ());
+
+	double txPowerDbm = 10 * std::log10 (Integral (*txParams->psd)) + 30;
+	std::vector<Ptr<SpectrumPhy> > candidates;
+	uint64_t evaluated = 0;
+	uint64_t filtered = 0;
+	uint64_t outOfRange = 0;
+	uint64_t belowThreshold = 0;
+
+	m_rxPsdChannel = 0;
+	m_rxPsdJobs.clear ();
+	if (m_numThreads > 1)
+	{
+		m_rxPsdChannel = DynamicCast<const MmWave3gppChannel> (m_spectrumPropagationLoss);
+		if (m_rxPsdChannel != 0 && m_rxPsdChannel->GetNext () != 0)
+		{
+			// the chained models are applied only by CalcRxPowerSpectralDensity
+			m_rxPsdChannel = 0;
+		}
+		if (m_rxPsdChannel != 0 && m_threadPool == 0)
+		{
+			m_threadPool = Create<MmWaveThreadPool> (m_numThreads);
+		}
+	}
+
+	for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+	     rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+	     ++rxInfoIterator)
+	{
+		SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
+
+		Ptr <SpectrumValue> convertedTxPowerSpectrum;
+		if (txSpectrumModelUid == rxSpectrumModelUid)
+		{
+			convertedTxPowerSpectrum = txParams->psd;
+		}
+		else
+		{
+			SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIterator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
+			if (rxConverterIterator == txInfoIterator->second.m_spectrumConverterMap.end ())
+			{
+				// No converter means TX SpectrumModel is orthogonal to RX SpectrumModel
+				continue;
+			}
+			convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
+		}
+
+		const std::set<Ptr<SpectrumPhy> > &rxPhySet = rxInfoIterator->second.m_rxPhySet;
+		GetCandidateReceivers (rxSpectrumModelUid, rxPhySet, txMobility, candidates);
+		uint64_t numOtherRx = rxPhySet.size () - rxPhySet.count (txParams->txPhy);
+		uint64_t numOtherCandidates = candidates.size () - std::count (candidates.begin (), candidates.end (), txParams->txPhy);
+		outOfRange += numOtherRx - numOtherCandidates;
+
+		for (std::vector<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = candidates.begin ();
+		     rxPhyIterator != candidates.end ();
+		     ++rxPhyIterator)
+		{
+			NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
+			               "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
+
+			if ((*rxPhyIterator) == txParams->txPhy)
+			{
+				continue;
+			}
+
+			if (m_linkFilter != 0 && !m_linkFilter->IsEligible (txParams->txPhy, *rxPhyIterator))
+			{
+				NS_LOG_LOGIC ("Link to " << *rxPhyIterator << " not eligible");
+				filtered++;
+				continue;
+			}
+
+			Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
+			if (m_maxRange > 0 && txMobility && receiverMobility
+			    && CalculateDistance (txMobility->GetPosition (), receiverMobility->GetPosition ()) > m_maxRange)
+			{
+				outOfRange++;
+				continue;
+			}
+
+			Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+			rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+			Time delay = MicroSeconds (0);
+
+			if (txMobility && receiverMobility)
+			{
+				double pathLossDb = 0;
+				if (rxParams->txAntenna != 0)
+				{
+					Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+					double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+					NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+					pathLossDb -= txAntennaGain;
+				}
+				Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
+				if (rxAntenna != 0)
+				{
+					Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+					double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+					NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+					pathLossDb -= rxAntennaGain;
+				}
+				if (m_propagationLoss)
+				{
+					double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+					NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+					pathLossDb -= propagationGainDb;
+				}
+				NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");
+				m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
+				if (pathLossDb > m_maxLossDb || txPowerDbm - pathLossDb < m_minRxPowerDbm)
+				{
+					// beyond range
+					belowThreshold++;
+					continue;
+				}
+				double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+				*(rxParams->psd) *= pathGainLinear;
+
+				if (m_rxPsdChannel != 0)
+				{
+					// the channel is resolved now, the BF gain is applied in place after the loop
+					m_rxPsdJobs.push_back (RxPsdJob ());
+					RxPsdJob &job = m_rxPsdJobs.back ();
+					if (m_rxPsdChannel->PrepareBeamformingGain (txMobility, receiverMobility, job.m_job))
+					{
+						job.m_psd = &(*rxParams->psd->ValuesBegin ());
+						job.m_numBands = rxParams->psd->GetSpectrumModel ()->GetNumBands ();
+					}
+					else
+					{
+						m_rxPsdJobs.pop_back ();
+					}
+				}
+				else if (m_spectrumPropagationLoss)
+				{
+					rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+				}
+
+				if (m_propagationDelay)
+				{
+					delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+				}
+			}
+			evaluated++;
+
+			Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
+			if (netDev)
+			{
+				// the receiver has a NetDevice, so we expect that it is attached to a Node
+				uint32_t dstNode =  netDev->GetNode ()->GetId ();
+				Simulator::ScheduleWithContext (dstNode, delay, &MmWaveSpectrumChannel::StartRx, this,
+				                                rxParams, *rxPhyIterator);
+			}
+			else
+			{
+				// the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+				Simulator::Schedule (delay, &MmWaveSpectrumChannel::StartRx, this,
+				                     rxParams, *rxPhyIterator);
+			}
+		}
+	}
+	// the receptions are scheduled, but not started yet
+	if (!m_rxPsdJobs.empty ())
+	{
+		NS_LOG_LOGIC ("Apply the BF gain of " << m_rxPsdJobs.size () << " links with " << m_threadPool->GetNumThreads () << " threads");
+		m_threadPool->Run (m_rxPsdJobs.size (), m_applyRxPsdJob);
+	}
+
+	m_evaluated += evaluated;
+	m_filtered += filtered;
+	m_outOfRange += outOfRange;
+	m_belowThreshold += belowThreshold;
+	m_totalEvaluated += evaluated;
+	m_totalSaved += filtered + outOfRange + belowThreshold;
+}
+
+} // namespace ns3
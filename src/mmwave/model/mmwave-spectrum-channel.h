@@ -0,0 +1,170 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_SPECTRUM_CHANNEL_H
+#define MMWAVE_SPECTRUM_CHANNEL_H
+
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/nstime.h>
+#include <ns3/traced-callback.h>
+#include "mmwave-link-eligibility-filter.h"
+#include "mmwave-3gpp-channel.h"
+#include "mmwave-thread-pool.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * A MultiModelSpectrumChannel which avoids the propagation of the signals
+ * to the receivers that would discard them. For each transmission, the
+ * receivers are culled, in order, by
+ *  - a uniform grid spatial index, which only returns the receivers within
+ *    MaxRange meters from the transmitter;
+ *  - the link eligibility filter (e.g., BS to BS or UE to UE links), before
+ *    any propagation loss is computed;
+ *  - the single-frequency propagation loss, if the received power, without
+ *    the gain of the SpectrumPropagationLossModel, is below MinRxPower
+ *    (or the loss above MaxLossDb).
+ * Only the remaining links are passed to the SpectrumPropagationLossModel
+ * (e.g., MmWave3gppChannel) and scheduled for reception.
+ *
+ * The grid is rebuilt with the current positions of the receivers the first
+ * time it is used at each simulation time, thus the culling is exact also
+ * with mobile nodes.
+ *
+ * If NumThreads is larger than 1 and the SpectrumPropagationLossModel is a
+ * MmWave3gppChannel with no other model chained to it, the links of a transmission are first resolved in the
+ * simulation thread, in order (channel generation and update, BF vectors,
+ * random variables, traces and scheduling of the receptions), and then the
+ * frequency selective BF gains, which are the most expensive part, are
+ * applied to the PSDs by a pool of threads. Each PSD is computed by a single
+ * thread with the same operations, thus the results do not depend on the
+ * number of threads.
+ */
+class MmWaveSpectrumChannel : public MultiModelSpectrumChannel
+{
+public:
+	static TypeId GetTypeId (void);
+	MmWaveSpectrumChannel ();
+	virtual ~MmWaveSpectrumChannel ();
+
+	virtual void AddRx (Ptr<SpectrumPhy> phy);
+	virtual void StartTx (Ptr<SpectrumSignalParameters> params);
+
+	void SetLinkEligibilityFilter (Ptr<MmWaveLinkEligibilityFilter> filter);
+	Ptr<MmWaveLinkEligibilityFilter> GetLinkEligibilityFilter () const;
+
+	void SetNumThreads (uint32_t numThreads);
+	uint32_t GetNumThreads () const;
+
+	/**
+	 * @returns the number of links whose propagation was evaluated since the start of the simulation
+	 */
+	uint64_t GetNumEvaluatedLinks () const;
+	/**
+	 * @returns the number of links whose propagation was skipped since the start of the simulation
+	 */
+	uint64_t GetNumSavedLinks () const;
+
+	/**
+	 * TracedCallback signature for the culling statistics of a StatsPeriod
+	 * @params the duration of the period
+	 * @params the number of links whose propagation was evaluated
+	 * @params the number of links discarded by the eligibility filter
+	 * @params the number of links beyond MaxRange
+	 * @params the number of links discarded by MinRxPower or MaxLossDb
+	 */
+	typedef void (* CullingStatsTracedCallback)
+		(Time period, uint64_t evaluated, uint64_t filtered, uint64_t outOfRange, uint64_t belowThreshold);
+
+protected:
+	virtual void DoDispose ();
+
+private:
+	typedef std::pair<int64_t, int64_t> GridCell_t;
+
+	/**
+	 * Receivers of a RX spectrum model, sorted by the cell of the grid they
+	 * were in at m_buildTime
+	 */
+	struct SpatialGrid
+	{
+		Time m_buildTime;
+		bool m_valid;
+		std::map<GridCell_t, std::vector<Ptr<SpectrumPhy> > > m_cells;
+		std::vector<Ptr<SpectrumPhy> > m_unlocated; ///< receivers without a mobility model
+	};
+
+	GridCell_t GetGridCell (const Vector &position) const;
+
+	/**
+	 * Collect the receivers of a RX spectrum model that may be within
+	 * MaxRange meters from the transmitter, in the same order in which
+	 * MultiModelSpectrumChannel would visit them
+	 */
+	void GetCandidateReceivers (SpectrumModelUid_t rxSpectrumModelUid, const std::set<Ptr<SpectrumPhy> > &rxPhySet,
+			Ptr<MobilityModel> txMobility, std::vector<Ptr<SpectrumPhy> > &candidates);
+
+	/**
+	 * Fire the culling statistics trace if StatsPeriod has elapsed
+	 */
+	void UpdateStats ();
+
+	/**
+	 * Apply the BF gain of a link of the current transmission, called by the thread pool
+	 * @params the index of the job in m_rxPsdJobs
+	 */
+	void ApplyRxPsdJob (uint32_t index);
+
+	/**
+	 * The BF gain of a link, to be applied to the PSD of the reception
+	 */
+	struct RxPsdJob
+	{
+		MmWave3gppChannel::BeamformingGainJob m_job;
+		double *m_psd;
+		uint32_t m_numBands;
+	};
+
+	Ptr<MmWaveLinkEligibilityFilter> m_linkFilter;
+	double m_maxRange;
+	double m_minRxPowerDbm;
+	std::map<SpectrumModelUid_t, SpatialGrid> m_grids;
+
+	Time m_statsPeriod;
+	Time m_statsStart;
+	uint64_t m_evaluated;
+	uint64_t m_filtered;
+	uint64_t m_outOfRange;
+	uint64_t m_belowThreshold;
+	uint64_t m_totalEvaluated;
+	uint64_t m_totalSaved;
+	TracedCallback<Time, uint64_t, uint64_t, uint64_t, uint64_t> m_cullingStatsTrace;
+
+	uint32_t m_numThreads;
+	Ptr<MmWaveThreadPool> m_threadPool;
+	Ptr<const MmWave3gppChannel> m_rxPsdChannel;	///< the channel of the jobs of the current transmission
+	std::vector<RxPsdJob> m_rxPsdJobs;
+	Callback<void, uint32_t> m_applyRxPsdJob;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_SPECTRUM_CHANNEL_H */
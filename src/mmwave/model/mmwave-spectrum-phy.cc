@@ -351,44 +351,41 @@ MmWaveSpectrumPhy::SetPhyUlHarqFeedbackCallback (MmWavePhyUlHarqFeedbackCallback
   m_phyUlHarqFeedbackCallback = c;
 }
 
-void
-MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+bool
+MmWaveSpectrumPhy::IsLinkNeglected (Ptr<SpectrumPhy> txPhy)
 {
-
-	NS_LOG_FUNCTION(this);
-
 	Ptr<MmWaveEnbNetDevice> EnbTx =
-			DynamicCast<MmWaveEnbNetDevice> (params->txPhy->GetDevice ());
+			DynamicCast<MmWaveEnbNetDevice> (txPhy->GetDevice ());
 	Ptr<MmWaveUeNetDevice> UeTx =
-			DynamicCast<MmWaveUeNetDevice> (params->txPhy->GetDevice ());
+			DynamicCast<MmWaveUeNetDevice> (txPhy->GetDevice ());
 	Ptr<McUeNetDevice> McUeTx =	
-			DynamicCast<McUeNetDevice> (params->txPhy->GetDevice ());
+			DynamicCast<McUeNetDevice> (txPhy->GetDevice ());
 	Ptr<MmWaveIabNetDevice> iabTx = 
-				DynamicCast<MmWaveIabNetDevice> (params->txPhy->GetDevice ());
+				DynamicCast<MmWaveIabNetDevice> (txPhy->GetDevice ());
 
 	if(GetDeviceType() == ENB && EnbTx != 0)
 	{
 		// eNB to eNB, skip
 		NS_LOG_INFO ("BS to BS or UE to UE transmission neglected.");
-		return;
+		return true;
 	}
 	else if(GetDeviceType() == UE && UeTx != 0)
 	{
 		// UE to UE, skip
 		NS_LOG_INFO ("BS to BS or UE to UE transmission neglected.");
-		return;
+		return true;
 	}
 	else if(GetDeviceType() == MCUE && McUeTx != 0)
 	{
 		// MC to MC, skip
 		NS_LOG_INFO ("BS to BS or UE to UE transmission neglected.");
-		return;
+		return true;
 	}
 	else if(GetDeviceType() == IAB && (m_device == iabTx)) // check that this is not a TX of the same IAB device and for now discard it
 	{
 		// transmisssion and reception in the same device, skip it!
-		NS_LOG_INFO ("Transmission and reception in the SAME IAB neglected. Tx spectrum phy " << params->txPhy << " " <<  Simulator::Now().GetSeconds());
-		return;
+		NS_LOG_INFO ("Transmission and reception in the SAME IAB neglected. Tx spectrum phy " << txPhy << " " <<  Simulator::Now().GetSeconds());
+		return true;
 	}
 	else
 	{
@@ -400,40 +397,53 @@ MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
 		// UE to IAB backhaul
 		// IAB backhaul to UE
 
-		if(iabTx && !(DynamicCast<MmWaveSpectrumPhy>(params->txPhy)->GetAccessSpectrumPhy()) && (GetDeviceType() == UE || GetDeviceType() == MCUE))
+		if(iabTx && !(DynamicCast<MmWaveSpectrumPhy>(txPhy)->GetAccessSpectrumPhy()) && (GetDeviceType() == UE || GetDeviceType() == MCUE))
 		{
 			// the TX is an IAB device in the backhaul and the RX is an UE, do not receive the ctrl
 			NS_LOG_INFO("IAB backhaul to UE - neglect"<< " " <<  Simulator::Now().GetSeconds());
-			return;
+			return true;
 		}
-		else if(iabTx && !(DynamicCast<MmWaveSpectrumPhy>(params->txPhy)->GetAccessSpectrumPhy()) && GetDeviceType() == IAB && !GetAccessSpectrumPhy())
+		else if(iabTx && !(DynamicCast<MmWaveSpectrumPhy>(txPhy)->GetAccessSpectrumPhy()) && GetDeviceType() == IAB && !GetAccessSpectrumPhy())
 		{
 			NS_LOG_INFO("IAB backhaul to IAB backhaul - neglect"<< " " <<  Simulator::Now().GetSeconds());
-			return;
+			return true;
 		}
 		else if((GetDeviceType() == IAB) && !GetAccessSpectrumPhy() && (UeTx || McUeTx))
 		{
 			// the TX is an UE and the RX is the IAB in backhaul, ignore
 			NS_LOG_INFO(this << " UE to IAB backhaul - neglect " << GetAccessSpectrumPhy() << " " <<  Simulator::Now().GetSeconds());
-			return;
+			return true;
 		}
-		else if(iabTx && (DynamicCast<MmWaveSpectrumPhy>(params->txPhy)->GetAccessSpectrumPhy()) && GetDeviceType() == IAB && GetAccessSpectrumPhy())
+		else if(iabTx && (DynamicCast<MmWaveSpectrumPhy>(txPhy)->GetAccessSpectrumPhy()) && GetDeviceType() == IAB && GetAccessSpectrumPhy())
 		{
 			NS_LOG_INFO("IAB access to IAB access - neglect" << " " <<  Simulator::Now().GetSeconds());
-			return;
+			return true;
 		}
 		else if(EnbTx && GetDeviceType() == IAB && GetAccessSpectrumPhy())
 		{
 			NS_LOG_INFO("eNB access to IAB access - neglect" << " " <<  Simulator::Now().GetSeconds());
-			return;
+			return true;
 		}
-		else if(iabTx && (DynamicCast<MmWaveSpectrumPhy>(params->txPhy)->GetAccessSpectrumPhy()) && GetDeviceType() == ENB)
+		else if(iabTx && (DynamicCast<MmWaveSpectrumPhy>(txPhy)->GetAccessSpectrumPhy()) && GetDeviceType() == ENB)
 		{
 			NS_LOG_INFO("IAB access to eNB access - neglect" << " " <<  Simulator::Now().GetSeconds());
-			return;
+			return true;
 		}
 	}
 	// other IAB to IAB can be valid
+	return false;
+}
+
+void
+MmWaveSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
+{
+
+	NS_LOG_FUNCTION(this);
+
+	if (IsLinkNeglected (params->txPhy))
+	{
+		return;
+	}
 
 	Ptr<MmwaveSpectrumSignalParametersDataFrame> mmwaveDataRxParams =
 			DynamicCast<MmwaveSpectrumSignalParametersDataFrame> (params);
@@ -134,6 +134,13 @@ public:
 
 	void SetNoisePowerSpectralDensity (Ptr<const SpectrumValue> noisePsd);
 	void SetTxPowerSpectralDensity (Ptr<SpectrumValue> TxPsd);
+	/**
+	 * Check if the signals transmitted by txPhy are discarded by this
+	 * receiver (e.g., BS to BS, UE to UE or IAB access to IAB access)
+	 * @params the transmitter
+	 * @returns true if the link is not valid
+	 */
+	bool IsLinkNeglected (Ptr<SpectrumPhy> txPhy);
 	void StartRx (Ptr<SpectrumSignalParameters> params);
 	void StartRxData (Ptr<MmwaveSpectrumSignalParametersDataFrame> params);
 	void StartRxCtrl (Ptr<SpectrumSignalParameters> params);
@@ -0,0 +1,170 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-thread-pool.h"
+#include <ns3/core-config.h>
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveThreadPool");
+
+MmWaveThreadPool::MmWaveThreadPool (uint32_t numThreads)
+	: m_ranges (std::max (numThreads, 1u)),
+	  m_task (0),
+	  m_batch (0),
+	  m_busyWorkers (0),
+	  m_stop (false)
+{
+	NS_LOG_FUNCTION (this << numThreads);
+#ifdef HAVE_PTHREAD_H
+	for (uint32_t thread = 1; thread < m_ranges.size (); thread++)
+	{
+		m_workers.push_back (std::thread (&MmWaveThreadPool::WorkerLoop, this, thread));
+	}
+#else
+	NS_LOG_WARN ("No threading support, the tasks run in the calling thread");
+#endif
+}
+
+MmWaveThreadPool::~MmWaveThreadPool ()
+{
+	NS_LOG_FUNCTION (this);
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_stop = true;
+	}
+	m_startCondition.notify_all ();
+	for (uint32_t i = 0; i < m_workers.size (); i++)
+	{
+		m_workers[i].join ();
+	}
+}
+
+uint32_t
+MmWaveThreadPool::GetNumThreads () const
+{
+	return m_workers.size () + 1;
+}
+
+void
+MmWaveThreadPool::Run (uint32_t numTasks, const Callback<void, uint32_t> &task)
+{
+	NS_LOG_FUNCTION (this << numTasks);
+	if (m_workers.empty () || numTasks <= 1)
+	{
+		for (uint32_t i = 0; i < numTasks; i++)
+		{
+			task (i);
+		}
+		return;
+	}
+
+	uint32_t numThreads = GetNumThreads ();
+	for (uint32_t thread = 0; thread < numThreads; thread++)
+	{
+		m_ranges[thread].m_next = (uint64_t) numTasks * thread / numThreads;
+		m_ranges[thread].m_end = (uint64_t) numTasks * (thread + 1) / numThreads;
+	}
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_task = &task;
+		m_busyWorkers = m_workers.size ();
+		m_batch++;
+	}
+	m_startCondition.notify_all ();
+
+	RunTasks (0);
+
+	std::unique_lock<std::mutex> lock (m_mutex);
+	while (m_busyWorkers > 0)
+	{
+		m_doneCondition.wait (lock);
+	}
+	m_task = 0;
+}
+
+bool
+MmWaveThreadPool::PopTask (uint32_t thread, uint32_t &task)
+{
+	{
+		TaskRange &own = m_ranges[thread];
+		std::lock_guard<std::mutex> lock (own.m_mutex);
+		if (own.m_next < own.m_end)
+		{
+			task = own.m_next++;
+			return true;
+		}
+	}
+	for (uint32_t i = 1; i < m_ranges.size (); i++)
+	{
+		TaskRange &victim = m_ranges[(thread + i) % m_ranges.size ()];
+		std::lock_guard<std::mutex> lock (victim.m_mutex);
+		if (victim.m_next < victim.m_end)
+		{
+			task = --victim.m_end;
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+MmWaveThreadPool::RunTasks (uint32_t thread)
+{
+	uint32_t task;
+	while (PopTask (thread, task))
+	{
+		(*m_task) (task);
+	}
+}
+
+void
+MmWaveThreadPool::WorkerLoop (uint32_t thread)
+{
+	uint64_t lastBatch = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock (m_mutex);
+			while (!m_stop && m_batch == lastBatch)
+			{
+				m_startCondition.wait (lock);
+			}
+			if (m_stop)
+			{
+				return;
+			}
+			lastBatch = m_batch;
+		}
+
+		RunTasks (thread);
+
+		std::lock_guard<std::mutex> lock (m_mutex);
+		NS_ASSERT (m_busyWorkers > 0);
+		if (--m_busyWorkers == 0)
+		{
+			m_doneCondition.notify_one ();
+		}
+	}
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_THREAD_POOL_H
+#define MMWAVE_THREAD_POOL_H
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/callback.h>
+#include <stdint.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace ns3 {
+
+/**
+ * A pool of threads which run the tasks 0, 1, ..., N-1 of a batch, and
+ * return when all of them are done. The tasks are split in contiguous ranges,
+ * one per thread (the calling thread is one of them); a thread which has
+ * finished its range steals the tasks from the end of the ranges of the
+ * others, so that the batches of tasks with different costs are balanced.
+ *
+ * The tasks run outside of the simulation thread: they must not use the
+ * Simulator or the logging, nor copy or release the Ptr to objects which
+ * are shared with the other tasks, since SimpleRefCount is not thread-safe.
+ *
+ * Without the threading support of ns-3 (pthread.h), all the tasks run in
+ * the calling thread.
+ */
+class MmWaveThreadPool : public SimpleRefCount<MmWaveThreadPool>
+{
+public:
+	/**
+	 * @params the number of threads, including the calling one
+	 */
+	MmWaveThreadPool (uint32_t numThreads);
+	~MmWaveThreadPool ();
+
+	/**
+	 * @returns the number of threads which run the tasks, including the calling one
+	 */
+	uint32_t GetNumThreads () const;
+
+	/**
+	 * Run task (i) for i = 0, ..., numTasks - 1
+	 * @params the number of tasks
+	 * @params the task, called with the index of the task
+	 */
+	void Run (uint32_t numTasks, const Callback<void, uint32_t> &task);
+
+private:
+	/**
+	 * Tasks [m_next, m_end) of a thread
+	 */
+	struct TaskRange
+	{
+		std::mutex m_mutex;
+		uint32_t m_next;
+		uint32_t m_end;
+	};
+
+	/**
+	 * Take a task from the front of the range of a thread, or steal it from
+	 * the back of the range of another thread
+	 * @params the index of the thread
+	 * @params the index of the task
+	 * @returns false if no task is left
+	 */
+	bool PopTask (uint32_t thread, uint32_t &task);
+	void RunTasks (uint32_t thread);
+	void WorkerLoop (uint32_t thread);
+
+	std::vector<TaskRange> m_ranges;
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_startCondition;
+	std::condition_variable m_doneCondition;
+	const Callback<void, uint32_t> *m_task;
+	uint64_t m_batch;	///< incremented at the start of each batch
+	uint32_t m_busyWorkers;
+	bool m_stop;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_THREAD_POOL_H */
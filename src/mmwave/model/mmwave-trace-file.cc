@@ -0,0 +1,329 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mmwave-trace-file.h"
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/abort.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceFile");
+
+static const char g_traceFileMagic[8] = {'M', 'M', 'W', 'T', 'R', 'A', 'C', 'E'};
+static const uint32_t g_traceFileVersion = 1;
+static const uint32_t g_traceFileByteOrder = 0x01020304;
+static const uint32_t g_traceFileComplexFlag = 0x1;
+
+/**
+ * Header of the binary trace files, 40 bytes, so that the row offsets
+ * and the values which follow it are aligned to 8 bytes
+ */
+struct MmWaveTraceFileHeader
+{
+	char m_magic[8];
+	uint32_t m_version;
+	uint32_t m_byteOrder;
+	uint32_t m_flags;
+	uint32_t m_reserved;
+	uint64_t m_numRows;
+	uint64_t m_numValues;
+};
+
+/**
+ * The tables loaded in this process, indexed by the name of the file
+ */
+static std::map<std::string, Ptr<MmWaveTraceFile> >&
+GetTraceFileCache ()
+{
+	static std::map<std::string, Ptr<MmWaveTraceFile> > cache;
+	return cache;
+}
+
+MmWaveTraceFile::MmWaveTraceFile ()
+	: m_complex (false),
+	  m_numRows (0),
+	  m_offsets (0),
+	  m_data (0),
+	  m_map (0),
+	  m_mapSize (0)
+{
+}
+
+MmWaveTraceFile::~MmWaveTraceFile ()
+{
+	if (m_map != 0)
+	{
+		munmap (m_map, m_mapSize);
+	}
+}
+
+Ptr<const MmWaveTraceFile>
+MmWaveTraceFile::Load (std::string filename, bool complex)
+{
+	std::map<std::string, Ptr<MmWaveTraceFile> > &cache = GetTraceFileCache ();
+	std::map<std::string, Ptr<MmWaveTraceFile> >::const_iterator it = cache.find (filename);
+	if (it != cache.end ())
+	{
+		NS_ABORT_MSG_IF (it->second->m_complex != complex, "Trace file " << filename << " loaded with a different type");
+		return it->second;
+	}
+
+	Ptr<MmWaveTraceFile> table = Ptr<MmWaveTraceFile> (new MmWaveTraceFile (), false);
+	if (!table->MapBinary (filename, complex))
+	{
+		table = ParseText (filename, complex);
+	}
+	NS_LOG_INFO ("Loaded " << filename << ": " << table->m_numRows << " rows, "
+			<< table->m_offsets[table->m_numRows] << " values, " << (table->IsMapped () ? "mapped" : "parsed"));
+	cache.insert (std::make_pair (filename, table));
+	return table;
+}
+
+Ptr<const MmWaveTraceFile>
+MmWaveTraceFile::LoadAny (std::string basename, bool complex)
+{
+	std::string binaryName = basename + ".bin";
+	if (std::ifstream (binaryName.c_str ()).good ())
+	{
+		return Load (binaryName, complex);
+	}
+	return Load (basename + ".txt", complex);
+}
+
+std::complex<double>
+MmWaveTraceFile::ParseComplex (const char *str)
+{
+	// same rules of MmWaveBeamforming::ParseComplex, the number after the
+	// first sign which is not at the beginning is the imaginary part
+	std::string strCmplx (str);
+	size_t findj = strCmplx.find ('i');
+	bool hasImag = (findj != std::string::npos);
+	if (hasImag)
+	{
+		strCmplx[findj] = '\0';
+	}
+	bool hasReal = !hasImag
+			|| strCmplx.find ('+', 1) != std::string::npos || strCmplx.find ('-', 1) != std::string::npos;
+
+	double re = 0.0;
+	double im = 0.0;
+	const char *begin = strCmplx.c_str ();
+	char *end = 0;
+	if (hasReal)
+	{
+		re = std::strtod (begin, &end);
+		begin = end;
+	}
+	if (hasImag)
+	{
+		im = std::strtod (begin, &end);
+	}
+	return std::complex<double> (re, im);
+}
+
+Ptr<MmWaveTraceFile>
+MmWaveTraceFile::ParseText (std::string filename, bool complex)
+{
+	NS_LOG_FUNCTION (filename << complex);
+	std::ifstream singlefile (filename.c_str (), std::ifstream::in | std::ifstream::binary);
+	NS_ABORT_MSG_IF (!singlefile.good (), "Trace file " << filename << " not found");
+	std::ostringstream content;
+	content << singlefile.rdbuf ();
+	const std::string text = content.str ();
+
+	Ptr<MmWaveTraceFile> table = Ptr<MmWaveTraceFile> (new MmWaveTraceFile (), false);
+	table->m_complex = complex;
+	table->m_ownedOffsets.push_back (0);
+	std::string token;
+	size_t pos = 0;
+	while (pos < text.size ()) //Parse each line of the file
+	{
+		size_t lineEnd = text.find ('\n', pos);
+		if (lineEnd == std::string::npos)
+		{
+			lineEnd = text.size ();
+		}
+		uint64_t rowSize = 0;
+		while (pos < lineEnd) //Parse each comma separated string in a line
+		{
+			size_t tokenEnd = std::min (text.find (',', pos), lineEnd);
+			token.assign (text, pos, tokenEnd - pos);
+			if (complex)
+			{
+				std::complex<double> value = ParseComplex (token.c_str ());
+				table->m_ownedData.push_back (value.real ());
+				table->m_ownedData.push_back (value.imag ());
+			}
+			else
+			{
+				table->m_ownedData.push_back (std::strtod (token.c_str (), 0));
+			}
+			rowSize++;
+			pos = tokenEnd + 1;
+		}
+		table->m_ownedOffsets.push_back (table->m_ownedOffsets.back () + rowSize);
+		pos = lineEnd + 1;
+	}
+
+	table->m_numRows = table->m_ownedOffsets.size () - 1;
+	table->m_offsets = &table->m_ownedOffsets[0];
+	table->m_data = table->m_ownedData.empty () ? 0 : &table->m_ownedData[0];
+	return table;
+}
+
+bool
+MmWaveTraceFile::MapBinary (std::string filename, bool complex)
+{
+	int fd = open (filename.c_str (), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat fileStat;
+	MmWaveTraceFileHeader header;
+	if (fstat (fd, &fileStat) != 0 || (size_t) fileStat.st_size < sizeof (header)
+			|| read (fd, &header, sizeof (header)) != sizeof (header)
+			|| std::memcmp (header.m_magic, g_traceFileMagic, sizeof (g_traceFileMagic)) != 0)
+	{
+		// not a binary trace file
+		close (fd);
+		return false;
+	}
+
+	NS_ABORT_MSG_IF (header.m_byteOrder != g_traceFileByteOrder, "Trace file " << filename << " written with a different byte order");
+	NS_ABORT_MSG_IF (header.m_version != g_traceFileVersion, "Trace file " << filename << " has version " << header.m_version
+			<< ", expected " << g_traceFileVersion);
+	NS_ABORT_MSG_IF (((header.m_flags & g_traceFileComplexFlag) != 0) != complex,
+			"Trace file " << filename << (complex ? " does not store complex values" : " stores complex values"));
+	uint64_t valueSize = complex ? 2 * sizeof (double) : sizeof (double);
+	NS_ABORT_MSG_IF ((uint64_t) fileStat.st_size != sizeof (header) + (header.m_numRows + 1) * sizeof (uint64_t)
+			+ header.m_numValues * valueSize, "Trace file " << filename << " is truncated");
+
+	m_mapSize = fileStat.st_size;
+	m_map = mmap (0, m_mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	NS_ABORT_MSG_IF (m_map == MAP_FAILED, "Cannot map the trace file " << filename);
+
+	m_complex = complex;
+	m_numRows = header.m_numRows;
+	m_offsets = reinterpret_cast<const uint64_t*> (static_cast<const char*> (m_map) + sizeof (header));
+	m_data = reinterpret_cast<const double*> (m_offsets + m_numRows + 1);
+	NS_ABORT_MSG_IF (m_offsets[0] != 0 || m_offsets[m_numRows] != header.m_numValues,
+			"Trace file " << filename << " has invalid row offsets");
+	for (uint64_t row = 0; row < m_numRows; row++)
+	{
+		NS_ABORT_MSG_IF (m_offsets[row] > m_offsets[row + 1], "Trace file " << filename << " has invalid row offsets");
+	}
+	return true;
+}
+
+void
+MmWaveTraceFile::WriteBinary (std::string filename) const
+{
+	NS_LOG_FUNCTION (this << filename);
+	MmWaveTraceFileHeader header;
+	std::memcpy (header.m_magic, g_traceFileMagic, sizeof (g_traceFileMagic));
+	header.m_version = g_traceFileVersion;
+	header.m_byteOrder = g_traceFileByteOrder;
+	header.m_flags = m_complex ? g_traceFileComplexFlag : 0;
+	header.m_reserved = 0;
+	header.m_numRows = m_numRows;
+	header.m_numValues = m_offsets[m_numRows];
+
+	std::ofstream outFile (filename.c_str (), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+	NS_ABORT_MSG_IF (!outFile.good (), "Cannot open " << filename);
+	outFile.write (reinterpret_cast<const char*> (&header), sizeof (header));
+	outFile.write (reinterpret_cast<const char*> (m_offsets), (m_numRows + 1) * sizeof (uint64_t));
+	if (header.m_numValues > 0)
+	{
+		outFile.write (reinterpret_cast<const char*> (m_data),
+				header.m_numValues * (m_complex ? 2 : 1) * sizeof (double));
+	}
+	outFile.close ();
+	NS_ABORT_MSG_IF (outFile.fail (), "Cannot write " << filename);
+}
+
+bool
+MmWaveTraceFile::IsMapped () const
+{
+	return m_map != 0;
+}
+
+bool
+MmWaveTraceFile::IsComplex () const
+{
+	return m_complex;
+}
+
+uint32_t
+MmWaveTraceFile::GetNRows () const
+{
+	return m_numRows;
+}
+
+uint32_t
+MmWaveTraceFile::GetRowSize (uint32_t row) const
+{
+	NS_ASSERT_MSG (row < m_numRows, "Row " << row << " out of " << m_numRows);
+	return m_offsets[row + 1] - m_offsets[row];
+}
+
+const double*
+MmWaveTraceFile::GetRow (uint32_t row) const
+{
+	NS_ASSERT_MSG (row < m_numRows, "Row " << row << " out of " << m_numRows);
+	NS_ASSERT (!m_complex);
+	return m_data + m_offsets[row];
+}
+
+const std::complex<double>*
+MmWaveTraceFile::GetComplexRow (uint32_t row) const
+{
+	NS_ASSERT_MSG (row < m_numRows, "Row " << row << " out of " << m_numRows);
+	NS_ASSERT (m_complex);
+	// std::complex<double> has the layout of double[2]
+	return reinterpret_cast<const std::complex<double>*> (m_data) + m_offsets[row];
+}
+
+std::vector<double>
+MmWaveTraceFile::GetRowVector (uint32_t row) const
+{
+	const double *begin = GetRow (row);
+	return std::vector<double> (begin, begin + GetRowSize (row));
+}
+
+std::vector< std::complex<double> >
+MmWaveTraceFile::GetComplexRowVector (uint32_t row) const
+{
+	const std::complex<double> *begin = GetComplexRow (row);
+	return std::vector< std::complex<double> > (begin, begin + GetRowSize (row));
+}
+
+} // namespace ns3
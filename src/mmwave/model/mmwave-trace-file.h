@@ -0,0 +1,162 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef MMWAVE_TRACE_FILE_H
+#define MMWAVE_TRACE_FILE_H
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/ptr.h>
+#include <complex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * Read-only table of numbers loaded from the trace files of the
+ * MmWaveBeamforming and MmWaveChannelRaytracing models. The file has one
+ * row per line, with a variable number of comma separated values, that are
+ * either real numbers or complex numbers written as 3+2i.
+ *
+ * The values are stored in a single flat array, together with the offset
+ * of the first value of each row. Two formats are supported:
+ * - the text format, which is parsed at loading time;
+ * - a binary format, written by WriteBinary (or by the mmwave-trace-converter
+ *   example), that is mapped in memory with mmap and used without copies.
+ *
+ * The binary file starts with a header of 40 bytes (magic "MMWTRACE",
+ * version, byte order mark, flags, number of rows and number of values),
+ * followed by the numRows + 1 row offsets (uint64_t) and by the values
+ * (double, or pairs of double for the complex tables), in the byte order
+ * of the machine which wrote it.
+ *
+ * The tables are loaded with Load, which keeps them in a cache shared by
+ * all the models of the process, so that a file is read only once even
+ * across several simulation runs.
+ */
+class MmWaveTraceFile : public SimpleRefCount<MmWaveTraceFile>
+{
+public:
+	~MmWaveTraceFile ();
+
+	/**
+	 * Load a table, in the binary or in the text format, or get it from the cache
+	 * @params the name of the file
+	 * @params true if the values are complex numbers
+	 * @returns the table
+	 */
+	static Ptr<const MmWaveTraceFile> Load (std::string filename, bool complex);
+
+	/**
+	 * Load the binary version of a table if it exists, i.e., basename.bin,
+	 * otherwise the text version basename.txt
+	 * @params the name of the file, without extension
+	 * @params true if the values are complex numbers
+	 * @returns the table
+	 */
+	static Ptr<const MmWaveTraceFile> LoadAny (std::string basename, bool complex);
+
+	/**
+	 * Parse a table in the text format, without using the cache
+	 * @params the name of the file
+	 * @params true if the values are complex numbers
+	 * @returns the table
+	 */
+	static Ptr<MmWaveTraceFile> ParseText (std::string filename, bool complex);
+
+	/**
+	 * Get a complex number from a string, i.e. 3+2i, 3 or 2i
+	 * @params the string
+	 * @returns the complex number
+	 */
+	static std::complex<double> ParseComplex (const char *str);
+
+	/**
+	 * Write the table in the binary format
+	 * @params the name of the file
+	 */
+	void WriteBinary (std::string filename) const;
+
+	/**
+	 * @returns true if the table was mapped from a binary file
+	 */
+	bool IsMapped () const;
+
+	/**
+	 * @returns true if the values are complex numbers
+	 */
+	bool IsComplex () const;
+
+	/**
+	 * @returns the number of rows
+	 */
+	uint32_t GetNRows () const;
+
+	/**
+	 * @params the row
+	 * @returns the number of values of the row
+	 */
+	uint32_t GetRowSize (uint32_t row) const;
+
+	/**
+	 * @params the row of a real table
+	 * @returns the pointer to the first value of the row
+	 */
+	const double* GetRow (uint32_t row) const;
+
+	/**
+	 * @params the row of a complex table
+	 * @returns the pointer to the first value of the row
+	 */
+	const std::complex<double>* GetComplexRow (uint32_t row) const;
+
+	/**
+	 * @params the row of a real table
+	 * @returns a copy of the row
+	 */
+	std::vector<double> GetRowVector (uint32_t row) const;
+
+	/**
+	 * @params the row of a complex table
+	 * @returns a copy of the row
+	 */
+	std::vector< std::complex<double> > GetComplexRowVector (uint32_t row) const;
+
+private:
+	MmWaveTraceFile ();
+	bool MapBinary (std::string filename, bool complex);
+
+	bool m_complex;
+	uint64_t m_numRows;
+	const uint64_t *m_offsets;	///< numRows + 1 offsets of the rows, in values
+	const double *m_data;		///< values, two doubles for each complex value
+
+	// storage of the parsed text tables
+	std::vector<uint64_t> m_ownedOffsets;
+	std::vector<double> m_ownedData;
+
+	// mapped binary file
+	void *m_map;
+	size_t m_mapSize;
+};
+
+} // namespace ns3
+
+#endif /* MMWAVE_TRACE_FILE_H */
@@ -218,6 +218,11 @@ MmWaveUeMac::GetTypeId (void)
                  BooleanValue (false),
                  MakeBooleanAccessor (&MmWaveUeMac::m_interRatHoCapable),
                  MakeBooleanChecker ())
+		    .AddTraceSource ("HarqCopiedBytes",
+                 "Total number of bytes copied to retransmit the PDUs of the UL HARQ buffers, "
+                 "when they are still referenced by the PHY or by the channel.",
+                 MakeTraceSourceAccessor (&MmWaveUeMac::m_harqCopiedBytes),
+                 "ns3::TracedValueCallback::Uint64")
 	;
 	return tid;
 }
@@ -228,7 +233,8 @@ MmWaveUeMac::MmWaveUeMac (void)
   m_freshUlBsr (false),
   //m_harqProcessId (0),
   m_rnti (0),
-  m_waitingForRaResponse (true)
+  m_waitingForRaResponse (true),
+  m_harqCopiedBytes (0)
 {
 	NS_LOG_FUNCTION (this);
 	m_cmacSapProvider = new UeMemberMmWaveUeCmacSapProvider (this);
@@ -264,11 +270,6 @@ MmWaveUeMac::SetConfigurationParameters (Ptr<MmWavePhyMacCommon> ptrConfig)
 
 	m_miUlHarqProcessesPacket.clear();
 	m_miUlHarqProcessesPacket.resize (m_phyMacConfig->GetNumHarqProcess ());
-	for (uint8_t i = 0; i < m_miUlHarqProcessesPacket.size (); i++)
-	{
-		Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-		m_miUlHarqProcessesPacket.at (i).m_pktBurst = pb;
-	}
 	m_miUlHarqProcessesPacketTimer.clear();
 	m_miUlHarqProcessesPacketTimer.resize (m_phyMacConfig->GetNumHarqProcess (), 0);
 
@@ -335,7 +336,7 @@ MmWaveUeMac::DoTransmitPdu (LteMacSapProvider::TransmitPduParameters params)
 
 			LteRadioBearerTag bearerTag (params.rnti, 0, 0);
 			it->second.m_pdu->AddPacketTag (bearerTag);
-			m_miUlHarqProcessesPacket.at (params.harqProcessId).m_pktBurst->AddPacket (it->second.m_pdu);
+			m_miUlHarqProcessesPacket.at (params.harqProcessId).m_pduBuffer.AddPdu (it->second.m_pdu);
 			m_miUlHarqProcessesPacketTimer.at (params.harqProcessId) = m_phyMacConfig->GetHarqTimeout ();
 			//m_harqProcessId = (m_harqProcessId + 1) % m_phyMacConfig->GetHarqTimeout();
 			m_phySapProvider->SendMacPdu (it->second.m_pdu);
@@ -473,12 +474,11 @@ MmWaveUeMac::RefreshHarqProcessesPacketBuffer (void)
     {
       if (m_miUlHarqProcessesPacketTimer.at (i) == 0)
         {
-          if (m_miUlHarqProcessesPacket.at (i).m_pktBurst->GetSize () > 0)
+          if (m_miUlHarqProcessesPacket.at (i).m_pduBuffer.GetSize () > 0)
             {
               // timer expired: drop packets in buffer for this process
               NS_LOG_INFO (this << " HARQ Proc Id " << i << " packets buffer expired");
-              Ptr<PacketBurst> emptyPb = CreateObject <PacketBurst> ();
-              m_miUlHarqProcessesPacket.at (i).m_pktBurst = emptyPb;
+              m_miUlHarqProcessesPacket.at (i).m_pduBuffer.Clear ();
               m_miUlHarqProcessesPacket.at (i).m_lcidList.clear ();
             }
         }
@@ -651,8 +651,7 @@ MmWaveUeMac::DoReceiveControlMessage  (Ptr<MmWaveControlMessage> msg)
 			if (dciInfoElem.m_ndi == 1)
 			{
 				// New transmission -> empty pkt buffer queue (for deleting eventual pkts not acked )
-				Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-				m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_pktBurst = pb;
+				m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_pduBuffer.Clear ();
 				m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_lcidList.clear ();
 				// Retrieve data from RLC
 				std::map <uint8_t, LteMacSapProvider::ReportBufferStatusParameters>::iterator itBsr;
@@ -700,7 +699,7 @@ MmWaveUeMac::DoReceiveControlMessage  (Ptr<MmWaveControlMessage> msg)
 					emptyPdu->AddPacketTag (tag);
 					LteRadioBearerTag bearerTag (dciInfoElem.m_rnti, 3, 0);
 					emptyPdu->AddPacketTag (bearerTag);
-					m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_pktBurst->AddPacket (emptyPdu);
+					m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_pduBuffer.AddPdu (emptyPdu);
 					m_miUlHarqProcessesPacketTimer.at (dciInfoElem.m_harqProcess) = m_phyMacConfig->GetHarqTimeout ();
 					//m_harqProcessId = (m_harqProcessId + 1) % m_phyMacConfig->GetHarqTimeout();
 					m_phySapProvider->SendMacPdu (emptyPdu);
@@ -830,10 +829,11 @@ MmWaveUeMac::DoReceiveControlMessage  (Ptr<MmWaveControlMessage> msg)
 			{
 				// HARQ retransmission -> retrieve data from HARQ buffer
 				NS_LOG_DEBUG (this << " UE MAC RETX HARQ " << (unsigned)dciInfoElem.m_harqProcess);
-				Ptr<PacketBurst> pb = m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_pktBurst;
-				for (std::list<Ptr<Packet> >::const_iterator j = pb->Begin (); j != pb->End (); ++j)
+				MmWaveHarqPduBuffer &pduBuffer = m_miUlHarqProcessesPacket.at (dciInfoElem.m_harqProcess).m_pduBuffer;
+				uint64_t copiedBytes = 0;
+				for (uint32_t ipdu = 0; ipdu < pduBuffer.GetNPdus (); ipdu++)
 				{
-					Ptr<Packet> pkt = (*j)->Copy ();
+					Ptr<Packet> pkt = pduBuffer.GetPduForUpdate (ipdu, copiedBytes);
 					// update packet tag
 					MmWaveMacPduTag tag;
 					if(!pkt->RemovePacketTag (tag))
@@ -861,6 +861,10 @@ MmWaveUeMac::DoReceiveControlMessage  (Ptr<MmWaveControlMessage> msg)
 					pkt->AddPacketTag (tag);
 					m_phySapProvider->SendMacPdu (pkt);
 				}
+				if (copiedBytes > 0)
+				{
+					m_harqCopiedBytes += copiedBytes;
+				}
 				m_miUlHarqProcessesPacketTimer.at (dciInfoElem.m_harqProcess) = m_phyMacConfig->GetHarqTimeout();
 			}
 		}
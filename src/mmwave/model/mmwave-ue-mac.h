@@ -39,6 +39,7 @@
 #include <ns3/lte-mac-sap.h>
 #include <ns3/lte-radio-bearer-tag.h>
 #include <ns3/mmwave-mac-csched-sap.h>
+#include <ns3/traced-value.h>
 
 
 namespace ns3
@@ -144,7 +145,7 @@ private:
 
 	struct UlHarqProcessInfo
 		{
-			Ptr<PacketBurst> m_pktBurst;
+			MmWaveHarqPduBuffer m_pduBuffer;
 			// maintain list of LCs contained in this TB
 			// used to signal HARQ failure to RLC handlers
 			std::vector<uint8_t> m_lcidList;
@@ -164,6 +165,7 @@ private:
 	uint16_t m_rnti;
 
 	bool m_waitingForRaResponse;
+	TracedValue<uint64_t> m_harqCopiedBytes; // bytes copied to retransmit the PDUs of the HARQ buffers
 	static uint8_t g_raPreambleId;
 	Ptr<UniformRandomVariable> m_randomAccessProcedureDelay;
 	double m_ueUpdateSinrPeriod;
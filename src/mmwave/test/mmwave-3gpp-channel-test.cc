@@ -0,0 +1,171 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-enb-net-device.h"
+#include "ns3/mmwave-ue-net-device.h"
+#include "ns3/antenna-array-model.h"
+#include "ns3/mmwave-3gpp-channel.h"
+#include "ns3/mmwave-spectrum-value-helper.h"
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWave3gppChannelTest");
+
+/**
+ * Evaluate a gNB-UE link of a MmWave3gppChannel with UpdatePeriod exactly at
+ * the refresh time of its channel, from an event scheduled before the
+ * channel was generated, i.e., before the refresh event, and check that the
+ * expired channel is not used, and that it is used just before
+ */
+class MmWave3gppChannelRefreshTestCase : public TestCase
+{
+public:
+  MmWave3gppChannelRefreshTestCase ();
+  virtual ~MmWave3gppChannelRefreshTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Evaluate (bool expired);
+
+  Ptr<MmWave3gppChannel> m_channel;
+  Ptr<MmWaveEnbNetDevice> m_enbDev;
+  Ptr<MmWaveUeNetDevice> m_ueDev;
+  Ptr<MobilityModel> m_enbMob;
+  Ptr<MobilityModel> m_ueMob;
+  Ptr<const SpectrumValue> m_txPsd;
+  uint32_t m_numEvaluations;
+};
+
+MmWave3gppChannelRefreshTestCase::MmWave3gppChannelRefreshTestCase ()
+  : TestCase ("transmission at the refresh time of the channel"),
+    m_numEvaluations (0)
+{
+}
+
+MmWave3gppChannelRefreshTestCase::~MmWave3gppChannelRefreshTestCase ()
+{
+}
+
+void
+MmWave3gppChannelRefreshTestCase::Evaluate (bool expired)
+{
+  m_numEvaluations++;
+  // the gNB PHY switches its antenna to omni for the control symbols
+  DynamicCast<AntennaArrayModel> (m_enbDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ())->ChangeBeamformingVector (m_ueDev);
+  DynamicCast<AntennaArrayModel> (m_ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ())->ChangeBeamformingVector (m_enbDev);
+  Time generated = m_channel->GetChannelGenerationTime (m_enbMob, m_ueMob);
+  if (expired)
+    {
+      NS_TEST_ASSERT_MSG_EQ (generated, Seconds (-1), "the channel should be expired at " << Simulator::Now ());
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (generated, Seconds (0), "the channel should be valid at " << Simulator::Now ());
+    }
+
+  m_channel->CalcRxPowerSpectralDensity (m_txPsd, m_enbMob, m_ueMob);
+  generated = m_channel->GetChannelGenerationTime (m_enbMob, m_ueMob);
+  NS_TEST_ASSERT_MSG_EQ (generated, (expired ? Simulator::Now () : Seconds (0)),
+                         "wrong generation time of the channel used at " << Simulator::Now ());
+}
+
+void
+MmWave3gppChannelRefreshTestCase::DoRun (void)
+{
+  Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper> ();
+  mmwaveHelper->Initialize ();
+  mmwaveHelper->GetPathLossModel ()->SetAttribute ("Scenario", StringValue ("UMi-StreetCanyon"));
+
+  NodeContainer enbNodes;
+  NodeContainer ueNodes;
+  enbNodes.Create (1);
+  ueNodes.Create (1);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0, 0, 10));
+  positionAlloc->Add (Vector (40, 20, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+  NetDeviceContainer enbDevs = mmwaveHelper->InstallEnbDevice (enbNodes);
+  NetDeviceContainer ueDevs = mmwaveHelper->InstallUeDevice (ueNodes);
+  // the antenna of a UE is omnidirectional until it is attached
+  mmwaveHelper->AttachToClosestEnb (ueDevs, enbDevs);
+  m_enbDev = DynamicCast<MmWaveEnbNetDevice> (enbDevs.Get (0));
+  m_ueDev = DynamicCast<MmWaveUeNetDevice> (ueDevs.Get (0));
+  m_enbMob = enbNodes.Get (0)->GetObject<MobilityModel> ();
+  m_ueMob = ueNodes.Get (0)->GetObject<MobilityModel> ();
+
+  Ptr<MmWavePhyMacCommon> config = mmwaveHelper->GetPhyMacConfigurable ();
+  m_channel = CreateObject<MmWave3gppChannel> ();
+  m_channel->SetAttribute ("UpdatePeriod", TimeValue (MilliSeconds (2)));
+  m_channel->SetConfigurationParameters (config);
+  m_channel->SetPathlossModel (mmwaveHelper->GetPathLossModel ());
+  std::vector<int> subChannels;
+  for (uint32_t i = 0; i < config->GetTotalNumChunk (); ++i)
+    {
+      subChannels.push_back (i);
+    }
+  m_txPsd = MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (config, 30, subChannels);
+
+  // the evaluations are scheduled before the refresh event of the channel
+  Simulator::Schedule (MilliSeconds (2) - NanoSeconds (1), &MmWave3gppChannelRefreshTestCase::Evaluate, this, false);
+  Simulator::Schedule (MilliSeconds (2), &MmWave3gppChannelRefreshTestCase::Evaluate, this, true);
+  m_channel->Initial (ueDevs, enbDevs);
+  NS_TEST_ASSERT_MSG_EQ (m_channel->GetChannelGenerationTime (m_enbMob, m_ueMob), Seconds (0),
+                         "the channel was not generated");
+
+  Simulator::Stop (MilliSeconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_numEvaluations, 2, "the link was not evaluated");
+
+  m_channel->Dispose ();
+  m_channel = 0;
+  m_enbDev = 0;
+  m_ueDev = 0;
+  m_enbMob = 0;
+  m_ueMob = 0;
+  m_txPsd = 0;
+}
+
+
+class MmWave3gppChannelTestSuite : public TestSuite
+{
+public:
+  MmWave3gppChannelTestSuite ();
+};
+
+MmWave3gppChannelTestSuite::MmWave3gppChannelTestSuite ()
+  : TestSuite ("mmwave-3gpp-channel", UNIT)
+{
+  AddTestCase (new MmWave3gppChannelRefreshTestCase (), TestCase::QUICK);
+}
+
+static MmWave3gppChannelTestSuite mmWave3gppChannelTestSuite;
@@ -0,0 +1,160 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/mmwave-amc.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include <sstream>
+#include <cstdlib>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveAmcTbSizeTest");
+
+/**
+ * Check MmWaveAmc::GetMinNumSymbolsFromTbsMcs against the bisection over
+ * GetTbSizeFromMcsSymbols which the flex-TTI schedulers ran in
+ * CalcMinTbSizeNumSym, and against a linear search over the TB sizes of
+ * 1, 2, ... symbols, for all the MCS and all the buffer sizes up to a full
+ * subframe
+ */
+class MmWaveAmcTbSizeTestCase : public TestCase
+{
+public:
+  MmWaveAmcTbSizeTestCase (uint32_t symbolsPerSubframe);
+  virtual ~MmWaveAmcTbSizeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  unsigned LegacyMinNumSym (Ptr<MmWaveAmc> amc, unsigned mcs, unsigned bufSize, unsigned &tbSize);
+
+  uint32_t m_symbolsPerSubframe;
+};
+
+static std::string
+BuildNameString (uint32_t symbolsPerSubframe)
+{
+  std::ostringstream oss;
+  oss << symbolsPerSubframe << " symbols per subframe";
+  return oss.str ();
+}
+
+MmWaveAmcTbSizeTestCase::MmWaveAmcTbSizeTestCase (uint32_t symbolsPerSubframe)
+  : TestCase (BuildNameString (symbolsPerSubframe)),
+    m_symbolsPerSubframe (symbolsPerSubframe)
+{
+}
+
+MmWaveAmcTbSizeTestCase::~MmWaveAmcTbSizeTestCase ()
+{
+}
+
+unsigned
+MmWaveAmcTbSizeTestCase::LegacyMinNumSym (Ptr<MmWaveAmc> amc, unsigned mcs, unsigned bufSize, unsigned &tbSize)
+{
+  int numSymLow = 0;
+  int numSymHigh = m_symbolsPerSubframe;
+  int diff = 0;
+  tbSize = (amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+  while (tbSize > bufSize)
+    {
+      diff = abs (numSymHigh - numSymLow) / 2;
+      if (diff == 0)
+        {
+          tbSize = (amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+          return numSymHigh;
+        }
+      tbSize = (amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh - diff) / 8);
+      if (tbSize > bufSize)
+        {
+          numSymHigh -= diff;
+        }
+      while (tbSize < bufSize)
+        {
+          diff = abs (numSymHigh - numSymLow) / 2;
+          if (diff == 0)
+            {
+              tbSize = (amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+              return numSymHigh;
+            }
+          tbSize = (amc->GetTbSizeFromMcsSymbols (mcs, numSymLow + diff) / 8);
+          if (tbSize < bufSize)
+            {
+              numSymLow += diff;
+            }
+        }
+    }
+  tbSize = (amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+  return numSymHigh;
+}
+
+void
+MmWaveAmcTbSizeTestCase::DoRun (void)
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  config->SetAttribute ("SymbolsPerSubframe", UintegerValue (m_symbolsPerSubframe));
+  Ptr<MmWaveAmc> amc = CreateObject<MmWaveAmc> (config);
+
+  for (unsigned mcs = 0; mcs < 29; mcs++)
+    {
+      int maxTbSize = amc->GetTbSizeFromMcsSymbols (mcs, m_symbolsPerSubframe) / 8;
+      unsigned minNumSym = 1;
+      for (int bufSize = 0; bufSize <= maxTbSize + 10; bufSize++)
+        {
+          // the buffer sizes are increasing, thus so is the linear search
+          while (minNumSym < m_symbolsPerSubframe && amc->GetTbSizeFromMcsSymbols (mcs, minNumSym) / 8 < bufSize)
+            {
+              minNumSym++;
+            }
+          unsigned tbSize = 0;
+          unsigned numSym = amc->GetMinNumSymbolsFromTbsMcs (bufSize, mcs, tbSize);
+          unsigned legacyTbSize = 0;
+          NS_TEST_ASSERT_MSG_EQ (numSym, LegacyMinNumSym (amc, mcs, bufSize, legacyTbSize),
+                                 "different number of symbols for MCS " << mcs << " and " << bufSize << " bytes");
+          NS_TEST_ASSERT_MSG_EQ (tbSize, legacyTbSize, "different TB size for MCS " << mcs << " and " << bufSize << " bytes");
+          NS_TEST_ASSERT_MSG_EQ (tbSize, (unsigned) (amc->GetTbSizeFromMcsSymbols (mcs, numSym) / 8),
+                                 "wrong TB size for MCS " << mcs << " and " << bufSize << " bytes");
+          // above the minimum only if a TB is exactly bufSize bytes
+          if (numSym != minNumSym)
+            {
+              NS_TEST_ASSERT_MSG_EQ (amc->GetTbSizeFromMcsSymbols (mcs, minNumSym) / 8, bufSize,
+                                     "not the minimum number of symbols for MCS " << mcs << " and " << bufSize << " bytes");
+              NS_TEST_ASSERT_MSG_GT (numSym, minNumSym, "below the minimum number of symbols");
+            }
+        }
+    }
+}
+
+
+class MmWaveAmcTbSizeTestSuite : public TestSuite
+{
+public:
+  MmWaveAmcTbSizeTestSuite ();
+};
+
+MmWaveAmcTbSizeTestSuite::MmWaveAmcTbSizeTestSuite ()
+  : TestSuite ("mmwave-amc-tb-size", UNIT)
+{
+  AddTestCase (new MmWaveAmcTbSizeTestCase (24), TestCase::QUICK);
+  AddTestCase (new MmWaveAmcTbSizeTestCase (240), TestCase::QUICK);
+}
+
+static MmWaveAmcTbSizeTestSuite mmWaveAmcTbSizeTestSuite;
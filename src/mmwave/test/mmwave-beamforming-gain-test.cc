@@ -0,0 +1,167 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/mmwave-beamforming-gain-kernel.h"
+#include <complex>
+#include <vector>
+#include <sstream>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBeamformingGainTest");
+
+/**
+ * Compare the rotating phasor implementations of the beamforming gain
+ * (scalar and, when supported by the CPU, AVX2 and AVX-512) with the scalar
+ * implementation, and the scalar implementation with the reference one, on
+ * random clustered channels.
+ */
+class MmWaveBeamformingGainTestCase : public TestCase
+{
+public:
+  MmWaveBeamformingGainTestCase (uint32_t numCluster, uint32_t numBand);
+  virtual ~MmWaveBeamformingGainTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Check (MmWaveBeamformingGainKernel::Type type, const std::vector<double> &expected,
+              MmWaveBeamformingGainKernel::Type expectedType);
+
+  uint32_t m_numCluster;
+  uint32_t m_numBand;
+  std::vector<std::complex<double> > m_longTerm;
+  std::vector<double> m_delay;
+  std::vector<double> m_inPsd;
+  double m_f0;
+  double m_df;
+};
+
+static std::string
+BuildNameString (uint32_t numCluster, uint32_t numBand)
+{
+  std::ostringstream oss;
+  oss << numCluster << " clusters, " << numBand << " subbands";
+  return oss.str ();
+}
+
+MmWaveBeamformingGainTestCase::MmWaveBeamformingGainTestCase (uint32_t numCluster, uint32_t numBand)
+  : TestCase (BuildNameString (numCluster, numBand)),
+    m_numCluster (numCluster),
+    m_numBand (numBand),
+    m_f0 (28e9 - 0.5e9),
+    m_df (1e9 / numBand)
+{
+}
+
+MmWaveBeamformingGainTestCase::~MmWaveBeamformingGainTestCase ()
+{
+}
+
+void
+MmWaveBeamformingGainTestCase::Check (MmWaveBeamformingGainKernel::Type type, const std::vector<double> &expected,
+                                      MmWaveBeamformingGainKernel::Type expectedType)
+{
+  if (!MmWaveBeamformingGainKernel::IsSupported (type))
+    {
+      NS_LOG_INFO ("kernel " << type << " not supported by this CPU, skipped");
+      return;
+    }
+
+  // the incoherent sum of the cluster powers bounds the gain; it is used as the
+  // scale of the error in the subbands where the clusters add up destructively
+  double incoherent = 0;
+  for (uint32_t c = 0; c < m_numCluster; c++)
+    {
+      incoherent += std::abs (m_longTerm[c]);
+    }
+  incoherent *= incoherent;
+
+  std::vector<double> outPsd (m_numBand);
+  MmWaveBeamformingGainKernel::Compute (type, &m_longTerm[0], &m_delay[0], m_numCluster,
+                                        m_f0, m_df, &m_inPsd[0], &outPsd[0], m_numBand);
+  for (uint32_t b = 0; b < m_numBand; b++)
+    {
+      double scale = std::max (expected[b], 1e-3 * incoherent * m_inPsd[b]);
+      NS_TEST_ASSERT_MSG_EQ_TOL (outPsd[b], expected[b], 1e-9 * scale,
+                                 "kernel " << type << " differs from kernel " << expectedType << " in subband " << b);
+    }
+}
+
+void
+MmWaveBeamformingGainTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_numCluster * 1000 + m_numBand);
+
+  for (uint32_t c = 0; c < m_numCluster; c++)
+    {
+      double amplitude = std::pow (10, -uniform->GetValue (0, 4));
+      m_longTerm.push_back (std::polar (amplitude, uniform->GetValue (0, 2 * M_PI)));
+      m_delay.push_back (uniform->GetValue (0, 1e-6));
+    }
+  for (uint32_t b = 0; b < m_numBand; b++)
+    {
+      // some subbands are not used by the transmitter
+      m_inPsd.push_back (b % 5 == 3 ? 0.0 : uniform->GetValue (1e-12, 1e-9));
+    }
+
+  std::vector<double> scalar (m_numBand);
+  MmWaveBeamformingGainKernel::Compute (MmWaveBeamformingGainKernel::SCALAR, &m_longTerm[0], &m_delay[0],
+                                        m_numCluster, m_f0, m_df, &m_inPsd[0], &scalar[0], m_numBand);
+
+  Check (MmWaveBeamformingGainKernel::REFERENCE, scalar, MmWaveBeamformingGainKernel::SCALAR);
+  Check (MmWaveBeamformingGainKernel::AVX2, scalar, MmWaveBeamformingGainKernel::SCALAR);
+  Check (MmWaveBeamformingGainKernel::AVX512, scalar, MmWaveBeamformingGainKernel::SCALAR);
+  Check (MmWaveBeamformingGainKernel::SIMD, scalar, MmWaveBeamformingGainKernel::SCALAR);
+
+  for (uint32_t b = 0; b < m_numBand; b++)
+    {
+      if (m_inPsd[b] == 0.0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (scalar[b], 0.0, "unused subband " << b << " has non-zero power");
+        }
+    }
+}
+
+
+class MmWaveBeamformingGainTestSuite : public TestSuite
+{
+public:
+  MmWaveBeamformingGainTestSuite ();
+};
+
+MmWaveBeamformingGainTestSuite::MmWaveBeamformingGainTestSuite ()
+  : TestSuite ("mmwave-beamforming-gain", UNIT)
+{
+  uint32_t numClusters[] = {1, 3, 8, 19, 23};
+  uint32_t numBands[] = {72, 100, 1000};
+  for (uint32_t i = 0; i < sizeof (numClusters) / sizeof (numClusters[0]); i++)
+    {
+      for (uint32_t j = 0; j < sizeof (numBands) / sizeof (numBands[0]); j++)
+        {
+          AddTestCase (new MmWaveBeamformingGainTestCase (numClusters[i], numBands[j]), TestCase::QUICK);
+        }
+    }
+}
+
+static MmWaveBeamformingGainTestSuite mmWaveBeamformingGainTestSuite;
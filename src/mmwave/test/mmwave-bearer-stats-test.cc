@@ -0,0 +1,294 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/basic-data-calculators.h"
+#include "ns3/mmwave-bearer-stats-calculator.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBearerStatsTest");
+
+/**
+ * Notify random PDUs of a few bearers to a MmWaveBearerStatsCalculator in
+ * the aggregation mode, and check the converted epoch blocks against the
+ * counters and the MinMaxAvgTotalCalculators of each bearer and epoch.
+ * Without Simulator::Stop, the third epoch has no PDUs, and the simulation
+ * must end after the epoch which follows the last PDU.
+ */
+class MmWaveBearerStatsAggregationTestCase : public TestCase
+{
+public:
+  MmWaveBearerStatsAggregationTestCase (bool stop);
+  virtual ~MmWaveBearerStatsAggregationTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Expected statistics of a bearer in an epoch and direction
+  struct Expected
+  {
+    uint64_t txPackets;
+    uint64_t txBytes;
+    uint64_t rxBytes;
+    Ptr<MinMaxAvgTotalCalculator<uint64_t> > delay;
+    Ptr<MinMaxAvgTotalCalculator<uint32_t> > size;
+  };
+
+  void CheckFile (std::string binaryFile, std::string textFile, std::vector<std::vector<Expected> > &expected,
+                  const std::vector<bool> &written);
+
+  bool m_stop;
+  uint16_t m_cellId[3];
+  uint64_t m_imsi[3];
+  uint16_t m_rnti[3];
+  uint8_t m_lcid[3];
+};
+
+MmWaveBearerStatsAggregationTestCase::MmWaveBearerStatsAggregationTestCase (bool stop)
+  : TestCase (stop ? "epoch blocks of the aggregation mode" : "epoch blocks of the aggregation mode, without Stop"),
+    m_stop (stop)
+{
+}
+
+MmWaveBearerStatsAggregationTestCase::~MmWaveBearerStatsAggregationTestCase ()
+{
+}
+
+void
+MmWaveBearerStatsAggregationTestCase::DoRun (void)
+{
+  const uint32_t numBearers = 3;
+  const uint32_t numEpochs = 4; // the last one is partial
+  const uint32_t epochUs = 10000;
+  for (uint32_t b = 0; b < numBearers; b++)
+    {
+      m_cellId[b] = 2 + b % 2;
+      m_imsi[b] = 1 + b / 2;
+      m_rnti[b] = 10 + b;
+      m_lcid[b] = 3 + b % 2;
+    }
+
+  std::string prefix = m_stop ? "" : "NoStop";
+  std::string ulFile = CreateTempDirFilename (prefix + "UlRlcStats.txt");
+  std::string dlFile = CreateTempDirFilename (prefix + "DlRlcStats.txt");
+  Ptr<MmWaveBearerStatsCalculator> stats = CreateObject<MmWaveBearerStatsCalculator> ();
+  stats->SetAttribute ("AggregationMode", BooleanValue (true));
+  stats->SetAttribute ("EpochDuration", TimeValue (MicroSeconds (epochUs)));
+  stats->SetAttribute ("UlRlcOutputFilename", StringValue (ulFile));
+  stats->SetAttribute ("DlRlcOutputFilename", StringValue (dlFile));
+
+  std::vector<uint32_t> bearers;
+  for (uint32_t b = 0; b < numBearers; b++)
+    {
+      bearers.push_back (stats->RegisterBearer (m_cellId[b], m_imsi[b], m_rnti[b], m_lcid[b]));
+    }
+  NS_TEST_ASSERT_MSG_EQ (stats->RegisterBearer (m_cellId[1], m_imsi[1], m_rnti[1], m_lcid[1]), bearers[1],
+                         "a bearer registered twice must keep its index");
+
+  std::vector<std::vector<Expected> > expected[2]; // UL, DL
+  for (uint32_t dir = 0; dir < 2; dir++)
+    {
+      expected[dir].resize (numEpochs, std::vector<Expected> (numBearers));
+      for (uint32_t e = 0; e < numEpochs; e++)
+        {
+          for (uint32_t b = 0; b < numBearers; b++)
+            {
+              Expected &exp = expected[dir][e][b];
+              exp.txPackets = 0;
+              exp.txBytes = 0;
+              exp.rxBytes = 0;
+              exp.delay = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
+              exp.size = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
+            }
+        }
+    }
+
+  // PDUs at random times of the first three epochs and of the first half of
+  // the last one, but the third one without Stop
+  std::vector<bool> written (numEpochs, true);
+  if (!m_stop)
+    {
+      written[2] = false;
+    }
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      uint32_t b = uniform->GetInteger (0, numBearers - 1);
+      bool dl = uniform->GetValue () < 0.5;
+      bool tx = uniform->GetValue () < 0.5;
+      uint32_t size = uniform->GetInteger (10, 1500);
+      uint64_t delay = uniform->GetInteger (10000, 50000000);
+      uint32_t us = uniform->GetInteger (0, epochUs * 7 / 2 - 1);
+      if (us % epochUs == 0)
+        {
+          us++; // not together with the end of an epoch
+        }
+      if (!written[us / epochUs])
+        {
+          us -= epochUs;
+        }
+      Expected &exp = expected[dl][us / epochUs][b];
+      if (tx)
+        {
+          exp.txPackets++;
+          exp.txBytes += size;
+          if (dl)
+            {
+              Simulator::Schedule (MicroSeconds (us), (void (MmWaveBearerStatsCalculator::*) (uint32_t, uint32_t))
+                                   &MmWaveBearerStatsCalculator::DlTxPdu, stats, bearers[b], size);
+            }
+          else
+            {
+              Simulator::Schedule (MicroSeconds (us), (void (MmWaveBearerStatsCalculator::*) (uint32_t, uint32_t))
+                                   &MmWaveBearerStatsCalculator::UlTxPdu, stats, bearers[b], size);
+            }
+        }
+      else
+        {
+          exp.rxBytes += size;
+          exp.delay->Update (delay);
+          exp.size->Update (size);
+          if (dl)
+            {
+              Simulator::Schedule (MicroSeconds (us), (void (MmWaveBearerStatsCalculator::*) (uint32_t, uint32_t, uint64_t))
+                                   &MmWaveBearerStatsCalculator::DlRxPdu, stats, bearers[b], size, delay);
+            }
+          else
+            {
+              Simulator::Schedule (MicroSeconds (us), (void (MmWaveBearerStatsCalculator::*) (uint32_t, uint32_t, uint64_t))
+                                   &MmWaveBearerStatsCalculator::UlRxPdu, stats, bearers[b], size, delay);
+            }
+        }
+    }
+
+  if (m_stop)
+    {
+      Simulator::Stop (MicroSeconds (epochUs * 37 / 10));
+    }
+  Simulator::Run ();
+  if (!m_stop)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MicroSeconds (epochUs * (numEpochs + 1)),
+                             "the simulation must end with the epoch after the last PDU");
+    }
+  Simulator::Destroy ();
+
+  CheckFile (CreateTempDirFilename (prefix + "UlRlcStats.bin"), CreateTempDirFilename (prefix + "UlRlcStatsConverted.txt"),
+             expected[0], written);
+  CheckFile (CreateTempDirFilename (prefix + "DlRlcStats.bin"), CreateTempDirFilename (prefix + "DlRlcStatsConverted.txt"),
+             expected[1], written);
+}
+
+void
+MmWaveBearerStatsAggregationTestCase::CheckFile (std::string binaryFile, std::string textFile,
+                                                 std::vector<std::vector<Expected> > &expected,
+                                                 const std::vector<bool> &written)
+{
+  uint32_t numEpochs = expected.size ();
+  uint32_t numBearers = expected[0].size ();
+  uint32_t numWritten = std::count (written.begin (), written.end (), true);
+  NS_TEST_ASSERT_MSG_EQ (MmWaveBearerStatsCalculator::ConvertEpochStats (binaryFile, textFile), numWritten * numBearers,
+                         "wrong number of rows in " << binaryFile);
+
+  std::ifstream file (textFile.c_str ());
+  std::string line;
+  std::getline (file, line);
+  NS_TEST_ASSERT_MSG_EQ (line.substr (0, 28), "% start\tend\tCellId\tIMSI\tRNTI", "wrong columns in " << textFile);
+  for (uint32_t e = 0; e < numEpochs; e++)
+    {
+      if (!written[e])
+        {
+          continue;
+        }
+      for (uint32_t b = 0; b < numBearers; b++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (std::getline (file, line).good (), true, "missing row in " << textFile);
+          std::istringstream row (line);
+          double start, end;
+          uint64_t cellId, imsi, rnti, lcid, txPackets, txBytes, rxPackets, rxBytes;
+          double values[8];
+          row >> start >> end >> cellId >> imsi >> rnti >> lcid >> txPackets >> txBytes >> rxPackets >> rxBytes;
+          for (uint32_t v = 0; v < 8; v++)
+            {
+              row >> values[v];
+            }
+          NS_TEST_ASSERT_MSG_EQ (row.fail (), false, "malformed row " << line);
+
+          const Expected &exp = expected[e][b];
+          NS_TEST_ASSERT_MSG_EQ_TOL (start, e * 0.01, 1e-9, "wrong epoch start");
+          NS_TEST_ASSERT_MSG_EQ_TOL (end, (e + 1) * 0.01, 1e-9, "wrong epoch end");
+          NS_TEST_ASSERT_MSG_EQ (cellId, m_cellId[b], "wrong CellId");
+          NS_TEST_ASSERT_MSG_EQ (imsi, m_imsi[b], "wrong IMSI");
+          NS_TEST_ASSERT_MSG_EQ (rnti, m_rnti[b], "wrong RNTI");
+          NS_TEST_ASSERT_MSG_EQ (lcid, m_lcid[b], "wrong LCID");
+          NS_TEST_ASSERT_MSG_EQ (txPackets, exp.txPackets, "wrong number of TX PDUs");
+          NS_TEST_ASSERT_MSG_EQ (txBytes, exp.txBytes, "wrong TX bytes");
+          NS_TEST_ASSERT_MSG_EQ (rxPackets, (uint64_t) exp.delay->getCount (), "wrong number of RX PDUs");
+          NS_TEST_ASSERT_MSG_EQ (rxBytes, exp.rxBytes, "wrong RX bytes");
+
+          double reference[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+          if (exp.delay->getCount () > 0)
+            {
+              reference[0] = exp.delay->getMean () * 1e-9;
+              reference[1] = exp.delay->getStddev () * 1e-9;
+              reference[2] = exp.delay->getMin () * 1e-9;
+              reference[3] = exp.delay->getMax () * 1e-9;
+              reference[4] = exp.size->getMean ();
+              reference[5] = exp.size->getStddev ();
+              reference[6] = exp.size->getMin ();
+              reference[7] = exp.size->getMax ();
+            }
+          for (uint32_t v = 0; v < 8; v++)
+            {
+              // the text has 6 significant digits
+              NS_TEST_ASSERT_MSG_EQ_TOL (values[v], reference[v], 1e-5 * std::abs (reference[v]),
+                                         "wrong statistic " << v << " of bearer " << b << " in epoch " << e);
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (std::getline (file, line).good (), false, "unexpected row in " << textFile);
+}
+
+
+class MmWaveBearerStatsTestSuite : public TestSuite
+{
+public:
+  MmWaveBearerStatsTestSuite ();
+};
+
+MmWaveBearerStatsTestSuite::MmWaveBearerStatsTestSuite ()
+  : TestSuite ("mmwave-bearer-stats", UNIT)
+{
+  AddTestCase (new MmWaveBearerStatsAggregationTestCase (true), TestCase::QUICK);
+  AddTestCase (new MmWaveBearerStatsAggregationTestCase (false), TestCase::QUICK);
+}
+
+static MmWaveBearerStatsTestSuite mmWaveBearerStatsTestSuite;
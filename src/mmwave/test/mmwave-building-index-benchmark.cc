@@ -0,0 +1,171 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/building.h"
+#include "ns3/building-list.h"
+#include "ns3/mmwave-building-index.h"
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <ctime>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBuildingIndexBenchmark");
+
+/**
+ * Check that MmWaveBuildingIndex gives the same LOS condition as a linear
+ * scan of the BuildingList, on random links in a random city, and compare
+ * the number of LOS queries per second of the two.
+ */
+class MmWaveBuildingIndexBenchmarkTestCase : public TestCase
+{
+public:
+  MmWaveBuildingIndexBenchmarkTestCase (uint32_t numBuildings);
+  virtual ~MmWaveBuildingIndexBenchmarkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  static bool LinearScan (const Vector &l1, const Vector &l2, bool footprint);
+
+  uint32_t m_numBuildings;
+};
+
+static std::string
+BuildNameString (uint32_t numBuildings)
+{
+  std::ostringstream oss;
+  oss << numBuildings << " buildings";
+  return oss.str ();
+}
+
+MmWaveBuildingIndexBenchmarkTestCase::MmWaveBuildingIndexBenchmarkTestCase (uint32_t numBuildings)
+  : TestCase (BuildNameString (numBuildings)),
+    m_numBuildings (numBuildings)
+{
+}
+
+MmWaveBuildingIndexBenchmarkTestCase::~MmWaveBuildingIndexBenchmarkTestCase ()
+{
+}
+
+bool
+MmWaveBuildingIndexBenchmarkTestCase::LinearScan (const Vector &l1, const Vector &l2, bool footprint)
+{
+  for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+    {
+      if (MmWaveBuildingIndex::IsLineIntersectBox (l1, l2, (*bit)->GetBoundaries (), footprint))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+MmWaveBuildingIndexBenchmarkTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_numBuildings);
+
+  // about 60 m x 60 m of city per building
+  double side = 60 * std::sqrt ((double) m_numBuildings);
+  for (uint32_t i = 0; i < m_numBuildings; i++)
+    {
+      double x = uniform->GetValue (0, side);
+      double y = uniform->GetValue (0, side);
+      Ptr<Building> building = CreateObject<Building> ();
+      building->SetBoundaries (Box (x, x + uniform->GetValue (10, 40),
+                                    y, y + uniform->GetValue (10, 40),
+                                    0, uniform->GetValue (10, 60)));
+    }
+
+  // links between a BS and a UE up to 300 m apart
+  uint32_t numQueries = 20000;
+  std::vector<Vector> l1 (numQueries);
+  std::vector<Vector> l2 (numQueries);
+  for (uint32_t q = 0; q < numQueries; q++)
+    {
+      l1[q] = Vector (uniform->GetValue (0, side), uniform->GetValue (0, side), uniform->GetValue (10, 25));
+      double distance = uniform->GetValue (10, 300);
+      double angle = uniform->GetValue (0, 2 * M_PI);
+      l2[q] = Vector (l1[q].x + distance * std::cos (angle), l1[q].y + distance * std::sin (angle), 1.5);
+    }
+
+  std::vector<bool> expected (numQueries);
+  uint32_t numBlocked = 0;
+  std::clock_t start = std::clock ();
+  for (uint32_t q = 0; q < numQueries; q++)
+    {
+      expected[q] = LinearScan (l1[q], l2[q], false);
+      numBlocked += expected[q];
+    }
+  double linearTime = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+
+  // the first query builds the index
+  MmWaveBuildingIndex::IsLineIntersectBuildings (l1[0], l2[0]);
+  uint32_t repetitions = 20;
+  uint32_t numMismatches = 0;
+  start = std::clock ();
+  for (uint32_t rep = 0; rep < repetitions; rep++)
+    {
+      for (uint32_t q = 0; q < numQueries; q++)
+        {
+          numMismatches += (MmWaveBuildingIndex::IsLineIntersectBuildings (l1[q], l2[q]) != expected[q]);
+        }
+    }
+  double indexTime = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  NS_TEST_ASSERT_MSG_EQ (numMismatches, 0, "different 3D LOS condition");
+
+  for (uint32_t q = 0; q < numQueries; q++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (MmWaveBuildingIndex::IsLineIntersectFootprints (l1[q], l2[q]),
+                             LinearScan (l1[q], l2[q], true), "different 2D LOS condition for link " << q);
+    }
+
+  std::cout << m_numBuildings << " buildings: linear scan " << numQueries / linearTime
+            << " queries/s, index " << repetitions * numQueries / indexTime
+            << " queries/s, " << 100.0 * numBlocked / numQueries << " % NLOS links" << std::endl;
+
+  Simulator::Destroy ();
+}
+
+
+class MmWaveBuildingIndexBenchmarkTestSuite : public TestSuite
+{
+public:
+  MmWaveBuildingIndexBenchmarkTestSuite ();
+};
+
+MmWaveBuildingIndexBenchmarkTestSuite::MmWaveBuildingIndexBenchmarkTestSuite ()
+  : TestSuite ("mmwave-building-index-benchmark", PERFORMANCE)
+{
+  uint32_t numBuildings[] = {100, 1000, 10000};
+  for (uint32_t i = 0; i < sizeof (numBuildings) / sizeof (numBuildings[0]); i++)
+    {
+      AddTestCase (new MmWaveBuildingIndexBenchmarkTestCase (numBuildings[i]), TestCase::QUICK);
+    }
+}
+
+static MmWaveBuildingIndexBenchmarkTestSuite mmWaveBuildingIndexBenchmarkTestSuite;
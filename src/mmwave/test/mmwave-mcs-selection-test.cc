@@ -0,0 +1,150 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/mmwave-mi-error-model.h"
+#include <vector>
+#include <sstream>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveMcsSelectionTest");
+
+/**
+ * Compare MmWaveMiErrorModel::GetMaxMcs with the search that MmWaveAmc used
+ * to run, i.e., GetTbDecodificationStats for MCS 0, 1, ... until the TBLER
+ * is above 10 %, on a corpus of frequency-selective SINRs and TB sizes
+ * (including the small TBs, whose BLER curves are not sorted with the MCS).
+ */
+class MmWaveMcsSelectionTestCase : public TestCase
+{
+public:
+  MmWaveMcsSelectionTestCase (uint32_t numChunk, double meanSinrDb);
+  virtual ~MmWaveMcsSelectionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  static uint8_t ReferenceMcs (const SpectrumValue &sinr, const std::vector<int> &map, uint32_t tbSize);
+
+  uint32_t m_numChunk;
+  double m_meanSinrDb;
+};
+
+static std::string
+BuildNameString (uint32_t numChunk, double meanSinrDb)
+{
+  std::ostringstream oss;
+  oss << numChunk << " chunks, mean SINR " << meanSinrDb << " dB";
+  return oss.str ();
+}
+
+MmWaveMcsSelectionTestCase::MmWaveMcsSelectionTestCase (uint32_t numChunk, double meanSinrDb)
+  : TestCase (BuildNameString (numChunk, meanSinrDb)),
+    m_numChunk (numChunk),
+    m_meanSinrDb (meanSinrDb)
+{
+}
+
+MmWaveMcsSelectionTestCase::~MmWaveMcsSelectionTestCase ()
+{
+}
+
+uint8_t
+MmWaveMcsSelectionTestCase::ReferenceMcs (const SpectrumValue &sinr, const std::vector<int> &map, uint32_t tbSize)
+{
+  uint8_t mcs = 0;
+  while (mcs <= 28)
+    {
+      MmWaveHarqProcessInfoList_t harqInfoList;
+      MmWaveTbStats_t tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, map, tbSize, mcs, harqInfoList);
+      if (tbStats.tbler > 0.1)
+        {
+          break;
+        }
+      mcs++;
+    }
+  if (mcs > 0)
+    {
+      mcs--;
+    }
+  return mcs;
+}
+
+void
+MmWaveMcsSelectionTestCase::DoRun (void)
+{
+  std::vector<double> freqs;
+  std::vector<int> map;
+  for (uint32_t i = 0; i < m_numChunk; i++)
+    {
+      freqs.push_back (28e9 + i * 13.89e6);
+      map.push_back (i);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_numChunk * 100 + (int64_t) (m_meanSinrDb + 20));
+  Ptr<ExponentialRandomVariable> fading = CreateObject<ExponentialRandomVariable> ();
+  fading->SetStream (m_numChunk * 100 + (int64_t) (m_meanSinrDb + 20) + 50000);
+
+  uint32_t tbSizes[] = {1, 3, 5, 7, 10, 13, 20, 40, 100, 333, 767, 1000, 3000, 6000, 12000, 50000};
+  for (uint32_t rep = 0; rep < 20; rep++)
+    {
+      SpectrumValue sinr (model);
+      double meanSinr = std::pow (10, (m_meanSinrDb + uniform->GetValue (-2, 2)) / 10);
+      for (uint32_t i = 0; i < m_numChunk; i++)
+        {
+          // Rayleigh fading on half of the realizations, flat on the others
+          sinr[i] = rep % 2 ? meanSinr * fading->GetValue () : meanSinr;
+        }
+      for (uint32_t j = 0; j < sizeof (tbSizes) / sizeof (tbSizes[0]); j++)
+        {
+          uint8_t expected = ReferenceMcs (sinr, map, tbSizes[j]);
+          uint8_t mcs = MmWaveMiErrorModel::GetMaxMcs (sinr, map, tbSizes[j], 0.1);
+          NS_TEST_ASSERT_MSG_EQ ((uint16_t) mcs, (uint16_t) expected,
+                                 "different MCS for TB size " << tbSizes[j] << " realization " << rep);
+        }
+    }
+}
+
+
+class MmWaveMcsSelectionTestSuite : public TestSuite
+{
+public:
+  MmWaveMcsSelectionTestSuite ();
+};
+
+MmWaveMcsSelectionTestSuite::MmWaveMcsSelectionTestSuite ()
+  : TestSuite ("mmwave-mcs-selection", UNIT)
+{
+  uint32_t numChunks[] = {4, 72};
+  for (uint32_t i = 0; i < sizeof (numChunks) / sizeof (numChunks[0]); i++)
+    {
+      for (double sinrDb = -15; sinrDb <= 35; sinrDb += 5)
+        {
+          AddTestCase (new MmWaveMcsSelectionTestCase (numChunks[i], sinrDb), TestCase::QUICK);
+        }
+    }
+}
+
+static MmWaveMcsSelectionTestSuite mmWaveMcsSelectionTestSuite;
@@ -0,0 +1,143 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2015, NYU WIRELESS, Tandon School of Engineering, New York University
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/mmwave-mi-error-model.h"
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveMiBatchBenchmark");
+
+/**
+ * Check that MmWaveMiErrorModel::MibBatch returns the same mmib as Mib for
+ * the three modulations, and compare the number of chunks per second
+ * processed by three calls to Mib and by one call to MibBatch.
+ */
+class MmWaveMiBatchBenchmarkTestCase : public TestCase
+{
+public:
+  MmWaveMiBatchBenchmarkTestCase (uint32_t numChunk);
+  virtual ~MmWaveMiBatchBenchmarkTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_numChunk;
+};
+
+static std::string
+BuildNameString (uint32_t numChunk)
+{
+  std::ostringstream oss;
+  oss << numChunk << " chunks";
+  return oss.str ();
+}
+
+MmWaveMiBatchBenchmarkTestCase::MmWaveMiBatchBenchmarkTestCase (uint32_t numChunk)
+  : TestCase (BuildNameString (numChunk)),
+    m_numChunk (numChunk)
+{
+}
+
+MmWaveMiBatchBenchmarkTestCase::~MmWaveMiBatchBenchmarkTestCase ()
+{
+}
+
+void
+MmWaveMiBatchBenchmarkTestCase::DoRun (void)
+{
+  std::vector<double> freqs;
+  std::vector<int> map;
+  for (uint32_t i = 0; i < m_numChunk; i++)
+    {
+      freqs.push_back (28e9 + i * 13.89e6);
+      map.push_back (i);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+
+  Ptr<UniformRandomVariable> sinrDb = CreateObject<UniformRandomVariable> ();
+  sinrDb->SetStream (m_numChunk);
+  SpectrumValue sinr (model);
+  for (uint32_t i = 0; i < m_numChunk; i++)
+    {
+      sinr[i] = std::pow (10, sinrDb->GetValue (-20, 40) / 10);
+    }
+  const double *sinrArray = &(*sinr.ConstValuesBegin ());
+  uint8_t mcsPerModulation[3] = {0, 10, 17};
+
+  double mi[3];
+  MmWaveMiErrorModel::MibBatch (sinrArray, map, mi);
+  for (uint8_t mod = 0; mod < 3; mod++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (mi[mod], MmWaveMiErrorModel::Mib (sinr, map, mcsPerModulation[mod]),
+                             "different mmib for MCS " << (uint16_t) mcsPerModulation[mod]);
+    }
+
+  uint32_t iterations = 20000000 / m_numChunk;
+  double check = 0;
+  std::clock_t start = std::clock ();
+  for (uint32_t it = 0; it < iterations; it++)
+    {
+      for (uint8_t mod = 0; mod < 3; mod++)
+        {
+          check += MmWaveMiErrorModel::Mib (sinr, map, mcsPerModulation[mod]);
+        }
+    }
+  double singleTime = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+
+  start = std::clock ();
+  for (uint32_t it = 0; it < iterations; it++)
+    {
+      MmWaveMiErrorModel::MibBatch (sinrArray, map, mi);
+      check -= mi[0] + mi[1] + mi[2];
+    }
+  double batchTime = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  NS_TEST_ASSERT_MSG_EQ_TOL (check, 0, 1e-6 * iterations, "different mmib in the timed loops");
+
+  double chunks = (double) iterations * m_numChunk;
+  std::cout << m_numChunk << " chunks: Mib " << chunks / singleTime
+            << " chunks/s, MibBatch " << chunks / batchTime
+            << " chunks/s, speedup " << singleTime / batchTime << std::endl;
+}
+
+
+class MmWaveMiBatchBenchmarkTestSuite : public TestSuite
+{
+public:
+  MmWaveMiBatchBenchmarkTestSuite ();
+};
+
+MmWaveMiBatchBenchmarkTestSuite::MmWaveMiBatchBenchmarkTestSuite ()
+  : TestSuite ("mmwave-mi-batch-benchmark", PERFORMANCE)
+{
+  uint32_t numChunks[] = {72, 1024, 3300};
+  for (uint32_t i = 0; i < sizeof (numChunks) / sizeof (numChunks[0]); i++)
+    {
+      AddTestCase (new MmWaveMiBatchBenchmarkTestCase (numChunks[i]), TestCase::QUICK);
+    }
+}
+
+static MmWaveMiBatchBenchmarkTestSuite mmWaveMiBatchBenchmarkTestSuite;
@@ -0,0 +1,173 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mmwave-3gpp-channel.h"
+#include "ns3/mmwave-thread-pool.h"
+#include <complex>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveParallelRxPsdBenchmark");
+
+/**
+ * Apply the BF gains of the links of a transmission to their PSDs with
+ * MmWaveThreadPool, as MmWaveSpectrumChannel does when NumThreads is larger
+ * than 1, with 1 to 32 threads. Check that the PSDs are the same, bit by bit,
+ * as those computed one by one in this thread, and print the number of links
+ * per second. The time is the wall-clock time, since the CPU time of all the
+ * threads would not show the speedup.
+ */
+class MmWaveParallelRxPsdBenchmarkTestCase : public TestCase
+{
+public:
+  MmWaveParallelRxPsdBenchmarkTestCase (uint32_t numLinks, uint32_t numCluster);
+  virtual ~MmWaveParallelRxPsdBenchmarkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void ApplyJob (uint32_t index);
+
+  uint32_t m_numLinks;
+  uint32_t m_numCluster;
+  uint32_t m_numBands;
+  Ptr<MmWave3gppChannel> m_channel;
+  std::vector<MmWave3gppChannel::BeamformingGainJob> m_jobs;
+  std::vector<std::vector<double> > m_psds;
+};
+
+static std::string
+BuildNameString (uint32_t numLinks, uint32_t numCluster)
+{
+  std::ostringstream oss;
+  oss << numLinks << " links, " << numCluster << " clusters";
+  return oss.str ();
+}
+
+MmWaveParallelRxPsdBenchmarkTestCase::MmWaveParallelRxPsdBenchmarkTestCase (uint32_t numLinks, uint32_t numCluster)
+  : TestCase (BuildNameString (numLinks, numCluster)),
+    m_numLinks (numLinks),
+    m_numCluster (numCluster),
+    m_numBands (0)
+{
+}
+
+MmWaveParallelRxPsdBenchmarkTestCase::~MmWaveParallelRxPsdBenchmarkTestCase ()
+{
+}
+
+void
+MmWaveParallelRxPsdBenchmarkTestCase::ApplyJob (uint32_t index)
+{
+  m_channel->ApplyBeamformingGain (m_jobs[index], &m_psds[index][0], m_numBands);
+}
+
+void
+MmWaveParallelRxPsdBenchmarkTestCase::DoRun (void)
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  m_channel = CreateObject<MmWave3gppChannel> ();
+  m_channel->SetConfigurationParameters (config);
+  m_numBands = config->GetNumRb () * config->GetNumChunkPerRb ();
+  double bandwidth = config->GetChunkWidth () * m_numBands;
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_numLinks);
+  std::vector<double> txPsd;
+  for (uint32_t b = 0; b < m_numBands; b++)
+    {
+      txPsd.push_back (uniform->GetValue (1e-12, 1e-9));
+    }
+  m_jobs.resize (m_numLinks);
+  for (uint32_t link = 0; link < m_numLinks; link++)
+    {
+      MmWave3gppChannel::BeamformingGainJob &job = m_jobs[link];
+      job.m_params = Create<Params3gpp> ();
+      for (uint32_t c = 0; c < m_numCluster; c++)
+        {
+          double amplitude = std::pow (10, -uniform->GetValue (0, 4));
+          job.m_clusterGain.push_back (std::polar (amplitude, uniform->GetValue (0, 2 * M_PI)));
+          job.m_params->m_delay.push_back (uniform->GetValue (0, 1e-6));
+        }
+      job.m_f0 = config->GetCenterFrequency () - bandwidth / 2;
+      job.m_df = config->GetChunkWidth ();
+      job.m_reverseLink = false;
+    }
+
+  // the received PSDs computed one by one
+  std::vector<std::vector<double> > expected (m_numLinks, txPsd);
+  for (uint32_t link = 0; link < m_numLinks; link++)
+    {
+      m_channel->ApplyBeamformingGain (m_jobs[link], &expected[link][0], m_numBands);
+    }
+
+  uint32_t numTransmissions = 500;
+  double sequentialRate = 0;
+  for (uint32_t numThreads = 1; numThreads <= 32; numThreads *= 2)
+    {
+      Ptr<MmWaveThreadPool> pool = Create<MmWaveThreadPool> (numThreads);
+      Callback<void, uint32_t> task = MakeCallback (&MmWaveParallelRxPsdBenchmarkTestCase::ApplyJob, this);
+      uint32_t numMismatches = 0;
+      SystemWallClockMs clock;
+      clock.Start ();
+      for (uint32_t tx = 0; tx < numTransmissions; tx++)
+        {
+          m_psds.assign (m_numLinks, txPsd);
+          pool->Run (m_numLinks, task);
+          numMismatches += (m_psds != expected);
+        }
+      int64_t elapsedMs = clock.End ();
+      NS_TEST_ASSERT_MSG_EQ (numMismatches, 0, "different PSDs with " << numThreads << " threads");
+
+      double rate = 1000.0 * numTransmissions * m_numLinks / std::max (elapsedMs, (int64_t) 1);
+      if (numThreads == 1)
+        {
+          sequentialRate = rate;
+        }
+      std::cout << m_numLinks << " links, " << m_numCluster << " clusters, " << m_numBands << " subbands, "
+                << pool->GetNumThreads () << " threads: " << rate << " links/s, speedup "
+                << rate / sequentialRate << std::endl;
+    }
+  m_jobs.clear ();
+  m_psds.clear ();
+  m_channel->Dispose ();
+  m_channel = 0;
+}
+
+
+class MmWaveParallelRxPsdBenchmarkTestSuite : public TestSuite
+{
+public:
+  MmWaveParallelRxPsdBenchmarkTestSuite ();
+};
+
+MmWaveParallelRxPsdBenchmarkTestSuite::MmWaveParallelRxPsdBenchmarkTestSuite ()
+  : TestSuite ("mmwave-parallel-rx-psd-benchmark", PERFORMANCE)
+{
+  AddTestCase (new MmWaveParallelRxPsdBenchmarkTestCase (64, 20), TestCase::QUICK);
+}
+
+static MmWaveParallelRxPsdBenchmarkTestSuite mmWaveParallelRxPsdBenchmarkTestSuite;
@@ -0,0 +1,288 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/mmwave-phy-rx-trace.h"
+#include "ns3/mmwave-trace-writer.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveRxPacketTraceTest");
+
+static std::string
+ReadFile (std::string filename)
+{
+  std::ifstream file (filename.c_str (), std::ifstream::in | std::ifstream::binary);
+  std::ostringstream content;
+  content << file.rdbuf ();
+  return content.str ();
+}
+
+/**
+ * Check that the data written through MmWaveTraceWriter, in chunks smaller
+ * and larger than its buffers, is in the file in the same order
+ */
+class MmWaveTraceWriterTestCase : public TestCase
+{
+public:
+  MmWaveTraceWriterTestCase (uint32_t bufferSize);
+  virtual ~MmWaveTraceWriterTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_bufferSize;
+};
+
+static std::string
+BuildNameString (uint32_t bufferSize)
+{
+  std::ostringstream oss;
+  oss << "writer with buffers of " << bufferSize << " bytes";
+  return oss.str ();
+}
+
+MmWaveTraceWriterTestCase::MmWaveTraceWriterTestCase (uint32_t bufferSize)
+  : TestCase (BuildNameString (bufferSize)),
+    m_bufferSize (bufferSize)
+{
+}
+
+MmWaveTraceWriterTestCase::~MmWaveTraceWriterTestCase ()
+{
+}
+
+void
+MmWaveTraceWriterTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_bufferSize);
+  std::string filename = CreateTempDirFilename ("writer.bin");
+  Ptr<MmWaveTraceWriter> writer = Create<MmWaveTraceWriter> (filename, m_bufferSize);
+  std::string expected;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      std::string chunk (uniform->GetInteger (0, 3 * m_bufferSize), 'a' + i % 26);
+      writer->Write (chunk.data (), chunk.size ());
+      expected += chunk;
+    }
+  writer->Close ();
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (filename) == expected), true, "different content of " << filename);
+}
+
+
+/**
+ * Create 5000 random TBs, the first one DL or UL
+ */
+static void
+CreateTbs (Ptr<UniformRandomVariable> uniform, bool firstDownlink,
+           std::vector<RxPacketTraceParams> &tbs, std::vector<bool> &downlink)
+{
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      RxPacketTraceParams params;
+      params.m_cellId = uniform->GetInteger (1, 20);
+      params.m_rnti = uniform->GetInteger (1, 1000);
+      params.m_frameNum = uniform->GetInteger (0, 100000);
+      params.m_sfNum = uniform->GetInteger (0, 9);
+      params.m_slotNum = uniform->GetInteger (0, 7);
+      params.m_symStart = uniform->GetInteger (0, 23);
+      params.m_numSym = uniform->GetInteger (1, 24);
+      params.m_tbSize = uniform->GetInteger (0, 100000);
+      params.m_mcs = uniform->GetInteger (0, 28);
+      params.m_rv = uniform->GetInteger (0, 3);
+      params.m_sinr = std::pow (10, uniform->GetValue (-3, 4));
+      params.m_sinrMin = params.m_sinr;
+      params.m_tbler = uniform->GetValue (0, 1);
+      params.m_corrupt = (params.m_tbler > 0.9);
+      tbs.push_back (params);
+      downlink.push_back (i == 0 ? firstDownlink : uniform->GetValue () < 0.5);
+    }
+}
+
+/**
+ * Pass the TBs from first to last, excluded, to the RxPacketTrace callbacks
+ */
+static void
+WriteTbs (Ptr<MmWavePhyRxTrace> phyStats, const std::vector<RxPacketTraceParams> &tbs,
+          const std::vector<bool> &downlink, uint32_t first, uint32_t last)
+{
+  for (uint32_t i = first; i < last; i++)
+    {
+      if (downlink[i])
+        {
+          MmWavePhyRxTrace::RxPacketTraceUeCallback (phyStats, "", tbs[i]);
+        }
+      else
+        {
+          MmWavePhyRxTrace::RxPacketTraceEnbCallback (phyStats, "", tbs[i]);
+        }
+    }
+}
+
+/**
+ * Write random TBs to the RxPacketTrace file, in the text and in the binary
+ * format, and check that the binary file is converted to the same text
+ */
+class MmWaveRxPacketTraceTestCase : public TestCase
+{
+public:
+  MmWaveRxPacketTraceTestCase (bool firstDownlink);
+  virtual ~MmWaveRxPacketTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void WriteTrace (MmWavePhyRxTrace::OutputFormat_t format, std::string filename,
+                   const std::vector<RxPacketTraceParams> &tbs, const std::vector<bool> &downlink);
+
+  bool m_firstDownlink;
+};
+
+MmWaveRxPacketTraceTestCase::MmWaveRxPacketTraceTestCase (bool firstDownlink)
+  : TestCase (firstDownlink ? "trace opened by a DL TB" : "trace opened by an UL TB"),
+    m_firstDownlink (firstDownlink)
+{
+}
+
+MmWaveRxPacketTraceTestCase::~MmWaveRxPacketTraceTestCase ()
+{
+}
+
+void
+MmWaveRxPacketTraceTestCase::WriteTrace (MmWavePhyRxTrace::OutputFormat_t format, std::string filename,
+                                         const std::vector<RxPacketTraceParams> &tbs, const std::vector<bool> &downlink)
+{
+  Ptr<MmWavePhyRxTrace> phyStats = CreateObject<MmWavePhyRxTrace> ();
+  phyStats->SetAttribute ("OutputFormat", EnumValue (format));
+  phyStats->SetAttribute ("OutputFilename", StringValue (filename));
+  WriteTbs (phyStats, tbs, downlink, 0, tbs.size ());
+  MmWavePhyRxTrace::CloseRxPacketTraceFile ();
+}
+
+void
+MmWaveRxPacketTraceTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_firstDownlink);
+  std::vector<RxPacketTraceParams> tbs;
+  std::vector<bool> downlink;
+  CreateTbs (uniform, m_firstDownlink, tbs, downlink);
+
+  // the process appends to the files it already wrote
+  std::string prefix = m_firstDownlink ? "Dl" : "Ul";
+  std::string textFile = CreateTempDirFilename (prefix + "RxPacketTrace.txt");
+  std::string binaryFile = CreateTempDirFilename (prefix + "RxPacketTrace.bin");
+  std::string convertedFile = CreateTempDirFilename (prefix + "RxPacketTraceConverted.txt");
+  WriteTrace (MmWavePhyRxTrace::TEXT, textFile, tbs, downlink);
+  WriteTrace (MmWavePhyRxTrace::BINARY, binaryFile, tbs, downlink);
+  NS_TEST_ASSERT_MSG_EQ (MmWavePhyRxTrace::ConvertRxPacketTrace (binaryFile, convertedFile), tbs.size (), "wrong number of TBs");
+
+  std::string text = ReadFile (textFile);
+  NS_TEST_ASSERT_MSG_EQ (text.empty (), false, "cannot read " << textFile);
+  NS_TEST_ASSERT_MSG_EQ ((text.compare (0, 3, "DL\t") == 0), m_firstDownlink, "the column names are written only with an UL TB first");
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (convertedFile) == text), true, "the converted file differs from " << textFile);
+}
+
+
+/**
+ * Write TBs to the RxPacketTrace file in two simulations, one after the
+ * other, and check that the file is the same as if they were written by a
+ * single simulation, i.e., that Simulator::Destroy closes the file and the
+ * second simulation appends to it, without a second header
+ */
+class MmWaveRxPacketTraceReopenTestCase : public TestCase
+{
+public:
+  MmWaveRxPacketTraceReopenTestCase (MmWavePhyRxTrace::OutputFormat_t format);
+  virtual ~MmWaveRxPacketTraceReopenTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  MmWavePhyRxTrace::OutputFormat_t m_format;
+};
+
+MmWaveRxPacketTraceReopenTestCase::MmWaveRxPacketTraceReopenTestCase (MmWavePhyRxTrace::OutputFormat_t format)
+  : TestCase (format == MmWavePhyRxTrace::TEXT ? "text trace written by two simulations" : "binary trace written by two simulations"),
+    m_format (format)
+{
+}
+
+MmWaveRxPacketTraceReopenTestCase::~MmWaveRxPacketTraceReopenTestCase ()
+{
+}
+
+void
+MmWaveRxPacketTraceReopenTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (2 + m_format);
+  std::vector<RxPacketTraceParams> tbs;
+  std::vector<bool> downlink;
+  CreateTbs (uniform, false, tbs, downlink);
+
+  std::string suffix = (m_format == MmWavePhyRxTrace::TEXT) ? ".txt" : ".bin";
+  std::string singleFile = CreateTempDirFilename ("SingleRxPacketTrace" + suffix);
+  std::string reopenedFile = CreateTempDirFilename ("ReopenedRxPacketTrace" + suffix);
+  Ptr<MmWavePhyRxTrace> phyStats = CreateObject<MmWavePhyRxTrace> ();
+  phyStats->SetAttribute ("OutputFormat", EnumValue (m_format));
+
+  phyStats->SetAttribute ("OutputFilename", StringValue (singleFile));
+  WriteTbs (phyStats, tbs, downlink, 0, tbs.size ());
+  Simulator::Destroy ();
+
+  phyStats->SetAttribute ("OutputFilename", StringValue (reopenedFile));
+  WriteTbs (phyStats, tbs, downlink, 0, tbs.size () / 2);
+  Simulator::Destroy ();
+  WriteTbs (phyStats, tbs, downlink, tbs.size () / 2, tbs.size ());
+  Simulator::Destroy ();
+
+  std::string single = ReadFile (singleFile);
+  NS_TEST_ASSERT_MSG_EQ (single.empty (), false, "cannot read " << singleFile);
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (reopenedFile) == single), true, reopenedFile << " differs from " << singleFile);
+}
+
+
+class MmWaveRxPacketTraceTestSuite : public TestSuite
+{
+public:
+  MmWaveRxPacketTraceTestSuite ();
+};
+
+MmWaveRxPacketTraceTestSuite::MmWaveRxPacketTraceTestSuite ()
+  : TestSuite ("mmwave-rx-packet-trace", UNIT)
+{
+  AddTestCase (new MmWaveTraceWriterTestCase (1), TestCase::QUICK);
+  AddTestCase (new MmWaveTraceWriterTestCase (100), TestCase::QUICK);
+  AddTestCase (new MmWaveRxPacketTraceTestCase (true), TestCase::QUICK);
+  AddTestCase (new MmWaveRxPacketTraceTestCase (false), TestCase::QUICK);
+  AddTestCase (new MmWaveRxPacketTraceReopenTestCase (MmWavePhyRxTrace::TEXT), TestCase::QUICK);
+  AddTestCase (new MmWaveRxPacketTraceReopenTestCase (MmWavePhyRxTrace::BINARY), TestCase::QUICK);
+}
+
+static MmWaveRxPacketTraceTestSuite mmWaveRxPacketTraceTestSuite;
@@ -0,0 +1,305 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/spectrum-phy.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/constant-spectrum-propagation-loss.h"
+#include "ns3/mmwave-helper.h"
+#include "ns3/mmwave-enb-net-device.h"
+#include "ns3/mmwave-ue-net-device.h"
+#include "ns3/antenna-array-model.h"
+#include "ns3/mmwave-3gpp-channel.h"
+#include "ns3/mmwave-spectrum-channel.h"
+#include "ns3/mmwave-spectrum-value-helper.h"
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumChannelTest");
+
+/**
+ * A SpectrumPhy on the node of a mmWave device, which records the PSDs it
+ * receives
+ */
+class MmWaveRxPsdProbe : public SpectrumPhy
+{
+public:
+  MmWaveRxPsdProbe (Ptr<NetDevice> device, Ptr<const SpectrumModel> model)
+    : m_device (device),
+      m_mobility (device->GetNode ()->GetObject<MobilityModel> ()),
+      m_model (model)
+  {
+  }
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+    m_device = d;
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return m_device;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+    m_mobility = m;
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return m_mobility;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return m_model;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    m_rxPsds.push_back (std::vector<double> (params->psd->ConstValuesBegin (), params->psd->ConstValuesEnd ()));
+  }
+  virtual void DoDispose ()
+  {
+    m_device = 0;
+    m_mobility = 0;
+    m_model = 0;
+    SpectrumPhy::DoDispose ();
+  }
+
+  std::vector<std::vector<double> > m_rxPsds;
+
+private:
+  Ptr<NetDevice> m_device;
+  Ptr<MobilityModel> m_mobility;
+  Ptr<const SpectrumModel> m_model;
+};
+
+/**
+ * Transmit from each gNB and UE on a MmWaveSpectrumChannel with 1 thread and
+ * on one with 4 threads, which share a MmWave3gppChannel, and check that the
+ * PSDs received are the same, bit by bit. The UE to UE links are not
+ * beamformed, thus their jobs are dropped in the middle of the others. The
+ * same is checked for a MmWave3gppChannel with a model chained to it, which
+ * is applied only by the sequential computation.
+ */
+class MmWaveParallelRxPsdTestCase : public TestCase
+{
+public:
+  MmWaveParallelRxPsdTestCase ();
+  virtual ~MmWaveParallelRxPsdTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Transmit (uint32_t beam);
+  Ptr<MmWaveSpectrumChannel> CreateChannel (uint32_t numThreads, Ptr<MmWave3gppChannel> channel);
+  void CheckRxPsds (uint32_t first, uint32_t second, std::string name);
+
+  NetDeviceContainer m_enbDevs;
+  NetDeviceContainer m_ueDevs;
+  Ptr<const SpectrumValue> m_txPsd;
+  std::vector<Ptr<MmWaveSpectrumChannel> > m_channels;
+  std::vector<std::vector<Ptr<MmWaveRxPsdProbe> > > m_probes;
+};
+
+MmWaveParallelRxPsdTestCase::MmWaveParallelRxPsdTestCase ()
+  : TestCase ("received PSDs with 1 and 4 threads")
+{
+}
+
+MmWaveParallelRxPsdTestCase::~MmWaveParallelRxPsdTestCase ()
+{
+}
+
+Ptr<MmWaveSpectrumChannel>
+MmWaveParallelRxPsdTestCase::CreateChannel (uint32_t numThreads, Ptr<MmWave3gppChannel> channel)
+{
+  Ptr<MmWaveSpectrumChannel> spectrumChannel = CreateObject<MmWaveSpectrumChannel> ();
+  spectrumChannel->SetAttribute ("NumThreads", UintegerValue (numThreads));
+  spectrumChannel->AddSpectrumPropagationLossModel (channel);
+  std::vector<Ptr<MmWaveRxPsdProbe> > probes;
+  NetDeviceContainer devs (m_enbDevs, m_ueDevs);
+  for (uint32_t i = 0; i < devs.GetN (); i++)
+    {
+      Ptr<MmWaveRxPsdProbe> probe = CreateObject<MmWaveRxPsdProbe> (devs.Get (i), m_txPsd->GetSpectrumModel ());
+      spectrumChannel->AddRx (probe);
+      probes.push_back (probe);
+    }
+  m_channels.push_back (spectrumChannel);
+  m_probes.push_back (probes);
+  return spectrumChannel;
+}
+
+void
+MmWaveParallelRxPsdTestCase::Transmit (uint32_t beam)
+{
+  // the PHYs switch the antennas to omni for the control symbols
+  for (uint32_t i = 0; i < m_enbDevs.GetN (); i++)
+    {
+      Ptr<MmWaveEnbNetDevice> enbDev = DynamicCast<MmWaveEnbNetDevice> (m_enbDevs.Get (i));
+      DynamicCast<AntennaArrayModel> (enbDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ())
+        ->ChangeBeamformingVector (m_ueDevs.Get ((i + beam) % m_ueDevs.GetN ()));
+    }
+  for (uint32_t i = 0; i < m_ueDevs.GetN (); i++)
+    {
+      Ptr<MmWaveUeNetDevice> ueDev = DynamicCast<MmWaveUeNetDevice> (m_ueDevs.Get (i));
+      DynamicCast<AntennaArrayModel> (ueDev->GetPhy ()->GetDlSpectrumPhy ()->GetRxAntenna ())
+        ->ChangeBeamformingVector (ueDev->GetTargetEnb ());
+    }
+
+  // the channels which share a MmWave3gppChannel transmit one after the other,
+  // the first one generates or updates the channel matrices and the other
+  // ones use them
+  for (uint32_t node = 0; node < m_enbDevs.GetN () + m_ueDevs.GetN (); node++)
+    {
+      for (uint32_t ch = 0; ch < m_channels.size (); ch++)
+        {
+          Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+          params->duration = MicroSeconds (100);
+          params->psd = m_txPsd->Copy ();
+          params->txPhy = m_probes[ch][node];
+          m_channels[ch]->StartTx (params);
+        }
+    }
+}
+
+void
+MmWaveParallelRxPsdTestCase::CheckRxPsds (uint32_t first, uint32_t second, std::string name)
+{
+  for (uint32_t node = 0; node < m_probes[first].size (); node++)
+    {
+      const std::vector<std::vector<double> > &expected = m_probes[first][node]->m_rxPsds;
+      const std::vector<std::vector<double> > &rxPsds = m_probes[second][node]->m_rxPsds;
+      NS_TEST_ASSERT_MSG_EQ (rxPsds.size (), expected.size (), name << ": wrong number of PSDs received by node " << node);
+      NS_TEST_ASSERT_MSG_GT (expected.size (), 0, name << ": no PSD received by node " << node);
+      for (uint32_t i = 0; i < std::min (rxPsds.size (), expected.size ()); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((rxPsds[i] == expected[i]), true, name << ": different PSD " << i << " received by node " << node);
+        }
+    }
+}
+
+void
+MmWaveParallelRxPsdTestCase::DoRun (void)
+{
+  Ptr<MmWaveHelper> mmwaveHelper = CreateObject<MmWaveHelper> ();
+  mmwaveHelper->Initialize ();
+  mmwaveHelper->GetPathLossModel ()->SetAttribute ("Scenario", StringValue ("UMi-StreetCanyon"));
+
+  NodeContainer enbNodes;
+  NodeContainer ueNodes;
+  enbNodes.Create (2);
+  ueNodes.Create (4);
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0, 0, 10));
+  positionAlloc->Add (Vector (120, 0, 10));
+  positionAlloc->Add (Vector (30, 20, 1.5));
+  positionAlloc->Add (Vector (20, -40, 1.5));
+  positionAlloc->Add (Vector (100, 30, 1.5));
+  positionAlloc->Add (Vector (150, -10, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (enbNodes);
+  mobility.Install (ueNodes);
+  m_enbDevs = mmwaveHelper->InstallEnbDevice (enbNodes);
+  m_ueDevs = mmwaveHelper->InstallUeDevice (ueNodes);
+  mmwaveHelper->AttachToClosestEnb (m_ueDevs, m_enbDevs);
+
+  Ptr<MmWavePhyMacCommon> config = mmwaveHelper->GetPhyMacConfigurable ();
+  std::vector<int> subChannels;
+  for (uint32_t i = 0; i < config->GetTotalNumChunk (); ++i)
+    {
+      subChannels.push_back (i);
+    }
+  m_txPsd = MmWaveSpectrumValueHelper::CreateTxPowerSpectralDensity (config, 30, subChannels);
+
+  std::vector<Ptr<MmWave3gppChannel> > channels;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<MmWave3gppChannel> channel = CreateObject<MmWave3gppChannel> ();
+      channel->SetAttribute ("UpdatePeriod", TimeValue (MilliSeconds (1)));
+      channel->SetConfigurationParameters (config);
+      channel->SetPathlossModel (mmwaveHelper->GetPathLossModel ());
+      channel->Initial (m_ueDevs, m_enbDevs);
+      CreateChannel (1, channel);
+      CreateChannel (4, channel);
+      channels.push_back (channel);
+    }
+  // chained after it is added to the MmWaveSpectrumChannels, which reset the next model
+  Ptr<ConstantSpectrumPropagationLossModel> loss = CreateObject<ConstantSpectrumPropagationLossModel> ();
+  loss->SetAttribute ("Loss", DoubleValue (10));
+  channels[1]->SetNext (loss);
+
+  // also at the refresh time of the channel matrices
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Simulator::Schedule (MicroSeconds (500 * (i + 1)), &MmWaveParallelRxPsdTestCase::Transmit, this, i);
+    }
+  Simulator::Stop (MilliSeconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  CheckRxPsds (0, 1, "MmWave3gppChannel");
+  CheckRxPsds (2, 3, "chained MmWave3gppChannel");
+
+  for (uint32_t ch = 0; ch < m_channels.size (); ch++)
+    {
+      for (uint32_t node = 0; node < m_probes[ch].size (); node++)
+        {
+          m_probes[ch][node]->Dispose ();
+        }
+      m_channels[ch]->Dispose ();
+    }
+  for (uint32_t i = 0; i < channels.size (); i++)
+    {
+      channels[i]->Dispose ();
+    }
+  m_channels.clear ();
+  m_probes.clear ();
+  m_enbDevs = NetDeviceContainer ();
+  m_ueDevs = NetDeviceContainer ();
+  m_txPsd = 0;
+}
+
+
+class MmWaveSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MmWaveSpectrumChannelTestSuite ();
+};
+
+MmWaveSpectrumChannelTestSuite::MmWaveSpectrumChannelTestSuite ()
+  : TestSuite ("mmwave-spectrum-channel", UNIT)
+{
+  AddTestCase (new MmWaveParallelRxPsdTestCase (), TestCase::QUICK);
+}
+
+static MmWaveSpectrumChannelTestSuite mmWaveSpectrumChannelTestSuite;
@@ -0,0 +1,441 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <iostream>
+#include <ctime>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSymbolMaskTest");
+
+/**
+ * The symbol by symbol scans on a std::vector<bool> which the IAB
+ * schedulers used before SymbolAllocationMask
+ */
+class LegacySymbolMask
+{
+public:
+  LegacySymbolMask (uint32_t numSymbols)
+    : m_mask (numSymbols, false)
+  {
+  }
+  uint32_t GetSize () const
+  {
+    return m_mask.size ();
+  }
+  void SetBusy (uint32_t start, uint32_t numSymbols)
+  {
+    for (uint32_t index = start; index < start + numSymbols; ++index)
+      {
+        m_mask.at (index) = true;
+      }
+  }
+  bool IsBusy (uint32_t symbol) const
+  {
+    return m_mask.at (symbol);
+  }
+  bool IsAnyBusy (uint32_t start, uint32_t numSymbols) const
+  {
+    for (uint32_t index = start; index < std::min (start + numSymbols, GetSize ()); ++index)
+      {
+        if (m_mask.at (index))
+          {
+            return true;
+          }
+      }
+    return false;
+  }
+  uint32_t GetNumBusy () const
+  {
+    return std::count (m_mask.begin (), m_mask.end (), true);
+  }
+  uint32_t GetFirstBusy (uint32_t start) const
+  {
+    uint32_t index;
+    for (index = start; index < GetSize () && !m_mask.at (index); ++index)
+      {
+      }
+    return index;
+  }
+  uint32_t GetFreeRunLength (uint32_t start, uint32_t maxLength) const
+  {
+    uint32_t numFree = 0;
+    for (uint32_t index = start; index < std::min (start + maxLength, GetSize ()) && !m_mask.at (index); ++index)
+      {
+        numFree++;
+      }
+    return numFree;
+  }
+  uint32_t GetFirstFree (uint32_t start) const
+  {
+    uint32_t index;
+    for (index = start; index < GetSize () && m_mask.at (index); ++index)
+      {
+      }
+    return index;
+  }
+  uint32_t FindFreeRun (uint32_t start, uint32_t length) const
+  {
+    for (uint32_t index = start; index + length <= GetSize (); ++index)
+      {
+        if (GetFreeRunLength (index, length) == length)
+          {
+            return index;
+          }
+      }
+    return GetSize ();
+  }
+
+private:
+  std::vector<bool> m_mask;
+};
+
+/**
+ * The demand of a UE in a subframe
+ */
+struct UeDemand
+{
+  uint32_t m_numSym;
+  bool m_retx;
+};
+
+/**
+ * Mark the symbols of the IAB backhaul as busy and allocate the UEs as
+ * MmWaveFlexTtiMacScheduler does: the retransmissions need a single run of
+ * free symbols, the new transmissions are split around the busy symbols.
+ * Returns the (start, length) of each allocated chunk.
+ */
+template <class Mask>
+static std::vector<uint32_t>
+ScheduleSubframe (Mask &mask, const std::vector<std::pair<uint32_t, uint32_t> > &backhaul,
+                  const std::vector<UeDemand> &demands)
+{
+  std::vector<uint32_t> allocations;
+  for (uint32_t i = 0; i < backhaul.size (); i++)
+    {
+      if (!mask.IsAnyBusy (backhaul[i].first, backhaul[i].second))
+        {
+          mask.SetBusy (backhaul[i].first, backhaul[i].second);
+        }
+    }
+  uint32_t lastSym = mask.GetSize () - 1; // UL control
+  uint32_t symIdx = 1; // DL control
+  for (uint32_t ue = 0; ue < demands.size (); ue++)
+    {
+      if (demands[ue].m_retx)
+        {
+          uint32_t start = mask.FindFreeRun (symIdx, demands[ue].m_numSym);
+          if (start + demands[ue].m_numSym <= lastSym)
+            {
+              mask.SetBusy (start, demands[ue].m_numSym);
+              allocations.push_back (start);
+              allocations.push_back (demands[ue].m_numSym);
+            }
+          continue;
+        }
+      uint32_t numSymNeeded = demands[ue].m_numSym;
+      while (numSymNeeded > 0 && symIdx < lastSym)
+        {
+          symIdx = mask.GetFirstFree (symIdx);
+          uint32_t numFree = std::min (mask.GetFreeRunLength (symIdx, numSymNeeded), lastSym - std::min (symIdx, lastSym));
+          if (numFree == 0)
+            {
+              break;
+            }
+          mask.SetBusy (symIdx, numFree);
+          allocations.push_back (symIdx);
+          allocations.push_back (numFree);
+          numSymNeeded -= numFree;
+          symIdx += numFree;
+        }
+    }
+  return allocations;
+}
+
+/**
+ * Check that SymbolAllocationMask finds the same free and busy symbols as
+ * the symbol by symbol scans, on masks with runs of busy symbols across the
+ * boundaries of the 64 bit words, on the empty and the full mask, and on
+ * random masks
+ */
+class MmWaveSymbolMaskTestCase : public TestCase
+{
+public:
+  MmWaveSymbolMaskTestCase (uint32_t numSymbols);
+  virtual ~MmWaveSymbolMaskTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void SetBusy (uint32_t start, uint32_t numSymbols);
+  void CheckQueries (std::string mask);
+
+  uint32_t m_numSymbols;
+  SymbolAllocationMask m_mask;
+  LegacySymbolMask m_legacy;
+};
+
+static std::string
+BuildNameString (uint32_t numSymbols)
+{
+  std::ostringstream oss;
+  oss << numSymbols << " symbols";
+  return oss.str ();
+}
+
+MmWaveSymbolMaskTestCase::MmWaveSymbolMaskTestCase (uint32_t numSymbols)
+  : TestCase (BuildNameString (numSymbols)),
+    m_numSymbols (numSymbols),
+    m_mask (numSymbols),
+    m_legacy (numSymbols)
+{
+}
+
+MmWaveSymbolMaskTestCase::~MmWaveSymbolMaskTestCase ()
+{
+}
+
+void
+MmWaveSymbolMaskTestCase::SetBusy (uint32_t start, uint32_t numSymbols)
+{
+  start = std::min (start, m_numSymbols);
+  numSymbols = std::min (numSymbols, m_numSymbols - start);
+  m_mask.SetBusy (start, numSymbols);
+  m_legacy.SetBusy (start, numSymbols);
+}
+
+void
+MmWaveSymbolMaskTestCase::CheckQueries (std::string mask)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_mask.GetNumBusy (), m_legacy.GetNumBusy (), mask << ": GetNumBusy");
+  for (uint32_t symbol = 0; symbol < m_numSymbols; symbol++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_mask.IsBusy (symbol), m_legacy.IsBusy (symbol), mask << ": IsBusy " << symbol);
+    }
+  // the lengths around the size of a word and of the mask, from each start
+  // up to past the end of the mask
+  uint32_t lengths[] = {0, 1, 2, 3, 7, 31, 63, 64, 65, 127, 128, 129, m_numSymbols - 1, m_numSymbols, m_numSymbols + 1};
+  for (uint32_t start = 0; start <= m_numSymbols + 2; start++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_mask.GetFirstFree (start), std::min (m_legacy.GetFirstFree (start), m_numSymbols), mask << ": GetFirstFree " << start);
+      NS_TEST_ASSERT_MSG_EQ (m_mask.GetFirstBusy (start), std::min (m_legacy.GetFirstBusy (start), m_numSymbols), mask << ": GetFirstBusy " << start);
+      for (uint32_t i = 0; i < sizeof (lengths) / sizeof (lengths[0]); i++)
+        {
+          uint32_t length = lengths[i];
+          NS_TEST_ASSERT_MSG_EQ (m_mask.IsAnyBusy (start, length), m_legacy.IsAnyBusy (start, length), mask << ": IsAnyBusy " << start << " " << length);
+          NS_TEST_ASSERT_MSG_EQ (m_mask.GetFreeRunLength (start, length), m_legacy.GetFreeRunLength (start, length), mask << ": GetFreeRunLength " << start << " " << length);
+          NS_TEST_ASSERT_MSG_EQ (m_mask.FindFreeRun (start, length), m_legacy.FindFreeRun (start, length), mask << ": FindFreeRun " << start << " " << length);
+        }
+    }
+}
+
+void
+MmWaveSymbolMaskTestCase::DoRun (void)
+{
+  CheckQueries ("empty");
+
+  // single busy symbols at the edges of the mask and of the words
+  uint32_t symbols[] = {0, 62, 63, 64, 65, 127, 128, 191, 192, m_numSymbols - 1};
+  for (uint32_t i = 0; i < sizeof (symbols) / sizeof (symbols[0]); i++)
+    {
+      SetBusy (symbols[i], 1);
+    }
+  CheckQueries ("single symbols");
+
+  // runs of busy symbols across the boundaries of the words
+  m_mask.Clear ();
+  m_legacy = LegacySymbolMask (m_numSymbols);
+  SetBusy (60, 8);
+  SetBusy (120, 80);
+  CheckQueries ("runs across the words");
+
+  // a single free symbol, at the boundaries of the words
+  uint32_t freeSymbols[] = {0, 63, 64, 128, m_numSymbols - 1};
+  for (uint32_t i = 0; i < sizeof (freeSymbols) / sizeof (freeSymbols[0]); i++)
+    {
+      m_mask.Clear ();
+      m_legacy = LegacySymbolMask (m_numSymbols);
+      uint32_t symbol = std::min (freeSymbols[i], m_numSymbols - 1);
+      SetBusy (0, symbol);
+      SetBusy (symbol + 1, m_numSymbols);
+      std::ostringstream oss;
+      oss << "only " << symbol << " free";
+      CheckQueries (oss.str ());
+    }
+
+  SetBusy (0, m_numSymbols);
+  CheckQueries ("full");
+  m_mask.Clear ();
+  m_legacy = LegacySymbolMask (m_numSymbols);
+  CheckQueries ("cleared");
+
+  // random masks
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_numSymbols);
+  for (uint32_t trial = 0; trial < 20; trial++)
+    {
+      m_mask.Clear ();
+      m_legacy = LegacySymbolMask (m_numSymbols);
+      for (uint32_t run = 0; run < 10; run++)
+        {
+          uint32_t start = uniform->GetInteger (0, m_numSymbols - 1);
+          SetBusy (start, uniform->GetInteger (0, 80));
+        }
+      std::ostringstream oss;
+      oss << "random " << trial;
+      CheckQueries (oss.str ());
+    }
+}
+
+
+/**
+ * Compare the number of subframes per second which are scheduled with
+ * SymbolAllocationMask and with the symbol by symbol scans, and check that
+ * the allocations are the same, with 64 UEs and 8 IAB children in a
+ * subframe of 240 symbols.
+ */
+class MmWaveSymbolMaskBenchmarkTestCase : public TestCase
+{
+public:
+  MmWaveSymbolMaskBenchmarkTestCase (uint32_t numSymbols, uint32_t numUes, uint32_t numIabChildren);
+  virtual ~MmWaveSymbolMaskBenchmarkTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_numSymbols;
+  uint32_t m_numUes;
+  uint32_t m_numIabChildren;
+};
+
+static std::string
+BuildNameString (uint32_t numSymbols, uint32_t numUes, uint32_t numIabChildren)
+{
+  std::ostringstream oss;
+  oss << numSymbols << " symbols, " << numUes << " UEs, " << numIabChildren << " IAB children";
+  return oss.str ();
+}
+
+MmWaveSymbolMaskBenchmarkTestCase::MmWaveSymbolMaskBenchmarkTestCase (uint32_t numSymbols, uint32_t numUes, uint32_t numIabChildren)
+  : TestCase (BuildNameString (numSymbols, numUes, numIabChildren)),
+    m_numSymbols (numSymbols),
+    m_numUes (numUes),
+    m_numIabChildren (numIabChildren)
+{
+}
+
+MmWaveSymbolMaskBenchmarkTestCase::~MmWaveSymbolMaskBenchmarkTestCase ()
+{
+}
+
+void
+MmWaveSymbolMaskBenchmarkTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (m_numSymbols);
+
+  // the subframes to schedule
+  uint32_t numSubframes = 2000;
+  std::vector<std::vector<std::pair<uint32_t, uint32_t> > > backhaul (numSubframes);
+  std::vector<std::vector<UeDemand> > demands (numSubframes);
+  for (uint32_t sf = 0; sf < numSubframes; sf++)
+    {
+      for (uint32_t child = 0; child < m_numIabChildren; child++)
+        {
+          uint32_t length = uniform->GetInteger (1, 8);
+          backhaul[sf].push_back (std::make_pair (uniform->GetInteger (1, m_numSymbols - 1 - length), length));
+        }
+      for (uint32_t ue = 0; ue < m_numUes; ue++)
+        {
+          UeDemand demand;
+          demand.m_numSym = uniform->GetInteger (1, 4);
+          demand.m_retx = (uniform->GetValue () < 0.2);
+          demands[sf].push_back (demand);
+        }
+    }
+
+  std::vector<std::vector<uint32_t> > expected (numSubframes);
+  std::clock_t start = std::clock ();
+  for (uint32_t sf = 0; sf < numSubframes; sf++)
+    {
+      LegacySymbolMask legacy (m_numSymbols);
+      expected[sf] = ScheduleSubframe (legacy, backhaul[sf], demands[sf]);
+    }
+  double legacyTime = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+
+  uint32_t repetitions = 10;
+  uint32_t numMismatches = 0;
+  SymbolAllocationMask empty (m_numSymbols);
+  start = std::clock ();
+  for (uint32_t rep = 0; rep < repetitions; rep++)
+    {
+      for (uint32_t sf = 0; sf < numSubframes; sf++)
+        {
+          SymbolAllocationMask mask = empty;
+          numMismatches += (ScheduleSubframe (mask, backhaul[sf], demands[sf]) != expected[sf]);
+        }
+    }
+  double maskTime = (double) (std::clock () - start) / CLOCKS_PER_SEC;
+  NS_TEST_ASSERT_MSG_EQ (numMismatches, 0, "different allocations");
+
+  std::cout << m_numSymbols << " symbols, " << m_numUes << " UEs, " << m_numIabChildren << " IAB children: vector<bool> "
+            << numSubframes / legacyTime << " subframes/s, bitmap "
+            << repetitions * numSubframes / maskTime << " subframes/s" << std::endl;
+}
+
+
+class MmWaveSymbolMaskTestSuite : public TestSuite
+{
+public:
+  MmWaveSymbolMaskTestSuite ();
+};
+
+MmWaveSymbolMaskTestSuite::MmWaveSymbolMaskTestSuite ()
+  : TestSuite ("mmwave-symbol-mask", UNIT)
+{
+  AddTestCase (new MmWaveSymbolMaskTestCase (24), TestCase::QUICK);
+  AddTestCase (new MmWaveSymbolMaskTestCase (64), TestCase::QUICK);
+  AddTestCase (new MmWaveSymbolMaskTestCase (65), TestCase::QUICK);
+  AddTestCase (new MmWaveSymbolMaskTestCase (128), TestCase::QUICK);
+  AddTestCase (new MmWaveSymbolMaskTestCase (240), TestCase::QUICK);
+}
+
+static MmWaveSymbolMaskTestSuite mmWaveSymbolMaskTestSuite;
+
+
+class MmWaveSymbolMaskBenchmarkTestSuite : public TestSuite
+{
+public:
+  MmWaveSymbolMaskBenchmarkTestSuite ();
+};
+
+MmWaveSymbolMaskBenchmarkTestSuite::MmWaveSymbolMaskBenchmarkTestSuite ()
+  : TestSuite ("mmwave-symbol-mask-benchmark", PERFORMANCE)
+{
+  AddTestCase (new MmWaveSymbolMaskBenchmarkTestCase (24, 8, 2), TestCase::QUICK);
+  AddTestCase (new MmWaveSymbolMaskBenchmarkTestCase (240, 64, 8), TestCase::QUICK);
+}
+
+static MmWaveSymbolMaskBenchmarkTestSuite mmWaveSymbolMaskBenchmarkTestSuite;
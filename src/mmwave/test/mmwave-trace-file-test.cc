@@ -0,0 +1,187 @@
+ /* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+ /*
+ *   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/mmwave-trace-file.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <complex>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveTraceFileTest");
+
+/**
+ * Check that a file of the BeamFormingMatrix directory is parsed to the same
+ * values as the stringstream-based parser which MmWaveBeamforming used
+ * before, and that the binary version of the file is mapped without
+ * differences
+ */
+class MmWaveTraceFileTestCase : public TestCase
+{
+public:
+  MmWaveTraceFileTestCase (std::string name, bool complex);
+  virtual ~MmWaveTraceFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+  static std::complex<double> ParseComplex (std::string strCmplx);
+  static std::vector<std::vector<std::complex<double> > > ParseLegacy (std::string filename, bool complex);
+  void CheckTable (Ptr<const MmWaveTraceFile> table, const std::vector<std::vector<std::complex<double> > > &expected);
+
+  std::string m_name;
+  bool m_complex;
+};
+
+MmWaveTraceFileTestCase::MmWaveTraceFileTestCase (std::string name, bool complex)
+  : TestCase (name),
+    m_name (name),
+    m_complex (complex)
+{
+}
+
+MmWaveTraceFileTestCase::~MmWaveTraceFileTestCase ()
+{
+}
+
+std::complex<double>
+MmWaveTraceFileTestCase::ParseComplex (std::string strCmplx)
+{
+  double re = 0.00;
+  double im = 0.00;
+  size_t findj = strCmplx.find ("i");
+  if (findj == std::string::npos)
+    {
+      im = -1.00;
+    }
+  else
+    {
+      strCmplx[findj] = '\0';
+    }
+  if ((strCmplx.find ("+",1) == std::string::npos && strCmplx.find ("-",1) == std::string::npos) && im != -1)
+    {
+      re = -1.00;
+    }
+  std::stringstream stream (strCmplx);
+  if (re != -1.00)
+    {
+      stream >> re;
+    }
+  else
+    {
+      re = 0;
+    }
+  if (im != -1)
+    {
+      stream >> im;
+    }
+  else
+    {
+      im = 0.00;
+    }
+  return std::complex<double> (re, im);
+}
+
+std::vector<std::vector<std::complex<double> > >
+MmWaveTraceFileTestCase::ParseLegacy (std::string filename, bool complex)
+{
+  std::vector<std::vector<std::complex<double> > > rows;
+  std::ifstream singlefile (filename.c_str (), std::ifstream::in);
+  std::string line;
+  std::string token;
+  while (std::getline (singlefile, line))
+    {
+      std::vector<std::complex<double> > row;
+      std::istringstream stream (line);
+      while (std::getline (stream, token, ','))
+        {
+          if (complex)
+            {
+              row.push_back (ParseComplex (token));
+            }
+          else
+            {
+              double value = 0.00;
+              std::stringstream tokenStream (token);
+              tokenStream >> value;
+              row.push_back (value);
+            }
+        }
+      rows.push_back (row);
+    }
+  return rows;
+}
+
+void
+MmWaveTraceFileTestCase::CheckTable (Ptr<const MmWaveTraceFile> table, const std::vector<std::vector<std::complex<double> > > &expected)
+{
+  NS_TEST_ASSERT_MSG_EQ (table->IsComplex (), m_complex, "wrong type");
+  NS_TEST_ASSERT_MSG_EQ (table->GetNRows (), expected.size (), "wrong number of rows");
+  for (uint32_t row = 0; row < expected.size (); row++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table->GetRowSize (row), expected[row].size (), "wrong size of row " << row);
+      for (uint32_t i = 0; i < expected[row].size (); i++)
+        {
+          std::complex<double> value = m_complex ? table->GetComplexRow (row)[i] : table->GetRow (row)[i];
+          NS_TEST_ASSERT_MSG_EQ (value.real (), expected[row][i].real (), "different value in row " << row);
+          NS_TEST_ASSERT_MSG_EQ (value.imag (), expected[row][i].imag (), "different value in row " << row);
+        }
+    }
+}
+
+void
+MmWaveTraceFileTestCase::DoRun (void)
+{
+  SetDataDir (NS_TEST_SOURCEDIR);
+  std::string textFile = CreateDataDirFilename ("../model/BeamFormingMatrix/" + m_name + ".txt");
+  std::vector<std::vector<std::complex<double> > > expected = ParseLegacy (textFile, m_complex);
+  NS_TEST_ASSERT_MSG_GT (expected.size (), 0, "cannot read " << textFile);
+
+  Ptr<MmWaveTraceFile> parsed = MmWaveTraceFile::ParseText (textFile, m_complex);
+  NS_TEST_ASSERT_MSG_EQ (parsed->IsMapped (), false, "text file mapped");
+  CheckTable (parsed, expected);
+
+  std::string binaryFile = CreateTempDirFilename (m_name + ".bin");
+  parsed->WriteBinary (binaryFile);
+  Ptr<const MmWaveTraceFile> mapped = MmWaveTraceFile::Load (binaryFile, m_complex);
+  NS_TEST_ASSERT_MSG_EQ (mapped->IsMapped (), true, "binary file not mapped");
+  CheckTable (mapped, expected);
+  NS_TEST_ASSERT_MSG_EQ (MmWaveTraceFile::Load (binaryFile, m_complex), mapped, "the table is not shared");
+}
+
+
+class MmWaveTraceFileTestSuite : public TestSuite
+{
+public:
+  MmWaveTraceFileTestSuite ();
+};
+
+MmWaveTraceFileTestSuite::MmWaveTraceFileTestSuite ()
+  : TestSuite ("mmwave-trace-file", UNIT)
+{
+  AddTestCase (new MmWaveTraceFileTestCase ("SmallScaleFading", false), TestCase::QUICK);
+  AddTestCase (new MmWaveTraceFileTestCase ("TxAntenna", true), TestCase::QUICK);
+  AddTestCase (new MmWaveTraceFileTestCase ("RxAntenna", true), TestCase::QUICK);
+  AddTestCase (new MmWaveTraceFileTestCase ("TxSpatialSigniture", true), TestCase::QUICK);
+  AddTestCase (new MmWaveTraceFileTestCase ("RxSpatialSigniture", true), TestCase::QUICK);
+}
+
+static MmWaveTraceFileTestSuite mmWaveTraceFileTestSuite;
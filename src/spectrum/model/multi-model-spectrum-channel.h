@@ -137,7 +137,6 @@ public:
 protected:
   void DoDispose ();
 
-private:
   /**
    * This method checks if m_rxSpectrumModelInfoMap contains an entry
    * for the given TX SpectrumModel. If such entry exists, it returns
@@ -59,6 +59,12 @@ void SpectrumPropagationLossModel::SetNext (Ptr<SpectrumPropagationLossModel> ne
   m_next = next;
 }
 
+Ptr<SpectrumPropagationLossModel>
+SpectrumPropagationLossModel::GetNext () const
+{
+  return m_next;
+}
+
 
 Ptr<SpectrumValue>
 SpectrumPropagationLossModel::CalcRxPowerSpectralDensity (Ptr<const SpectrumValue> txPsd,
@@ -60,6 +60,11 @@ public:
    */
   void SetNext (Ptr<SpectrumPropagationLossModel> next);
 
+  /**
+   * \return the SpectrumPropagationLossModel chained to this one, if any
+   */
+  Ptr<SpectrumPropagationLossModel> GetNext () const;
+
   /**
    * This method is to be called to calculate
    *
@@ -21,8 +21,10 @@
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <string.h>
+#include <stdlib.h>
 
 #include "ns3/core-module.h"
 
@@ -145,6 +147,114 @@ Bench::Cb (void)
 }
 
 
+/// Replay of an event-time trace
+class Replay
+{
+public:
+  /**
+   * constructor
+   * \param filename the event trace of a simulation, either binary, as
+   *        written by the EventTraceFilename attribute of the
+   *        DefaultSimulatorImpl, or ascii, with the insertion time and
+   *        the event time of an event, in time steps, on each line
+   */
+  Replay (std::string filename);
+
+  /**
+   * Replay the trace with a scheduler
+   * \param factory the scheduler factory
+   */
+  void RunReplay (ObjectFactory factory);
+private:
+  /// the trace
+  std::vector<DefaultSimulatorImpl::EventTraceRecord> m_records;
+};
+
+Replay::Replay (std::string filename)
+{
+  if (DefaultSimulatorImpl::ReadEventTrace (filename, m_records))
+    {
+      LOGME ("found " << m_records.size () << " events in the event trace " << filename);
+      return;
+    }
+
+  std::ifstream input (filename.c_str ());
+  if (!input.good ())
+    {
+      LOGME ("cannot open " << filename);
+      exit (1);
+    }
+  std::string line;
+  while (std::getline (input, line))
+    {
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+      std::istringstream iss (line);
+      DefaultSimulatorImpl::EventTraceRecord record;
+      record.context = 0;
+      if (iss >> record.insertTs >> record.eventTs)
+        {
+          m_records.push_back (record);
+        }
+    }
+  LOGME ("found " << m_records.size () << " events in " << filename);
+}
+
+void
+Replay::RunReplay (ObjectFactory factory)
+{
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+  SystemWallClockMs time;
+  uint64_t removes = 0;
+  uint64_t size = 0;
+  uint64_t peak = 0;
+  double simu;
+
+  DEB ("replaying");
+  time.Start ();
+  Scheduler::Event ev;
+  ev.impl = 0;
+  for (uint32_t i = 0; i < m_records.size (); ++i)
+    {
+      // an event is inserted while the simulator runs the last event
+      // at the same time or before
+      const DefaultSimulatorImpl::EventTraceRecord &record = m_records[i];
+      while (!scheduler->IsEmpty ()
+             && scheduler->PeekNext ().key.m_ts <= record.insertTs)
+        {
+          scheduler->RemoveNext ();
+          ++removes;
+          --size;
+        }
+      ev.key.m_ts = record.eventTs;
+      ev.key.m_context = record.context;
+      ev.key.m_uid = i;
+      scheduler->Insert (ev);
+      if (++size > peak)
+        {
+          peak = size;
+        }
+    }
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+      ++removes;
+      --size;
+    }
+  simu = time.End ();
+  simu /= 1000;
+  DEB ("replay took " << simu << "s");
+
+  LOG (std::setw (g_fwidth) << simu <<
+       std::setw (g_fwidth) << (m_records.size () / simu) <<
+       std::setw (g_fwidth) << (removes / simu) <<
+       std::setw (g_fwidth) << (simu / (m_records.size () + removes)) <<
+       std::setw (g_fwidth) << peak);
+}
+
+
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
 {
@@ -207,11 +317,14 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string replay = "";
+  std::string schedulers = "";
 
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
@@ -221,16 +334,29 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "With --replay=\"<filename>\", every Scheduler replays instead\n"
+             "the insertions and removals of a trace captured from a\n"
+             "simulation with the EventTraceFilename attribute of the\n"
+             "DefaultSimulatorImpl, e.g. with the argument\n"
+             "--ns3::DefaultSimulatorImpl::EventTraceFilename=events.bin\n"
+             "of a simulation script, or of an ascii trace with the\n"
+             "insertion time and the event time of an event, in time\n"
+             "steps, on each line.  --schedulers restricts the replay to a\n"
+             "comma-separated list of Schedulers.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("replay", "file of event-time trace to replay", replay);
+  cmd.AddValue ("schedulers", "comma-separated Schedulers of the replay (default all)", schedulers);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -249,12 +375,77 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
-  Simulator::SetScheduler (factory);
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
+  if (replay != "")
+    {
+      Replay trace (replay);
+
+      // all the Schedulers, or those requested
+      std::vector<TypeId> tids;
+      if (schedulers == "")
+        {
+          for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+            {
+              TypeId tid = TypeId::GetRegistered (i);
+              if (tid != Scheduler::GetTypeId () && tid.IsChildOf (Scheduler::GetTypeId ())
+                  && tid.HasConstructor ())
+                {
+                  tids.push_back (tid);
+                }
+            }
+        }
+      else
+        {
+          std::istringstream names (schedulers);
+          std::string name;
+          while (std::getline (names, name, ','))
+            {
+              tids.push_back (TypeId::LookupByName (name));
+            }
+        }
+
+      // table header
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (5 * g_fwidth) << "Replay:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Ins (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Rem (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/op)" <<
+           std::left << std::setw (g_fwidth) << "Peak (ev)");
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+      for (std::vector<TypeId>::const_iterator tid = tids.begin (); tid != tids.end (); ++tid)
+        {
+          LOG (tid->GetName ());
+          factory.SetTypeId (*tid);
+          for (uint32_t i = 0; i < runs; i++)
+            {
+              std::cout << std::setw (g_fwidth) << i;
+              trace.RunReplay (factory);
+            }
+        }
+      LOG ("");
+      return 0;
+    }
+
   LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+  Simulator::SetScheduler (factory);
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);